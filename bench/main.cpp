@@ -0,0 +1,318 @@
+#include <engine.h>
+#include <system.h>
+#include <module.h>
+#include <timer.h>
+
+#include <file.h>
+#include <log.h>
+#include <json.h>
+
+#include <adapters/headlessadaptor.h>
+#include <adapters/replayadaptor.h>
+
+#include <systems/rendersystem.h>
+
+#include <components/camera.h>
+
+#include <resources/pipeline.h>
+
+#include <commandbuffer.h>
+
+#include <gui.h>
+#include <bullet.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <new>
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static std::atomic<uint64_t> s_Allocations(0);
+
+void *operator new(size_t size) {
+    s_Allocations++;
+    void *result = malloc(size ? size : 1);
+    if(result == nullptr) {
+        throw std::bad_alloc();
+    }
+    return result;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+class NullRenderSystem : public RenderSystem {
+public:
+    bool init() override {
+        registerClasses();
+        return true;
+    }
+};
+
+class NullRender : public Module {
+public:
+    NullRender() :
+            m_pSystem(new NullRenderSystem) {
+    }
+    ~NullRender() {
+        delete m_pSystem;
+    }
+
+    const char *description() const { return "Null Render"; }
+
+    const char *version() const { return "1.0"; }
+
+    uint8_t types() const { return SYSTEM; }
+
+    System *system() { return m_pSystem; }
+
+protected:
+    System *m_pSystem;
+};
+
+class BenchAdaptor : public HeadlessAdaptor {
+public:
+    struct Frame {
+        float time;
+        vector<float> systems;
+        uint64_t allocations;
+        uint32_t drawCalls;
+        uint32_t polygons;
+    };
+
+public:
+    BenchAdaptor(Engine *engine, const string &map, const vector<System *> &systems) :
+            HeadlessAdaptor(engine),
+            m_Map(map),
+            m_Systems(systems),
+            m_Allocations(0) {
+    }
+
+    bool start() override {
+        bool result = HeadlessAdaptor::start();
+        // Must be overridden after the bundle was loaded
+        Engine::setValue(".entry", m_Map);
+
+        m_Frames.reserve(frameLimit());
+        m_Last = Clock::now();
+        m_Allocations = s_Allocations;
+        return result;
+    }
+
+    void update() override {
+        Clock::time_point current = Clock::now();
+
+        Frame stats;
+        stats.time = std::chrono::duration_cast<std::chrono::duration<float, std::milli> >(current - m_Last).count();
+        for(auto it : m_Systems) {
+            stats.systems.push_back(it->updateTime());
+        }
+        stats.drawCalls = 0;
+        stats.polygons = 0;
+        Camera *camera = Camera::current();
+        if(camera) {
+            ICommandBuffer *buffer = camera->pipeline()->buffer();
+            stats.drawCalls = buffer->drawCalls();
+            stats.polygons = buffer->polygons();
+        }
+        uint64_t allocations = s_Allocations;
+        stats.allocations = allocations - m_Allocations;
+        // Skip the warm-up frame which uploads all the resources
+        if(frame() > 0) {
+            m_Frames.push_back(stats);
+        }
+
+        HeadlessAdaptor::update();
+
+        m_Allocations = s_Allocations;
+        m_Last = Clock::now();
+    }
+
+    VariantMap report() const {
+        VariantMap result;
+        result["map"] = m_Map;
+        result["frames"] = static_cast<int32_t>(m_Frames.size());
+        result["delta"] = Timer::fixedFrameTime();
+
+        vector<float> values;
+        values.reserve(m_Frames.size());
+
+        for(auto &it : m_Frames) {
+            values.push_back(it.time);
+        }
+        result["frameTime"] = percentiles(values);
+
+        VariantMap systems;
+        for(uint32_t i = 0; i < m_Systems.size(); i++) {
+            values.clear();
+            for(auto &it : m_Frames) {
+                values.push_back(it.systems[i]);
+            }
+            systems[m_Systems[i]->name()] = percentiles(values);
+        }
+        result["systems"] = systems;
+
+        values.clear();
+        uint64_t total = 0;
+        for(auto &it : m_Frames) {
+            values.push_back(it.allocations);
+            total += it.allocations;
+        }
+        VariantMap allocations = percentiles(values);
+        allocations["total"] = static_cast<int32_t>(total);
+        result["allocations"] = allocations;
+
+        values.clear();
+        for(auto &it : m_Frames) {
+            values.push_back(it.drawCalls);
+        }
+        result["drawCalls"] = percentiles(values);
+
+        values.clear();
+        for(auto &it : m_Frames) {
+            values.push_back(it.polygons);
+        }
+        result["polygons"] = percentiles(values);
+
+        return result;
+    }
+
+protected:
+    static VariantMap percentiles(vector<float> values) {
+        VariantMap result;
+        if(values.empty()) {
+            return result;
+        }
+        std::sort(values.begin(), values.end());
+
+        float sum = 0.0f;
+        for(auto it : values) {
+            sum += it;
+        }
+        result["mean"] = sum / values.size();
+        result["p50"] = values[(values.size() - 1) * 50 / 100];
+        result["p90"] = values[(values.size() - 1) * 90 / 100];
+        result["p99"] = values[(values.size() - 1) * 99 / 100];
+        result["max"] = values.back();
+        return result;
+    }
+
+protected:
+    string m_Map;
+
+    vector<System *> m_Systems;
+
+    vector<Frame> m_Frames;
+
+    Clock::time_point m_Last;
+
+    uint64_t m_Allocations;
+};
+
+static void usage() {
+    std::cerr << "Usage: thunder-bench <map> [--frames N] [--delta SECONDS] [--output FILE] [--replay FILE]" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        usage();
+        return 1;
+    }
+
+    string map;
+    string output;
+    string replay;
+    uint32_t frames = 1000;
+    float delta = 1.0f / 60.0f;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if(strcmp(argv[i], "--delta") == 0 && i + 1 < argc) {
+            delta = static_cast<float>(atof(argv[++i]));
+        } else if(strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if(strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay = argv[++i];
+        } else if(argv[i][0] != '-') {
+            map = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if(map.empty()) {
+        usage();
+        return 1;
+    }
+
+    Log::setLogLevel(Log::ERR);
+
+    File *file = new File;
+    file->finit(argv[0]);
+    Engine *engine = new Engine(file, argv[0]);
+
+    vector<Module *> modules = { new NullRender, new Gui, new Bullet(engine) };
+    vector<System *> systems;
+    for(auto it : modules) {
+        systems.push_back(it->system());
+    }
+
+    BenchAdaptor *adaptor = new BenchAdaptor(engine, map, systems);
+    // One extra warm-up frame
+    adaptor->setFrameLimit(frames + 1);
+    if(replay.empty()) {
+        engine->setPlatformAdaptor(adaptor);
+    } else {
+        // The recorded delta times override the --delta option
+        engine->setPlatformAdaptor(new ReplayAdaptor(adaptor, replay, ReplayAdaptor::Replay));
+    }
+
+    int result = 1;
+    if(engine->init()) {
+        if(replay.empty()) {
+            Timer::setFixedFrameTime(delta);
+        }
+
+        for(auto it : modules) {
+            engine->addModule(it);
+        }
+
+        if(engine->start()) {
+            string data = Json::save(adaptor->report(), 0);
+            if(output.empty()) {
+                std::cout << data << std::endl;
+            } else {
+                std::ofstream stream(output);
+                stream << data << std::endl;
+            }
+            result = 0;
+        }
+    }
+
+    delete engine;
+    delete file;
+
+    return result;
+}
@@ -12,6 +12,13 @@
 
 #include <QCoreApplication>
 
+#include <engine.h>
+#include <assetindex.h>
+#include <systems/resourcesystem.h>
+
+static const char *gIndex("index");
+static const char *gBinaryIndex("index.bin");
+
 Builder::Builder() {
     connect(AssetManager::instance(), &AssetManager::importFinished, this, &Builder::onImportFinished);
 
@@ -42,6 +49,10 @@ void Builder::setPlatform(const QString &platform) {
     }
 }
 
+void Builder::setPatchBase(const QString &base) {
+    m_PatchBase = base;
+}
+
 void Builder::package(const QString &target) {
     QFileInfo info(target);
     QString dir = info.absolutePath();
@@ -51,44 +62,91 @@ void Builder::package(const QString &target) {
         dir += "/Contents/MacOS";
     }
 #endif
-    dir    += "/base.pak";
+    Package base;
+    bool patch = !m_PatchBase.isEmpty();
+    if(patch) {
+        if(!base.open(qPrintable(m_PatchBase))) {
+            Log(Log::ERR) << "Can't open base package" << qPrintable(m_PatchBase);
+            return;
+        }
+        dir += "/patch.pak";
+    } else {
+        dir += "/base.pak";
+    }
 
     Log(Log::INF) << "Packaging Assets to:" << qPrintable(dir);
-    QuaZip zip(dir);
-    if(!zip.open(QuaZip::mdCreate)) {
+    PackageWriter writer;
+    if(!writer.open(qPrintable(dir), patch)) {
         Log(Log::ERR) << "Can't open package";
         return;
     }
-    QuaZipFile outZipFile(&zip);
+
+    auto unchanged = [&base, patch](const string &name, const uint8_t *data, uint64_t size) {
+        if(patch) {
+            const Package::Entry *entry = base.find(name);
+            if(entry && entry->originalSize == size) {
+                vector<uint8_t> buffer(entry->originalSize);
+                return base.read(entry, buffer.data()) && memcmp(buffer.data(), data, buffer.size()) == 0;
+            }
+        }
+        return false;
+    };
 
     QDirIterator it(ProjectManager::instance()->importPath(), QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
     while(it.hasNext()) {
         QString path = it.next();
         QFileInfo info(path);
-        if(info.isFile()) {
+        // The JSON index is replaced with the binary one below
+        if(info.isFile() && info.fileName() != gIndex) {
             QFile inFile(info.absoluteFilePath());
 
             string origin   = AssetManager::instance()->guidToPath(info.fileName().toStdString());
-            Log(Log::INF) << "\tCoping:" << origin.c_str();
 
             if(!inFile.open(QIODevice::ReadOnly)) {
-                zip.close();
+                writer.close();
                 Log(Log::ERR) << "Can't open input file";
                 return;
             }
+            QByteArray data = inFile.readAll();
+            inFile.close();
+
+            string name = info.fileName().toStdString();
+            if(unchanged(name, reinterpret_cast<const uint8_t *>(data.constData()), data.size())) {
+                continue;
+            }
+            Log(Log::INF) << "\tCoping:" << origin.c_str();
+
+            // Already compressed formats don't benefit from the package compression
+            QString type = AssetManager::instance()->assetTypeName(QFileInfo(origin.c_str()));
+            int compression = (type == "AudioClip") ? Package::None : Package::LZ4;
 
-            if(!outZipFile.open(QIODevice::WriteOnly, QuaZipNewInfo(info.fileName(), info.absoluteFilePath()))) {
-                inFile.close();
-                zip.close();
-                Log(Log::ERR) << "Can't open output file";
+            if(!writer.addEntry(name, reinterpret_cast<const uint8_t *>(data.constData()), data.size(), compression)) {
+                writer.close();
+                Log(Log::ERR) << "Can't write output file";
                 return;
             }
-            outZipFile.write(inFile.readAll());
-
-            outZipFile.close();
-            inFile.close();
         }
     }
+
+    Engine::reloadBundle();
+    AssetIndex &index = static_cast<ResourceSystem *>(Engine::resourceSystem())->assetIndex();
+    if(!index.isValid()) {
+        writer.close();
+        Log(Log::ERR) << "Can't build asset index";
+        return;
+    }
+    // The index is stored uncompressed to be used directly from the mapped package
+    if(!unchanged(gBinaryIndex, index.data(), index.dataSize()) &&
+       !writer.addEntry(gBinaryIndex, index.data(), index.dataSize(), Package::None)) {
+        writer.close();
+        Log(Log::ERR) << "Can't write asset index";
+        return;
+    }
+
+    if(!writer.close()) {
+        Log(Log::ERR) << "Can't finalize package";
+        return;
+    }
     Log(Log::INF) << "Packaging Done";
 
     if(m_Stack.isEmpty()) {
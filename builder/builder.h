@@ -4,8 +4,7 @@
 #include <QDirIterator>
 #include <QStack>
 
-#include <quazip.h>
-#include <quazipfile.h>
+#include <package.h>
 
 class Builder : public QObject {
     Q_OBJECT
@@ -13,6 +12,8 @@ public:
     Builder         ();
 
     void            setPlatform         (const QString &platform);
+
+    void            setPatchBase        (const QString &base);
 signals:
     void            packDone            ();
     void            moveDone            (const QString &target);
@@ -23,6 +24,8 @@ public slots:
 
 private:
     QStack<QString> m_Stack;
+
+    QString         m_PatchBase;
 };
 
 #endif // BUILDER_H
@@ -40,6 +40,11 @@ int main(int argc, char *argv[]) {
                 QCoreApplication::translate("main", "platform"));
     parser.addOption(platformOption);
 
+    QCommandLineOption patchOption(QStringList() << "patch",
+                QCoreApplication::translate("main", "Build a patch package which contains only the assets changed since the <base> package."),
+                QCoreApplication::translate("main", "base"));
+    parser.addOption(patchOption);
+
     parser.process(a);
 
     if(!parser.isSet(sourceFileOption) || !parser.isSet(targetDirectoryOption)) {
@@ -67,6 +72,7 @@ int main(int argc, char *argv[]) {
     PluginManager::instance()->rescan();
     PluginManager::instance()->initSystems();
 
+    builder.setPatchBase(parser.value(patchOption));
     builder.setPlatform(parser.value(platformOption));
 
     int result  = a.exec();
@@ -13,6 +13,7 @@ class AnimConverter : public IConverter {
     QStringList suffixes() const Q_DECL_OVERRIDE { return {"anim"}; }
 
     uint8_t convertFile(IConverterSettings *s) Q_DECL_OVERRIDE;
+    bool isThreadSafe(IConverterSettings *) const Q_DECL_OVERRIDE { return true; }
     IConverterSettings *createSettings() const Q_DECL_OVERRIDE;
 
     QString templatePath() const Q_DECL_OVERRIDE { return ":/Templates/Animation.anim"; }
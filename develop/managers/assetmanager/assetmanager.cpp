@@ -14,11 +14,13 @@
 #include <QCryptographicHash>
 
 #include <cstring>
+#include <atomic>
 
 #include "config.h"
 
 #include <json.h>
 #include <bson.h>
+#include <threadpool.h>
 
 #include <editor/converter.h>
 #include <editor/builder.h>
@@ -47,6 +49,8 @@
 
 #define BUFF_SIZE 1024
 
+#define HASH_BUFF_SIZE 65536
+
 #define INDEX_VERSION 2
 
 #define CODE "Code"
@@ -67,14 +71,87 @@ bool typeLessThan(IConverterSettings *left, IConverterSettings *right) {
     return left->type() < right->type();
 }
 
+namespace {
+QString hashFile(const QString &path) {
+    QString result;
+
+    QFile file(path);
+    if(file.open(QIODevice::ReadOnly)) {
+        QCryptographicHash hash(QCryptographicHash::Md5);
+
+        QByteArray buffer(HASH_BUFF_SIZE, 0);
+        qint64 size = 0;
+        while((size = file.read(buffer.data(), buffer.size())) > 0) {
+            hash.addData(buffer.constData(), size);
+        }
+        file.close();
+
+        QByteArray md5 = hash.result().toHex();
+        md5 = md5.insert(20, '-');
+        md5 = md5.insert(16, '-');
+        md5 = md5.insert(12, '-');
+        md5 = md5.insert( 8, '-');
+        md5.push_front('{');
+        md5.push_back('}');
+
+        result = md5;
+    }
+    return result;
+}
+
+class HashTask : public Object {
+public:
+    explicit HashTask(IConverterSettings *settings) :
+            m_pSettings(settings) {
+
+    }
+
+    void processEvents() override {
+        m_Hash = hashFile(m_pSettings->source());
+    }
+
+    IConverterSettings *m_pSettings;
+
+    QString m_Hash;
+};
+}
+
+class ImportTask : public Object {
+public:
+    ImportTask(IConverter *converter, IConverterSettings *settings) :
+            m_pConverter(converter),
+            m_pSettings(settings),
+            m_Result(1),
+            m_Done(false) {
+
+    }
+
+    void processEvents() override {
+        m_Result = m_pConverter->convertFile(m_pSettings);
+        m_Done = true;
+    }
+
+    IConverter *m_pConverter;
+
+    IConverterSettings *m_pSettings;
+
+    uint8_t m_Result;
+
+    atomic<bool> m_Done;
+};
+
 AssetManager::AssetManager() :
         m_Indices(static_cast<ResourceSystem *>(Engine::resourceSystem())->indices()),
         m_pDirWatcher(new QFileSystemWatcher(this)),
         m_pFileWatcher(new QFileSystemWatcher(this)),
+        m_Processed(0),
         m_pProjectManager(ProjectManager::instance()),
         m_pTimer(new QTimer(this)),
+        m_pPool(new ThreadPool),
         m_pEngine(nullptr) {
 
+    m_pPool->setMaxThreads(MAX(ThreadPool::optimalThreadCount(), 1U));
+
     m_Icons = {
         {"Invalid",     QImage(":/Style/styles/dark/images/unknown.png")},
         {"Text",        QImage(":/Style/styles/dark/images/text.png")},
@@ -100,6 +177,13 @@ AssetManager::AssetManager() :
 }
 
 AssetManager::~AssetManager() {
+    m_pPool->waitForDone();
+    delete m_pPool;
+
+    for(ImportTask *it : m_ImportTasks) {
+        delete it;
+    }
+
     delete m_pDirWatcher;
     delete m_pFileWatcher;
 
@@ -197,7 +281,7 @@ bool AssetManager::pushToImport(const QFileInfo &source) {
 }
 
 bool AssetManager::pushToImport(IConverterSettings *settings) {
-    if(settings) {
+    if(settings && !m_ImportQueue.contains(settings)) {
         m_ImportQueue.push_back(settings);
     }
     return true;
@@ -205,7 +289,8 @@ bool AssetManager::pushToImport(IConverterSettings *settings) {
 
 void AssetManager::reimport() {
     std::sort(m_ImportQueue.begin(), m_ImportQueue.end(), typeLessThan);
-    emit importStarted(m_ImportQueue.size(), tr("Importing resources"));
+    m_Processed = 0;
+    emit importStarted(m_ImportQueue.size() + m_ImportTasks.size(), tr("Importing resources"));
     m_pTimer->start(10);
 }
 
@@ -227,26 +312,22 @@ bool AssetManager::isOutdated(IConverterSettings *settings) {
     if(settings->version() > settings->currentVersion()) {
         return true;
     }
-    bool result = true;
-
-    QFile file(settings->source());
-    if(file.open(QIODevice::ReadOnly)) {
-        QByteArray md5 = QCryptographicHash::hash(file.readAll(), QCryptographicHash::Md5).toHex();
-        file.close();
+    return isOutdated(settings, hashFile(settings->source()));
+}
 
-        md5 = md5.insert(20, '-');
-        md5 = md5.insert(16, '-');
-        md5 = md5.insert(12, '-');
-        md5 = md5.insert( 8, '-');
-        md5.push_front('{');
-        md5.push_back('}');
+bool AssetManager::isOutdated(IConverterSettings *settings, const QString &hash) {
+    if(settings->version() > settings->currentVersion()) {
+        return true;
+    }
+    bool result = true;
 
-        if(settings->hash() == md5) {
+    if(!hash.isEmpty()) {
+        if(settings->hash() == hash) {
             if(settings->typeName() == CODE || QFileInfo::exists(settings->absoluteDestination())) {
                 result = false;
             }
         }
-        settings->setHash(md5);
+        settings->setHash(hash);
     }
     return result;
 }
@@ -627,17 +708,42 @@ void AssetManager::dumpBundle() {
 }
 
 void AssetManager::onPerform() {
-    QDir dir(m_pProjectManager->contentPath());
+    for(auto it = m_ImportTasks.begin(); it != m_ImportTasks.end(); ) {
+        ImportTask *task = *it;
+        if(task->m_Done) {
+            it = m_ImportTasks.erase(it);
+            finishImport(task->m_pSettings, task->m_Result == 0);
+            delete task;
+        } else {
+            ++it;
+        }
+    }
+
+    while(!m_ImportQueue.isEmpty()) {
+        IConverterSettings *settings = m_ImportQueue.first();
+        // The queue is sorted by type and the next type may depend on the resources of the current one
+        for(ImportTask *it : m_ImportTasks) {
+            if(it->m_pSettings->type() != settings->type() || it->m_pSettings == settings) {
+                return;
+            }
+        }
+        m_ImportQueue.removeFirst();
 
-    if(!m_ImportQueue.isEmpty()) {
-        IConverterSettings *settings = m_ImportQueue.takeFirst();
+        IConverter *converter = getConverter(settings);
+        if(converter && converter->isThreadSafe(settings)) {
+            Log(Log::INF) << "Converting:" << qPrintable(settings->source());
 
-        if(!convert(settings)) {
-            QString dst = m_pProjectManager->importPath() + "/" + settings->destination();
-            dir.mkpath(QFileInfo(dst).absoluteDir().absolutePath());
-            QFile::copy(settings->source(), dst);
+            ImportTask *task = new ImportTask(converter, settings);
+            m_ImportTasks.push_back(task);
+            m_pPool->start(*task);
+        } else {
+            // Converter uses engine systems so it must be processed on this thread, one per tick
+            finishImport(settings, convert(settings));
+            return;
         }
-    } else {
+    }
+
+    if(m_ImportTasks.isEmpty()) {
         foreach(IBuilder *it, m_Builders) {
             it->rescanSources(ProjectManager::instance()->contentPath());
             if(!it->isEmpty()) {
@@ -674,20 +780,17 @@ void AssetManager::onFileChanged(const QString &path, bool force) {
         if(force || isOutdated(settings)) {
             pushToImport(settings);
         } else {
-            if(settings->typeName() != CODE) {
-                QString guid = settings->destination();
-                registerAsset(info, guid, settings->typeName());
-                for(const QString &it : settings->subKeys()) {
-                    QString value = settings->subItem(it);
-                    QString path = info.absoluteFilePath() + "/" + it;
-                    registerAsset(path, value, settings->subTypeName(it));
-                }
-            }
+            registerSettings(settings);
         }
     }
 }
 
 void AssetManager::onDirectoryChanged(const QString &path, bool force) {
+    ThreadPool pool;
+    pool.setMaxThreads(MAX(ThreadPool::optimalThreadCount(), 1U));
+
+    QList<HashTask *> tasks;
+
     QDirIterator it(path, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
     while(it.hasNext()) {
         QString item = it.next();
@@ -700,7 +803,24 @@ void AssetManager::onDirectoryChanged(const QString &path, bool force) {
         }
         m_pFileWatcher->addPath(info.absoluteFilePath());
 
-        onFileChanged(item, force);
+        IConverterSettings *settings = fetchSettings(info);
+        if(force || settings->version() > settings->currentVersion()) {
+            pushToImport(settings);
+        } else {
+            HashTask *task = new HashTask(settings);
+            tasks.push_back(task);
+            pool.start(*task);
+        }
+    }
+    pool.waitForDone();
+
+    for(HashTask *it : tasks) {
+        if(isOutdated(it->m_pSettings, it->m_Hash)) {
+            pushToImport(it->m_pSettings);
+        } else {
+            registerSettings(it->m_pSettings);
+        }
+        delete it;
     }
 }
 
@@ -717,44 +837,60 @@ IConverter *AssetManager::getConverter(IConverterSettings *settings) {
 
 
 bool AssetManager::convert(IConverterSettings *settings) {
-    QFileInfo info(settings->source());
-    QString format = info.completeSuffix().toLower();
-
-    auto it = m_Converters.find(format);
-    if(it != m_Converters.end()) {
+    IConverter *converter = getConverter(settings);
+    if(converter) {
         Log(Log::INF) << "Converting:" << qPrintable(settings->source());
 
-        if(it.value()->convertFile(settings) == 0) {
-            QString guid = settings->destination();
-            QString type = settings->typeName();
-            QString source = settings->source();
-            registerAsset(source, guid, type);
+        return (converter->convertFile(settings) == 0);
+    }
+
+    return false;
+}
+
+void AssetManager::finishImport(IConverterSettings *settings, bool converted) {
+    if(converted) {
+        QString guid = settings->destination();
+        QString type = settings->typeName();
+        QString source = settings->source();
+        registerAsset(source, guid, type);
 
-            for(const QString &it : settings->subKeys()) {
-                QString value = settings->subItem(it);
-                QString type = settings->subTypeName(it);
-                QString path = source + "/" + it;
+        for(const QString &it : settings->subKeys()) {
+            QString value = settings->subItem(it);
+            QString type = settings->subTypeName(it);
+            QString path = source + "/" + it;
 
-                registerAsset(path, value, settings->subTypeName(it));
+            registerAsset(path, value, settings->subTypeName(it));
 
-                if(QFileInfo::exists(m_pProjectManager->importPath() + "/" + value)) {
-                    Object *res = Engine::loadResource(value.toStdString());
-                    static_cast<ResourceSystem *>(m_pEngine->resourceSystem())->reloadResource(static_cast<Resource *>(res));
-                    emit imported(path, type);
-                }
+            if(QFileInfo::exists(m_pProjectManager->importPath() + "/" + value)) {
+                Object *res = Engine::loadResource(value.toStdString());
+                static_cast<ResourceSystem *>(m_pEngine->resourceSystem())->reloadResource(static_cast<Resource *>(res));
+                emit imported(path, type);
             }
+        }
 
-            Object *res = Engine::loadResource(guid.toStdString());
-            static_cast<ResourceSystem *>(m_pEngine->resourceSystem())->reloadResource(static_cast<Resource *>(res));
-            emit imported(source, type);
+        Object *res = Engine::loadResource(guid.toStdString());
+        static_cast<ResourceSystem *>(m_pEngine->resourceSystem())->reloadResource(static_cast<Resource *>(res));
+        emit imported(source, type);
 
-            settings->saveSettings();
+        settings->saveSettings();
+    } else {
+        QString dst = m_pProjectManager->importPath() + "/" + settings->destination();
+        QDir().mkpath(QFileInfo(dst).absoluteDir().absolutePath());
+        QFile::copy(settings->source(), dst);
+    }
 
-            return true;
+    m_Processed++;
+    emit importProgress(m_Processed, m_Processed + m_ImportQueue.size() + m_ImportTasks.size());
+}
+
+void AssetManager::registerSettings(IConverterSettings *settings) {
+    if(settings->typeName() != CODE) {
+        QString source = settings->source();
+        registerAsset(source, settings->destination(), settings->typeName());
+        for(const QString &it : settings->subKeys()) {
+            registerAsset(source + "/" + it, settings->subItem(it), settings->subTypeName(it));
         }
     }
-
-    return false;
 }
 
 bool AssetManager::isOutdated() const {
@@ -21,6 +21,9 @@ class ProjectManager;
 
 class IBuilder;
 
+class ThreadPool;
+class ImportTask;
+
 struct Template {
     Template() :
         type(MetaType::INVALID) {
@@ -106,6 +109,7 @@ signals:
 
     void imported(const QString &path, const QString &type);
     void importStarted(int count, const QString &stage);
+    void importProgress(int processed, int count);
     void importFinished();
 
     void prefabCreated(uint32_t uuid, uint32_t clone);
@@ -137,11 +141,16 @@ protected:
     QFileSystemWatcher *m_pFileWatcher;
 
     QList<IConverterSettings *> m_ImportQueue;
+    QList<ImportTask *> m_ImportTasks;
+
+    int m_Processed;
 
     ProjectManager *m_pProjectManager;
 
     QTimer *m_pTimer;
 
+    ThreadPool *m_pPool;
+
     Engine *m_pEngine;
 
     ClassMap m_ClassMaps;
@@ -158,9 +167,14 @@ protected:
     void dumpBundle();
 
     bool isOutdated(IConverterSettings *settings);
+    bool isOutdated(IConverterSettings *settings, const QString &hash);
 
     bool convert(IConverterSettings *settings);
 
+    void finishImport(IConverterSettings *settings, bool converted);
+
+    void registerSettings(IConverterSettings *settings);
+
     QString pathToLocal(const QFileInfo &source);
 
     void registerAsset(const QFileInfo &source, const QString &guid, const QString &type);
@@ -65,6 +65,7 @@ AssimpImportSettings::AssimpImportSettings() :
         m_Scale(1.0f),
         m_Colors(true),
         m_Normals(true),
+        m_Bvh(false),
         m_Animation(true),
         m_Filter(Keyframe_Reduction),
         m_PositionError(0.5f),
@@ -95,6 +96,16 @@ void AssimpImportSettings::setNormals(bool value) {
     }
 }
 
+bool AssimpImportSettings::bvh() const {
+    return m_Bvh;
+}
+void AssimpImportSettings::setBvh(bool value) {
+    if(m_Bvh != value) {
+        m_Bvh = value;
+        emit updated();
+    }
+}
+
 bool AssimpImportSettings::animation() const {
     return m_Animation;
 }
@@ -474,6 +485,13 @@ Mesh *AssimpConverter::importMesh(const aiMesh *item, Actor *parent, AssimpImpor
 
     mesh->addLod(&l);
 
+    if(fbxSettings->bvh()) {
+        // Built hierarchies are serialized with the mesh
+        for(int i = 0; i < mesh->lodsCount(); i++) {
+            mesh->bvh(i);
+        }
+    }
+
     return mesh;
 }
 
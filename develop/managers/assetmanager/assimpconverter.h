@@ -24,6 +24,7 @@ class AssimpImportSettings : public IConverterSettings {
     Q_PROPERTY(float Custom_Scale READ customScale WRITE setCustomScale DESIGNABLE true USER true)
     Q_PROPERTY(bool Import_Color READ colors WRITE setColors DESIGNABLE true USER true)
     Q_PROPERTY(bool Import_Normals READ normals WRITE setNormals DESIGNABLE true USER true)
+    Q_PROPERTY(bool Build_BVH READ bvh WRITE setBvh DESIGNABLE true USER true)
 
     Q_PROPERTY(bool Import_Animation READ animation WRITE setAnimation DESIGNABLE true USER true)
     Q_PROPERTY(Compression Compress_Animation READ filter WRITE setFilter DESIGNABLE true USER true)
@@ -47,6 +48,9 @@ public:
     bool normals() const;
     void setNormals(bool value);
 
+    bool bvh() const;
+    void setBvh(bool value);
+
     bool animation() const;
     void setAnimation(bool value);
 
@@ -87,6 +91,7 @@ protected:
 
     bool m_Colors;
     bool m_Normals;
+    bool m_Bvh;
 
     bool m_Animation;
     Compression m_Filter;
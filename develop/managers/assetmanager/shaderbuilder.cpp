@@ -19,6 +19,8 @@
 #include <QJsonObject>
 
 #include <QDir>
+#include <QSaveFile>
+#include <QCryptographicHash>
 
 #include "material/aconstvalue.h"
 #include "material/acoordinates.h"
@@ -47,6 +49,7 @@
 #include <resources/material.h>
 
 #include <bson.h>
+#include <threadpool.h>
 
 #define TYPE        "Type"
 #define BLEND       "Blend"
@@ -60,11 +63,111 @@
 
 #define UNIFORM 50
 
-#define FORMAT_VERSION 4
+#define FORMAT_VERSION 5
+
+#define SHADER_CACHE "/shaders/"
 
 const regex include("^[ ]*#[ ]*include[ ]+[\"<](.*)[\">][^?]*");
 const regex pragma("^[ ]*#[ ]*pragma[ ]+(.*)[^?]*");
 
+namespace {
+    QString cacheFile(int32_t rhi, const string &buff, int stage) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(buff.c_str(), buff.size());
+
+        // Any change in target or compilers must produce a new entry
+        string key = to_string(rhi) + " " + to_string(stage) + " " +
+                     to_string(options.version) + " " + to_string(options.es) + " " +
+                     to_string(GLSLANG_MINOR_VERSION) + " " + to_string(glslang::GetSpirvGeneratorVersion()) + " " +
+                     to_string(FORMAT_VERSION);
+        hash.addData(key.c_str(), key.size());
+
+        return ProjectManager::instance()->cachePath() + SHADER_CACHE + hash.result().toHex();
+    }
+
+    Variant compileShader(int32_t rhi, const string &buff, int stage) {
+        QString path = cacheFile(rhi, buff, stage);
+
+        QFile cache(path);
+        if(cache.open(QIODevice::ReadOnly)) {
+            QByteArray bytes = cache.readAll();
+            cache.close();
+
+            ByteArray array(bytes.begin(), bytes.end());
+            VariantList list = Bson::load(array).toList();
+            if(!list.empty()) {
+                return list.front();
+            }
+        }
+
+        Variant data;
+
+        vector<uint32_t> spv = SpirVConverter::glslToSpv(buff, static_cast<EShLanguage>(stage));
+        if(!spv.empty()) {
+            switch(rhi) {
+                case ShaderBuilder::OpenGL: data = SpirVConverter::spvToGlsl(spv); break;
+                case ShaderBuilder::Metal: data = SpirVConverter::spvToMetal(spv); break;
+                case ShaderBuilder::DirectX: data = SpirVConverter::spvToHlsl(spv); break;
+                default: {
+                    ByteArray array;
+                    array.resize(spv.size() * sizeof(uint32_t));
+                    memcpy(&array[0], &spv[0], array.size());
+                    data = array;
+                    break;
+                }
+            }
+
+            QDir().mkpath(QFileInfo(path).absolutePath());
+            // Identical variants may be stored from several threads at once
+            QSaveFile file(path);
+            if(file.open(QIODevice::WriteOnly)) {
+                ByteArray array = Bson::save(VariantList({data}));
+                file.write(reinterpret_cast<const char *>(&array[0]), array.size());
+                file.commit();
+            }
+        }
+        return data;
+    }
+
+    class CompileTask : public Object {
+    public:
+        CompileTask(const char *name, int32_t rhi, const QString &buff, int stage) :
+                m_pName(name),
+                m_Buff(buff.toStdString()),
+                m_Rhi(rhi),
+                m_Stage(stage) {
+
+        }
+
+        void processEvents() override {
+            m_Data = compileShader(m_Rhi, m_Buff, m_Stage);
+        }
+
+        const char *m_pName;
+
+        string m_Buff;
+
+        int32_t m_Rhi;
+
+        int m_Stage;
+
+        Variant m_Data;
+    };
+
+    class CompilePool : public ThreadPool {
+    public:
+        CompilePool() {
+            setMaxThreads(MAX(ThreadPool::optimalThreadCount(), 1U));
+        }
+    };
+
+    ThreadPool &compilePool() {
+        // Compiler threads live as long as the editor, so each of them initializes glslang only once
+        static CompilePool pool;
+        return pool;
+    }
+}
+
 ShaderBuilder::ShaderBuilder() :
         m_BlendMode(Opaque),
         m_LightModel(Lit),
@@ -502,74 +605,42 @@ Variant ShaderBuilder::data(bool editor) const {
     }
     SpirVConverter::setGlslVersion(version, es);
 
+    vector<CompileTask *> tasks;
+
     QString fragment = (!m_RawPath.filePath().isEmpty()) ? m_RawPath.filePath() : "Surface.frag";
-    {
-        Variant data = compile(rhi, fragment, define, EShLanguage::EShLangFragment);
-        if(data.isValid()) {
-            user["Shader"] = data;
-        }
-    }
+    tasks.push_back(new CompileTask("Shader", rhi, loadIncludes(fragment, define), EShLanguage::EShLangFragment));
     if(m_MaterialType == Surface && !editor) {
         define += "\n#define SIMPLE 1";
-        Variant data = compile(rhi, fragment, define, EShLanguage::EShLangFragment);
-        if(data.isValid()) {
-            user["Simple"] = data;
-        }
+        tasks.push_back(new CompileTask("Simple", rhi, loadIncludes(fragment, define), EShLanguage::EShLangFragment));
     }
 
     QString vertex = "BasePass.vert";
     define = "#define TYPE_STATIC 1";
-    {
-        Variant data = compile(rhi, vertex, define, EShLanguage::EShLangVertex);
-        if(data.isValid()) {
-            user["Static"] = data;
-        }
-    }
+    tasks.push_back(new CompileTask("Static", rhi, loadIncludes(vertex, define), EShLanguage::EShLangVertex));
     if(m_MaterialType == Surface && !editor) {
-        {
-            define += "\n#define INSTANCING 1";
-            Variant data = compile(rhi, vertex, define, EShLanguage::EShLangVertex);
-            if(data.isValid()) {
-                user["StaticInst"] = data;
-            }
-        }
-        {
-            Variant data = compile(rhi, vertex, "#define TYPE_BILLBOARD 1", EShLanguage::EShLangVertex);
-            if(data.isValid()) {
-                user["Particle"] = data;
-            }
-        }
-        {
-            Variant data = compile(rhi, vertex, "#define TYPE_SKINNED 1", EShLanguage::EShLangVertex);
-            if(data.isValid()) {
-                user["Skinned"] = data;
-            }
-        }
+        define += "\n#define INSTANCING 1";
+        tasks.push_back(new CompileTask("StaticInst", rhi, loadIncludes(vertex, define), EShLanguage::EShLangVertex));
+        tasks.push_back(new CompileTask("Particle", rhi, loadIncludes(vertex, "#define TYPE_BILLBOARD 1"), EShLanguage::EShLangVertex));
+        tasks.push_back(new CompileTask("Skinned", rhi, loadIncludes(vertex, "#define TYPE_SKINNED 1"), EShLanguage::EShLangVertex));
     }
 
-    return user;
-}
+    // The first initialization of glslang isn't thread safe
+    ShInitialize();
 
-Variant ShaderBuilder::compile(int32_t rhi, const QString &source, const string &define, int stage) const {
-    Variant data;
+    ThreadPool &pool = compilePool();
+    for(auto it : tasks) {
+        pool.start(*it);
+    }
+    pool.waitForDone();
 
-    QString buff = loadIncludes(source, define);
-    vector<uint32_t> spv = SpirVConverter::glslToSpv(buff.toStdString(), static_cast<EShLanguage>(stage));
-    if(!spv.empty()) {
-        switch(rhi) {
-            case Rhi::OpenGL: data = SpirVConverter::spvToGlsl(spv); break;
-            case Rhi::Metal: data = SpirVConverter::spvToMetal(spv); break;
-            case Rhi::DirectX: data = SpirVConverter::spvToHlsl(spv); break;
-            default: {
-                ByteArray array;
-                array.resize(spv.size() * sizeof(uint32_t));
-                memcpy(&array[0], &spv[0], array.size());
-                data = array;
-                break;
-            }
+    for(auto it : tasks) {
+        if(it->m_Data.isValid()) {
+            user[it->m_pName] = it->m_Data;
         }
+        delete it;
     }
-    return data;
+
+    return user;
 }
 
 int ShaderBuilder::setTexture(const QString &path, Vector4 &sub, uint8_t flags) {
@@ -222,8 +222,6 @@ private:
 
     QString templatePath() const Q_DECL_OVERRIDE { return ":/Templates/Material.mtl"; }
 
-    Variant compile(int32_t rhi, const QString &source, const string &define, int stage) const;
-
     bool build(QString &, const AbstractSchemeModel::Link &, uint32_t &, uint8_t &) {return true;}
 
     void addParam(const QString &param);
@@ -124,6 +124,8 @@ class SpirVConverter  {
 public:
     static vector<uint32_t> glslToSpv(const string &buff, EShLanguage stage) {
         ShInitialize();
+        // Each compiler thread must have own pool allocator
+        glslang::InitThread();
 
         glslang::TProgram program;
 
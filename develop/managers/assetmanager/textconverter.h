@@ -7,6 +7,7 @@
 class TextConverter : public IConverter {
     QStringList suffixes() const Q_DECL_OVERRIDE { return {"txt", "json", "html", "htm", "xml"}; }
     uint8_t convertFile(IConverterSettings *s) Q_DECL_OVERRIDE;
+    bool isThreadSafe(IConverterSettings *) const Q_DECL_OVERRIDE { return true; }
     IConverterSettings *createSettings() const Q_DECL_OVERRIDE;
 };
 
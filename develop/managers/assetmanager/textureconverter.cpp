@@ -11,12 +11,15 @@
 
 #include <bson.h>
 #include <engine.h>
+#include <log.h>
+#include <threadpool.h>
+#include <distancefield.h>
 #include <components/actor.h>
 #include <components/spriterender.h>
 #include <resources/resource.h>
 #include <resources/material.h>
 
-#define FORMAT_VERSION 3
+#define FORMAT_VERSION 6
 
 static hash<string> hash_str;
 
@@ -36,12 +39,50 @@ void copyData(int8_t *dst, const uchar *src, uint32_t size, uint8_t channels) {
     }
 }
 
+ByteArray imageData(const uint8_t *rgba, int32_t width, int32_t height, uint8_t channels, int32_t compress, int32_t quality, ThreadPool *pool) {
+    ByteArray data;
+    if(compress != Texture::Uncompressed) {
+        data = TextureEncoder::encode(rgba, width, height, compress, channels, quality, pool);
+    } else {
+        uint32_t size = width * height * channels;
+        if(size) {
+            data.resize(size);
+            copyData(&data[0], rgba, size, channels);
+        }
+    }
+    return data;
+}
+
+class MipTask : public Object {
+public:
+    MipTask(const QImage &image, const MipGenerator::Options &options) :
+            m_Image(image),
+            m_Options(options) {
+
+    }
+
+    void processEvents() override {
+        m_Levels = MipGenerator::generate(m_Image.constBits(), m_Image.width(), m_Image.height(), m_Options, 1);
+    }
+
+    QImage m_Image;
+
+    MipGenerator::Options m_Options;
+
+    MipGenerator::Levels m_Levels;
+};
+
 TextureImportSettings::TextureImportSettings() :
         m_TextureType(TextureType::Texture2D),
         m_FormType(FormatType::Uncompressed_R8G8B8),
+        m_Quality(CompressionQuality::Normal),
         m_Filtering(FilteringType::None),
         m_Wrap(WrapType::Repeat),
-        m_Lod(false) {
+        m_MipFilter(MipFilterType::Kaiser),
+        m_Lod(false),
+        m_NormalMap(false),
+        m_AlphaCoverage(false),
+        m_DistanceField(false) {
 
     setVersion(FORMAT_VERSION);
     setType(MetaType::type<Texture *>());
@@ -67,6 +108,56 @@ void TextureImportSettings::setFormatType(FormatType type) {
     }
 }
 
+TextureImportSettings::CompressionQuality TextureImportSettings::quality() const {
+    return m_Quality;
+}
+void TextureImportSettings::setQuality(CompressionQuality quality) {
+    if(m_Quality != quality) {
+        m_Quality = quality;
+        emit updated();
+    }
+}
+
+TextureImportSettings::MipFilterType TextureImportSettings::mipFilter() const {
+    return m_MipFilter;
+}
+void TextureImportSettings::setMipFilter(MipFilterType filter) {
+    if(m_MipFilter != filter) {
+        m_MipFilter = filter;
+        emit updated();
+    }
+}
+
+bool TextureImportSettings::normalMap() const {
+    return m_NormalMap;
+}
+void TextureImportSettings::setNormalMap(bool normal) {
+    if(m_NormalMap != normal) {
+        m_NormalMap = normal;
+        emit updated();
+    }
+}
+
+bool TextureImportSettings::alphaCoverage() const {
+    return m_AlphaCoverage;
+}
+void TextureImportSettings::setAlphaCoverage(bool coverage) {
+    if(m_AlphaCoverage != coverage) {
+        m_AlphaCoverage = coverage;
+        emit updated();
+    }
+}
+
+bool TextureImportSettings::distanceField() const {
+    return m_DistanceField;
+}
+void TextureImportSettings::setDistanceField(bool field) {
+    if(m_DistanceField != field) {
+        m_DistanceField = field;
+        emit updated();
+    }
+}
+
 TextureImportSettings::FilteringType TextureImportSettings::filtering() const {
     return m_Filtering;
 }
@@ -196,53 +287,64 @@ void TextureImportSettings::setSubItemData(const QString &name, const QJsonObjec
 }
 
 uint8_t TextureConverter::convertFile(IConverterSettings *settings) {
-    Resource *resource = nullptr;
+    Variant variant;
 
     TextureImportSettings *s = dynamic_cast<TextureImportSettings *>(settings);
     if(s) {
         if(s->textureType() == TextureImportSettings::TextureType::Sprite) {
             Sprite *sprite = Engine::objectCreate<Sprite>();
             convertSprite(s, sprite);
-            resource = sprite;
+            variant = Engine::toVariant(sprite);
+            delete sprite;
         } else {
-            Texture *texture = Engine::objectCreate<Texture>();
-            convertTexture(s, texture);
-            resource = texture;
+            // Not registered in any system so can be converted from the import threads
+            Texture texture;
+            convertTexture(s, &texture);
+            variant = Engine::toVariant(&texture);
         }
     }
 
     QFile file(settings->absoluteDestination());
     if(file.open(QIODevice::WriteOnly)) {
-        ByteArray data = Bson::save( Engine::toVariant(resource) );
+        ByteArray data = Bson::save(variant);
         file.write((const char *)&data[0], data.size());
         file.close();
     }
 
-    delete resource;
-
     settings->setCurrentVersion(settings->version());
 
     return 0;
 }
 
+bool TextureConverter::isThreadSafe(IConverterSettings *settings) const {
+    TextureImportSettings *s = dynamic_cast<TextureImportSettings *>(settings);
+    return (s && s->textureType() != TextureImportSettings::TextureType::Sprite);
+}
+
 void TextureConverter::convertTexture(TextureImportSettings *settings, Texture *texture) {
-    uint8_t channels;
-    QImage src(settings->source());
-    QImage img;
-    switch(settings->formatType()) {
-        case TextureImportSettings::FormatType::Uncompressed_R8G8B8: {
-            img = src.convertToFormat(QImage::Format_RGB32).rgbSwapped();
-            channels = 3;
-        } break;
-        default: {
-            img = src.convertToFormat(QImage::Format_RGBA8888);
-            channels = 4;
-        } break;
+    int32_t type = int32_t(settings->formatType());
+    int32_t format = type & 0xff;
+    int32_t compress = type >> 8;
+    int32_t quality = int32_t(settings->quality());
+
+    bool field = settings->distanceField() && settings->textureType() != TextureImportSettings::TextureType::Cubemap;
+    if(field && format == Texture::RGB8) {
+        // The distance field is stored in alpha, it would be dropped by the format without the alpha channel
+        Log(Log::WRN) << "Distance field requires alpha channel, format with alpha will be used for:" << qPrintable(settings->source());
+        format = Texture::RGBA8;
+        if(compress == Texture::DXT1) {
+            compress = Texture::DXT5;
+        }
     }
 
+    uint8_t channels = (format == Texture::RGB8) ? 3 : 4;
+    QImage src(settings->source());
+    QImage img = src.convertToFormat(QImage::Format_RGBA8888);
+
     texture->clear();
 
-    texture->setFormat((channels == 3) ? Texture::RGB8 : Texture::RGBA8);
+    texture->setFormat(format);
+    texture->setCompress(compress);
     texture->setFiltering(Texture::FilteringType(settings->filtering()));
     texture->setWrap(Texture::WrapType(settings->wrap()));
 
@@ -295,41 +397,65 @@ void TextureConverter::convertTexture(TextureImportSettings *settings, Texture *
     } else {
         texture->setWidth(img.width());
         texture->setHeight(img.height());
+        if(field) {
+            // Alpha keeps the distance to the sprite edge, so outlines and glows can be drawn by the material
+            DistanceField::Options options;
+            options.scale = 8.0f;
+            options.channels = 4;
+            options.channel = 3;
+            DistanceField::generate(img.constBits(), img.width(), img.height(), img.bytesPerLine(),
+                                    img.bits(), img.width(), img.height(), options);
+        }
         sides.push_back(img.mirrored());
     }
 
+    MipGenerator::Options options;
+    options.filter = int32_t(settings->mipFilter());
+    options.alphaCutoff = (settings->alphaCoverage()) ? 0.5f : 0.0f;
+    options.normalMap = settings->normalMap();
+    options.repeat = (settings->wrap() == TextureImportSettings::WrapType::Repeat);
+
+    // One pool is shared by all the faces and levels of the texture
+    ThreadPool pool;
+
+    QList<MipGenerator::Levels> mips;
+    if(settings->lod()) {
+        /// \todo Specular convolution for cubemaps
+        if(sides.size() > 1) {
+            // Faces are processed in parallel, each face uses one thread
+            list<MipTask> tasks;
+            foreach(const QImage &it, sides) {
+                tasks.emplace_back(it, options);
+                pool.start(tasks.back());
+            }
+            pool.waitForDone();
+            for(auto &it : tasks) {
+                mips.push_back(it.m_Levels);
+            }
+        } else {
+            // Rows of each level are processed in parallel
+            foreach(const QImage &it, sides) {
+                mips.push_back(MipGenerator::generate(it.constBits(), it.width(), it.height(), options));
+            }
+        }
+    }
+
     int i = 0;
     foreach(const QImage &it, sides) {
         Texture::Surface surface;
 
-        VariantList lods;
-
-        ByteArray data;
-        uint32_t size = it.width() * it.height() * channels;
-        if(size) {
-            data.resize(size);
-            copyData(&data[0], it.constBits(), size, channels);
-        }
-        surface.push_back(data);
-
-        if(settings->lod()) {
-            /// \todo Specular convolution for cubemaps
-            int w = texture->width();
-            int h = texture->height();
-            QImage mip = it;
-            while(w > 1 || h > 1 ) {
+        if(i < mips.size()) {
+            int32_t w = it.width();
+            int32_t h = it.height();
+            for(auto &level : mips[i]) {
+                surface.push_back(imageData(reinterpret_cast<const uint8_t *>(&level[0]), w, h, channels, compress, quality, &pool));
                 w = MAX(w / 2, 1);
                 h = MAX(h / 2, 1);
-
-                mip = mip.scaled(w, h, Qt::IgnoreAspectRatio);
-                size = w * h * channels;
-                if(size) {
-                    data.resize(size);
-                    copyData(&data[0], mip.constBits(), size, channels);
-                }
-                surface.push_back(data);
             }
+        } else {
+            surface.push_back(imageData(it.constBits(), it.width(), it.height(), channels, compress, quality, &pool));
         }
+
         texture->addSurface(surface);
 
         i++;
@@ -5,6 +5,8 @@
 #include <resources/sprite.h>
 
 #include <editor/converter.h>
+#include <editor/textureencoder.h>
+#include <editor/mipgenerator.h>
 
 #include <QRect>
 
@@ -15,14 +17,30 @@ class TextureImportSettings : public IConverterSettings {
 
     Q_PROPERTY(TextureType Type READ textureType WRITE setTextureType DESIGNABLE true USER true)
     Q_PROPERTY(FormatType Format READ formatType WRITE setFormatType DESIGNABLE true USER true)
+    Q_PROPERTY(CompressionQuality Quality READ quality WRITE setQuality DESIGNABLE true USER true)
     Q_PROPERTY(WrapType Wrap READ wrap WRITE setWrap DESIGNABLE true USER true)
     Q_PROPERTY(bool MIP_maping READ lod WRITE setLod DESIGNABLE true USER true)
+    Q_PROPERTY(MipFilterType MIP_filter READ mipFilter WRITE setMipFilter DESIGNABLE true USER true)
+    Q_PROPERTY(bool Normal_map READ normalMap WRITE setNormalMap DESIGNABLE true USER true)
+    Q_PROPERTY(bool Alpha_coverage READ alphaCoverage WRITE setAlphaCoverage DESIGNABLE true USER true)
+    Q_PROPERTY(bool Distance_field READ distanceField WRITE setDistanceField DESIGNABLE true USER true)
     Q_PROPERTY(FilteringType Filtering READ filtering WRITE setFiltering DESIGNABLE true USER true)
 
 public:
     enum class FormatType {
         Uncompressed_R8G8B8     = Texture::RGB8,
         Uncompressed_R8G8B8A8   = Texture::RGBA8,
+        Compressed_BC1          = (Texture::DXT1 << 8) | Texture::RGB8,
+        Compressed_BC3          = (Texture::DXT5 << 8) | Texture::RGBA8,
+        Compressed_BC7          = (Texture::BC7  << 8) | Texture::RGBA8,
+        Compressed_ETC2_RGB8    = (Texture::ETC2 << 8) | Texture::RGB8,
+        Compressed_ETC2_RGBA8   = (Texture::ETC2 << 8) | Texture::RGBA8
+    };
+
+    enum class CompressionQuality {
+        Fast        = TextureEncoder::Fast,
+        Normal      = TextureEncoder::Normal,
+        Best        = TextureEncoder::Best
     };
 
     enum class TextureType {
@@ -37,6 +55,11 @@ public:
         Trilinear   = Texture::Trilinear
     };
 
+    enum class MipFilterType {
+        Box         = MipGenerator::Box,
+        Kaiser      = MipGenerator::Kaiser
+    };
+
     enum class WrapType {
         Clamp,
         Repeat,
@@ -44,9 +67,11 @@ public:
     };
 
     Q_ENUM(WrapType)
+    Q_ENUM(MipFilterType)
     Q_ENUM(FilteringType)
     Q_ENUM(TextureType)
     Q_ENUM(FormatType)
+    Q_ENUM(CompressionQuality)
 
     struct Element {
         Element() {
@@ -74,6 +99,9 @@ public:
     FormatType formatType() const;
     void setFormatType(FormatType type);
 
+    CompressionQuality quality() const;
+    void setQuality(CompressionQuality quality);
+
     FilteringType filtering() const;
     void setFiltering(FilteringType type);
 
@@ -83,6 +111,18 @@ public:
     bool lod() const;
     void setLod(bool lod);
 
+    MipFilterType mipFilter() const;
+    void setMipFilter(MipFilterType filter);
+
+    bool normalMap() const;
+    void setNormalMap(bool normal);
+
+    bool alphaCoverage() const;
+    void setAlphaCoverage(bool coverage);
+
+    bool distanceField() const;
+    void setDistanceField(bool field);
+
     ElementMap elements() const;
     QString setElement(const Element &element, const QString &key = QString());
     void removeElement(const QString &key);
@@ -100,13 +140,23 @@ protected:
 
     FormatType    m_FormType;
 
+    CompressionQuality m_Quality;
+
     FilteringType m_Filtering;
 
     WrapType      m_Wrap;
 
     ElementMap    m_Elements;
 
+    MipFilterType m_MipFilter;
+
     bool          m_Lod;
+
+    bool          m_NormalMap;
+
+    bool          m_AlphaCoverage;
+
+    bool          m_DistanceField;
 };
 
 class TextureConverter : public IConverter {
@@ -117,6 +167,7 @@ public:
 private:
     QStringList suffixes() const Q_DECL_OVERRIDE { return {"bmp", "dds", "jpg", "jpeg", "png", "tga", "ico", "tif"}; }
     uint8_t convertFile(IConverterSettings *settings) Q_DECL_OVERRIDE;
+    bool isThreadSafe(IConverterSettings *settings) const Q_DECL_OVERRIDE;
 
     IConverterSettings *createSettings() const Q_DECL_OVERRIDE;
 
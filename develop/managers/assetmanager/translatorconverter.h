@@ -9,6 +9,7 @@ class TranslatorConverter : public IConverter {
 public:
     QStringList suffixes() const Q_DECL_OVERRIDE { return {"loc"}; }
     uint8_t convertFile(IConverterSettings *s) Q_DECL_OVERRIDE;
+    bool isThreadSafe(IConverterSettings *) const Q_DECL_OVERRIDE { return true; }
     IConverterSettings *createSettings() const Q_DECL_OVERRIDE;
 };
 
@@ -10,6 +10,7 @@
 #include <module.h>
 #include <system.h>
 #include <components/scene.h>
+#include <components/private/transformhierarchy.h>
 #include <systems/rendersystem.h>
 
 #include <bson.h>
@@ -307,6 +308,9 @@ void PluginManager::initSystems() {
 }
 
 void PluginManager::updateRender(Scene *scene) {
+    // The editor doesn't run Engine::update, so the hierarchy pass is done here
+    TransformHierarchy::instance()->update();
+
     m_pEngine->resourceSystem()->processEvents();
 
     if(m_pRender) {
@@ -1,7 +1,32 @@
 #include "undomanager.h"
 
+#include <bson.h>
+#include <objectsystem.h>
+
+#define MEMORY_LIMIT (256 * 1024 * 1024)
+
 UndoManager *UndoManager::m_pInstance   = nullptr;
 
+namespace {
+    void releaseCommand(QUndoCommand *command) {
+        // Macros and groups keep the snapshots in the child commands
+        for(int i = 0; i < command->childCount(); i++) {
+            releaseCommand(const_cast<QUndoCommand *>(command->child(i)));
+        }
+        UndoCommand *undo = dynamic_cast<UndoCommand *>(command);
+        if(undo) {
+            undo->release();
+        } else {
+            command->setObsolete(true);
+        }
+    }
+}
+
+UndoManager::UndoManager() :
+        m_MemoryLimit(MEMORY_LIMIT) {
+
+}
+
 UndoManager *UndoManager::instance() {
     if(!m_pInstance) {
         m_pInstance = new UndoManager;
@@ -17,3 +42,70 @@ void UndoManager::destroy() {
 void UndoManager::init() {
 
 }
+
+void UndoManager::push(QUndoCommand *command) {
+    QUndoStack::push(command);
+    trim();
+}
+
+UndoSnapshot UndoManager::snapshot(const Object *object, bool force) {
+    ByteArray data = Bson::save(ObjectSystem::toVariant(object, force));
+
+    uint64_t hash = 14695981039346656037ULL;
+    for(auto it : data) {
+        hash ^= static_cast<uint8_t>(it);
+        hash *= 1099511628211ULL;
+    }
+    // Identical subtrees share the same data between the commands
+    auto range = m_Snapshots.equal_range(hash);
+    for(auto it = range.first; it != range.second; ++it) {
+        UndoSnapshot shared = it->second.lock();
+        if(shared && *shared == data) {
+            return shared;
+        }
+    }
+
+    UndoSnapshot result = make_shared<const ByteArray>(std::move(data));
+    m_Snapshots.emplace(hash, result);
+    return result;
+}
+
+Object *UndoManager::restore(const UndoSnapshot &snapshot, Object *root) {
+    if(snapshot == nullptr) {
+        return nullptr;
+    }
+    return ObjectSystem::toObject(Bson::load(*snapshot), root);
+}
+
+uint64_t UndoManager::memoryUsage() {
+    uint64_t result = 0;
+    for(auto it = m_Snapshots.begin(); it != m_Snapshots.end(); ) {
+        UndoSnapshot shared = it->second.lock();
+        if(shared) {
+            result += shared->size();
+            ++it;
+        } else {
+            it = m_Snapshots.erase(it);
+        }
+    }
+    return result;
+}
+
+uint64_t UndoManager::memoryLimit() const {
+    return m_MemoryLimit;
+}
+
+void UndoManager::setMemoryLimit(uint64_t limit) {
+    m_MemoryLimit = limit;
+    trim();
+}
+
+void UndoManager::trim() {
+    // QUndoStack can't remove the commands from the bottom, so the oldest commands release their snapshots instead
+    for(int i = 0; i < index() && memoryUsage() > m_MemoryLimit; i++) {
+        QUndoCommand *command = const_cast<QUndoCommand *>(QUndoStack::command(i));
+        if(command && !command->isObsolete()) {
+            releaseCommand(command);
+        }
+    }
+}
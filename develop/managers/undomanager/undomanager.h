@@ -7,12 +7,26 @@
 #include <QUndoCommand>
 
 #include <memory>
+#include <unordered_map>
 
 #include <engine.h>
 
 class Object;
 class ObjectCtrl;
 
+typedef shared_ptr<const ByteArray> UndoSnapshot;
+
+class UndoCommand : public QUndoCommand {
+public:
+    explicit UndoCommand(const QString &text, QUndoCommand *parent = nullptr) :
+            QUndoCommand(text, parent) {
+    }
+
+    virtual void release() {
+        setObsolete(true);
+    }
+};
+
 class UndoManager : public QUndoStack {
     Q_OBJECT
 
@@ -23,11 +37,29 @@ public:
 
     void                        init                ();
 
+    void                        push                (QUndoCommand *command);
+
+    UndoSnapshot                snapshot            (const Object *object, bool force = false);
+
+    Object                     *restore             (const UndoSnapshot &snapshot, Object *root = nullptr);
+
+    uint64_t                    memoryUsage         ();
+
+    uint64_t                    memoryLimit         () const;
+
+    void                        setMemoryLimit      (uint64_t limit);
+
 private:
-    UndoManager                 () {}
+    UndoManager                 ();
     ~UndoManager                () {}
 
+    void                        trim                ();
+
     static UndoManager         *m_pInstance;
+
+    unordered_multimap<uint64_t, weak_ptr<const ByteArray>> m_Snapshots;
+
+    uint64_t                    m_MemoryLimit;
 };
 
 
@@ -75,6 +75,10 @@ public:
         return _fsize(stream) - AAsset_getRemainingLength((AAsset *)stream);
     }
 
+    const uint8_t *_fmap        (_FILE *stream) {
+        return static_cast<const uint8_t *>(AAsset_getBuffer((AAsset *)stream));
+    }
+
 };
 
 #endif // ANDROIDFILE_H
@@ -24,6 +24,10 @@ public:
 
     bool                        isValid                     ();
 
+    bool                        makeCurrent                 (bool current);
+
+    void                        swapBuffers                 ();
+
     bool                        key                         (Input::KeyCode code);
     bool                        keyPressed                  (Input::KeyCode code);
     bool                        keyReleased                 (Input::KeyCode code);
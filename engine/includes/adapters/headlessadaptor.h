@@ -0,0 +1,46 @@
+#ifndef HEADLESSADAPTOR_H
+#define HEADLESSADAPTOR_H
+
+#include "platformadaptor.h"
+
+class HeadlessAdaptor : public PlatformAdaptor {
+public:
+    HeadlessAdaptor             (Engine *engine, uint32_t width = 1024, uint32_t height = 768);
+
+    virtual ~HeadlessAdaptor    () {}
+
+    bool                        init                        ();
+
+    void                        update                      ();
+
+    bool                        start                       ();
+
+    void                        stop                        ();
+
+    void                        destroy                     ();
+
+    bool                        isValid                     ();
+
+    string                      inputString                 ();
+
+    uint32_t                    screenWidth                 ();
+    uint32_t                    screenHeight                ();
+
+    uint32_t                    frame                       () const;
+
+    uint32_t                    frameLimit                  () const;
+    void                        setFrameLimit               (uint32_t frames);
+
+protected:
+    Engine                     *m_pEngine;
+
+    uint32_t                    m_Width;
+    uint32_t                    m_Height;
+
+    uint32_t                    m_Frame;
+    uint32_t                    m_FrameLimit;
+
+    bool                        m_Running;
+};
+
+#endif // HEADLESSADAPTOR_H
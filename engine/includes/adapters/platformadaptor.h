@@ -26,6 +26,10 @@ public:
 
     virtual bool                        isValid                     () = 0;
 
+    virtual bool                        makeCurrent                 (bool current) { A_UNUSED(current); return false; }
+
+    virtual void                        swapBuffers                 () {}
+
     virtual uint32_t                    screenWidth                 () = 0;
 
     virtual uint32_t                    screenHeight                () = 0;
@@ -0,0 +1,137 @@
+#ifndef REPLAYADAPTOR_H
+#define REPLAYADAPTOR_H
+
+#include "platformadaptor.h"
+
+#include <cstdio>
+
+class ReplayAdaptor : public PlatformAdaptor {
+public:
+    enum Mode {
+        Record,
+        Replay
+    };
+
+    struct Joystick {
+        uint32_t buttons;
+        Vector4 thumbs;
+        Vector2 triggers;
+    };
+
+    struct Touch {
+        uint32_t state;
+        Vector4 position;
+    };
+
+    struct FrameState {
+        map<int32_t, uint8_t> keys;
+
+        uint8_t buttons[3];
+
+        Vector4 mousePosition;
+        Vector4 mouseDelta;
+
+        string input;
+
+        vector<Joystick> joysticks;
+
+        vector<Touch> touches;
+    };
+
+public:
+    ReplayAdaptor               (PlatformAdaptor *platform, const string &path, Mode mode, uint32_t seed = 0);
+
+    virtual ~ReplayAdaptor      ();
+
+    bool                        init                        ();
+
+    void                        update                      ();
+
+    bool                        start                       ();
+
+    void                        stop                        ();
+
+    void                        destroy                     ();
+
+    bool                        isValid                     ();
+
+    bool                        makeCurrent                 (bool current);
+
+    void                        swapBuffers                 ();
+
+    bool                        key                         (Input::KeyCode code);
+    bool                        keyPressed                  (Input::KeyCode code);
+    bool                        keyReleased                 (Input::KeyCode code);
+
+    string                      inputString                 ();
+    void                        setKeyboardVisible          (bool visible);
+
+    Vector4                     mousePosition               ();
+    Vector4                     mouseDelta                  ();
+    bool                        mouseButton                 (Input::MouseButton button);
+    bool                        mousePressed                (Input::MouseButton button);
+    bool                        mouseReleased               (Input::MouseButton button);
+
+    void                        setMousePosition            (int32_t x, int32_t y);
+
+    uint32_t                    screenWidth                 ();
+    uint32_t                    screenHeight                ();
+
+    uint32_t                    joystickCount               ();
+    uint32_t                    joystickButtons             (uint32_t index);
+    Vector4                     joystickThumbs              (uint32_t index);
+    Vector2                     joystickTriggers            (uint32_t index);
+
+    uint32_t                    touchCount                  ();
+    uint32_t                    touchState                  (uint32_t index);
+    Vector4                     touchPosition               (uint32_t index);
+
+    void                       *pluginLoad                  (const char *name);
+
+    bool                        pluginUnload                (void *plugin);
+
+    void                       *pluginAddress               (void *plugin, const string &name);
+
+    string                      locationLocalDir            ();
+
+    void                        syncConfiguration           (VariantMap &map) const;
+
+    PlatformAdaptor            *platform                    () const;
+
+    Mode                        mode                        () const;
+
+    uint32_t                    frame                       () const;
+
+protected:
+    void                        captureState                ();
+
+    void                        writeState                  ();
+
+    bool                        readState                   ();
+
+    void                        writeDelta                  ();
+
+    bool                        readDelta                   ();
+
+protected:
+    PlatformAdaptor            *m_pPlatform;
+
+    FILE                       *m_pFile;
+
+    string                      m_Path;
+
+    FrameState                  m_State;
+
+    Mode                        m_Mode;
+
+    uint32_t                    m_Seed;
+
+    uint32_t                    m_Width;
+    uint32_t                    m_Height;
+
+    uint32_t                    m_Frame;
+
+    bool                        m_Finished;
+};
+
+#endif // REPLAYADAPTOR_H
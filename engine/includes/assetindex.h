@@ -0,0 +1,57 @@
+#ifndef ASSETINDEX_H
+#define ASSETINDEX_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <global.h>
+
+using namespace std;
+
+class AssetIndexPrivate;
+
+class NEXT_LIBRARY_EXPORT AssetIndex {
+public:
+    typedef unordered_map<string, pair<string, string>> Items;
+    typedef unordered_map<string, string> Settings;
+
+public:
+    AssetIndex();
+    ~AssetIndex();
+
+    bool open(const uint8_t *data, uint64_t size);
+    bool load(vector<uint8_t> &data);
+    void close();
+
+    bool isValid() const;
+
+    uint32_t size() const;
+
+    const uint8_t *data() const;
+    uint64_t dataSize() const;
+
+    const char *uuid(const string &path) const;
+    const char *uuid(uint64_t hash) const;
+
+    const char *type(const string &path) const;
+
+    uint32_t settingsCount() const;
+    const char *settingKey(uint32_t index) const;
+    const char *settingValue(uint32_t index) const;
+
+    static vector<uint8_t> build(const Items &items, const Settings &settings);
+
+    static constexpr uint64_t hash(const char *path, uint64_t value = 14695981039346656037ULL) {
+        return (*path == 0) ? value : hash(path + 1, (value ^ static_cast<uint8_t>(*path)) * 1099511628211ULL);
+    }
+
+    static uint64_t hash(const string &path);
+
+private:
+    AssetIndexPrivate *p_ptr;
+
+};
+
+#endif // ASSETINDEX_H
@@ -24,6 +24,8 @@ public:
     };
 
 public:
+    ICommandBuffer();
+
     virtual void clearRenderTarget(bool clearColor = true, const Vector4 &color = Vector4(0.0f), bool clearDepth = true, float depth = 1.0f);
 
     virtual void drawMesh(const Matrix4 &model, Mesh *mesh, uint32_t layer = ICommandBuffer::DEFAULT, MaterialInstance *material = nullptr);
@@ -64,6 +66,17 @@ public:
 
     static void setInited();
 
+    uint32_t drawCalls() const;
+
+    uint32_t polygons() const;
+
+    void resetStatistics();
+
+protected:
+    uint32_t m_DrawCalls;
+
+    uint32_t m_Polygons;
+
 };
 
 #endif // COMMANDBUFFER_H
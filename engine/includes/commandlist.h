@@ -0,0 +1,64 @@
+#ifndef COMMANDLIST_H
+#define COMMANDLIST_H
+
+#include "commandbuffer.h"
+
+class CommandListPrivate;
+
+class Resource;
+
+class NEXT_LIBRARY_EXPORT CommandList : public ICommandBuffer {
+public:
+    CommandList();
+    ~CommandList();
+
+    void clearRenderTarget(bool clearColor = true, const Vector4 &color = Vector4(0.0f), bool clearDepth = true, float depth = 1.0f) override;
+
+    void drawMesh(const Matrix4 &model, Mesh *mesh, uint32_t layer = ICommandBuffer::DEFAULT, MaterialInstance *material = nullptr) override;
+
+    void drawMeshInstanced(const Matrix4 *models, uint32_t count, Mesh *mesh, uint32_t layer = ICommandBuffer::DEFAULT, MaterialInstance *material = nullptr) override;
+
+    void setRenderTarget(RenderTarget *target, uint32_t level = 0) override;
+
+    void setRenderTarget(uint32_t target) override;
+
+    void setColor(const Vector4 &color) override;
+
+    void resetViewProjection() override;
+
+    void setViewProjection(const Matrix4 &view, const Matrix4 &projection) override;
+
+    void setGlobalValue(const char *name, const Variant &value) override;
+
+    void setGlobalTexture(const char *name, Texture *value) override;
+
+    void setViewport(int32_t x, int32_t y, int32_t width, int32_t height) override;
+
+    void enableScissor(int32_t x, int32_t y, int32_t width, int32_t height) override;
+
+    void disableScissor() override;
+
+    Matrix4 projection() const override;
+
+    Matrix4 view() const override;
+
+    Texture *texture(const char *name) const override;
+
+    void begin(const ICommandBuffer *source = nullptr, bool copy = false);
+
+    void execute(ICommandBuffer &buffer) const;
+
+    void resources(vector<Resource *> &result) const;
+
+    void clear();
+
+    uint32_t size() const;
+
+    bool operator== (const CommandList &right) const;
+
+private:
+    CommandListPrivate *p_ptr;
+
+};
+
+#endif // COMMANDLIST_H
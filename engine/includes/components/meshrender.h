@@ -29,6 +29,10 @@ public:
 private:
     AABBox bound() const override;
 
+    bool raycast(const Ray &ray, Vector3 *pt) const override;
+
+    bool instanceData(uint32_t layer, Mesh **mesh, MaterialInstance **material) const override;
+
     void draw(ICommandBuffer &buffer, uint32_t layer) override;
 
     void loadUserData(const VariantMap &data) override;
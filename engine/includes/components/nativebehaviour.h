@@ -14,6 +14,8 @@ public:
 
     virtual void update();
 
+    virtual void fixedUpdate();
+
 };
 
 #endif // NATIVEBEHAVIOUR_H
@@ -29,6 +29,8 @@ private:
 
     AABBox bound() const override;
 
+    bool raycast(const Ray &ray, Vector3 *pt) const override;
+
     void draw(ICommandBuffer &buffer, uint32_t layer) override;
 
     void update() override;
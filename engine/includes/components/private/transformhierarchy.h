@@ -0,0 +1,185 @@
+#ifndef TRANSFORMHIERARCHY_H
+#define TRANSFORMHIERARCHY_H
+
+#include <amath.h>
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+
+using namespace std;
+
+class ThreadPool;
+
+class NEXT_LIBRARY_EXPORT TransformHierarchy {
+public:
+    // Fixed size pages keep the element addresses stable while the hierarchy grows
+    template<typename T>
+    class Column {
+    public:
+        enum {
+            PAGE_SHIFT = 8,
+            PAGE_SIZE = 1 << PAGE_SHIFT,
+            PAGE_MASK = PAGE_SIZE - 1
+        };
+
+        Column() :
+                m_Table(nullptr),
+                m_Size(0),
+                m_Capacity(0) {
+
+        }
+
+        ~Column() {
+            T **table = m_Table.load(memory_order_relaxed);
+            for(uint32_t i = 0; i < m_Size; i++) {
+                delete []table[i];
+            }
+            delete []table;
+            for(auto it : m_Retired) {
+                delete []it;
+            }
+        }
+
+        inline T &operator[](uint32_t index) {
+            return m_Table.load(memory_order_acquire)[index >> PAGE_SHIFT][index & PAGE_MASK];
+        }
+
+        void reserve(uint32_t size) {
+            T **table = m_Table.load(memory_order_relaxed);
+            while((m_Size << PAGE_SHIFT) < size) {
+                if(m_Size == m_Capacity) {
+                    m_Capacity = MAX(m_Capacity * 2, 16U);
+                    T **grown = new T*[m_Capacity];
+                    for(uint32_t i = 0; i < m_Size; i++) {
+                        grown[i] = table[i];
+                    }
+                    // The other threads may still look up the pages through the old table
+                    if(table) {
+                        m_Retired.push_back(table);
+                    }
+                    table = grown;
+                }
+                table[m_Size++] = new T[PAGE_SIZE]();
+                m_Table.store(table, memory_order_release);
+            }
+        }
+
+        void swap(Column &column) {
+            T **table = m_Table.load(memory_order_relaxed);
+            m_Table.store(column.m_Table.load(memory_order_relaxed), memory_order_release);
+            column.m_Table.store(table, memory_order_release);
+
+            std::swap(m_Size, column.m_Size);
+            std::swap(m_Capacity, column.m_Capacity);
+            m_Retired.swap(column.m_Retired);
+        }
+
+    private:
+        Column(const Column &);
+        Column &operator=(const Column &);
+
+        atomic<T **> m_Table;
+
+        uint32_t m_Size;
+
+        uint32_t m_Capacity;
+
+        vector<T **> m_Retired;
+
+    };
+
+public:
+    TransformHierarchy();
+
+    static TransformHierarchy *instance();
+
+    uint32_t create(uint32_t *handle);
+    void destroy(uint32_t index);
+
+    void setParent(uint32_t index, int32_t parent);
+
+    void setPosition(uint32_t index, const Vector3 &position);
+    void setRotation(uint32_t index, const Vector3 &angles);
+    void setQuaternion(uint32_t index, const Quaternion &quaternion);
+    void setScale(uint32_t index, const Vector3 &scale);
+
+    inline bool isModified() const {
+        return m_Modified.load(memory_order_relaxed);
+    }
+
+    inline bool isOwner() const {
+        return (this_thread::get_id() == m_Owner);
+    }
+
+    // Transforms can be modified from the pool threads, so the flags sharing one word are changed atomically
+    inline bool isDirty(uint32_t index) const {
+        return (m_Dirty[index >> 6].load(memory_order_relaxed) & (1ULL << (index & 63))) != 0;
+    }
+
+    inline void setDirty(uint32_t index) {
+        m_Dirty[index >> 6].fetch_or(1ULL << (index & 63), memory_order_relaxed);
+        m_Modified.store(true, memory_order_relaxed);
+    }
+
+    inline void resetDirty(uint32_t index) {
+        m_Dirty[index >> 6].fetch_and(~(1ULL << (index & 63)), memory_order_relaxed);
+    }
+
+    void updateNode(uint32_t index);
+
+    uint32_t update(ThreadPool *pool = nullptr);
+
+    uint32_t count() const;
+
+    Column<Vector3> m_Position;
+    Column<Vector3> m_Rotation;
+    Column<Quaternion> m_Quaternion;
+    Column<Vector3> m_Scale;
+
+    Column<Matrix4> m_Local;
+    Column<Matrix4> m_World;
+
+    Column<Vector3> m_WorldPosition;
+    Column<Vector3> m_WorldRotation;
+    Column<Quaternion> m_WorldQuaternion;
+    Column<Vector3> m_WorldScale;
+
+    Column<int32_t> m_Parents;
+
+    // Guards the structure and the local values against the systems running on the pool threads
+    mutex m_Mutex;
+
+private:
+    TransformHierarchy(const TransformHierarchy &);
+    TransformHierarchy &operator=(const TransformHierarchy &);
+
+    void rebuild();
+
+    void updateRange(uint32_t first, uint32_t last);
+
+    template<typename T>
+    void permute(Column<T> &column, const vector<uint32_t> &order);
+
+    friend class TransformTask;
+
+    void clearDirty();
+
+    Column<uint32_t *> m_Handles;
+
+    mutable Column<atomic<uint64_t>> m_Dirty;
+
+    vector<uint32_t> m_Roots;
+
+    thread::id m_Owner;
+
+    uint32_t m_Count;
+
+    atomic<bool> m_OrderDirty;
+
+    atomic<bool> m_Modified;
+
+};
+
+#endif // TRANSFORMHIERARCHY_H
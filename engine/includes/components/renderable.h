@@ -7,6 +7,8 @@
 
 class RenderablePrivate;
 class ICommandBuffer;
+class Mesh;
+class MaterialInstance;
 
 class NEXT_LIBRARY_EXPORT Renderable : public NativeBehaviour {
     A_REGISTER(Renderable, NativeBehaviour, General)
@@ -23,8 +25,15 @@ public:
 
     virtual AABBox bound() const;
 
+    virtual bool raycast(const Ray &ray, Vector3 *pt) const;
+
+    virtual bool instanceData(uint32_t layer, Mesh **mesh, MaterialInstance **material) const;
+
     virtual bool isLight() const;
 
+protected:
+    bool raycastMesh(Mesh *mesh, const Ray &ray, Vector3 *pt) const;
+
 private:
     bool isRenderable() const override;
 
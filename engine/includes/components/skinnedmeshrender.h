@@ -34,6 +34,8 @@ public:
 private:
     AABBox bound() const override;
 
+    bool raycast(const Ray &ray, Vector3 *pt) const override;
+
     void draw(ICommandBuffer &buffer, uint32_t layer) override;
 
     void loadUserData(const VariantMap &data) override;
@@ -69,6 +69,8 @@ private:
 
     AABBox bound() const override;
 
+    bool raycast(const Ray &ray, Vector3 *pt) const override;
+
     void loadUserData(const VariantMap &data) override;
     VariantMap saveUserData() const override;
 
@@ -73,6 +73,8 @@ private:
 
     AABBox bound() const override;
 
+    bool raycast(const Ray &ray, Vector3 *pt) const override;
+
 #ifdef NEXT_SHARED
     bool drawHandles(ObjectList &selected) override;
 #endif
@@ -57,8 +57,7 @@ public:
 protected:
     list<Transform *> &children() const;
 
-private:
-    void setDirty();
+    virtual void setDirty();
 
 private:
     friend class TransformPrivate;
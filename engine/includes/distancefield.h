@@ -0,0 +1,28 @@
+#ifndef DISTANCEFIELD_H
+#define DISTANCEFIELD_H
+
+#include <stdint.h>
+
+#include <global.h>
+
+class NEXT_LIBRARY_EXPORT DistanceField {
+public:
+    struct Options {
+        Options();
+
+        float scale;
+
+        int32_t threshold;
+
+        int32_t channels;
+
+        int32_t channel;
+    };
+
+public:
+    static void generate(const uint8_t *src, int32_t width, int32_t height, int32_t pitch,
+                         uint8_t *dst, int32_t dstWidth, int32_t dstHeight, const Options &options = Options());
+
+};
+
+#endif // DISTANCEFIELD_H
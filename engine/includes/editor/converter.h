@@ -89,6 +89,7 @@ public:
     virtual QStringList suffixes() const = 0;
 
     virtual uint8_t convertFile(IConverterSettings *settings) = 0;
+    virtual bool isThreadSafe(IConverterSettings *settings) const;
     virtual IConverterSettings *createSettings() const = 0;
 
     virtual QString templatePath() const;
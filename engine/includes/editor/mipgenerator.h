@@ -0,0 +1,36 @@
+#ifndef MIPGENERATOR_H
+#define MIPGENERATOR_H
+
+#include <variant.h>
+
+class NEXT_LIBRARY_EXPORT MipGenerator {
+public:
+    enum FilterType {
+        Box,
+        Kaiser
+    };
+
+    struct Options {
+        Options();
+
+        int32_t filter;
+
+        float alphaCutoff;
+
+        bool sRGB;
+
+        bool normalMap;
+
+        bool repeat;
+    };
+
+    typedef vector<ByteArray> Levels;
+
+public:
+    static Levels generate(const uint8_t *rgba, int32_t width, int32_t height, const Options &options, uint32_t threads = 0);
+
+    static float alphaCoverage(const uint8_t *rgba, int32_t width, int32_t height, float cutoff);
+
+};
+
+#endif // MIPGENERATOR_H
@@ -0,0 +1,27 @@
+#ifndef TEXTUREENCODER_H
+#define TEXTUREENCODER_H
+
+#include <variant.h>
+
+class ThreadPool;
+
+class NEXT_LIBRARY_EXPORT TextureEncoder {
+public:
+    enum Quality {
+        Fast,
+        Normal,
+        Best
+    };
+
+public:
+    static ByteArray encode(const uint8_t *rgba, int32_t width, int32_t height, int32_t compression, uint8_t channels, int32_t quality = Normal, ThreadPool *pool = nullptr);
+
+    static ByteArray decode(const ByteArray &data, int32_t width, int32_t height, int32_t compression, uint8_t channels);
+
+    static int32_t blockSize(int32_t compression, uint8_t channels);
+
+    static int32_t surfaceSize(int32_t width, int32_t height, int32_t compression, uint8_t channels);
+
+};
+
+#endif // TEXTUREENCODER_H
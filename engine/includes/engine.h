@@ -45,6 +45,8 @@ public:
 */
     static Object              *loadResource                (const string &path);
 
+    static Object              *loadResource                (uint64_t hash);
+
     static void                 unloadResource              (const string &path);
 
     static void                 reloadResource              (const string &path);
@@ -54,6 +56,11 @@ public:
         return dynamic_cast<T *>(loadResource(path));
     }
 
+    template<typename T>
+    static T                   *loadResource                (uint64_t hash) {
+        return dynamic_cast<T *>(loadResource(hash));
+    }
+
     static bool                 isResourceExist             (const string &path);
 
     static string               reference                   (Object *object);
@@ -98,6 +105,8 @@ private:
 
     void                        processEvents               () override;
 
+    void                        fixedUpdate                 (Scene *scene);
+
 private:
     EnginePrivate              *p_ptr;
 
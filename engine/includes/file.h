@@ -34,6 +34,8 @@ typedef list<string>    StringList;
 
 class NEXT_LIBRARY_EXPORT File {
 public:
+    virtual ~File() {}
+
     void                finit           (const char *argv0);
     void                fsearchPathAdd  (const char *path, bool isFirst = false);
 
@@ -60,6 +62,8 @@ public:
     virtual _size_t     _fsize          (_FILE *stream);
 
     virtual _size_t     _ftell          (_FILE *stream);
+
+    virtual const uint8_t *_fmap        (_FILE *stream);
 };
 
 #endif // FILEIO_H
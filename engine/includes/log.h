@@ -5,6 +5,12 @@
 
 #include <engine.h>
 
+#ifndef LOG_MAX_LEVEL
+    #define LOG_MAX_LEVEL Log::DBG
+#endif
+
+#define A_LOG(type) ((type) > LOG_MAX_LEVEL || !Log::isEnabled(type)) ? (void)0 : LogVoid() & Log(type)
+
 class LogHandler;
 
 class LogPrivate;
@@ -29,6 +35,14 @@ public:
 
     static void         setLogLevel                 (LogTypes level);
 
+    static bool         isEnabled                   (LogTypes type);
+
+    static void         setAsync                    (bool async);
+
+    static void         flush                       ();
+
+    static uint64_t     droppedRecords              ();
+
     Log                &operator<<                  (bool b);
 
     Log                &operator<<                  (unsigned char c);
@@ -48,6 +62,14 @@ public:
 
     Log                &operator<<                  (const char *s);
 
+    template<typename T>
+    Log                &field                       (const char *key, const T &value) {
+        return fieldKey(key) << value;
+    }
+
+private:
+    Log                &fieldKey                    (const char *key);
+
 private:
     LogPrivate         *p_ptr;
 
@@ -59,4 +81,11 @@ public:
 
 };
 
+class LogVoid {
+public:
+    // Has lower priority than operator<<, so the whole stream becomes the branch of A_LOG
+    void operator&(const Log &) { }
+
+};
+
 #endif // LOG_H
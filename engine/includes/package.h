@@ -0,0 +1,79 @@
+#ifndef PACKAGE_H
+#define PACKAGE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <global.h>
+
+using namespace std;
+
+class PackagePrivate;
+class PackageWriterPrivate;
+
+class NEXT_LIBRARY_EXPORT Package {
+public:
+    enum Compression {
+        None = 0,
+        LZ4
+    };
+
+    struct Entry {
+        uint64_t hash;
+        uint64_t offset;
+        uint64_t size;
+        uint64_t originalSize;
+        uint32_t name;
+        uint32_t compression;
+    };
+
+public:
+    Package();
+    ~Package();
+
+    bool open(const string &path);
+    void close();
+
+    bool isPatch() const;
+
+    uint32_t entryCount() const;
+    const Entry *entry(uint32_t index) const;
+
+    const Entry *find(const string &path) const;
+
+    string name(const Entry *entry) const;
+
+    const uint8_t *data(const Entry *entry) const;
+
+    bool read(const Entry *entry, uint8_t *buffer) const;
+
+    static bool isPackage(const string &path);
+
+    static uint64_t hash(const string &path);
+
+    static vector<uint8_t> compress(const uint8_t *data, uint64_t size);
+
+    static bool decompress(const uint8_t *data, uint64_t size, uint8_t *buffer, uint64_t bufferSize);
+
+private:
+    PackagePrivate *p_ptr;
+
+};
+
+class NEXT_LIBRARY_EXPORT PackageWriter {
+public:
+    PackageWriter();
+    ~PackageWriter();
+
+    bool open(const string &path, bool patch = false);
+    bool close();
+
+    bool addEntry(const string &path, const uint8_t *data, uint64_t size, int compression = Package::None);
+
+private:
+    PackageWriterPrivate *p_ptr;
+
+};
+
+#endif // PACKAGE_H
@@ -0,0 +1,41 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <stdint.h>
+
+#include <amath.h>
+
+class ICommandBuffer;
+class Renderable;
+class ThreadPool;
+class RenderQueuePrivate;
+
+class NEXT_LIBRARY_EXPORT RenderQueue {
+public:
+    RenderQueue();
+    ~RenderQueue();
+
+    void begin(uint32_t layer, const Matrix4 &view);
+
+    void push(Renderable *renderable);
+
+    void sort();
+
+    void draw(ICommandBuffer &buffer, ThreadPool *pool = nullptr);
+
+    uint32_t size() const;
+
+    uint64_t key(uint32_t index) const;
+
+    static uint64_t opaqueKey(uint16_t material, uint16_t mesh, float depth, bool custom = false);
+
+    static uint64_t translucentKey(float depth, uint16_t material);
+
+    static void radixSort(uint64_t *keys, uint32_t *values, uint32_t count);
+
+private:
+    RenderQueuePrivate *p_ptr;
+
+};
+
+#endif // RENDERQUEUE_H
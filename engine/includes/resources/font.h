@@ -36,8 +36,15 @@ public:
 
     void loadUserData(const VariantMap &data) override;
 private:
+    friend class TextLayout;
+    friend class GlyphTask;
+
+    bool event(Event *ev) override;
+
     void clear();
 
+    uint32_t version() const;
+
     bool requestCharacter(uint32_t character);
 
 protected:
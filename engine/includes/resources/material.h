@@ -162,6 +162,8 @@ public:
     uint16_t surfaceType() const;
     void setSurfaceType(uint16_t type);
 
+    bool isOverridden() const;
+
 protected:
     friend class Material;
 
@@ -170,6 +172,8 @@ protected:
     InfoMap m_Info;
 
     uint16_t m_SurfaceType;
+
+    bool m_Overridden;
 };
 
 #endif // SHADER
@@ -6,6 +6,7 @@
 #include "resource.h"
 
 class Material;
+class MeshBvh;
 class MeshPrivate;
 
 typedef vector<uint32_t> IndexVector;
@@ -53,6 +54,7 @@ public:
 
 private:
     friend class Mesh;
+    friend class MeshPrivate;
 
 private:
     Vector4Vector m_Colors;
@@ -158,6 +160,14 @@ public:
 
     void recalcBounds();
 
+    bool raycast(const Ray &ray, Vector3 *pt, int lod = 0) const;
+
+    bool overlapSphere(const Vector3 &center, float radius, IndexVector *triangles = nullptr, int lod = 0) const;
+
+    bool closestPoint(const Vector3 &point, Vector3 *pt, int lod = 0) const;
+
+    const MeshBvh *bvh(int lod) const;
+
     static void registerSuper(ObjectSystem *system);
 
 private:
@@ -0,0 +1,45 @@
+#ifndef MESHBVH_H
+#define MESHBVH_H
+
+#include <amath.h>
+
+#include <variant.h>
+
+class MeshBvhPrivate;
+
+typedef vector<uint32_t> IndexVector;
+
+class NEXT_LIBRARY_EXPORT MeshBvh {
+public:
+    MeshBvh();
+    ~MeshBvh();
+
+    void build(const Vector3Vector &vertices, const IndexVector &indices);
+    void clear();
+
+    bool isEmpty() const;
+
+    uint32_t nodesCount() const;
+    uint32_t trianglesCount() const;
+
+    AABBox bound() const;
+
+    bool raycast(const Ray &ray, Vector3 *pt, uint32_t *triangle = nullptr) const;
+
+    bool overlapSphere(const Vector3 &center, float radius, IndexVector *triangles = nullptr) const;
+
+    bool closestPoint(const Vector3 &point, Vector3 *pt, uint32_t *triangle = nullptr) const;
+
+    ByteArray save() const;
+    bool load(const ByteArray &data);
+
+private:
+    MeshBvh(const MeshBvh &);
+    MeshBvh &operator=(const MeshBvh &);
+
+private:
+    MeshBvhPrivate *p_ptr;
+
+};
+
+#endif // MESHBVH_H
@@ -25,6 +25,7 @@ class PostProcessSettings;
 class AtlasNode;
 
 class Renderable;
+class RenderQueue;
 
 class NEXT_LIBRARY_EXPORT Pipeline : public Resource {
     A_REGISTER(Pipeline, Resource, Resources)
@@ -49,6 +50,7 @@ public:
     void setTarget(uint32_t resource);
 
     ICommandBuffer *buffer() const;
+    void setBuffer(ICommandBuffer *buffer);
 
     RenderTarget *requestShadowTiles(uint32_t id, uint32_t lod, int32_t *x, int32_t *y, int32_t *w, int32_t *h, uint32_t count);
 
@@ -56,15 +58,13 @@ public:
 
     int screenHeight() const;
 
+    void drawComponents(uint32_t layer, list<Renderable *> &list);
+
 protected:
     void cameraReset(Camera &camera);
 
-    void drawComponents(uint32_t layer, list<Renderable *> &list);
-
     void postProcess(RenderTarget *source, uint32_t layer);
 
-    void sortByDistance(list<Renderable *> &in, const Vector3 &origin);
-
     void cleanShadowCache();
     void updateShadows(Camera &camera);
 
@@ -76,6 +76,8 @@ protected:
 
     ICommandBuffer *m_Buffer;
 
+    RenderQueue *m_pQueue;
+
     list<Renderable *> m_SceneComponents;
     list<Renderable *> m_SceneLights;
     list<Renderable *> m_UiComponents;
@@ -33,6 +33,8 @@ public:
 protected:
     void clearAtlas();
 
+    void updateElement(int key);
+
 private:
     void resize(int32_t width, int32_t height);
 
@@ -14,6 +14,7 @@ class NEXT_LIBRARY_EXPORT Texture : public Resource {
         A_PROPERTY(int, width, Texture::width, Texture::setWidth),
         A_PROPERTY(int, height, Texture::height, Texture::setHeight),
         A_PROPERTY(int, format, Texture::format, Texture::setFormat),
+        A_PROPERTY(int, compress, Texture::compress, Texture::setCompress),
         A_PROPERTY(int, wrap, Texture::wrap, Texture::setWrap),
         A_PROPERTY(int, filtering, Texture::filtering, Texture::setFiltering)
     )
@@ -37,6 +38,13 @@ class NEXT_LIBRARY_EXPORT Texture : public Resource {
                A_VALUE(Depth),
                A_VALUE(RGBA32Float)),
 
+        A_ENUM(CompressionType,
+               A_VALUE(Uncompressed),
+               A_VALUE(DXT1),
+               A_VALUE(DXT5),
+               A_VALUE(ETC2),
+               A_VALUE(BC7)),
+
         A_ENUM(FilteringType,
                A_VALUE(None),
                A_VALUE(Bilinear),
@@ -64,7 +72,8 @@ public:
         Uncompressed,
         DXT1,
         DXT5,
-        ETC2
+        ETC2,
+        BC7
     };
 
     enum FilteringType {
@@ -103,12 +112,16 @@ public:
     void addSurface(const Surface &surface);
 
     void setDirty();
+    void setDirtyRegion(int x, int y, int width, int height);
 
     void resize(int width, int height);
 
     int format() const;
     void setFormat(int type);
 
+    int compress() const;
+    void setCompress(int type);
+
     int wrap() const;
     void setWrap(int type);
 
@@ -127,8 +140,12 @@ protected:
     void loadUserData(const VariantMap &data) override;
     VariantMap saveUserData() const override;
 
+    void setState(ResourceState state) override;
+
     Sides *getSides();
 
+    bool dirtyRegion(int &x, int &y, int &width, int &height) const;
+
     int32_t size(int32_t width, int32_t height) const;
     int32_t sizeDXTc(int32_t width, int32_t height) const;
     int32_t sizeRGB(int32_t width, int32_t height) const;
@@ -0,0 +1,16 @@
+#ifndef STATICBATCHER_H
+#define STATICBATCHER_H
+
+#include <stdint.h>
+
+#include <global.h>
+
+class Actor;
+
+class NEXT_LIBRARY_EXPORT StaticBatcher {
+public:
+    static Actor *combine(Actor *root, uint32_t maxVertices = 65536, float clusterSize = 64.0f);
+
+};
+
+#endif // STATICBATCHER_H
@@ -25,6 +25,8 @@ public:
 
     virtual void update(Scene *scene) = 0;
 
+    virtual void fixedUpdate(Scene *scene);
+
     virtual int threadPolicy() const = 0;
 
     virtual void syncSettings() const;
@@ -35,9 +37,13 @@ public:
 
     void processEvents() override;
 
+    float updateTime() const;
+
 protected:
     Scene *m_pScene;
 
+    float m_UpdateTime;
+
 };
 
 #endif // SYSTEM_H
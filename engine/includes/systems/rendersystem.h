@@ -9,6 +9,10 @@ class Renderable;
 class PostProcessSettings;
 
 class QWindow;
+class ThreadPool;
+class PlatformAdaptor;
+class ICommandBuffer;
+class CommandList;
 
 class NEXT_LIBRARY_EXPORT RenderSystem : public System {
 public:
@@ -32,13 +36,27 @@ public:
     virtual QWindow *createRhiWindow() const;
 #endif
 
+    ThreadPool *threadPool() const;
+
+    bool setPipelined(PlatformAdaptor *platform);
+    bool isPipelined() const;
+
     static void atlasPageSize(int32_t &width, int32_t &height);
 
 protected:
     void processEvents() override;
 
+    virtual void upload(ICommandBuffer &buffer, const CommandList &commands);
+
+    virtual void submit(ICommandBuffer &buffer, const CommandList &commands);
+
     static void setAtlasPageSize(int32_t width, int32_t height);
 
+private:
+    void synchronize();
+
+    void renderThread();
+
 private:
     RenderSystemPrivate *p_ptr;
 
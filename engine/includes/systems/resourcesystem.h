@@ -4,6 +4,7 @@
 #include "system.h"
 
 class Resource;
+class AssetIndex;
 
 class ResourceSystemPrivate;
 
@@ -31,6 +32,8 @@ public:
 
     DictionaryMap &indices() const;
 
+    AssetIndex &assetIndex() const;
+
 private:
     bool init() override;
 
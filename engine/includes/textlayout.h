@@ -0,0 +1,32 @@
+#ifndef TEXTLAYOUT_H
+#define TEXTLAYOUT_H
+
+#include <stdint.h>
+#include <string>
+
+#include <amath.h>
+
+using namespace std;
+
+class Font;
+class Mesh;
+
+class TextLayoutPrivate;
+
+class NEXT_LIBRARY_EXPORT TextLayout {
+public:
+    TextLayout();
+    ~TextLayout();
+
+    void compose(Font *font, Mesh *mesh, int size, const string &text, int alignment, bool kerning, bool wrap, const Vector2 &boundaries);
+
+    void reset();
+
+    uint32_t reused() const;
+
+private:
+    TextLayoutPrivate *p_ptr;
+
+};
+
+#endif // TEXTLAYOUT_H
@@ -17,11 +17,33 @@ public:
 
     static float                deltaTime                   ();
 
+    static float                unscaledDeltaTime           ();
+
     static float                scale                       ();
 
     static void                 setScale                    (float scale);
 
     static float                time                        ();
+
+    static float                fixedFrameTime              ();
+
+    static void                 setFixedFrameTime           (float time);
+
+    static float                fixedTimeStep               ();
+
+    static void                 setFixedTimeStep            (float step);
+
+    static int32_t              maxFixedSteps               ();
+
+    static void                 setMaxFixedSteps            (int32_t steps);
+
+    static int32_t              fixedSteps                  ();
+
+    static float                interpolation               ();
+
+    static int32_t              frameRate                   ();
+
+    static void                 setFrameRate                (int32_t rate);
 };
 
 #endif // TIMER
@@ -13,6 +13,7 @@
 
 #include <log.h>
 #include <file.h>
+#include <package.h>
 #include <utils.h>
 #include <json.h>
 
@@ -88,7 +89,10 @@ bool DesktopAdaptor::init() {
 }
 
 void DesktopAdaptor::update() {
-    glfwSwapBuffers(m_pWindow);
+    // The context can be moved to the render thread which presents the frames itself
+    if(glfwGetCurrentContext() == m_pWindow) {
+        glfwSwapBuffers(m_pWindow);
+    }
 
     s_inputString.clear();
 
@@ -115,6 +119,10 @@ bool DesktopAdaptor::start() {
     Log::overrideHandler(new DesktopHandler());
 
     g_pFile->fsearchPathAdd((g_pEngine->locationAppDir() + "/base.pak").c_str());
+    string patch = g_pEngine->locationAppDir() + "/patch.pak";
+    if(Package::isPackage(patch)) {
+        g_pFile->fsearchPathAdd(patch.c_str());
+    }
 
     if(Engine::reloadBundle() == false) {
         Log(Log::ERR) << "Filed to load bundle";
@@ -201,6 +209,15 @@ bool DesktopAdaptor::isValid() {
     return !glfwWindowShouldClose(m_pWindow);
 }
 
+bool DesktopAdaptor::makeCurrent(bool current) {
+    glfwMakeContextCurrent((current) ? m_pWindow : nullptr);
+    return true;
+}
+
+void DesktopAdaptor::swapBuffers() {
+    glfwSwapBuffers(m_pWindow);
+}
+
 bool DesktopAdaptor::key(Input::KeyCode code) {
     return (glfwGetKey(m_pWindow, code) == GLFW_PRESS);
 }
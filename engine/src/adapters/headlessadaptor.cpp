@@ -0,0 +1,102 @@
+#include "adapters/headlessadaptor.h"
+
+#include <log.h>
+#include <file.h>
+#include <package.h>
+
+/*!
+    \class HeadlessAdaptor
+    \brief The platform adaptor which runs the engine without a window, a graphics context or input devices.
+    \inmodule Engine
+
+    HeadlessAdaptor is intended for the dedicated servers, automated tests and benchmarks.
+    It must be installed by Engine::setPlatformAdaptor() before the Engine::init() call.
+    The game cycle will be stopped after the frameLimit() frames or after stop() call.
+    \note The render system still can be used with this adaptor in case of the render backend doesn't require a graphics context.
+*/
+
+/*!
+    Constructs the adaptor for the \a engine with a virtual screen \a width and \a height.
+*/
+HeadlessAdaptor::HeadlessAdaptor(Engine *engine, uint32_t width, uint32_t height) :
+        m_pEngine(engine),
+        m_Width(width),
+        m_Height(height),
+        m_Frame(0),
+        m_FrameLimit(0),
+        m_Running(false) {
+
+}
+
+bool HeadlessAdaptor::init() {
+    return true;
+}
+/*!
+    Finishes the current frame.
+*/
+void HeadlessAdaptor::update() {
+    m_Frame++;
+}
+
+bool HeadlessAdaptor::start() {
+    m_pEngine->file()->fsearchPathAdd((m_pEngine->locationAppDir() + "/base.pak").c_str());
+    string patch = m_pEngine->locationAppDir() + "/patch.pak";
+    if(Package::isPackage(patch)) {
+        m_pEngine->file()->fsearchPathAdd(patch.c_str());
+    }
+
+    if(Engine::reloadBundle() == false) {
+        Log(Log::ERR) << "Failed to load bundle";
+    }
+
+    m_Frame = 0;
+    m_Running = true;
+
+    return true;
+}
+
+void HeadlessAdaptor::stop() {
+    m_Running = false;
+}
+
+void HeadlessAdaptor::destroy() {
+
+}
+/*!
+    Returns true while the adaptor is running and the frame limit is not reached.
+*/
+bool HeadlessAdaptor::isValid() {
+    return m_Running && (m_FrameLimit == 0 || m_Frame < m_FrameLimit);
+}
+
+string HeadlessAdaptor::inputString() {
+    return string();
+}
+
+uint32_t HeadlessAdaptor::screenWidth() {
+    return m_Width;
+}
+
+uint32_t HeadlessAdaptor::screenHeight() {
+    return m_Height;
+}
+/*!
+    Returns the number of frames processed since the start() call.
+*/
+uint32_t HeadlessAdaptor::frame() const {
+    return m_Frame;
+}
+/*!
+    Returns the number of frames to process before the game cycle will be stopped.
+    Zero value means unlimited number of frames.
+*/
+uint32_t HeadlessAdaptor::frameLimit() const {
+    return m_FrameLimit;
+}
+/*!
+    Sets the number of \a frames to process before the game cycle will be stopped.
+    Zero value means unlimited number of frames.
+*/
+void HeadlessAdaptor::setFrameLimit(uint32_t frames) {
+    m_FrameLimit = frames;
+}
@@ -0,0 +1,470 @@
+#include "adapters/replayadaptor.h"
+
+#include <log.h>
+#include <objectsystem.h>
+
+#include <cfloat>
+#include <cstring>
+#include <random>
+
+#include "timer.h"
+
+#define REPLAY_MAGIC "TRPL"
+#define REPLAY_VERSION 1
+
+#define KEY_HELD        (1<<0)
+#define KEY_PRESSED     (1<<1)
+#define KEY_RELEASED    (1<<2)
+
+#define BUTTON_HELD     0
+#define BUTTON_PRESSED  1
+#define BUTTON_RELEASED 2
+
+#define BUTTON_COUNT    8
+
+namespace {
+    template<typename T>
+    void writeValue(FILE *fp, const T &value) {
+        fwrite(&value, sizeof(T), 1, fp);
+    }
+
+    template<typename T>
+    bool readValue(FILE *fp, T &value) {
+        return fread(&value, sizeof(T), 1, fp) == 1;
+    }
+}
+
+/*!
+    \class ReplayAdaptor
+    \brief The platform adaptor which records the play session or replays it.
+    \inmodule Engine
+
+    ReplayAdaptor wraps another platform adaptor.
+    In the Record mode the state of all input devices and the frame delta time are written to a compact binary log each frame.
+    The game receives the input state from the log in both modes, so the recorded session sees exactly the same values as the replayed one.
+    In the Replay mode the input devices of the wrapped adaptor are ignored and the Timer is driven by the recorded delta times.
+    The seed for ObjectSystem::generateUUID() is stored in the log too, which makes the replays reproducible.
+
+    The adaptor must be installed by Engine::setPlatformAdaptor() before the Engine::init() call:
+    \code
+        engine->setPlatformAdaptor(new ReplayAdaptor(new HeadlessAdaptor(engine), "session.replay", ReplayAdaptor::Replay));
+        if(engine->init()) {
+            ...
+            engine->start();
+        }
+    \endcode
+
+    \note The log uses native byte order.
+*/
+
+/*!
+    Constructs the adaptor which wraps the \a platform adaptor and records to or replays from the file with \a path according to the \a mode.
+    The \a seed will be used for the UUID generator in the Record mode; zero value means a random seed.
+    \note The ReplayAdaptor takes ownership of the \a platform adaptor.
+*/
+ReplayAdaptor::ReplayAdaptor(PlatformAdaptor *platform, const string &path, Mode mode, uint32_t seed) :
+        m_pPlatform(platform),
+        m_pFile(nullptr),
+        m_Path(path),
+        m_Mode(mode),
+        m_Seed(seed),
+        m_Width(0),
+        m_Height(0),
+        m_Frame(0),
+        m_Finished(false) {
+
+    memset(m_State.buttons, 0, sizeof(m_State.buttons));
+}
+
+ReplayAdaptor::~ReplayAdaptor() {
+    if(m_pFile) {
+        fclose(m_pFile);
+    }
+    delete m_pPlatform;
+}
+
+bool ReplayAdaptor::init() {
+    return m_pPlatform->init();
+}
+/*!
+    Finishes the current frame and prepares the input state for the next one.
+*/
+void ReplayAdaptor::update() {
+    if(m_pFile == nullptr) {
+        m_pPlatform->update();
+        return;
+    }
+
+    if(m_Mode == Record) {
+        writeDelta();
+        m_pPlatform->update();
+        captureState();
+        writeState();
+    } else {
+        m_pPlatform->update();
+        if(!readState() || !readDelta()) {
+            Log(Log::INF) << "Replay finished on frame:" << m_Frame;
+            m_Finished = true;
+        }
+    }
+    m_Frame++;
+}
+/*!
+    Starts the wrapped adaptor and opens the log.
+    Returns false in case of the log can't be opened or has an unsupported format.
+*/
+bool ReplayAdaptor::start() {
+    bool result = m_pPlatform->start();
+
+    m_Frame = 0;
+    m_Finished = false;
+
+    m_pFile = fopen(m_Path.c_str(), (m_Mode == Record) ? "wb" : "rb");
+    if(m_pFile == nullptr) {
+        Log(Log::ERR) << "Unable to open replay:" << m_Path.c_str();
+        m_Finished = true;
+        return false;
+    }
+
+    if(m_Mode == Record) {
+        if(m_Seed == 0) {
+            random_device device;
+            m_Seed = device();
+        }
+        m_Width = m_pPlatform->screenWidth();
+        m_Height = m_pPlatform->screenHeight();
+
+        fwrite(REPLAY_MAGIC, 4, 1, m_pFile);
+        writeValue(m_pFile, static_cast<uint32_t>(REPLAY_VERSION));
+        writeValue(m_pFile, m_Seed);
+        writeValue(m_pFile, m_Width);
+        writeValue(m_pFile, m_Height);
+
+        captureState();
+        writeState();
+    } else {
+        char magic[4];
+        uint32_t version = 0;
+        if(fread(magic, 4, 1, m_pFile) != 1 || memcmp(magic, REPLAY_MAGIC, 4) != 0 ||
+           !readValue(m_pFile, version) || version != REPLAY_VERSION ||
+           !readValue(m_pFile, m_Seed) || !readValue(m_pFile, m_Width) || !readValue(m_pFile, m_Height) ||
+           !readState() || !readDelta()) {
+
+            Log(Log::ERR) << "Invalid replay:" << m_Path.c_str();
+            m_Finished = true;
+            return false;
+        }
+    }
+    ObjectSystem::setUUIDSeed(m_Seed);
+
+    return result;
+}
+
+void ReplayAdaptor::stop() {
+    m_pPlatform->stop();
+
+    if(m_pFile) {
+        fclose(m_pFile);
+        m_pFile = nullptr;
+    }
+    if(m_Mode == Replay) {
+        Timer::setFixedFrameTime(0.0f);
+    }
+}
+
+void ReplayAdaptor::destroy() {
+    m_pPlatform->destroy();
+}
+/*!
+    Returns false in case of the wrapped adaptor is finished or the replay reached the end of log.
+*/
+bool ReplayAdaptor::isValid() {
+    return !m_Finished && m_pPlatform->isValid();
+}
+
+bool ReplayAdaptor::makeCurrent(bool current) {
+    return m_pPlatform->makeCurrent(current);
+}
+
+void ReplayAdaptor::swapBuffers() {
+    m_pPlatform->swapBuffers();
+}
+
+bool ReplayAdaptor::key(Input::KeyCode code) {
+    auto it = m_State.keys.find(code);
+    return (it != m_State.keys.end()) && (it->second & KEY_HELD);
+}
+
+bool ReplayAdaptor::keyPressed(Input::KeyCode code) {
+    auto it = m_State.keys.find(code);
+    return (it != m_State.keys.end()) && (it->second & KEY_PRESSED);
+}
+
+bool ReplayAdaptor::keyReleased(Input::KeyCode code) {
+    auto it = m_State.keys.find(code);
+    return (it != m_State.keys.end()) && (it->second & KEY_RELEASED);
+}
+
+string ReplayAdaptor::inputString() {
+    return m_State.input;
+}
+
+void ReplayAdaptor::setKeyboardVisible(bool visible) {
+    m_pPlatform->setKeyboardVisible(visible);
+}
+
+Vector4 ReplayAdaptor::mousePosition() {
+    return m_State.mousePosition;
+}
+
+Vector4 ReplayAdaptor::mouseDelta() {
+    return m_State.mouseDelta;
+}
+
+bool ReplayAdaptor::mouseButton(Input::MouseButton button) {
+    return m_State.buttons[BUTTON_HELD] & (1 << button);
+}
+
+bool ReplayAdaptor::mousePressed(Input::MouseButton button) {
+    return m_State.buttons[BUTTON_PRESSED] & (1 << button);
+}
+
+bool ReplayAdaptor::mouseReleased(Input::MouseButton button) {
+    return m_State.buttons[BUTTON_RELEASED] & (1 << button);
+}
+
+void ReplayAdaptor::setMousePosition(int32_t x, int32_t y) {
+    if(m_Mode == Record) {
+        m_pPlatform->setMousePosition(x, y);
+    }
+}
+
+uint32_t ReplayAdaptor::screenWidth() {
+    return (m_Mode == Replay && m_Width > 0) ? m_Width : m_pPlatform->screenWidth();
+}
+
+uint32_t ReplayAdaptor::screenHeight() {
+    return (m_Mode == Replay && m_Height > 0) ? m_Height : m_pPlatform->screenHeight();
+}
+
+uint32_t ReplayAdaptor::joystickCount() {
+    return m_State.joysticks.size();
+}
+
+uint32_t ReplayAdaptor::joystickButtons(uint32_t index) {
+    return (index < m_State.joysticks.size()) ? m_State.joysticks[index].buttons : 0;
+}
+
+Vector4 ReplayAdaptor::joystickThumbs(uint32_t index) {
+    return (index < m_State.joysticks.size()) ? m_State.joysticks[index].thumbs : Vector4();
+}
+
+Vector2 ReplayAdaptor::joystickTriggers(uint32_t index) {
+    return (index < m_State.joysticks.size()) ? m_State.joysticks[index].triggers : Vector2();
+}
+
+uint32_t ReplayAdaptor::touchCount() {
+    return m_State.touches.size();
+}
+
+uint32_t ReplayAdaptor::touchState(uint32_t index) {
+    return (index < m_State.touches.size()) ? m_State.touches[index].state : 0;
+}
+
+Vector4 ReplayAdaptor::touchPosition(uint32_t index) {
+    return (index < m_State.touches.size()) ? m_State.touches[index].position : Vector4();
+}
+
+void *ReplayAdaptor::pluginLoad(const char *name) {
+    return m_pPlatform->pluginLoad(name);
+}
+
+bool ReplayAdaptor::pluginUnload(void *plugin) {
+    return m_pPlatform->pluginUnload(plugin);
+}
+
+void *ReplayAdaptor::pluginAddress(void *plugin, const string &name) {
+    return m_pPlatform->pluginAddress(plugin, name);
+}
+
+string ReplayAdaptor::locationLocalDir() {
+    return m_pPlatform->locationLocalDir();
+}
+
+void ReplayAdaptor::syncConfiguration(VariantMap &map) const {
+    m_pPlatform->syncConfiguration(map);
+}
+/*!
+    Returns the wrapped platform adaptor.
+*/
+PlatformAdaptor *ReplayAdaptor::platform() const {
+    return m_pPlatform;
+}
+/*!
+    Returns the adaptor mode.
+*/
+ReplayAdaptor::Mode ReplayAdaptor::mode() const {
+    return m_Mode;
+}
+/*!
+    Returns the number of recorded or replayed frames.
+*/
+uint32_t ReplayAdaptor::frame() const {
+    return m_Frame;
+}
+/*!
+    \internal
+    Reads the current input state from the wrapped adaptor.
+*/
+void ReplayAdaptor::captureState() {
+    m_State.keys.clear();
+    for(int32_t code = Input::KEY_SPACE; code <= Input::KEY_MENU; code++) {
+        Input::KeyCode key = static_cast<Input::KeyCode>(code);
+        uint8_t bits = 0;
+        if(m_pPlatform->key(key)) {
+            bits |= KEY_HELD;
+        }
+        if(m_pPlatform->keyPressed(key)) {
+            bits |= KEY_PRESSED;
+        }
+        if(m_pPlatform->keyReleased(key)) {
+            bits |= KEY_RELEASED;
+        }
+        if(bits) {
+            m_State.keys[code] = bits;
+        }
+    }
+
+    memset(m_State.buttons, 0, sizeof(m_State.buttons));
+    for(int32_t i = 0; i < BUTTON_COUNT; i++) {
+        Input::MouseButton button = static_cast<Input::MouseButton>(i);
+        if(m_pPlatform->mouseButton(button)) {
+            m_State.buttons[BUTTON_HELD] |= (1 << i);
+        }
+        if(m_pPlatform->mousePressed(button)) {
+            m_State.buttons[BUTTON_PRESSED] |= (1 << i);
+        }
+        if(m_pPlatform->mouseReleased(button)) {
+            m_State.buttons[BUTTON_RELEASED] |= (1 << i);
+        }
+    }
+
+    m_State.mousePosition = m_pPlatform->mousePosition();
+    m_State.mouseDelta = m_pPlatform->mouseDelta();
+
+    m_State.input = m_pPlatform->inputString();
+
+    m_State.joysticks.resize(m_pPlatform->joystickCount());
+    for(uint32_t i = 0; i < m_State.joysticks.size(); i++) {
+        m_State.joysticks[i].buttons = m_pPlatform->joystickButtons(i);
+        m_State.joysticks[i].thumbs = m_pPlatform->joystickThumbs(i);
+        m_State.joysticks[i].triggers = m_pPlatform->joystickTriggers(i);
+    }
+
+    m_State.touches.resize(m_pPlatform->touchCount());
+    for(uint32_t i = 0; i < m_State.touches.size(); i++) {
+        m_State.touches[i].state = m_pPlatform->touchState(i);
+        m_State.touches[i].position = m_pPlatform->touchPosition(i);
+    }
+}
+/*!
+    \internal
+*/
+void ReplayAdaptor::writeState() {
+    writeValue(m_pFile, static_cast<uint16_t>(m_State.keys.size()));
+    for(auto &it : m_State.keys) {
+        writeValue(m_pFile, static_cast<int16_t>(it.first));
+        writeValue(m_pFile, it.second);
+    }
+    fwrite(m_State.buttons, sizeof(m_State.buttons), 1, m_pFile);
+
+    writeValue(m_pFile, m_State.mousePosition);
+    writeValue(m_pFile, m_State.mouseDelta);
+
+    writeValue(m_pFile, static_cast<uint16_t>(m_State.input.size()));
+    fwrite(m_State.input.c_str(), m_State.input.size(), 1, m_pFile);
+
+    writeValue(m_pFile, static_cast<uint8_t>(m_State.joysticks.size()));
+    for(auto &it : m_State.joysticks) {
+        writeValue(m_pFile, it.buttons);
+        writeValue(m_pFile, it.thumbs);
+        writeValue(m_pFile, it.triggers);
+    }
+
+    writeValue(m_pFile, static_cast<uint8_t>(m_State.touches.size()));
+    for(auto &it : m_State.touches) {
+        writeValue(m_pFile, it.state);
+        writeValue(m_pFile, it.position);
+    }
+}
+/*!
+    \internal
+*/
+bool ReplayAdaptor::readState() {
+    uint16_t count = 0;
+    if(!readValue(m_pFile, count)) {
+        return false;
+    }
+    m_State.keys.clear();
+    for(uint16_t i = 0; i < count; i++) {
+        int16_t code;
+        uint8_t bits;
+        if(!readValue(m_pFile, code) || !readValue(m_pFile, bits)) {
+            return false;
+        }
+        m_State.keys[code] = bits;
+    }
+    if(fread(m_State.buttons, sizeof(m_State.buttons), 1, m_pFile) != 1 ||
+       !readValue(m_pFile, m_State.mousePosition) || !readValue(m_pFile, m_State.mouseDelta)) {
+        return false;
+    }
+
+    if(!readValue(m_pFile, count)) {
+        return false;
+    }
+    m_State.input.resize(count);
+    if(count > 0 && fread(&m_State.input[0], count, 1, m_pFile) != 1) {
+        return false;
+    }
+
+    uint8_t size = 0;
+    if(!readValue(m_pFile, size)) {
+        return false;
+    }
+    m_State.joysticks.resize(size);
+    for(auto &it : m_State.joysticks) {
+        if(!readValue(m_pFile, it.buttons) || !readValue(m_pFile, it.thumbs) || !readValue(m_pFile, it.triggers)) {
+            return false;
+        }
+    }
+
+    if(!readValue(m_pFile, size)) {
+        return false;
+    }
+    m_State.touches.resize(size);
+    for(auto &it : m_State.touches) {
+        if(!readValue(m_pFile, it.state) || !readValue(m_pFile, it.position)) {
+            return false;
+        }
+    }
+    return true;
+}
+/*!
+    \internal
+*/
+void ReplayAdaptor::writeDelta() {
+    writeValue(m_pFile, Timer::unscaledDeltaTime());
+}
+/*!
+    \internal
+    Reads the delta time for the next frame and applies it to the Timer.
+*/
+bool ReplayAdaptor::readDelta() {
+    float delta;
+    if(!readValue(m_pFile, delta)) {
+        return false;
+    }
+    // Zero value switches the Timer to the real clock
+    Timer::setFixedFrameTime((delta > 0.0f) ? delta : FLT_MIN);
+    return true;
+}
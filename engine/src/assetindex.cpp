@@ -0,0 +1,425 @@
+#include "assetindex.h"
+
+#include "log.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define INDEX_MAGIC "TIDX"
+#define INDEX_VERSION 1
+
+#define BUCKET_SIZE 4
+#define MAX_SEED 65536
+
+namespace {
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t count;
+        uint32_t slots;
+        uint32_t buckets;
+        uint32_t settings;
+        uint32_t stringsSize;
+        uint32_t reserved;
+    };
+
+    struct Slot {
+        uint64_t hash;
+        uint32_t path;
+        uint32_t uuid;
+        uint32_t type;
+        uint32_t reserved;
+    };
+
+    inline uint64_t mix(uint64_t hash, uint32_t seed) {
+        uint64_t x = hash ^ (seed * 0x9E3779B97F4A7C15ULL);
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    inline uint64_t totalSize(const Header &header) {
+        return sizeof(Header) + sizeof(Slot) * header.slots + sizeof(uint32_t) * header.buckets +
+               sizeof(uint32_t) * 2 * header.settings + header.stringsSize;
+    }
+
+    struct Key {
+        uint64_t hash;
+        uint32_t path;
+        uint32_t uuid;
+        uint32_t type;
+    };
+
+    bool place(const vector<Key> &keys, uint32_t buckets, uint32_t slots, vector<uint32_t> &seeds, vector<int32_t> &table) {
+        vector<vector<uint32_t>> groups(buckets);
+        for(uint32_t i = 0; i < keys.size(); i++) {
+            groups[mix(keys[i].hash, 0) % buckets].push_back(i);
+        }
+
+        vector<uint32_t> order(buckets);
+        for(uint32_t i = 0; i < buckets; i++) {
+            order[i] = i;
+        }
+        // The largest buckets are placed first while the table is still empty
+        stable_sort(order.begin(), order.end(), [&groups](uint32_t a, uint32_t b) {
+            return groups[a].size() > groups[b].size();
+        });
+
+        seeds.assign(buckets, 0);
+        table.assign(slots, -1);
+
+        vector<uint32_t> positions;
+        for(auto bucket : order) {
+            const vector<uint32_t> &group = groups[bucket];
+            if(group.empty()) {
+                break;
+            }
+
+            bool placed = false;
+            for(uint32_t seed = 0; seed < MAX_SEED && !placed; seed++) {
+                positions.clear();
+                placed = true;
+                for(auto it : group) {
+                    uint32_t position = mix(keys[it].hash, seed + 1) % slots;
+                    if(table[position] != -1 || find(positions.begin(), positions.end(), position) != positions.end()) {
+                        placed = false;
+                        break;
+                    }
+                    positions.push_back(position);
+                }
+                if(placed) {
+                    for(uint32_t i = 0; i < group.size(); i++) {
+                        table[positions[i]] = group[i];
+                    }
+                    seeds[bucket] = seed;
+                }
+            }
+            if(!placed) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+class AssetIndexPrivate {
+public:
+    AssetIndexPrivate() :
+            m_pData(nullptr),
+            m_Size(0),
+            m_pHeader(nullptr),
+            m_pSlots(nullptr),
+            m_pSeeds(nullptr),
+            m_pSettings(nullptr),
+            m_pStrings(nullptr) {
+
+    }
+
+    bool parse(const uint8_t *data, uint64_t size) {
+        if(data == nullptr || size < sizeof(Header)) {
+            return false;
+        }
+        const Header *header = reinterpret_cast<const Header *>(data);
+        if(memcmp(header->magic, INDEX_MAGIC, 4) != 0 || header->version != INDEX_VERSION) {
+            return false;
+        }
+        if(header->slots == 0 || header->buckets == 0 || header->stringsSize == 0 || totalSize(*header) > size) {
+            return false;
+        }
+
+        m_pSlots = reinterpret_cast<const Slot *>(data + sizeof(Header));
+        m_pSeeds = reinterpret_cast<const uint32_t *>(m_pSlots + header->slots);
+        m_pSettings = m_pSeeds + header->buckets;
+        m_pStrings = reinterpret_cast<const char *>(m_pSettings + 2 * header->settings);
+        if(m_pStrings[header->stringsSize - 1] != 0) {
+            return false;
+        }
+
+        m_pData = data;
+        m_Size = size;
+        m_pHeader = header;
+        return true;
+    }
+
+    const Slot *find(uint64_t hash) const {
+        if(m_pHeader == nullptr) {
+            return nullptr;
+        }
+        uint32_t seed = m_pSeeds[mix(hash, 0) % m_pHeader->buckets];
+        const Slot *slot = &m_pSlots[mix(hash, seed + 1) % m_pHeader->slots];
+        return (slot->hash == hash && slot->path != 0) ? slot : nullptr;
+    }
+
+    const char *text(uint32_t offset) const {
+        return (offset < m_pHeader->stringsSize) ? m_pStrings + offset : "";
+    }
+
+    vector<uint8_t> m_Buffer;
+
+    const uint8_t *m_pData;
+
+    uint64_t m_Size;
+
+    const Header *m_pHeader;
+
+    const Slot *m_pSlots;
+
+    const uint32_t *m_pSeeds;
+
+    const uint32_t *m_pSettings;
+
+    const char *m_pStrings;
+
+};
+/*!
+    \class AssetIndex
+    \brief The lookup table which maps the asset paths to the asset identifiers.
+    \inmodule Engine
+
+    The index is a flat binary blob which can be used directly from a memory-mapped file without any parsing.
+    Lookups use a minimal perfect hash of the asset path; each lookup touches exactly one bucket seed and one slot.
+
+    Asset paths are hashed with 64-bit FNV-1a. For the literal paths the hash can be calculated at compile time:
+    \code
+    constexpr uint64_t key = AssetIndex::hash(".embedded/DefaultSprite.mtl");
+    Material *material = Engine::loadResource<Material>(key);
+    \endcode
+*/
+
+AssetIndex::AssetIndex() :
+        p_ptr(new AssetIndexPrivate) {
+
+}
+
+AssetIndex::~AssetIndex() {
+    delete p_ptr;
+}
+/*!
+    Opens the index stored in the \a data with \a size.
+    The \a data isn't copied and must stay valid until the index is closed.
+    Returns true if the \a data contains a valid index; otherwise returns false.
+*/
+bool AssetIndex::open(const uint8_t *data, uint64_t size) {
+    close();
+    return p_ptr->parse(data, size);
+}
+/*!
+    Takes ownership of the index \a data; the \a data container is left empty.
+    Returns true if the \a data contains a valid index; otherwise returns false.
+*/
+bool AssetIndex::load(vector<uint8_t> &data) {
+    close();
+    p_ptr->m_Buffer.swap(data);
+    if(!p_ptr->parse(p_ptr->m_Buffer.data(), p_ptr->m_Buffer.size())) {
+        close();
+        return false;
+    }
+    return true;
+}
+/*!
+    Closes the index and releases the owned data.
+*/
+void AssetIndex::close() {
+    p_ptr->m_Buffer.clear();
+    p_ptr->m_pData = nullptr;
+    p_ptr->m_Size = 0;
+    p_ptr->m_pHeader = nullptr;
+}
+/*!
+    Returns true if the index is opened.
+*/
+bool AssetIndex::isValid() const {
+    return p_ptr->m_pHeader != nullptr;
+}
+/*!
+    Returns the number of assets in the index.
+*/
+uint32_t AssetIndex::size() const {
+    return p_ptr->m_pHeader ? p_ptr->m_pHeader->count : 0;
+}
+/*!
+    Returns the raw data of the index which can be stored to a file.
+*/
+const uint8_t *AssetIndex::data() const {
+    return p_ptr->m_pData;
+}
+/*!
+    Returns the size of the raw data of the index in bytes.
+*/
+uint64_t AssetIndex::dataSize() const {
+    return p_ptr->m_Size;
+}
+/*!
+    Returns the identifier of the asset with \a path or nullptr if the index doesn't contain it.
+*/
+const char *AssetIndex::uuid(const string &path) const {
+    const Slot *slot = p_ptr->find(hash(path));
+    if(slot && path == p_ptr->text(slot->path)) {
+        return p_ptr->text(slot->uuid);
+    }
+    return nullptr;
+}
+/*!
+    Returns the identifier of the asset with path \a hash or nullptr if the index doesn't contain it.
+
+    \sa hash()
+*/
+const char *AssetIndex::uuid(uint64_t hash) const {
+    const Slot *slot = p_ptr->find(hash);
+    if(slot) {
+        return p_ptr->text(slot->uuid);
+    }
+    return nullptr;
+}
+/*!
+    Returns the type name of the asset with \a path or nullptr if the index doesn't contain it.
+*/
+const char *AssetIndex::type(const string &path) const {
+    const Slot *slot = p_ptr->find(hash(path));
+    if(slot && path == p_ptr->text(slot->path)) {
+        return p_ptr->text(slot->type);
+    }
+    return nullptr;
+}
+/*!
+    Returns the number of the project settings stored in the index.
+*/
+uint32_t AssetIndex::settingsCount() const {
+    return p_ptr->m_pHeader ? p_ptr->m_pHeader->settings : 0;
+}
+/*!
+    Returns the key of the setting with \a index.
+*/
+const char *AssetIndex::settingKey(uint32_t index) const {
+    return (index < settingsCount()) ? p_ptr->text(p_ptr->m_pSettings[index * 2]) : nullptr;
+}
+/*!
+    Returns the value of the setting with \a index.
+*/
+const char *AssetIndex::settingValue(uint32_t index) const {
+    return (index < settingsCount()) ? p_ptr->text(p_ptr->m_pSettings[index * 2 + 1]) : nullptr;
+}
+/*!
+    Builds the index data for the asset \a items and project \a settings.
+    The \a items map an asset path to the pair of the asset type and identifier.
+    Returns an empty container in case of failure.
+*/
+vector<uint8_t> AssetIndex::build(const Items &items, const Settings &settings) {
+    // The offset 0 is reserved for the empty string to mark unused slots
+    vector<char> strings(1, 0);
+    unordered_map<string, uint32_t> offsets;
+    auto add = [&strings, &offsets](const string &value) {
+        auto it = offsets.find(value);
+        if(it != offsets.end()) {
+            return it->second;
+        }
+        uint32_t offset = strings.size();
+        strings.insert(strings.end(), value.begin(), value.end());
+        strings.push_back(0);
+        offsets[value] = offset;
+        return offset;
+    };
+
+    // Sorted input makes the output independent from the items order
+    vector<const Items::value_type *> sorted;
+    sorted.reserve(items.size());
+    for(auto &it : items) {
+        if(!it.first.empty()) {
+            sorted.push_back(&it);
+        }
+    }
+    sort(sorted.begin(), sorted.end(), [](const Items::value_type *a, const Items::value_type *b) {
+        return a->first < b->first;
+    });
+
+    vector<Key> keys;
+    keys.reserve(sorted.size());
+    for(auto it : sorted) {
+        Key key;
+        key.hash = hash(it->first);
+        key.path = add(it->first);
+        key.type = add(it->second.first);
+        key.uuid = add(it->second.second);
+        keys.push_back(key);
+    }
+    sort(keys.begin(), keys.end(), [](const Key &a, const Key &b) {
+        return a.hash < b.hash;
+    });
+    for(uint32_t i = 1; i < keys.size(); i++) {
+        if(keys[i].hash == keys[i - 1].hash) {
+            Log(Log::ERR) << "[ AssetIndex ] Hash collision for" << &strings[keys[i].path] << "and" << &strings[keys[i - 1].path];
+            return vector<uint8_t>();
+        }
+    }
+
+    vector<pair<string, string>> values(settings.begin(), settings.end());
+    sort(values.begin(), values.end());
+    vector<uint32_t> settingsTable;
+    for(auto &it : values) {
+        settingsTable.push_back(add(it.first));
+        settingsTable.push_back(add(it.second));
+    }
+
+    uint32_t count = keys.size();
+    uint32_t buckets = max((count + BUCKET_SIZE - 1) / BUCKET_SIZE, 1U);
+    uint32_t slots = max(count + count / 8, 1U);
+
+    vector<uint32_t> seeds;
+    vector<int32_t> table;
+    while(!place(keys, buckets, slots, seeds, table)) {
+        slots += slots / 8 + 1;
+    }
+
+    Header header;
+    memcpy(header.magic, INDEX_MAGIC, 4);
+    header.version = INDEX_VERSION;
+    header.count = count;
+    header.slots = slots;
+    header.buckets = buckets;
+    header.settings = values.size();
+    header.stringsSize = strings.size();
+    header.reserved = 0;
+
+    vector<uint8_t> result(totalSize(header), 0);
+    uint8_t *ptr = result.data();
+    memcpy(ptr, &header, sizeof(Header));
+    ptr += sizeof(Header);
+
+    for(auto it : table) {
+        Slot slot;
+        memset(&slot, 0, sizeof(Slot));
+        if(it >= 0) {
+            const Key &key = keys[it];
+            slot.hash = key.hash;
+            slot.path = key.path;
+            slot.uuid = key.uuid;
+            slot.type = key.type;
+        }
+        memcpy(ptr, &slot, sizeof(Slot));
+        ptr += sizeof(Slot);
+    }
+    memcpy(ptr, seeds.data(), sizeof(uint32_t) * seeds.size());
+    ptr += sizeof(uint32_t) * seeds.size();
+
+    if(!settingsTable.empty()) {
+        memcpy(ptr, settingsTable.data(), sizeof(uint32_t) * settingsTable.size());
+        ptr += sizeof(uint32_t) * settingsTable.size();
+    }
+    memcpy(ptr, strings.data(), strings.size());
+
+    return result;
+}
+/*!
+    Returns the 64-bit FNV-1a hash of the asset \a path.
+*/
+uint64_t AssetIndex::hash(const string &path) {
+    uint64_t result = 14695981039346656037ULL;
+    for(auto it : path) {
+        result ^= static_cast<uint8_t>(it);
+        result *= 1099511628211ULL;
+    }
+    return result;
+}
@@ -1,7 +1,15 @@
 #include "commandbuffer.h"
 
+#include "resources/mesh.h"
+
 static bool s_Inited = false;
 
+ICommandBuffer::ICommandBuffer() :
+        m_DrawCalls(0),
+        m_Polygons(0) {
+
+}
+
 void ICommandBuffer::clearRenderTarget(bool clearColor, const Vector4 &color, bool clearDepth, float depth) {
      A_UNUSED(clearColor);
      A_UNUSED(color);
@@ -11,17 +19,28 @@ void ICommandBuffer::clearRenderTarget(bool clearColor, const Vector4 &color, bo
 
 void ICommandBuffer::drawMesh(const Matrix4 &model, Mesh *mesh, uint32_t layer, MaterialInstance *material) {
     A_UNUSED(model);
-    A_UNUSED(mesh);
     A_UNUSED(layer);
-    A_UNUSED(material);
+
+    if(mesh && material) {
+        Lod *lod = mesh->lod(0);
+        if(lod) {
+            m_DrawCalls++;
+            m_Polygons += lod->indices().size() / 3;
+        }
+    }
 }
 
 void ICommandBuffer::drawMeshInstanced(const Matrix4 *models, uint32_t count, Mesh *mesh, uint32_t layer, MaterialInstance *material) {
     A_UNUSED(models);
-    A_UNUSED(count);
-    A_UNUSED(mesh);
     A_UNUSED(layer);
-    A_UNUSED(material);
+
+    if(mesh && material) {
+        Lod *lod = mesh->lod(0);
+        if(lod) {
+            m_DrawCalls++;
+            m_Polygons += (lod->indices().size() / 3) * count;
+        }
+    }
 }
 
 void ICommandBuffer::setRenderTarget(RenderTarget *target, uint32_t level) {
@@ -108,3 +127,23 @@ void ICommandBuffer::enableScissor(int32_t x, int32_t y, int32_t width, int32_t
 void ICommandBuffer::disableScissor() {
 
 }
+/*!
+    Returns the number of draw calls issued since the last resetStatistics() call.
+*/
+uint32_t ICommandBuffer::drawCalls() const {
+    return m_DrawCalls;
+}
+/*!
+    Returns the number of polygons submitted since the last resetStatistics() call.
+*/
+uint32_t ICommandBuffer::polygons() const {
+    return m_Polygons;
+}
+/*!
+    Resets draw calls and polygons counters.
+    \note Usually, this method calls internally at the beginning of each frame.
+*/
+void ICommandBuffer::resetStatistics() {
+    m_DrawCalls = 0;
+    m_Polygons = 0;
+}
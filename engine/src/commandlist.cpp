@@ -0,0 +1,433 @@
+#include "commandlist.h"
+
+#include "resources/material.h"
+#include "resources/mesh.h"
+#include "resources/texture.h"
+#include "resources/rendertarget.h"
+
+#include <cstring>
+#include <unordered_set>
+
+class CommandListPrivate {
+public:
+    enum Type {
+        Clear,
+        Draw,
+        DrawInstanced,
+        Target,
+        TargetHandle,
+        Color,
+        ResetViewProjection,
+        ViewProjection,
+        GlobalValue,
+        GlobalTexture,
+        Viewport,
+        EnableScissor,
+        DisableScissor
+    };
+
+    struct Command {
+        Type type;
+
+        Mesh *mesh;
+
+        MaterialInstance *material;
+
+        Texture *texture;
+
+        RenderTarget *target;
+
+        // Layer, level, target handle or clear flags
+        uint32_t value;
+
+        // Range in the matrices storage
+        uint32_t first;
+        uint32_t count;
+
+        int32_t rect[4];
+
+        Vector4 vector;
+
+        string name;
+
+        Variant variant;
+    };
+
+    struct Instance {
+        Instance() :
+                instance(nullptr) {
+
+        }
+
+        MaterialInstance instance;
+
+        vector<uint8_t> data;
+    };
+
+    CommandListPrivate() :
+            m_pSource(nullptr),
+            m_Used(0),
+            m_Copy(false) {
+
+    }
+
+    ~CommandListPrivate() {
+        for(auto it : m_Instances) {
+            delete it;
+        }
+    }
+
+    MaterialInstance *copy(MaterialInstance *material) {
+        if(!m_Copy || material == nullptr) {
+            return material;
+        }
+        if(m_Used == m_Instances.size()) {
+            m_Instances.push_back(new Instance);
+        }
+        Instance *result = m_Instances[m_Used++];
+        result->instance = *material;
+
+        // Parameters point to the memory of components, the values must be copied
+        size_t size = 0;
+        for(auto &it : result->instance.params()) {
+            if(it.second.type != 0 && it.second.ptr) {
+                size += MetaType::size(it.second.type) * it.second.count;
+            }
+        }
+        result->data.resize(size);
+
+        uint8_t *ptr = result->data.data();
+        for(auto &it : result->instance.params()) {
+            if(it.second.type != 0 && it.second.ptr) {
+                size = MetaType::size(it.second.type) * it.second.count;
+                memcpy(ptr, it.second.ptr, size);
+                it.second.ptr = ptr;
+                ptr += size;
+            }
+        }
+        return &result->instance;
+    }
+
+    Command &add(Type type) {
+        m_Commands.push_back(Command());
+        Command &result = m_Commands.back();
+        result.type = type;
+        result.mesh = nullptr;
+        result.material = nullptr;
+        result.texture = nullptr;
+        result.target = nullptr;
+        result.value = 0;
+        result.first = 0;
+        result.count = 0;
+        memset(result.rect, 0, sizeof(result.rect));
+        return result;
+    }
+
+    vector<Command> m_Commands;
+
+    vector<Matrix4> m_Matrices;
+
+    Material::TextureMap m_Textures;
+
+    Matrix4 m_View;
+    Matrix4 m_Projection;
+
+    Matrix4 m_SaveView;
+    Matrix4 m_SaveProjection;
+
+    const ICommandBuffer *m_pSource;
+
+    vector<Instance *> m_Instances;
+
+    uint32_t m_Used;
+
+    bool m_Copy;
+
+};
+/*!
+    \class CommandList
+    \brief Records the rendering commands to execute them later.
+    \inmodule Engine
+
+    CommandList has the same interface as ICommandBuffer but doesn't depend on any graphics backend.
+    Each thread can record own CommandList, the recorded lists must be executed on the render thread with execute().
+    Only the pointers to resources are stored, so all used resources must be alive till the execution.
+*/
+
+CommandList::CommandList() :
+        p_ptr(new CommandListPrivate) {
+
+}
+
+CommandList::~CommandList() {
+    delete p_ptr;
+}
+/*!
+    \internal
+*/
+void CommandList::clearRenderTarget(bool clearColor, const Vector4 &color, bool clearDepth, float depth) {
+    CommandListPrivate::Command &command = p_ptr->add(CommandListPrivate::Clear);
+    command.value = (clearColor ? 1 : 0) | (clearDepth ? 2 : 0);
+    command.vector = color;
+    command.variant = depth;
+}
+/*!
+    \internal
+*/
+void CommandList::drawMesh(const Matrix4 &model, Mesh *mesh, uint32_t layer, MaterialInstance *material) {
+    CommandListPrivate::Command &command = p_ptr->add(CommandListPrivate::Draw);
+    command.mesh = mesh;
+    command.material = p_ptr->copy(material);
+    command.value = layer;
+    command.first = p_ptr->m_Matrices.size();
+    command.count = 1;
+    p_ptr->m_Matrices.push_back(model);
+}
+/*!
+    \internal
+*/
+void CommandList::drawMeshInstanced(const Matrix4 *models, uint32_t count, Mesh *mesh, uint32_t layer, MaterialInstance *material) {
+    CommandListPrivate::Command &command = p_ptr->add(CommandListPrivate::DrawInstanced);
+    command.mesh = mesh;
+    command.material = p_ptr->copy(material);
+    command.value = layer;
+    command.first = p_ptr->m_Matrices.size();
+    command.count = count;
+    p_ptr->m_Matrices.insert(p_ptr->m_Matrices.end(), models, models + count);
+}
+/*!
+    \internal
+*/
+void CommandList::setRenderTarget(RenderTarget *target, uint32_t level) {
+    CommandListPrivate::Command &command = p_ptr->add(CommandListPrivate::Target);
+    command.target = target;
+    command.value = level;
+}
+/*!
+    \internal
+*/
+void CommandList::setRenderTarget(uint32_t target) {
+    p_ptr->add(CommandListPrivate::TargetHandle).value = target;
+}
+/*!
+    \internal
+*/
+void CommandList::setColor(const Vector4 &color) {
+    p_ptr->add(CommandListPrivate::Color).vector = color;
+}
+/*!
+    \internal
+*/
+void CommandList::resetViewProjection() {
+    p_ptr->m_View = p_ptr->m_SaveView;
+    p_ptr->m_Projection = p_ptr->m_SaveProjection;
+
+    p_ptr->add(CommandListPrivate::ResetViewProjection);
+}
+/*!
+    \internal
+*/
+void CommandList::setViewProjection(const Matrix4 &view, const Matrix4 &projection) {
+    p_ptr->m_SaveView = p_ptr->m_View;
+    p_ptr->m_SaveProjection = p_ptr->m_Projection;
+
+    p_ptr->m_View = view;
+    p_ptr->m_Projection = projection;
+
+    CommandListPrivate::Command &command = p_ptr->add(CommandListPrivate::ViewProjection);
+    command.first = p_ptr->m_Matrices.size();
+    command.count = 2;
+    p_ptr->m_Matrices.push_back(view);
+    p_ptr->m_Matrices.push_back(projection);
+}
+/*!
+    \internal
+*/
+void CommandList::setGlobalValue(const char *name, const Variant &value) {
+    CommandListPrivate::Command &command = p_ptr->add(CommandListPrivate::GlobalValue);
+    command.name = name;
+    command.variant = value;
+}
+/*!
+    \internal
+*/
+void CommandList::setGlobalTexture(const char *name, Texture *value) {
+    p_ptr->m_Textures[name] = value;
+
+    CommandListPrivate::Command &command = p_ptr->add(CommandListPrivate::GlobalTexture);
+    command.name = name;
+    command.texture = value;
+}
+/*!
+    \internal
+*/
+void CommandList::setViewport(int32_t x, int32_t y, int32_t width, int32_t height) {
+    CommandListPrivate::Command &command = p_ptr->add(CommandListPrivate::Viewport);
+    command.rect[0] = x;
+    command.rect[1] = y;
+    command.rect[2] = width;
+    command.rect[3] = height;
+}
+/*!
+    \internal
+*/
+void CommandList::enableScissor(int32_t x, int32_t y, int32_t width, int32_t height) {
+    CommandListPrivate::Command &command = p_ptr->add(CommandListPrivate::EnableScissor);
+    command.rect[0] = x;
+    command.rect[1] = y;
+    command.rect[2] = width;
+    command.rect[3] = height;
+}
+/*!
+    \internal
+*/
+void CommandList::disableScissor() {
+    p_ptr->add(CommandListPrivate::DisableScissor);
+}
+/*!
+    Returns the projection matrix which will be active at this point of execution.
+*/
+Matrix4 CommandList::projection() const {
+    return p_ptr->m_Projection;
+}
+/*!
+    Returns the view matrix which will be active at this point of execution.
+*/
+Matrix4 CommandList::view() const {
+    return p_ptr->m_View;
+}
+/*!
+    Returns the global texture with \a name recorded to this list or available in the source buffer.
+*/
+Texture *CommandList::texture(const char *name) const {
+    auto it = p_ptr->m_Textures.find(name);
+    if(it != p_ptr->m_Textures.end()) {
+        return it->second;
+    }
+    if(p_ptr->m_pSource) {
+        return p_ptr->m_pSource->texture(name);
+    }
+    return nullptr;
+}
+/*!
+    Clears the list and starts a new recording.
+    The current view and projection are taken from the \a source buffer which will execute the list.
+    If the \a source is the CommandList, the recording continues the state at the end of that list.
+    If \a copy is true, the material parameters are copied on recording, so the list doesn't depend on the components anymore.
+    \note This method must be called from the thread which owns the \a source.
+*/
+void CommandList::begin(const ICommandBuffer *source, bool copy) {
+    clear();
+
+    p_ptr->m_Copy = copy;
+    p_ptr->m_pSource = source;
+    if(source) {
+        p_ptr->m_View = source->view();
+        p_ptr->m_Projection = source->projection();
+
+        const CommandList *list = dynamic_cast<const CommandList *>(source);
+        if(list) {
+            p_ptr->m_Textures = list->p_ptr->m_Textures;
+            p_ptr->m_pSource = list->p_ptr->m_pSource;
+        }
+    }
+    p_ptr->m_SaveView = p_ptr->m_View;
+    p_ptr->m_SaveProjection = p_ptr->m_Projection;
+}
+/*!
+    Replays the recorded commands on the \a buffer in the order of recording.
+*/
+void CommandList::execute(ICommandBuffer &buffer) const {
+    const Matrix4 *matrices = p_ptr->m_Matrices.data();
+    for(auto &it : p_ptr->m_Commands) {
+        switch(it.type) {
+            case CommandListPrivate::Clear: buffer.clearRenderTarget(it.value & 1, it.vector, it.value & 2, it.variant.toFloat()); break;
+            case CommandListPrivate::Draw: buffer.drawMesh(matrices[it.first], it.mesh, it.value, it.material); break;
+            case CommandListPrivate::DrawInstanced: buffer.drawMeshInstanced(&matrices[it.first], it.count, it.mesh, it.value, it.material); break;
+            case CommandListPrivate::Target: buffer.setRenderTarget(it.target, it.value); break;
+            case CommandListPrivate::TargetHandle: buffer.setRenderTarget(it.value); break;
+            case CommandListPrivate::Color: buffer.setColor(it.vector); break;
+            case CommandListPrivate::ResetViewProjection: buffer.resetViewProjection(); break;
+            case CommandListPrivate::ViewProjection: buffer.setViewProjection(matrices[it.first], matrices[it.first + 1]); break;
+            case CommandListPrivate::GlobalValue: buffer.setGlobalValue(it.name.c_str(), it.variant); break;
+            case CommandListPrivate::GlobalTexture: buffer.setGlobalTexture(it.name.c_str(), it.texture); break;
+            case CommandListPrivate::Viewport: buffer.setViewport(it.rect[0], it.rect[1], it.rect[2], it.rect[3]); break;
+            case CommandListPrivate::EnableScissor: buffer.enableScissor(it.rect[0], it.rect[1], it.rect[2], it.rect[3]); break;
+            case CommandListPrivate::DisableScissor: buffer.disableScissor(); break;
+            default: break;
+        }
+    }
+}
+/*!
+    Fills the \a result with the resources used by the recorded commands, each resource is listed once.
+    The list includes meshes, materials, textures of the material instances, global textures and render targets.
+*/
+void CommandList::resources(vector<Resource *> &result) const {
+    result.clear();
+
+    unordered_set<Resource *> unique;
+    auto add = [&](Resource *resource) {
+        if(resource && unique.insert(resource).second) {
+            result.push_back(resource);
+        }
+    };
+
+    for(auto &it : p_ptr->m_Commands) {
+        add(it.mesh);
+        add(it.texture);
+        add(it.target);
+        if(it.material) {
+            add(it.material->material());
+            for(auto &param : it.material->params()) {
+                // Textures are the only parameters without the type
+                if(param.second.type == 0) {
+                    add(static_cast<Texture *>(param.second.ptr));
+                }
+            }
+        }
+    }
+}
+/*!
+    Removes all recorded commands.
+    The memory is kept to be reused by the next recording.
+*/
+void CommandList::clear() {
+    p_ptr->m_Commands.clear();
+    p_ptr->m_Matrices.clear();
+    p_ptr->m_Textures.clear();
+    p_ptr->m_Used = 0;
+}
+/*!
+    Returns the number of recorded commands.
+*/
+uint32_t CommandList::size() const {
+    return p_ptr->m_Commands.size();
+}
+/*!
+    Returns true if both lists contain the same stream of commands with the same arguments; otherwise returns false.
+*/
+bool CommandList::operator== (const CommandList &right) const {
+    const CommandListPrivate::Command *left = p_ptr->m_Commands.data();
+    const CommandListPrivate::Command *other = right.p_ptr->m_Commands.data();
+    if(p_ptr->m_Commands.size() != right.p_ptr->m_Commands.size()) {
+        return false;
+    }
+    for(uint32_t i = 0; i < p_ptr->m_Commands.size(); i++) {
+        const CommandListPrivate::Command &a = left[i];
+        const CommandListPrivate::Command &b = other[i];
+        if(a.type != b.type || a.mesh != b.mesh || a.material != b.material || a.texture != b.texture ||
+           a.target != b.target || a.value != b.value || a.count != b.count ||
+           memcmp(a.rect, b.rect, sizeof(a.rect)) != 0 || a.vector != b.vector ||
+           a.name != b.name || a.variant.isValid() != b.variant.isValid() || (a.variant.isValid() && a.variant != b.variant)) {
+            return false;
+        }
+        // Matrices are compared by value, their placement in the storage may differ
+        for(uint32_t m = 0; m < a.count && (a.type == CommandListPrivate::Draw || a.type == CommandListPrivate::DrawInstanced ||
+                                            a.type == CommandListPrivate::ViewProjection); m++) {
+            if(p_ptr->m_Matrices[a.first + m] != right.p_ptr->m_Matrices[b.first + m]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
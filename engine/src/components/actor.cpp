@@ -252,6 +252,9 @@ bool Actor::isStatic() const {
 /*!
     Marks current Actor as static or dynamic (by default).
     This \a flag can help to optimize rendering.
+    Meshes of the static actors are merged together by StaticBatcher when a level is loaded, so the actor must not be moved after that.
+
+    \sa StaticBatcher
 */
 void Actor::setStatic(const bool flag) {
     p_ptr->m_static = flag;
@@ -50,7 +50,7 @@ public:
             }
 #ifdef NEXT_SHARED
             else {
-              Log(Log::DBG) << "Unable to make the transition to state" << hash;
+              A_LOG(Log::DBG) << "Unable to make the transition to state" << hash;
             }
 #endif
         }
@@ -123,7 +123,7 @@ public:
                 Object *object = actor->find(it.path());
 #ifdef NEXT_SHARED
                 if(object == nullptr) {
-                    Log(Log::DBG) << "Can't resolve animation path:" << it.path().c_str();
+                    A_LOG(Log::DBG) << "Can't resolve animation path:" << it.path().c_str();
                 }
 #endif
                 property->setTarget(object, it.property().c_str());
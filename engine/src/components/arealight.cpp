@@ -162,9 +162,7 @@ void AreaLight::shadowsUpdate(const Camera &camera, Pipeline *pipeline, RenderLi
         RenderList filter = Camera::frustumCulling(components,
                                                    Camera::frustumCorners(false, 90.0f, 1.0f, pos, rot[i], p_ptr->m_near, zFar));
         // Draw in the depth buffer from position of the light source
-        for(auto it : filter) {
-            static_cast<Renderable *>(it)->draw(*buffer, ICommandBuffer::SHADOWCAST);
-        }
+        pipeline->drawComponents(ICommandBuffer::SHADOWCAST, filter);
         buffer->resetViewProjection();
     }
 }
@@ -198,9 +198,7 @@ void DirectLight::shadowsUpdate(const Camera &camera, Pipeline *pipeline, Render
                                                    Camera::frustumCorners(true, max.y - min.y, 1.0f, pos, q, min.z, max.z));
 
         // Draw in the depth buffer from position of the light source
-        for(auto it : filter) {
-            static_cast<Renderable *>(it)->draw(*buffer, ICommandBuffer::SHADOWCAST);
-        }
+        pipeline->drawComponents(ICommandBuffer::SHADOWCAST, filter);
     }
 }
 /*!
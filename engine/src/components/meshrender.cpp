@@ -63,6 +63,25 @@ AABBox MeshRender::bound() const {
     }
     return Renderable::bound();
 }
+/*!
+    \internal
+*/
+bool MeshRender::raycast(const Ray &ray, Vector3 *pt) const {
+    return raycastMesh(p_ptr->m_pMesh, ray, pt);
+}
+/*!
+    \internal
+*/
+bool MeshRender::instanceData(uint32_t layer, Mesh **mesh, MaterialInstance **material) const {
+    Actor *a = actor();
+    if(p_ptr->m_pMesh && p_ptr->m_pMaterial && layer & a->layers() && a->transform() &&
+       !(layer & ICommandBuffer::RAYCAST) && !p_ptr->m_pMaterial->isOverridden()) {
+        *mesh = p_ptr->m_pMesh;
+        *material = p_ptr->m_pMaterial;
+        return true;
+    }
+    return false;
+}
 /*!
     Returns a Mesh assigned to this component.
 */
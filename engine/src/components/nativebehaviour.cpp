@@ -7,3 +7,7 @@ void NativeBehaviour::start() {
 void NativeBehaviour::update() {
 
 }
+
+void NativeBehaviour::fixedUpdate() {
+
+}
@@ -256,6 +256,16 @@ AABBox ParticleRender::bound() const {
 /*!
     \internal
 */
+bool ParticleRender::raycast(const Ray &ray, Vector3 *pt) const {
+    if(p_ptr->m_pEffect == nullptr) {
+        return false;
+    }
+    Ray r(ray.pos, ray.dir);
+    return r.intersect(bound(), pt);
+}
+/*!
+    \internal
+*/
 void ParticleRender::loadUserData(const VariantMap &data) {
     Component::loadUserData(data);
     {
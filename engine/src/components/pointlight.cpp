@@ -156,9 +156,7 @@ void PointLight::shadowsUpdate(const Camera &camera, Pipeline *pipeline, RenderL
         RenderList filter = Camera::frustumCulling(components,
                                                    Camera::frustumCorners(false, 90.0f, 1.0f, pos, rot[i], p_ptr->m_near, zFar));
         // Draw in the depth buffer from position of the light source
-        for(auto it : filter) {
-            static_cast<Renderable *>(it)->draw(*buffer, ICommandBuffer::SHADOWCAST);
-        }
+        pipeline->drawComponents(ICommandBuffer::SHADOWCAST, filter);
         buffer->resetViewProjection();
     }
 }
@@ -0,0 +1,309 @@
+#include "private/transformhierarchy.h"
+
+#include <threadpool.h>
+
+#define MIN_PARALLEL_TRANSFORMS 4096
+
+class TransformTask : public Object {
+public:
+    TransformTask(TransformHierarchy *hierarchy, uint32_t first, uint32_t last) :
+            m_pHierarchy(hierarchy),
+            m_First(first),
+            m_Last(last) {
+
+    }
+
+    void processEvents() override {
+        m_pHierarchy->updateRange(m_First, m_Last);
+    }
+
+protected:
+    TransformHierarchy *m_pHierarchy;
+
+    uint32_t m_First;
+
+    uint32_t m_Last;
+
+};
+
+TransformHierarchy::TransformHierarchy() :
+        m_Owner(this_thread::get_id()),
+        m_Count(0),
+        m_OrderDirty(false),
+        m_Modified(false) {
+
+}
+
+TransformHierarchy *TransformHierarchy::instance() {
+    static TransformHierarchy hierarchy;
+    return &hierarchy;
+}
+
+uint32_t TransformHierarchy::create(uint32_t *handle) {
+    unique_lock<mutex> locker(m_Mutex);
+
+    uint32_t index = m_Count++;
+
+    m_Position.reserve(m_Count);
+    m_Rotation.reserve(m_Count);
+    m_Quaternion.reserve(m_Count);
+    m_Scale.reserve(m_Count);
+    m_Local.reserve(m_Count);
+    m_World.reserve(m_Count);
+    m_WorldPosition.reserve(m_Count);
+    m_WorldRotation.reserve(m_Count);
+    m_WorldQuaternion.reserve(m_Count);
+    m_WorldScale.reserve(m_Count);
+    m_Parents.reserve(m_Count);
+    m_Handles.reserve(m_Count);
+    m_Dirty.reserve((m_Count + 63) / 64);
+
+    m_Position[index] = Vector3();
+    m_Rotation[index] = Vector3();
+    m_Quaternion[index] = Quaternion();
+    m_Scale[index] = Vector3(1.0f);
+    m_Local[index] = Matrix4();
+    m_World[index] = Matrix4();
+    m_WorldPosition[index] = Vector3();
+    m_WorldRotation[index] = Vector3();
+    m_WorldQuaternion[index] = Quaternion();
+    m_WorldScale[index] = Vector3(1.0f);
+    m_Parents[index] = -1;
+    m_Handles[index] = handle;
+    resetDirty(index);
+
+    // A new root at the end of the arrays keeps the parent before child order, but splits no subtree
+    if(!m_OrderDirty.load(memory_order_relaxed)) {
+        m_Roots.push_back(index);
+    }
+    setDirty(index);
+
+    return index;
+}
+
+void TransformHierarchy::destroy(uint32_t index) {
+    unique_lock<mutex> locker(m_Mutex);
+
+    m_Handles[index] = nullptr;
+    m_Parents[index] = -1;
+    resetDirty(index);
+    m_OrderDirty.store(true, memory_order_relaxed);
+}
+
+void TransformHierarchy::setParent(uint32_t index, int32_t parent) {
+    unique_lock<mutex> locker(m_Mutex);
+
+    if(m_Parents[index] != parent) {
+        m_Parents[index] = parent;
+        m_OrderDirty.store(true, memory_order_relaxed);
+    }
+    setDirty(index);
+}
+
+void TransformHierarchy::setPosition(uint32_t index, const Vector3 &position) {
+    unique_lock<mutex> locker(m_Mutex);
+
+    m_Position[index] = position;
+}
+
+void TransformHierarchy::setRotation(uint32_t index, const Vector3 &angles) {
+    unique_lock<mutex> locker(m_Mutex);
+
+    m_Rotation[index] = angles;
+    m_Quaternion[index] = Quaternion(angles);
+}
+
+void TransformHierarchy::setQuaternion(uint32_t index, const Quaternion &quaternion) {
+    unique_lock<mutex> locker(m_Mutex);
+
+    m_Quaternion[index] = quaternion;
+}
+
+void TransformHierarchy::setScale(uint32_t index, const Vector3 &scale) {
+    unique_lock<mutex> locker(m_Mutex);
+
+    m_Scale[index] = scale;
+}
+
+void TransformHierarchy::updateNode(uint32_t index) {
+    const Vector3 &position = m_Position[index];
+    const Quaternion &quaternion = m_Quaternion[index];
+    const Vector3 &scale = m_Scale[index];
+
+    Matrix4 &local = m_Local[index];
+    local = Matrix4(position, quaternion, scale);
+
+    int32_t parent = m_Parents[index];
+    if(parent >= 0) {
+        const Matrix4 &world = m_World[parent];
+        m_World[index] = world * local;
+        m_WorldPosition[index] = world * position;
+        m_WorldRotation[index] = m_WorldRotation[parent] + m_Rotation[index];
+        m_WorldQuaternion[index] = m_WorldQuaternion[parent] * quaternion;
+        m_WorldScale[index] = m_WorldScale[parent] * scale;
+    } else {
+        m_World[index] = local;
+        m_WorldPosition[index] = position;
+        m_WorldRotation[index] = m_Rotation[index];
+        m_WorldQuaternion[index] = quaternion;
+        m_WorldScale[index] = scale;
+    }
+}
+
+uint32_t TransformHierarchy::update(ThreadPool *pool) {
+    // Only the thread which runs the passes is allowed to recalculate the world values lazily
+    m_Owner = this_thread::get_id();
+
+    unique_lock<mutex> locker(m_Mutex);
+
+    bool orderDirty = m_OrderDirty.load(memory_order_relaxed);
+    if(!isModified() && !orderDirty) {
+        return 0;
+    }
+
+    if(orderDirty) {
+        rebuild();
+    }
+
+    uint32_t threads = (pool) ? MIN(pool->maxThreads(), m_Count / MIN_PARALLEL_TRANSFORMS) : 1;
+    uint32_t result = 1;
+    if(threads <= 1 || m_Roots.size() <= 1) {
+        updateRange(0, m_Count);
+    } else {
+        // Every root subtree is contiguous, so the tasks never share a parent
+        list<TransformTask> tasks;
+        uint32_t step = (m_Count + threads - 1) / threads;
+        uint32_t first = 0;
+        for(size_t i = 1; i <= m_Roots.size(); i++) {
+            uint32_t last = (i < m_Roots.size()) ? m_Roots[i] : m_Count;
+            if(last - first >= step || last == m_Count) {
+                tasks.emplace_back(this, first, last);
+                pool->start(tasks.back());
+                first = last;
+            }
+        }
+        pool->waitForDone();
+        result = tasks.size();
+    }
+
+    clearDirty();
+    m_Modified.store(false, memory_order_relaxed);
+
+    return result;
+}
+
+uint32_t TransformHierarchy::count() const {
+    return m_Count;
+}
+
+void TransformHierarchy::rebuild() {
+    // Children of every node in the compressed sparse row form
+    vector<uint32_t> offsets(m_Count + 1, 0);
+    for(uint32_t i = 0; i < m_Count; i++) {
+        int32_t parent = m_Parents[i];
+        if(m_Handles[i] && parent >= 0) {
+            offsets[parent + 1]++;
+        }
+    }
+    for(uint32_t i = 0; i < m_Count; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+    vector<uint32_t> children(offsets[m_Count]);
+    vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for(uint32_t i = 0; i < m_Count; i++) {
+        int32_t parent = m_Parents[i];
+        if(m_Handles[i] && parent >= 0) {
+            children[cursor[parent]++] = i;
+        }
+    }
+
+    // Depth first order places every node after its parent and every subtree in one range
+    vector<uint32_t> order;
+    order.reserve(m_Count);
+    m_Roots.clear();
+
+    vector<uint32_t> stack;
+    for(uint32_t i = 0; i < m_Count; i++) {
+        if(m_Handles[i] && m_Parents[i] < 0) {
+            m_Roots.push_back(order.size());
+            stack.push_back(i);
+            while(!stack.empty()) {
+                uint32_t node = stack.back();
+                stack.pop_back();
+                order.push_back(node);
+                for(uint32_t c = offsets[node + 1]; c > offsets[node]; c--) {
+                    stack.push_back(children[c - 1]);
+                }
+            }
+        }
+    }
+
+    vector<int32_t> remap(m_Count, -1);
+    for(uint32_t i = 0; i < order.size(); i++) {
+        remap[order[i]] = i;
+    }
+
+    Column<atomic<uint64_t>> dirty;
+    dirty.reserve((order.size() + 63) / 64);
+    for(uint32_t i = 0; i < order.size(); i++) {
+        if(isDirty(order[i])) {
+            dirty[i >> 6].fetch_or(1ULL << (i & 63), memory_order_relaxed);
+        }
+    }
+    m_Dirty.swap(dirty);
+
+    Column<int32_t> parents;
+    parents.reserve(order.size());
+    for(uint32_t i = 0; i < order.size(); i++) {
+        int32_t parent = m_Parents[order[i]];
+        parents[i] = (parent >= 0) ? remap[parent] : -1;
+    }
+    m_Parents.swap(parents);
+
+    permute(m_Position, order);
+    permute(m_Rotation, order);
+    permute(m_Quaternion, order);
+    permute(m_Scale, order);
+    permute(m_Local, order);
+    permute(m_World, order);
+    permute(m_WorldPosition, order);
+    permute(m_WorldRotation, order);
+    permute(m_WorldQuaternion, order);
+    permute(m_WorldScale, order);
+    permute(m_Handles, order);
+
+    m_Count = order.size();
+    for(uint32_t i = 0; i < m_Count; i++) {
+        *m_Handles[i] = i;
+    }
+
+    m_OrderDirty.store(false, memory_order_relaxed);
+}
+
+void TransformHierarchy::clearDirty() {
+    for(uint32_t i = 0; i < (m_Count + 63) / 64; i++) {
+        m_Dirty[i].store(0, memory_order_relaxed);
+    }
+}
+
+void TransformHierarchy::updateRange(uint32_t first, uint32_t last) {
+    // Marks nodes recalculated during this pass, their children have to follow
+    vector<uint8_t> updated(last - first, 0);
+    for(uint32_t i = first; i < last; i++) {
+        int32_t parent = m_Parents[i];
+        if(isDirty(i) || (parent >= 0 && updated[parent - first])) {
+            updateNode(i);
+            updated[i - first] = 1;
+        }
+    }
+}
+
+template<typename T>
+void TransformHierarchy::permute(Column<T> &column, const vector<uint32_t> &order) {
+    Column<T> result;
+    result.reserve(order.size());
+    for(uint32_t i = 0; i < order.size(); i++) {
+        result[i] = column[order[i]];
+    }
+    column.swap(result);
+}
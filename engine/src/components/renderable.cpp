@@ -1,5 +1,10 @@
 #include "components/renderable.h"
 
+#include "components/actor.h"
+#include "components/transform.h"
+
+#include "resources/mesh.h"
+
 /*!
     \class Renderable
     \brief Base class for every object which can be drawn on the screen.
@@ -25,6 +30,53 @@ void Renderable::draw(ICommandBuffer &buffer, uint32_t layer) {
 AABBox Renderable::bound() const {
     return AABBox();
 }
+/*!
+    Returns true if the world space \a ray hits the geometry of the renderable object; otherwise returns false.
+    Output argument \a pt contains the closest point of intersection in world space.
+    The default implementation doesn't have any geometry and always returns false.
+*/
+bool Renderable::raycast(const Ray &ray, Vector3 *pt) const {
+    A_UNUSED(ray);
+    A_UNUSED(pt);
+    return false;
+}
+/*!
+    Casts the world space \a ray against the \a mesh placed with the actor transform.
+    Returns true in case of intersection and writes the world space point of intersection to \a pt; otherwise returns false.
+*/
+bool Renderable::raycastMesh(Mesh *mesh, const Ray &ray, Vector3 *pt) const {
+    Transform *t = actor()->transform();
+    if(mesh == nullptr || t == nullptr) {
+        return false;
+    }
+
+    const Matrix4 &world = t->worldTransform();
+    Matrix4 inverse = world.inverse();
+
+    Vector3 origin = inverse * ray.pos;
+    Ray local(origin, inverse * (ray.pos + ray.dir) - origin);
+
+    Vector3 point;
+    if(mesh->raycast(local, &point)) {
+        if(pt) {
+            *pt = world * point;
+        }
+        return true;
+    }
+    return false;
+}
+
+/*!
+    Returns true if the component can be drawn for the \a layer together with other components which have the same \a mesh and \a material.
+    In this case the pipeline draws all of them with one instanced call using the world transform of each actor, instead of calling draw().
+    Default implementation returns false.
+*/
+bool Renderable::instanceData(uint32_t layer, Mesh **mesh, MaterialInstance **material) const {
+    A_UNUSED(layer);
+    A_UNUSED(mesh);
+    A_UNUSED(material);
+    return false;
+}
 
 bool Renderable::isLight() const {
     return false;
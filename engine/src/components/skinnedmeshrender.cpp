@@ -75,6 +75,17 @@ AABBox SkinnedMeshRender::bound() const {
     }
     return result;
 }
+/*!
+    \internal
+    Vertices are deformed on the GPU so the skinned bound is used instead of triangles.
+*/
+bool SkinnedMeshRender::raycast(const Ray &ray, Vector3 *pt) const {
+    if(p_ptr->m_pMesh == nullptr) {
+        return false;
+    }
+    Ray r(ray.pos, ray.dir);
+    return r.intersect(bound(), pt);
+}
 /*!
     Returns a Mesh assigned to this component.
 */
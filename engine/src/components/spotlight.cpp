@@ -141,9 +141,7 @@ void SpotLight::shadowsUpdate(const Camera &camera, Pipeline *pipeline, RenderLi
     RenderList filter = Camera::frustumCulling(components,
                                                Camera::frustumCorners(false, p_ptr->m_angle * 2.0f, 1.0f, pos, q, p_ptr->m_near, zFar));
     // Draw in the depth buffer from position of the light source
-    for(auto it : filter) {
-        it->draw(*buffer, ICommandBuffer::SHADOWCAST);
-    }
+    pipeline->drawComponents(ICommandBuffer::SHADOWCAST, filter);
     buffer->resetViewProjection();
 }
 /*!
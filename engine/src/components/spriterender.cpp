@@ -141,6 +141,12 @@ AABBox SpriteRender::bound() const {
 
     return result;
 }
+/*!
+    \internal
+*/
+bool SpriteRender::raycast(const Ray &ray, Vector3 *pt) const {
+    return raycastMesh((p_ptr->m_pCustomMesh) ? p_ptr->m_pCustomMesh : p_ptr->m_pMesh, ray, pt);
+}
 /*!
     Returns an instantiated Material assigned to SpriteRender.
 */
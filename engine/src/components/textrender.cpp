@@ -7,9 +7,7 @@
 #include "resources/material.h"
 
 #include "commandbuffer.h"
-#include "utils.h"
-
-#include <array>
+#include "textlayout.h"
 
 #define FONT     "Font"
 #define MATERIAL "Material"
@@ -27,7 +25,8 @@ public:
         m_Size(16),
         m_Alignment(Left),
         m_Kerning(true),
-        m_Wrap(false) {
+        m_Wrap(false),
+        m_Dirty(false) {
 
         m_pMesh->makeDynamic();
         m_pMesh->setFlags(Mesh::Uv0);
@@ -46,14 +45,20 @@ public:
 
     void resourceUpdated(const Resource *resource, Resource::ResourceState state) override {
         if(resource == m_pFont && state == Resource::Ready) {
-            composeMesh();
+            m_Layout.reset();
+            m_Dirty = true;
         }
     }
 
     void composeMesh() {
-        TextRender::composeMesh(m_pFont, m_pMesh, m_Size, m_Text, m_Alignment, m_Kerning, m_Wrap, m_Boundaries);
+        if(m_Dirty) {
+            m_Layout.compose(m_pFont, m_pMesh, m_Size, m_Text, m_Alignment, m_Kerning, m_Wrap, m_Boundaries);
+            m_Dirty = false;
+        }
     }
 
+    TextLayout m_Layout;
+
     string m_Text;
 
     Vector4 m_Color;
@@ -73,6 +78,8 @@ public:
     bool m_Kerning;
 
     bool m_Wrap;
+
+    bool m_Dirty;
 };
 /*!
     \class TextRender
@@ -80,6 +87,7 @@ public:
     \inmodule Engine
 
     The TextRender component allows you to display a text in both 2D and 3D scenes.
+    The text mesh is composed lazily: all changes of the text properties are collected and applied once right before the text is used.
 */
 
 TextRender::TextRender() :
@@ -94,6 +102,8 @@ TextRender::~TextRender() {
     \internal
 */
 void TextRender::draw(ICommandBuffer &buffer, uint32_t layer) {
+    p_ptr->composeMesh();
+
     Actor *a = actor();
     if(p_ptr->m_pMesh && layer & a->layers() && !p_ptr->m_Text.empty()) {
         if(layer & ICommandBuffer::RAYCAST) {
@@ -114,7 +124,7 @@ string TextRender::text() const {
 */
 void TextRender::setText(const string &text) {
     p_ptr->m_Text = text;
-    p_ptr->composeMesh();
+    p_ptr->m_Dirty = true;
 }
 /*!
     Returns the font which will be used to draw a text.
@@ -136,7 +146,7 @@ void TextRender::setFont(Font *font) {
             p_ptr->m_pMaterial->setTexture(OVERRIDE, p_ptr->m_pFont->texture());
         }
     }
-    p_ptr->composeMesh();
+    p_ptr->m_Dirty = true;
 }
 /*!
     Returns an instantiated Material assigned to TextRender.
@@ -177,7 +187,7 @@ int TextRender::fontSize() const {
 */
 void TextRender::setFontSize(int size) {
     p_ptr->m_Size = size;
-    p_ptr->composeMesh();
+    p_ptr->m_Dirty = true;
 }
 /*!
     Returns the color of the text to be drawn.
@@ -205,7 +215,7 @@ bool TextRender::wordWrap() const {
 */
 void TextRender::setWordWrap(bool wrap) {
     p_ptr->m_Wrap = wrap;
-    p_ptr->composeMesh();
+    p_ptr->m_Dirty = true;
 }
 /*!
     Returns the boundaries of the text area. This parameter is involved in Word Wrap calculations.
@@ -218,7 +228,7 @@ Vector2 &TextRender::size() const {
 */
 void TextRender::setSize(const Vector2 &boundaries) {
     p_ptr->m_Boundaries = boundaries;
-    p_ptr->composeMesh();
+    p_ptr->m_Dirty = true;
 }
 /*!
     Returns text alignment policy.
@@ -231,7 +241,7 @@ int TextRender::align() const {
 */
 void TextRender::setAlign(int alignment) {
     p_ptr->m_Alignment = alignment;
-    p_ptr->composeMesh();
+    p_ptr->m_Dirty = true;
 }
 /*!
     Returns true if glyph kerning enabled; otherwise returns false.
@@ -245,14 +255,14 @@ bool TextRender::kerning() const {
 */
 void TextRender::setKerning(const bool kerning) {
     p_ptr->m_Kerning = kerning;
-    p_ptr->composeMesh();
+    p_ptr->m_Dirty = true;
 }
 /*!
     \internal
 */
 void TextRender::loadData(const VariantList &data) {
     Component::loadData(data);
-    p_ptr->composeMesh();
+    p_ptr->m_Dirty = true;
 }
 /*!
     \internal
@@ -298,7 +308,7 @@ VariantMap TextRender::saveUserData() const {
 */
 bool TextRender::event(Event *ev) {
     if(ev->type() == Event::LanguageChange) {
-        p_ptr->composeMesh();
+        p_ptr->m_Dirty = true;
     }
 
     return true;
@@ -307,6 +317,7 @@ bool TextRender::event(Event *ev) {
     \internal
 */
 AABBox TextRender::bound() const {
+    p_ptr->composeMesh();
     if(p_ptr->m_pMesh) {
         return p_ptr->m_pMesh->bound() * actor()->transform()->worldTransform();
     }
@@ -315,156 +326,17 @@ AABBox TextRender::bound() const {
 /*!
     \internal
 */
+bool TextRender::raycast(const Ray &ray, Vector3 *pt) const {
+    p_ptr->composeMesh();
+    return raycastMesh(p_ptr->m_pMesh, ray, pt);
+}
+/*!
+    \internal
+    Composes the \a text mesh from scratch; the TextLayout should be used to update the text incrementally.
+*/
 void TextRender::composeMesh(Font *font, Mesh *mesh, int size, const string &text, int alignment, bool kerning, bool wrap, const Vector2 &boundaries) {
-    if(font) {
-        float spaceWidth = font->spaceWidth() * size;
-        float spaceLine = font->lineHeight() * size;
-
-        string data = Engine::translate(text);
-        font->requestCharacters(data);
-
-        uint32_t length = font->length(data);
-        if(length) {
-            u32string u32 = Utils::utf8ToUtf32(data);
-
-            Lod lod;
-
-            IndexVector &indices = lod.indices();
-            Vector3Vector &vertices = lod.vertices();
-            Vector2Vector &uv0 = lod.uv0();
-
-            vertices.resize(length * 4);
-            indices.resize(length * 6);
-            uv0.resize(length * 4);
-
-            list<float> width;
-            list<uint32_t> position;
-
-            Vector3 pos(0.0, boundaries.y - size, 0.0f);
-            uint32_t previous = 0;
-            uint32_t it = 0;
-            uint32_t space = 0;
-
-            Vector3 bb[2];
-            bb[1].y = -spaceLine;
-            for(uint32_t i = 0; i < length; i++) {
-                uint32_t ch = u32[i];
-                switch(ch) {
-                    case ' ': {
-                        pos += Vector3(spaceWidth, 0.0f, 0.0f);
-                        space = it;
-                    } break;
-                    case '\t': {
-                        pos += Vector3(spaceWidth * 4, 0.0f, 0.0f);
-                        space = it;
-                    } break;
-                    case '\r': break;
-                    case '\n': {
-                        width.push_back(pos.x);
-                        bb[1].x = MAX(bb[1].x, pos.x);
-                        position.push_back(it);
-                        pos = Vector3(0.0f, pos.y - spaceLine, 0.0f);
-                        bb[1].y = MAX(bb[1].y, pos.y);
-
-                        space = 0;
-                    } break;
-                    default: {
-                        if(kerning) {
-                            pos.x += font->requestKerning(ch, previous);
-                        }
-                        uint32_t index = font->atlasIndex(ch);
-
-                        Mesh *m = font->mesh(index);
-                        if(m == nullptr) {
-                            continue;
-                        }
-                        Lod *l = m->lod(0);
-
-                        Vector3Vector &shape = l->vertices();
-                        Vector2Vector &uv = l->uv0();
-
-                        bb[0].x = MIN(bb[0].x, shape[0].x * size);
-                        bb[0].y = MIN(bb[0].y, shape[0].y * size);
-
-                        float x = pos.x + shape[2].x * size;
-                        if(wrap && boundaries.x > 0.0f && boundaries.x < x && space > 0 && space < it) {
-                            float shift = vertices[space * 4].x;
-                            if((shift - spaceWidth) > 0.0f) {
-                                for(uint32_t s = space; s < it; s++) {
-                                    vertices[s * 4 + 0] -= Vector3(shift, spaceLine, 0.0f);
-                                    vertices[s * 4 + 1] -= Vector3(shift, spaceLine, 0.0f);
-                                    vertices[s * 4 + 2] -= Vector3(shift, spaceLine, 0.0f);
-                                    vertices[s * 4 + 3] -= Vector3(shift, spaceLine, 0.0f);
-                                }
-                                width.push_back(shift - spaceWidth);
-                                position.push_back(space);
-                                pos = Vector3(pos.x - shift, pos.y - spaceLine, 0.0f);
-
-                                bb[1].x = MAX(bb[1].x, shift - spaceWidth);
-                                bb[1].y = MAX(bb[1].y, pos.y);
-                            }
-                        }
-
-                        vertices[it * 4 + 0] = pos + shape[0] * size;
-                        vertices[it * 4 + 1] = pos + shape[1] * size;
-                        vertices[it * 4 + 2] = pos + shape[2] * size;
-                        vertices[it * 4 + 3] = pos + shape[3] * size;
-
-                        uv0[it * 4 + 0] = uv[0];
-                        uv0[it * 4 + 1] = uv[1];
-                        uv0[it * 4 + 2] = uv[2];
-                        uv0[it * 4 + 3] = uv[3];
-
-                        indices[it * 6 + 0] = it * 4 + 0;
-                        indices[it * 6 + 1] = it * 4 + 1;
-                        indices[it * 6 + 2] = it * 4 + 2;
-
-                        indices[it * 6 + 3] = it * 4 + 0;
-                        indices[it * 6 + 4] = it * 4 + 2;
-                        indices[it * 6 + 5] = it * 4 + 3;
-
-                        pos += Vector3(shape[2].x * size, 0.0f, 0.0f);
-                        it++;
-                    } break;
-                }
-                previous = ch;
-            }
-            if(wrap) {
-                bb[1].x = boundaries.x;
-                bb[1].y = -boundaries.y;
-            } else {
-                bb[1].x = MAX(bb[1].x, pos.x);
-                bb[1].y = MAX(bb[1].y, pos.y);
-            }
-
-            width.push_back(pos.x);
-            position.push_back(it);
-
-            vertices.resize(it * 4);
-            indices.resize(it * 6);
-            uv0.resize(it * 4);
-
-            auto w = width.begin();
-            auto p = position.begin();
-            float shiftX = (!(alignment & Left)) ? (boundaries.x - (*w)) / ((alignment & Center) ? 2 : 1) : 0.0f;
-            float shiftY = (!(alignment & Top)) ? (boundaries.y - position.size() * spaceLine) / ((alignment & Middle) ? 2 : 1) : 0.0f;
-            for(uint32_t i = 0; i < vertices.size(); i++) {
-                if(uint32_t(i / 4) >= *p) {
-                    w++;
-                    p++;
-                    shiftX = (!(alignment & Left)) ? (boundaries.x - (*w)) / ((alignment & Center) ? 2 : 1) : 0.0f;
-                }
-                vertices[i].x += shiftX;
-                vertices[i].y -= shiftY;
-            }
-
-            AABBox box;
-            box.setBox(bb[0], bb[1]);
-            mesh->setBound(box);
-            mesh->setMode(Mesh::Triangles);
-            mesh->setLod(0, &lod);
-        }
-    }
+    TextLayout layout;
+    layout.compose(font, mesh, size, text, alignment, kerning, wrap, boundaries);
 }
 
 #ifdef NEXT_SHARED
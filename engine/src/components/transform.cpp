@@ -2,66 +2,65 @@
 
 #include "components/actor.h"
 
+#include "components/private/transformhierarchy.h"
+
 #include <algorithm>
-#include <mutex>
 
 class TransformPrivate {
 public:
     TransformPrivate() :
-        m_Position(Vector3()),
-        m_Rotation(Vector3()),
-        m_Scale(Vector3(1.0f)),
-        m_WorldPosition(Vector3()),
-        m_WorldRotation(Vector3()),
-        m_WorldScale(Vector3(1.0f)),
-        m_Quaternion(Quaternion()),
-        m_WorldQuaternion(Quaternion()),
-        m_Transform(Matrix4()),
-        m_WorldTransform(Matrix4()),
-        m_pParent(nullptr),
-        m_Dirty(true) {
+        m_pHierarchy(TransformHierarchy::instance()),
+        m_pParent(nullptr) {
 
+        m_Index = m_pHierarchy->create(&m_Index);
     }
 
-    void cleanDirty() {
-        unique_lock<mutex> locker(m_Mutex);
-        m_Transform = Matrix4(m_Position, m_Quaternion, m_Scale);
-        m_WorldTransform = m_Transform;
-        m_WorldRotation = m_Rotation;
-        m_WorldPosition = m_Position;
-        m_WorldQuaternion = m_Quaternion;
-        m_WorldScale = m_Scale;
-        if(m_pParent) {
-            m_WorldPosition = m_pParent->worldTransform() * m_WorldPosition;
-            m_WorldScale = m_pParent->worldScale() * m_WorldScale;
-            m_WorldRotation = m_pParent->worldRotation() + m_WorldRotation;
-            m_WorldQuaternion = m_pParent->worldQuaternion() * m_WorldQuaternion;
-            m_WorldTransform = m_pParent->worldTransform() * m_WorldTransform;
-        }
-        m_Dirty = false;
+    ~TransformPrivate() {
+        m_pHierarchy->destroy(m_Index);
     }
 
-    Vector3 m_Position;
-    Vector3 m_Rotation;
-    Vector3 m_Scale;
-
-    Vector3 m_WorldPosition;
-    Vector3 m_WorldRotation;
-    Vector3 m_WorldScale;
+    void cleanDirty() {
+        // The other threads read the values of the last pass, the shared arrays are written only by the owner
+        if(!m_pHierarchy->isModified() || !m_pHierarchy->isOwner()) {
+            return;
+        }
+        unique_lock<mutex> locker(m_pHierarchy->m_Mutex);
+        // Find the topmost modified transform on the way to the root
+        int32_t top = -1;
+        for(int32_t index = m_Index; index >= 0; index = m_pHierarchy->m_Parents[index]) {
+            if(m_pHierarchy->isDirty(index)) {
+                top = index;
+            }
+        }
+        if(top == -1) {
+            return;
+        }
 
-    Quaternion m_Quaternion;
-    Quaternion m_WorldQuaternion;
+        vector<TransformPrivate *> path;
+        for(TransformPrivate *ptr = this; ptr; ptr = (ptr->m_pParent) ? ptr->m_pParent->p_ptr : nullptr) {
+            path.push_back(ptr);
+            if(ptr->m_Index == static_cast<uint32_t>(top)) {
+                break;
+            }
+        }
+        // Children become dirty instead of the cleaned transforms, so the rest of their subtrees stays valid
+        for(auto it = path.rbegin(); it != path.rend(); ++it) {
+            TransformPrivate *ptr = *it;
+            m_pHierarchy->updateNode(ptr->m_Index);
+            m_pHierarchy->resetDirty(ptr->m_Index);
+            for(auto child : ptr->m_Children) {
+                m_pHierarchy->setDirty(child->p_ptr->m_Index);
+            }
+        }
+    }
 
-    Matrix4 m_Transform;
-    Matrix4 m_WorldTransform;
+    TransformHierarchy *m_pHierarchy;
 
     list<Transform *> m_Children;
 
     Transform *m_pParent;
 
-    mutex m_Mutex;
-
-    bool m_Dirty;
+    uint32_t m_Index;
 };
 /*!
     \class Transform
@@ -71,6 +70,13 @@ public:
     Every Actor in a Scene has a Transform.
     It's used to store and manipulate the position, rotation and scale of the object.
     Every Transform can have a parent, which allows you to apply position, rotation and scale hierarchically.
+
+    The data of all transforms is stored in shared arrays ordered parents first.
+    Changing a Transform only marks it as modified, the world space values of the whole hierarchy are recalculated in one pass at the start of each Engine::update().
+    Reading a world space value of a modified Transform between the passes recalculates only the chain of its parents,
+    this happens on the main thread only, the other threads get the values calculated by the last pass.
+    Creating, destroying, reparenting and changing the local values of transforms is thread safe.
+    \note References returned by the getters remain valid until the next hierarchy pass.
 */
 
 Transform::Transform() :
@@ -91,55 +97,52 @@ Transform::~Transform() {
     Returns current position of the Transform in local space.
 */
 Vector3 &Transform::position() const {
-    return p_ptr->m_Position;
+    return p_ptr->m_pHierarchy->m_Position[p_ptr->m_Index];
 }
 /*!
     Changes \a position of the Transform in local space.
 */
 void Transform::setPosition(const Vector3 &position) {
-    unique_lock<mutex> locker(p_ptr->m_Mutex);
-    p_ptr->m_Position = position;
+    p_ptr->m_pHierarchy->setPosition(p_ptr->m_Index, position);
     setDirty();
 }
 /*!
     Returns current rotation of the Transform in local space as Euler angles in degrees.
 */
 Vector3 &Transform::rotation() const {
-    return p_ptr->m_Rotation;
+    return p_ptr->m_pHierarchy->m_Rotation[p_ptr->m_Index];
 }
 /*!
     Changes the rotation of the Transform in local space by provided Euler \a angles in degrees.
 */
 void Transform::setRotation(const Vector3 &angles) {
-    p_ptr->m_Rotation = angles;
-    setQuaternion(Quaternion(p_ptr->m_Rotation));
+    p_ptr->m_pHierarchy->setRotation(p_ptr->m_Index, angles);
+    setDirty();
 }
 /*!
     Returns current rotation of the Transform in local space as Quaternion.
 */
 Quaternion &Transform::quaternion() const {
-    return p_ptr->m_Quaternion;
+    return p_ptr->m_pHierarchy->m_Quaternion[p_ptr->m_Index];
 }
 /*!
     Changes the rotation \a quaternion of the Transform in local space by provided Quaternion.
 */
 void Transform::setQuaternion(const Quaternion &quaternion) {
-    unique_lock<mutex> locker(p_ptr->m_Mutex);
-    p_ptr->m_Quaternion = quaternion;
+    p_ptr->m_pHierarchy->setQuaternion(p_ptr->m_Index, quaternion);
     setDirty();
 }
 /*!
     Returns current scale of the Transform in local space.
 */
 Vector3 &Transform::scale() const {
-    return p_ptr->m_Scale;
+    return p_ptr->m_pHierarchy->m_Scale[p_ptr->m_Index];
 }
 /*!
     Changes the \a scale of the Transform in local space.
 */
 void Transform::setScale(const Vector3 &scale) {
-    unique_lock<mutex> locker(p_ptr->m_Mutex);
-    p_ptr->m_Scale = scale;
+    p_ptr->m_pHierarchy->setScale(p_ptr->m_Index, scale);
     setDirty();
 }
 /*!
@@ -163,83 +166,82 @@ void Transform::setParentTransform(Transform *parent, bool force) {
         s = worldScale();
     }
 
-    if(p_ptr->m_pParent) {
-        auto it = std::find(p_ptr->m_pParent->p_ptr->m_Children.begin(),
-                            p_ptr->m_pParent->p_ptr->m_Children.end(),
-                            this);
-        if(it != p_ptr->m_pParent->p_ptr->m_Children.end()) {
-            p_ptr->m_pParent->p_ptr->m_Children.erase(it);
+    {
+        // The links are followed by the lazy recalculation on the main thread
+        unique_lock<mutex> locker(p_ptr->m_pHierarchy->m_Mutex);
+        if(p_ptr->m_pParent) {
+            auto it = std::find(p_ptr->m_pParent->p_ptr->m_Children.begin(),
+                                p_ptr->m_pParent->p_ptr->m_Children.end(),
+                                this);
+            if(it != p_ptr->m_pParent->p_ptr->m_Children.end()) {
+                p_ptr->m_pParent->p_ptr->m_Children.erase(it);
+            }
+        }
+
+        p_ptr->m_pParent = parent;
+        if(p_ptr->m_pParent) {
+            p_ptr->m_pParent->p_ptr->m_Children.push_back(this);
         }
     }
 
-    p_ptr->m_pParent = parent;
     if(p_ptr->m_pParent) {
-        p_ptr->m_pParent->p_ptr->m_Children.push_back(this);
+        p_ptr->m_pHierarchy->setParent(p_ptr->m_Index, p_ptr->m_pParent->p_ptr->m_Index);
         if(!force) {
             Vector3 scale = p_ptr->m_pParent->worldScale();
             scale = Vector3(1.0f / scale.x, 1.0f / scale.y, 1.0f / scale.z);
 
-            p_ptr->m_Position = p_ptr->m_pParent->worldQuaternion().inverse() * ((p - p_ptr->m_pParent->worldPosition()) * scale);
-            p_ptr->m_Scale = s * scale;
+            p_ptr->m_pHierarchy->setPosition(p_ptr->m_Index, p_ptr->m_pParent->worldQuaternion().inverse() * ((p - p_ptr->m_pParent->worldPosition()) * scale));
+            p_ptr->m_pHierarchy->setScale(p_ptr->m_Index, s * scale);
             setRotation(e - p_ptr->m_pParent->worldRotation());
         } else {
             setDirty();
         }
+    } else {
+        p_ptr->m_pHierarchy->setParent(p_ptr->m_Index, -1);
+        setDirty();
     }
 }
 /*!
     Returns current transform matrix in local space.
 */
 Matrix4 &Transform::localTransform() const {
-    if(p_ptr->m_Dirty) {
-        p_ptr->cleanDirty();
-    }
-    return p_ptr->m_Transform;
+    p_ptr->cleanDirty();
+    return p_ptr->m_pHierarchy->m_Local[p_ptr->m_Index];
 }
 /*!
     Returns current transform matrix in world space.
 */
 Matrix4 &Transform::worldTransform() const {
-    if(p_ptr->m_Dirty) {
-        p_ptr->cleanDirty();
-    }
-    return p_ptr->m_WorldTransform;
+    p_ptr->cleanDirty();
+    return p_ptr->m_pHierarchy->m_World[p_ptr->m_Index];
 }
 /*!
     Returns current position of the transform in world space.
 */
 Vector3 &Transform::worldPosition() const {
-    if(p_ptr->m_Dirty) {
-        p_ptr->cleanDirty();
-    }
-    return p_ptr->m_WorldPosition;
+    p_ptr->cleanDirty();
+    return p_ptr->m_pHierarchy->m_WorldPosition[p_ptr->m_Index];
 }
 /*!
     Returns current rotation of the transform in world space as Euler angles in degrees.
 */
 Vector3 &Transform::worldRotation() const {
-    if(p_ptr->m_Dirty) {
-        p_ptr->cleanDirty();
-    }
-    return p_ptr->m_WorldRotation;
+    p_ptr->cleanDirty();
+    return p_ptr->m_pHierarchy->m_WorldRotation[p_ptr->m_Index];
 }
 /*!
     Returns current rotation of the transform in world space as Quaternion.
 */
 Quaternion &Transform::worldQuaternion() const {
-    if(p_ptr->m_Dirty) {
-        p_ptr->cleanDirty();
-    }
-    return p_ptr->m_WorldQuaternion;
+    p_ptr->cleanDirty();
+    return p_ptr->m_pHierarchy->m_WorldQuaternion[p_ptr->m_Index];
 }
 /*!
     Returns current scale of the transform in world space.
 */
 Vector3 &Transform::worldScale() const {
-    if(p_ptr->m_Dirty) {
-        p_ptr->cleanDirty();
-    }
-    return p_ptr->m_WorldScale;
+    p_ptr->cleanDirty();
+    return p_ptr->m_pHierarchy->m_WorldScale[p_ptr->m_Index];
 }
 /*!
     Makes the Transform a child of \a parent at given \a position.
@@ -264,8 +266,5 @@ list<Transform *> &Transform::children() const {
     \internal
 */
 void Transform::setDirty() {
-    p_ptr->m_Dirty = true;
-    for(auto it : p_ptr->m_Children) {
-        it->setDirty();
-    }
+    p_ptr->m_pHierarchy->setDirty(p_ptr->m_Index);
 }
@@ -0,0 +1,213 @@
+#include "distancefield.h"
+
+#include <amath.h>
+
+#include <vector>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define DF_SSE
+#endif
+
+using namespace std;
+
+namespace {
+    struct Scratch {
+        // Distances along the columns to the nearest inside and outside texels
+        vector<float> inside;
+        vector<float> outside;
+
+        vector<float> mask;
+
+        vector<int32_t> columns;
+
+        vector<int32_t> v;
+        vector<double> z;
+
+        vector<double> toInside;
+        vector<double> toOutside;
+    };
+
+    Scratch &scratch() {
+        // Buffers are reused by all the fields generated on the same thread
+        static thread_local Scratch result;
+        return result;
+    }
+
+    // Forward sweep along the columns, distances grow by one texel from the previous row
+    void sweepDown(const float *mask, const float *inUp, const float *outUp, float *in, float *out, int32_t w) {
+        int32_t x = 0;
+#ifdef DF_SSE
+        __m128 one = _mm_set1_ps(1.0f);
+        for(; x + 4 <= w; x += 4) {
+            __m128 m = _mm_loadu_ps(mask + x);
+            _mm_storeu_ps(in + x, _mm_mul_ps(_mm_sub_ps(one, m), _mm_add_ps(_mm_loadu_ps(inUp + x), one)));
+            _mm_storeu_ps(out + x, _mm_mul_ps(m, _mm_add_ps(_mm_loadu_ps(outUp + x), one)));
+        }
+#endif
+        for(; x < w; x++) {
+            float m = mask[x];
+            in[x] = (1.0f - m) * (inUp[x] + 1.0f);
+            out[x] = m * (outUp[x] + 1.0f);
+        }
+    }
+
+    // Backward sweep along the columns, keeps the nearest of two directions
+    void sweepUp(const float *inDown, const float *outDown, float *in, float *out, int32_t w) {
+        int32_t x = 0;
+#ifdef DF_SSE
+        __m128 one = _mm_set1_ps(1.0f);
+        for(; x + 4 <= w; x += 4) {
+            _mm_storeu_ps(in + x, _mm_min_ps(_mm_loadu_ps(in + x), _mm_add_ps(_mm_loadu_ps(inDown + x), one)));
+            _mm_storeu_ps(out + x, _mm_min_ps(_mm_loadu_ps(out + x), _mm_add_ps(_mm_loadu_ps(outDown + x), one)));
+        }
+#endif
+        for(; x < w; x++) {
+            in[x] = MIN(in[x], inDown[x] + 1.0f);
+            out[x] = MIN(out[x], outDown[x] + 1.0f);
+        }
+    }
+
+    // Squared distances for the row of squared column distances f, evaluated only at the sampled columns
+    void envelope(const float *f, int32_t n, const int32_t *columns, int32_t count, double *d, Scratch &s) {
+        int32_t *v = &s.v[0];
+        double *z = &s.z[0];
+
+        int32_t k = 0;
+        v[0] = 0;
+        z[0] = -HUGE_VAL;
+        z[1] = HUGE_VAL;
+        for(int32_t q = 1; q < n; q++) {
+            double fq = static_cast<double>(f[q]) * f[q] + static_cast<double>(q) * q;
+            double sq;
+            while(true) {
+                int32_t p = v[k];
+                double fp = static_cast<double>(f[p]) * f[p] + static_cast<double>(p) * p;
+                sq = (fq - fp) / (2.0 * (q - p));
+                if(sq > z[k]) {
+                    break;
+                }
+                k--;
+            }
+            k++;
+            v[k] = q;
+            z[k] = sq;
+            z[k + 1] = HUGE_VAL;
+        }
+
+        k = 0;
+        for(int32_t i = 0; i < count; i++) {
+            int32_t q = columns[i];
+            while(z[k + 1] < q) {
+                k++;
+            }
+            double dq = q - v[k];
+            d[i] = dq * dq + static_cast<double>(f[v[k]]) * f[v[k]];
+        }
+    }
+}
+
+DistanceField::Options::Options() :
+        scale(32.0f),
+        threshold(128),
+        channels(1),
+        channel(0) {
+
+}
+/*!
+    \class DistanceField
+    \brief Generates signed distance fields from bitmaps.
+    \inmodule Engine
+
+    The distance field is computed with an exact Euclidean distance transform in linear time.
+    Distances are found along the columns first and then the lower envelope of parabolas is built for each row,
+    only the rows and columns which are sampled to the destination image are evaluated in the second pass.
+    The column passes process four texels at once with SSE when it's available.
+
+    \note Only single channel fields are generated; multi-channel signed distance fields (MSDF), which keep sharp corners, are out of scope.
+*/
+
+/*!
+    Generates a signed distance field for the \a src bitmap with \a width, \a height and \a pitch in bytes between the rows.
+    The texels greater than Options::threshold are inside of the shape.
+    The result is written to the \a dst image with \a dstWidth and \a dstHeight dimensions,
+    each destination texel takes the distance of the nearest source texel, which makes possible to produce smaller fields from the high resolution bitmaps.
+    Output values are 128 at the edge of the shape, greater inside and less outside, one texel of distance changes the value by Options::scale.
+
+    Both images have Options::channels interleaved channels and only Options::channel is read and written, the \a src and \a dst may point to the same image.
+*/
+void DistanceField::generate(const uint8_t *src, int32_t width, int32_t height, int32_t pitch,
+                             uint8_t *dst, int32_t dstWidth, int32_t dstHeight, const Options &options) {
+    PROFILE_FUNCTION();
+
+    if(width <= 0 || height <= 0 || dstWidth <= 0 || dstHeight <= 0) {
+        return;
+    }
+
+    Scratch &s = scratch();
+
+    // One texel border around the bitmap is outside of the shape
+    int32_t w = width + 2;
+    int32_t h = height + 2;
+    float far = static_cast<float>(w + h);
+
+    s.inside.resize(w * h);
+    s.outside.resize(w * h);
+    s.mask.resize(w);
+    s.columns.resize(dstWidth);
+    s.v.resize(w);
+    s.z.resize(w + 1);
+    s.toInside.resize(dstWidth);
+    s.toOutside.resize(dstWidth);
+
+    for(int32_t y = 0; y < h; y++) {
+        float *mask = &s.mask[0];
+        mask[0] = 0.0f;
+        mask[w - 1] = 0.0f;
+        if(y > 0 && y <= height) {
+            const uint8_t *row = src + (y - 1) * pitch + options.channel;
+            for(int32_t x = 0; x < width; x++) {
+                mask[x + 1] = (row[x * options.channels] > options.threshold) ? 1.0f : 0.0f;
+            }
+        } else {
+            for(int32_t x = 1; x <= width; x++) {
+                mask[x] = 0.0f;
+            }
+        }
+
+        float *in = &s.inside[y * w];
+        float *out = &s.outside[y * w];
+        if(y == 0) {
+            for(int32_t x = 0; x < w; x++) {
+                in[x] = far;
+                out[x] = 0.0f;
+            }
+        } else {
+            sweepDown(mask, in - w, out - w, in, out, w);
+        }
+    }
+    for(int32_t y = h - 2; y >= 0; y--) {
+        float *in = &s.inside[y * w];
+        float *out = &s.outside[y * w];
+        sweepUp(in + w, out + w, in, out, w);
+    }
+
+    // Destination texels take the distance of the nearest source texel
+    for(int32_t x = 0; x < dstWidth; x++) {
+        s.columns[x] = 1 + static_cast<int32_t>((2 * static_cast<int64_t>(x) + 1) * width / (2 * dstWidth));
+    }
+
+    for(int32_t y = 0; y < dstHeight; y++) {
+        int32_t row = 1 + static_cast<int32_t>((2 * static_cast<int64_t>(y) + 1) * height / (2 * dstHeight));
+
+        envelope(&s.inside[row * w], w, &s.columns[0], dstWidth, &s.toInside[0], s);
+        envelope(&s.outside[row * w], w, &s.columns[0], dstWidth, &s.toOutside[0], s);
+
+        uint8_t *target = dst + (y * dstWidth) * options.channels + options.channel;
+        for(int32_t x = 0; x < dstWidth; x++) {
+            double dist = sqrt(s.toOutside[x] + 1.0) - sqrt(s.toInside[x] + 1.0);
+            target[x * options.channels] = static_cast<uint8_t>(CLAMP(dist * options.scale + 128.0, 0.0, 255.0));
+        }
+    }
+}
@@ -220,6 +220,11 @@ void IConverter::init() {
 
 }
 
+bool IConverter::isThreadSafe(IConverterSettings *settings) const {
+    Q_UNUSED(settings)
+    return false;
+}
+
 IConverterSettings *IConverter::createSettings() const {
     return new IConverterSettings();
 }
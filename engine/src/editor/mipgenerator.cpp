@@ -0,0 +1,374 @@
+#include "editor/mipgenerator.h"
+
+#include <threadpool.h>
+
+#include <functional>
+#include <cmath>
+
+#define KAISER_WIDTH 3.0f
+#define KAISER_ALPHA 4.0f
+
+#define LINEAR_STEPS 4096
+
+#define MIN_PARALLEL_ROWS 32
+
+namespace {
+    typedef function<void(int32_t, int32_t)> RowFunction;
+
+    class RowTask : public Object {
+    public:
+        RowTask(const RowFunction &function, int32_t first, int32_t last) :
+                m_Function(function),
+                m_First(first),
+                m_Last(last) {
+
+        }
+
+        void processEvents() override {
+            m_Function(m_First, m_Last);
+        }
+
+    protected:
+        RowFunction m_Function;
+
+        int32_t m_First;
+
+        int32_t m_Last;
+    };
+
+    void parallelRows(ThreadPool *pool, int32_t rows, const RowFunction &function) {
+        uint32_t threads = (pool) ? MIN(pool->maxThreads(), static_cast<uint32_t>(rows / MIN_PARALLEL_ROWS)) : 1;
+        if(threads <= 1) {
+            function(0, rows);
+            return;
+        }
+
+        list<RowTask> tasks;
+        int32_t step = (rows + threads - 1) / threads;
+        for(int32_t first = 0; first < rows; first += step) {
+            tasks.emplace_back(function, first, MIN(first + step, rows));
+            pool->start(tasks.back());
+        }
+        pool->waitForDone();
+    }
+
+    const float *linearTable() {
+        static float table[256];
+        static bool init = [] {
+            for(int32_t i = 0; i < 256; i++) {
+                float c = i / 255.0f;
+                table[i] = (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return true;
+        }();
+        A_UNUSED(init);
+        return table;
+    }
+
+    const uint8_t *sRGBTable() {
+        static uint8_t table[LINEAR_STEPS];
+        static bool init = [] {
+            for(int32_t i = 0; i < LINEAR_STEPS; i++) {
+                float l = i / float(LINEAR_STEPS - 1);
+                float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+                table[i] = static_cast<uint8_t>(CLAMP(c * 255.0f + 0.5f, 0.0f, 255.0f));
+            }
+            return true;
+        }();
+        A_UNUSED(init);
+        return table;
+    }
+
+    float bessel0(float x) {
+        float sum = 1.0f;
+        float term = 1.0f;
+        float half = x * 0.5f;
+        for(int32_t k = 1; k < 32; k++) {
+            term *= (half / k) * (half / k);
+            sum += term;
+            if(term < sum * 1e-7f) {
+                break;
+            }
+        }
+        return sum;
+    }
+
+    float kaiser(float x) {
+        if(fabsf(x) > 1.0f) {
+            return 0.0f;
+        }
+        return bessel0(KAISER_ALPHA * sqrtf(1.0f - x * x)) / bessel0(KAISER_ALPHA);
+    }
+
+    float sinc(float x) {
+        if(fabsf(x) < 1e-6f) {
+            return 1.0f;
+        }
+        x *= PI;
+        return sinf(x) / x;
+    }
+    /*
+        Filter weights for each destination pixel, the number of taps is the same for all pixels.
+    */
+    struct Kernel {
+        vector<int32_t> index;
+
+        vector<float> weight;
+
+        int32_t taps;
+    };
+
+    Kernel buildKernel(int32_t src, int32_t dst, int32_t filter, bool repeat) {
+        float scale = float(src) / float(dst);
+        float support = ((filter == MipGenerator::Box) ? 0.5f : KAISER_WIDTH) * scale;
+
+        Kernel result;
+        result.taps = static_cast<int32_t>(ceilf(support * 2.0f)) + 1;
+        result.index.resize(dst * result.taps);
+        result.weight.resize(dst * result.taps);
+
+        for(int32_t x = 0; x < dst; x++) {
+            float center = (x + 0.5f) * scale;
+            int32_t first = static_cast<int32_t>(floorf(center - support));
+
+            float sum = 0.0f;
+            for(int32_t t = 0; t < result.taps; t++) {
+                int32_t i = first + t;
+                float d = (i + 0.5f - center) / scale;
+
+                float w = 0.0f;
+                if(filter == MipGenerator::Box) {
+                    w = (fabsf(d) < 0.5f) ? 1.0f : 0.0f;
+                } else {
+                    w = sinc(d) * kaiser(d / KAISER_WIDTH);
+                }
+
+                result.index[x * result.taps + t] = (repeat) ? ((i % src) + src) % src : CLAMP(i, 0, src - 1);
+                result.weight[x * result.taps + t] = w;
+                sum += w;
+            }
+            if(sum != 0.0f) {
+                for(int32_t t = 0; t < result.taps; t++) {
+                    result.weight[x * result.taps + t] /= sum;
+                }
+            }
+        }
+        return result;
+    }
+
+    float coverage(const vector<float> &pixels, float cutoff, float scale) {
+        uint32_t count = pixels.size() / 4;
+        uint32_t result = 0;
+        for(uint32_t i = 0; i < count; i++) {
+            if(pixels[i * 4 + 3] * scale > cutoff) {
+                result++;
+            }
+        }
+        return float(result) / float(count);
+    }
+
+    float alphaScale(const vector<float> &pixels, float cutoff, float target) {
+        float low = 0.0f;
+        float high = 4.0f;
+        for(int32_t i = 0; i < 10; i++) {
+            float middle = (low + high) * 0.5f;
+            if(coverage(pixels, cutoff, middle) < target) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+        }
+        float l = coverage(pixels, cutoff, low);
+        float h = coverage(pixels, cutoff, high);
+        return (fabsf(l - target) < fabsf(h - target)) ? low : high;
+    }
+}
+
+/*!
+    \class MipGenerator
+    \brief Produces the chain of mip levels for the imported images.
+    \inmodule Editor
+
+    Each level is filtered from the previous one with a separable kernel.
+    The color channels are filtered in linear space, optionally the normals are renormalized and the alpha coverage is preserved for cutout textures.
+    The rows of each level are processed in parallel.
+*/
+
+/*!
+    \enum MipGenerator::FilterType
+
+    \value Box \c Averages the source pixels covered by the destination pixel. Fast but aliasing is possible.
+    \value Kaiser \c Windowed sinc filter. Keeps the details sharp without aliasing.
+*/
+
+/*!
+    \class MipGenerator::Options
+    \inmodule Editor
+
+    The settings of mip generation.
+    \list
+        \li \c filter - the type of filter, one of MipGenerator::FilterType values.
+        \li \c alphaCutoff - the alpha test threshold, the coverage of alpha tested pixels is preserved for all levels if the value is greater than 0.
+        \li \c sRGB - the color channels are stored in sRGB space and must be filtered in linear space.
+        \li \c normalMap - the color channels contain normals which must be renormalized.
+        \li \c repeat - the image is tiled, samples outside of the image are wrapped instead of clamping.
+    \endlist
+*/
+MipGenerator::Options::Options() :
+        filter(Kaiser),
+        alphaCutoff(0.0f),
+        sRGB(true),
+        normalMap(false),
+        repeat(false) {
+
+}
+/*!
+    Generates the full chain of mip levels for the \a rgba image with \a width and \a height dimensions according to \a options.
+    The \a rgba data must contain 4 bytes per pixel.
+    The work is split between the \a threads, 0 means the optimal number of threads for the current system.
+    Returns all levels starting from the copy of the source image, each level contains 4 bytes per pixel.
+*/
+MipGenerator::Levels MipGenerator::generate(const uint8_t *rgba, int32_t width, int32_t height, const Options &options, uint32_t threads) {
+    Levels result;
+    if(rgba == nullptr || width <= 0 || height <= 0) {
+        return result;
+    }
+
+    bool sRGB = options.sRGB && !options.normalMap;
+    const float *toLinear = linearTable();
+    const uint8_t *toSRGB = sRGBTable();
+
+    uint32_t count = width * height;
+    result.push_back(ByteArray(reinterpret_cast<const int8_t *>(rgba), reinterpret_cast<const int8_t *>(rgba) + count * 4));
+
+    vector<float> current(count * 4);
+    for(uint32_t i = 0; i < count * 4; i++) {
+        current[i] = ((i & 3) != 3 && sRGB) ? toLinear[rgba[i]] : rgba[i] / 255.0f;
+    }
+
+    float target = 0.0f;
+    if(options.alphaCutoff > 0.0f) {
+        target = alphaCoverage(rgba, width, height, options.alphaCutoff);
+    }
+
+    if(threads == 0) {
+        threads = ThreadPool::optimalThreadCount();
+    }
+    ThreadPool *pool = nullptr;
+    if(threads > 1 && height >= MIN_PARALLEL_ROWS * 2) {
+        pool = new ThreadPool;
+        pool->setMaxThreads(threads);
+    }
+
+    int32_t w = width;
+    int32_t h = height;
+    while(w > 1 || h > 1) {
+        int32_t nw = MAX(w / 2, 1);
+        int32_t nh = MAX(h / 2, 1);
+
+        Kernel horizontal = buildKernel(w, nw, options.filter, options.repeat);
+        Kernel vertical = buildKernel(h, nh, options.filter, options.repeat);
+
+        vector<float> temp(nw * h * 4);
+        parallelRows(pool, h, [&](int32_t first, int32_t last) {
+            for(int32_t y = first; y < last; y++) {
+                const float *src = &current[y * w * 4];
+                float *dst = &temp[y * nw * 4];
+                for(int32_t x = 0; x < nw; x++) {
+                    float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                    const int32_t *index = &horizontal.index[x * horizontal.taps];
+                    const float *weight = &horizontal.weight[x * horizontal.taps];
+                    for(int32_t t = 0; t < horizontal.taps; t++) {
+                        const float *s = &src[index[t] * 4];
+                        for(int32_t c = 0; c < 4; c++) {
+                            sum[c] += s[c] * weight[t];
+                        }
+                    }
+                    for(int32_t c = 0; c < 4; c++) {
+                        dst[x * 4 + c] = sum[c];
+                    }
+                }
+            }
+        });
+
+        vector<float> next(nw * nh * 4);
+        parallelRows(pool, nh, [&](int32_t first, int32_t last) {
+            vector<float> sum(nw * 4);
+            for(int32_t y = first; y < last; y++) {
+                std::fill(sum.begin(), sum.end(), 0.0f);
+                const int32_t *index = &vertical.index[y * vertical.taps];
+                const float *weight = &vertical.weight[y * vertical.taps];
+                // Row by row accumulation keeps the memory access linear
+                for(int32_t t = 0; t < vertical.taps; t++) {
+                    const float *src = &temp[index[t] * nw * 4];
+                    float wt = weight[t];
+                    for(int32_t i = 0; i < nw * 4; i++) {
+                        sum[i] += src[i] * wt;
+                    }
+                }
+                float *dst = &next[y * nw * 4];
+                for(int32_t i = 0; i < nw * 4; i++) {
+                    dst[i] = CLAMP(sum[i], 0.0f, 1.0f);
+                }
+                if(options.normalMap) {
+                    for(int32_t x = 0; x < nw; x++) {
+                        float *n = &dst[x * 4];
+                        Vector3 normal(n[0] * 2.0f - 1.0f, n[1] * 2.0f - 1.0f, n[2] * 2.0f - 1.0f);
+                        float length = normal.length();
+                        if(length > 0.0f) {
+                            normal *= 1.0f / length;
+                            n[0] = normal.x * 0.5f + 0.5f;
+                            n[1] = normal.y * 0.5f + 0.5f;
+                            n[2] = normal.z * 0.5f + 0.5f;
+                        }
+                    }
+                }
+            }
+        });
+
+        float scale = 1.0f;
+        if(target > 0.0f) {
+            scale = alphaScale(next, options.alphaCutoff, target);
+        }
+
+        ByteArray level(nw * nh * 4);
+        uint8_t *out = reinterpret_cast<uint8_t *>(&level[0]);
+        parallelRows(pool, nh, [&](int32_t first, int32_t last) {
+            for(int32_t i = first * nw * 4; i < last * nw * 4; i++) {
+                float v = next[i];
+                if((i & 3) == 3) {
+                    out[i] = static_cast<uint8_t>(MIN(v * scale, 1.0f) * 255.0f + 0.5f);
+                } else if(sRGB) {
+                    out[i] = toSRGB[static_cast<int32_t>(v * (LINEAR_STEPS - 1) + 0.5f)];
+                } else {
+                    out[i] = static_cast<uint8_t>(v * 255.0f + 0.5f);
+                }
+            }
+        });
+        result.push_back(level);
+
+        current.swap(next);
+        w = nw;
+        h = nh;
+    }
+
+    delete pool;
+
+    return result;
+}
+/*!
+    Returns the fraction of pixels of the \a rgba image with \a width and \a height dimensions which pass the alpha test with provided \a cutoff.
+*/
+float MipGenerator::alphaCoverage(const uint8_t *rgba, int32_t width, int32_t height, float cutoff) {
+    uint32_t count = width * height;
+    if(count == 0) {
+        return 0.0f;
+    }
+    uint32_t result = 0;
+    for(uint32_t i = 0; i < count; i++) {
+        if(rgba[i * 4 + 3] / 255.0f > cutoff) {
+            result++;
+        }
+    }
+    return float(result) / float(count);
+}
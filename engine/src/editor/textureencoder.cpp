@@ -0,0 +1,1106 @@
+#include "editor/textureencoder.h"
+
+#include <resources/texture.h>
+
+#include <threadpool.h>
+
+#include <cstring>
+#include <cfloat>
+
+#define BLOCK_PIXELS 16
+#define MIN_PARALLEL_ROWS 8
+
+namespace {
+    typedef uint8_t Block[BLOCK_PIXELS][4];
+
+    const int32_t etcModifiers[8][2] = {
+        {2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}
+    };
+
+    const int32_t eacModifiers[16][8] = {
+        {-3, -6, -9, -15, 2, 5, 8, 14},
+        {-3, -7, -10, -13, 2, 6, 9, 12},
+        {-2, -5, -8, -13, 1, 4, 7, 12},
+        {-2, -4, -6, -13, 1, 3, 5, 12},
+        {-3, -6, -8, -12, 2, 5, 7, 11},
+        {-3, -7, -9, -11, 2, 6, 8, 10},
+        {-4, -7, -8, -11, 3, 6, 7, 10},
+        {-3, -5, -8, -11, 2, 4, 7, 10},
+        {-2, -6, -8, -10, 1, 5, 7, 9},
+        {-2, -5, -8, -10, 1, 4, 7, 9},
+        {-2, -4, -8, -10, 1, 3, 7, 9},
+        {-2, -5, -7, -10, 1, 4, 6, 9},
+        {-3, -4, -7, -10, 2, 3, 6, 9},
+        {-1, -2, -3, -10, 0, 1, 2, 9},
+        {-4, -6, -8, -9, 3, 5, 7, 8},
+        {-3, -5, -7, -9, 2, 4, 6, 8}
+    };
+
+    const int32_t bc7Weights[16] = {
+        0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64
+    };
+
+    inline int32_t clampByte(int32_t value) {
+        return CLAMP(value, 0, 255);
+    }
+
+    inline uint32_t distance(const int32_t *left, const uint8_t *right, uint8_t channels) {
+        uint32_t result = 0;
+        for(uint8_t c = 0; c < channels; c++) {
+            int32_t d = left[c] - right[c];
+            result += d * d;
+        }
+        return result;
+    }
+
+    void fetchBlock(const uint8_t *rgba, int32_t width, int32_t height, int32_t bx, int32_t by, Block block) {
+        // Edge pixels are replicated for the partial blocks
+        for(int32_t y = 0; y < 4; y++) {
+            int32_t py = MIN(by * 4 + y, height - 1);
+            for(int32_t x = 0; x < 4; x++) {
+                int32_t px = MIN(bx * 4 + x, width - 1);
+                memcpy(block[y * 4 + x], &rgba[(py * width + px) * 4], 4);
+            }
+        }
+    }
+
+    void storeBlock(uint8_t *rgba, int32_t width, int32_t height, int32_t bx, int32_t by, const Block block) {
+        for(int32_t y = 0; y < 4; y++) {
+            int32_t py = by * 4 + y;
+            for(int32_t x = 0; x < 4; x++) {
+                int32_t px = bx * 4 + x;
+                if(px < width && py < height) {
+                    memcpy(&rgba[(py * width + px) * 4], block[y * 4 + x], 4);
+                }
+            }
+        }
+    }
+    /*
+        Finds the line segment which approximates the colors of the block.
+        The fast path uses the bounding box, other modes use the principal axis of the color distribution.
+    */
+    void findEndpoints(const Block block, uint8_t channels, int32_t quality, float *e0, float *e1) {
+        float mean[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        float minimum[4] = {255.0f, 255.0f, 255.0f, 255.0f};
+        float maximum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+            for(uint8_t c = 0; c < channels; c++) {
+                float v = block[i][c];
+                mean[c] += v;
+                minimum[c] = MIN(minimum[c], v);
+                maximum[c] = MAX(maximum[c], v);
+            }
+        }
+        for(uint8_t c = 0; c < channels; c++) {
+            mean[c] /= BLOCK_PIXELS;
+        }
+
+        if(quality == TextureEncoder::Fast) {
+            uint8_t k = 0;
+            for(uint8_t c = 1; c < channels; c++) {
+                if(maximum[c] - minimum[c] > maximum[k] - minimum[k]) {
+                    k = c;
+                }
+            }
+            for(uint8_t c = 0; c < channels; c++) {
+                // The diagonal of bounding box is flipped for the channels anti-correlated with the widest one
+                float cross = 0.0f;
+                for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+                    cross += (block[i][k] - mean[k]) * (block[i][c] - mean[c]);
+                }
+                float inset = (maximum[c] - minimum[c]) / 16.0f;
+                e0[c] = maximum[c] - inset;
+                e1[c] = minimum[c] + inset;
+                if(cross < 0.0f) {
+                    std::swap(e0[c], e1[c]);
+                }
+            }
+            return;
+        }
+
+        float cov[4][4];
+        memset(cov, 0, sizeof(cov));
+        for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+            float d[4];
+            for(uint8_t c = 0; c < channels; c++) {
+                d[c] = block[i][c] - mean[c];
+            }
+            for(uint8_t r = 0; r < channels; r++) {
+                for(uint8_t c = 0; c < channels; c++) {
+                    cov[r][c] += d[r] * d[c];
+                }
+            }
+        }
+
+        // The diagonal of bounding box is orthogonal to the axis of anti-correlated channels, so the iterations start
+        // from the covariance column of the channel with the largest variance
+        uint8_t k = 0;
+        for(uint8_t c = 1; c < channels; c++) {
+            if(cov[c][c] > cov[k][k]) {
+                k = c;
+            }
+        }
+        float axis[4];
+        for(uint8_t c = 0; c < channels; c++) {
+            axis[c] = cov[k][c];
+        }
+        for(int32_t it = 0; it < 8; it++) {
+            float next[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            float length = 0.0f;
+            for(uint8_t r = 0; r < channels; r++) {
+                for(uint8_t c = 0; c < channels; c++) {
+                    next[r] += cov[r][c] * axis[c];
+                }
+                length = MAX(length, fabsf(next[r]));
+            }
+            if(length < FLT_EPSILON) {
+                break;
+            }
+            for(uint8_t c = 0; c < channels; c++) {
+                axis[c] = next[c] / length;
+            }
+        }
+
+        float tmin = FLT_MAX;
+        float tmax = -FLT_MAX;
+        for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+            float t = 0.0f;
+            for(uint8_t c = 0; c < channels; c++) {
+                t += (block[i][c] - mean[c]) * axis[c];
+            }
+            tmin = MIN(tmin, t);
+            tmax = MAX(tmax, t);
+        }
+
+        float length = 0.0f;
+        for(uint8_t c = 0; c < channels; c++) {
+            length += axis[c] * axis[c];
+        }
+        if(length < FLT_EPSILON) {
+            tmin = tmax = 0.0f;
+            length = 1.0f;
+        }
+        for(uint8_t c = 0; c < channels; c++) {
+            e0[c] = CLAMP(mean[c] + axis[c] * tmax / length, 0.0f, 255.0f);
+            e1[c] = CLAMP(mean[c] + axis[c] * tmin / length, 0.0f, 255.0f);
+        }
+    }
+    /*
+        Solves the least squares problem for two endpoints with provided interpolation \a weights of each pixel.
+        The weight is a factor of the first endpoint.
+    */
+    bool refineEndpoints(const Block block, uint8_t channels, const float *weights, float *e0, float *e1) {
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        float bx[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+            float a = weights[i];
+            float b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for(uint8_t c = 0; c < channels; c++) {
+                ax[c] += a * block[i][c];
+                bx[c] += b * block[i][c];
+            }
+        }
+        float det = aa * bb - ab * ab;
+        if(fabsf(det) < FLT_EPSILON) {
+            return false;
+        }
+        for(uint8_t c = 0; c < channels; c++) {
+            e0[c] = CLAMP((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+            e1[c] = CLAMP((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    // BC1 (DXT1) color block
+
+    uint16_t pack565(const float *color) {
+        int32_t r = CLAMP(static_cast<int32_t>(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+        int32_t g = CLAMP(static_cast<int32_t>(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+        int32_t b = CLAMP(static_cast<int32_t>(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void unpack565(uint16_t value, int32_t *color) {
+        int32_t r = (value >> 11) & 31;
+        int32_t g = (value >> 5) & 63;
+        int32_t b = value & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+        color[3] = 255;
+    }
+
+    void paletteBC1(uint16_t c0, uint16_t c1, bool four, int32_t palette[4][4]) {
+        unpack565(c0, palette[0]);
+        unpack565(c1, palette[1]);
+        for(int32_t c = 0; c < 3; c++) {
+            if(four) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            } else {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+        palette[2][3] = 255;
+        palette[3][3] = 255;
+    }
+
+    uint32_t fitBC1(const Block block, uint16_t &c0, uint16_t &c1, uint32_t &indices) {
+        if(c0 < c1) {
+            std::swap(c0, c1);
+        }
+        int32_t palette[4][4];
+        paletteBC1(c0, c1, true, palette);
+
+        uint32_t count = (c0 == c1) ? 1 : 4;
+
+        uint32_t error = 0;
+        indices = 0;
+        for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+            uint32_t best = UINT32_MAX;
+            uint32_t index = 0;
+            for(uint32_t p = 0; p < count; p++) {
+                uint32_t d = distance(palette[p], block[i], 3);
+                if(d < best) {
+                    best = d;
+                    index = p;
+                }
+            }
+            error += best;
+            indices |= index << (2 * i);
+        }
+        return error;
+    }
+
+    void encodeBC1(const Block block, int32_t quality, uint8_t *out) {
+        float e0[4], e1[4];
+        findEndpoints(block, 3, quality, e0, e1);
+
+        uint16_t c0 = pack565(e0);
+        uint16_t c1 = pack565(e1);
+        uint32_t indices;
+        uint32_t error = fitBC1(block, c0, c1, indices);
+
+        if(quality == TextureEncoder::Best) {
+            static const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+            for(int32_t it = 0; it < 2 && error > 0; it++) {
+                float w[BLOCK_PIXELS];
+                for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+                    w[i] = weights[(indices >> (2 * i)) & 3];
+                }
+                if(!refineEndpoints(block, 3, w, e0, e1)) {
+                    break;
+                }
+                uint16_t n0 = pack565(e0);
+                uint16_t n1 = pack565(e1);
+                uint32_t n;
+                uint32_t e = fitBC1(block, n0, n1, n);
+                if(e >= error) {
+                    break;
+                }
+                c0 = n0;
+                c1 = n1;
+                indices = n;
+                error = e;
+            }
+        }
+
+        out[0] = c0 & 0xff;
+        out[1] = c0 >> 8;
+        out[2] = c1 & 0xff;
+        out[3] = c1 >> 8;
+        for(int32_t i = 0; i < 4; i++) {
+            out[4 + i] = (indices >> (8 * i)) & 0xff;
+        }
+    }
+
+    void decodeBC1(const uint8_t *in, bool four, Block block) {
+        uint16_t c0 = in[0] | (in[1] << 8);
+        uint16_t c1 = in[2] | (in[3] << 8);
+        int32_t palette[4][4];
+        paletteBC1(c0, c1, four || c0 > c1, palette);
+
+        uint32_t indices = in[4] | (in[5] << 8) | (in[6] << 16) | (static_cast<uint32_t>(in[7]) << 24);
+        for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+            const int32_t *color = palette[(indices >> (2 * i)) & 3];
+            for(int32_t c = 0; c < 4; c++) {
+                block[i][c] = color[c];
+            }
+        }
+    }
+
+    // BC3 (DXT5) alpha block
+
+    void paletteAlpha(int32_t a0, int32_t a1, int32_t palette[8]) {
+        palette[0] = a0;
+        palette[1] = a1;
+        if(a0 > a1) {
+            for(int32_t i = 2; i < 8; i++) {
+                palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+            }
+        } else {
+            for(int32_t i = 2; i < 6; i++) {
+                palette[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    uint32_t fitAlpha(const Block block, int32_t a0, int32_t a1, uint64_t &indices) {
+        int32_t palette[8];
+        paletteAlpha(a0, a1, palette);
+
+        uint32_t error = 0;
+        indices = 0;
+        for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+            uint32_t best = UINT32_MAX;
+            uint64_t index = 0;
+            for(int32_t p = 0; p < 8; p++) {
+                int32_t d = palette[p] - block[i][3];
+                if(static_cast<uint32_t>(d * d) < best) {
+                    best = d * d;
+                    index = p;
+                }
+            }
+            error += best;
+            indices |= index << (3 * i);
+        }
+        return error;
+    }
+
+    void encodeAlpha(const Block block, int32_t quality, uint8_t *out) {
+        int32_t minimum = 255, maximum = 0;
+        int32_t inner0 = 255, inner1 = 0;
+        for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+            int32_t a = block[i][3];
+            minimum = MIN(minimum, a);
+            maximum = MAX(maximum, a);
+            if(a != 0 && a != 255) {
+                inner0 = MIN(inner0, a);
+                inner1 = MAX(inner1, a);
+            }
+        }
+
+        int32_t a0 = maximum;
+        int32_t a1 = minimum;
+        uint64_t indices;
+        uint32_t error = fitAlpha(block, a0, a1, indices);
+
+        // Six values mode has the exact 0 and 255 which is good for the cutout edges
+        if(quality == TextureEncoder::Best && error > 0 && inner0 <= inner1) {
+            uint64_t n;
+            uint32_t e = fitAlpha(block, inner0, inner1, n);
+            if(e < error) {
+                a0 = inner0;
+                a1 = inner1;
+                indices = n;
+            }
+        }
+
+        out[0] = a0;
+        out[1] = a1;
+        for(int32_t i = 0; i < 6; i++) {
+            out[2 + i] = (indices >> (8 * i)) & 0xff;
+        }
+    }
+
+    void decodeAlpha(const uint8_t *in, Block block) {
+        int32_t palette[8];
+        paletteAlpha(in[0], in[1], palette);
+
+        uint64_t indices = 0;
+        for(int32_t i = 0; i < 6; i++) {
+            indices |= static_cast<uint64_t>(in[2 + i]) << (8 * i);
+        }
+        for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+            block[i][3] = palette[(indices >> (3 * i)) & 7];
+        }
+    }
+
+    // ETC2 RGB block (individual and differential modes)
+
+    inline int32_t etcModifier(int32_t table, int32_t index) {
+        int32_t value = etcModifiers[table][index & 1];
+        return (index & 2) ? -value : value;
+    }
+
+    uint32_t fitEtcSubblock(const Block block, const int32_t *pixels, const int32_t *base, uint32_t &table, uint8_t *selectors) {
+        uint32_t result = UINT32_MAX;
+        for(int32_t t = 0; t < 8; t++) {
+            uint32_t error = 0;
+            uint8_t current[8];
+            for(int32_t p = 0; p < 8 && error < result; p++) {
+                const uint8_t *pixel = block[pixels[p]];
+                uint32_t best = UINT32_MAX;
+                for(int32_t s = 0; s < 4; s++) {
+                    int32_t m = etcModifier(t, s);
+                    int32_t color[3] = {clampByte(base[0] + m), clampByte(base[1] + m), clampByte(base[2] + m)};
+                    uint32_t d = distance(color, pixel, 3);
+                    if(d < best) {
+                        best = d;
+                        current[p] = s;
+                    }
+                }
+                error += best;
+            }
+            if(error < result) {
+                result = error;
+                table = t;
+                for(int32_t p = 0; p < 8; p++) {
+                    selectors[pixels[p]] = current[p];
+                }
+            }
+        }
+        return result;
+    }
+
+    inline int32_t expand4(int32_t value) {
+        return (value << 4) | value;
+    }
+
+    inline int32_t expand5(int32_t value) {
+        return (value << 3) | (value >> 2);
+    }
+
+    struct EtcCandidate {
+        int32_t color[2][3];
+
+        uint32_t table[2];
+
+        uint8_t selectors[BLOCK_PIXELS];
+
+        uint32_t error;
+
+        bool differential;
+
+        bool flip;
+    };
+    /*
+        Searches the best quantized base color of the subblock around the average \a color.
+        The \a reference is used to keep the difference of the colors in the differential mode.
+    */
+    uint32_t searchEtcBase(const Block block, const int32_t *pixels, const float *color, int32_t bits, int32_t range, const int32_t *reference,
+                           int32_t *result, uint32_t &table, uint8_t *selectors) {
+        int32_t levels = (1 << bits) - 1;
+        int32_t center[3];
+        for(int32_t c = 0; c < 3; c++) {
+            center[c] = CLAMP(static_cast<int32_t>(color[c] * levels / 255.0f + 0.5f), 0, levels);
+            if(reference) {
+                center[c] = CLAMP(center[c], reference[c] - 4, reference[c] + 3);
+            }
+        }
+
+        uint32_t error = UINT32_MAX;
+        for(int32_t r = -range; r <= range; r++) {
+            for(int32_t g = -range; g <= range; g++) {
+                for(int32_t b = -range; b <= range; b++) {
+                    int32_t q[3] = {center[0] + r, center[1] + g, center[2] + b};
+                    bool valid = true;
+                    for(int32_t c = 0; c < 3; c++) {
+                        valid &= (q[c] >= 0 && q[c] <= levels);
+                        if(reference) {
+                            int32_t d = q[c] - reference[c];
+                            valid &= (d >= -4 && d <= 3);
+                        }
+                    }
+                    if(!valid) {
+                        continue;
+                    }
+                    int32_t base[3];
+                    for(int32_t c = 0; c < 3; c++) {
+                        base[c] = (bits == 4) ? expand4(q[c]) : expand5(q[c]);
+                    }
+                    uint32_t t;
+                    uint8_t s[BLOCK_PIXELS];
+                    uint32_t e = fitEtcSubblock(block, pixels, base, t, s);
+                    if(e < error) {
+                        error = e;
+                        table = t;
+                        memcpy(result, q, sizeof(q));
+                        for(int32_t p = 0; p < 8; p++) {
+                            selectors[pixels[p]] = s[pixels[p]];
+                        }
+                    }
+                }
+            }
+        }
+        return error;
+    }
+
+    void encodeEtc(const Block block, int32_t quality, uint8_t *out) {
+        int32_t range = (quality == TextureEncoder::Best) ? 1 : 0;
+
+        EtcCandidate best;
+        best.error = UINT32_MAX;
+
+        for(int32_t flip = 0; flip < 2; flip++) {
+            int32_t pixels[2][8];
+            float average[2][3];
+            for(int32_t s = 0; s < 2; s++) {
+                int32_t n = 0;
+                for(int32_t y = 0; y < 4; y++) {
+                    for(int32_t x = 0; x < 4; x++) {
+                        if(((flip) ? y : x) / 2 == s) {
+                            pixels[s][n++] = y * 4 + x;
+                        }
+                    }
+                }
+                for(int32_t c = 0; c < 3; c++) {
+                    float sum = 0.0f;
+                    for(int32_t p = 0; p < 8; p++) {
+                        sum += block[pixels[s][p]][c];
+                    }
+                    average[s][c] = sum / 8.0f;
+                }
+            }
+
+            for(int32_t mode = 0; mode < 2; mode++) {
+                if(quality == TextureEncoder::Fast && mode == 0 && flip == 1) {
+                    continue;
+                }
+                EtcCandidate candidate;
+                candidate.flip = flip;
+                candidate.differential = (mode == 1);
+
+                int32_t bits = (candidate.differential) ? 5 : 4;
+                uint32_t e0 = searchEtcBase(block, pixels[0], average[0], bits, range, nullptr,
+                                            candidate.color[0], candidate.table[0], candidate.selectors);
+                uint32_t e1 = searchEtcBase(block, pixels[1], average[1], bits, range,
+                                            (candidate.differential) ? candidate.color[0] : nullptr,
+                                            candidate.color[1], candidate.table[1], candidate.selectors);
+                candidate.error = e0 + e1;
+                if(candidate.error < best.error) {
+                    best = candidate;
+                }
+            }
+        }
+
+        uint32_t high = (best.table[0] << 5) | (best.table[1] << 2) | (best.differential << 1) | best.flip;
+        if(best.differential) {
+            for(int32_t c = 0; c < 3; c++) {
+                int32_t d = best.color[1][c] - best.color[0][c];
+                high |= (best.color[0][c] << (27 - c * 8)) | ((d & 7) << (24 - c * 8));
+            }
+        } else {
+            for(int32_t c = 0; c < 3; c++) {
+                high |= (best.color[0][c] << (28 - c * 8)) | (best.color[1][c] << (24 - c * 8));
+            }
+        }
+
+        uint32_t low = 0;
+        for(int32_t y = 0; y < 4; y++) {
+            for(int32_t x = 0; x < 4; x++) {
+                uint32_t s = best.selectors[y * 4 + x];
+                int32_t j = x * 4 + y;
+                low |= ((s >> 1) << (j + 16)) | ((s & 1) << j);
+            }
+        }
+
+        for(int32_t i = 0; i < 4; i++) {
+            out[i] = (high >> (24 - i * 8)) & 0xff;
+            out[4 + i] = (low >> (24 - i * 8)) & 0xff;
+        }
+    }
+
+    void decodeEtc(const uint8_t *in, Block block) {
+        uint32_t high = (in[0] << 24) | (in[1] << 16) | (in[2] << 8) | in[3];
+        uint32_t low = (in[4] << 24) | (in[5] << 16) | (in[6] << 8) | in[7];
+
+        bool flip = high & 1;
+        bool differential = (high >> 1) & 1;
+        int32_t table[2] = {static_cast<int32_t>((high >> 5) & 7), static_cast<int32_t>((high >> 2) & 7)};
+
+        int32_t base[2][3];
+        for(int32_t c = 0; c < 3; c++) {
+            if(differential) {
+                int32_t c0 = (high >> (27 - c * 8)) & 31;
+                int32_t d = (high >> (24 - c * 8)) & 7;
+                d = (d >= 4) ? d - 8 : d;
+                // T, H and planar modes use the overflow of this value, they are never produced by the encoder
+                base[0][c] = expand5(c0);
+                base[1][c] = expand5(CLAMP(c0 + d, 0, 31));
+            } else {
+                base[0][c] = expand4((high >> (28 - c * 8)) & 15);
+                base[1][c] = expand4((high >> (24 - c * 8)) & 15);
+            }
+        }
+
+        for(int32_t y = 0; y < 4; y++) {
+            for(int32_t x = 0; x < 4; x++) {
+                int32_t j = x * 4 + y;
+                int32_t s = (((low >> (j + 16)) & 1) << 1) | ((low >> j) & 1);
+                int32_t sub = ((flip) ? y : x) / 2;
+                int32_t m = etcModifier(table[sub], s);
+                uint8_t *pixel = block[y * 4 + x];
+                for(int32_t c = 0; c < 3; c++) {
+                    pixel[c] = clampByte(base[sub][c] + m);
+                }
+                pixel[3] = 255;
+            }
+        }
+    }
+
+    // ETC2 EAC alpha block
+
+    uint32_t fitEac(const Block block, int32_t base, int32_t multiplier, int32_t table, uint64_t &indices) {
+        uint32_t error = 0;
+        indices = 0;
+        for(int32_t y = 0; y < 4; y++) {
+            for(int32_t x = 0; x < 4; x++) {
+                int32_t a = block[y * 4 + x][3];
+                uint32_t best = UINT32_MAX;
+                uint64_t index = 0;
+                for(int32_t p = 0; p < 8; p++) {
+                    int32_t d = clampByte(base + eacModifiers[table][p] * multiplier) - a;
+                    if(static_cast<uint32_t>(d * d) < best) {
+                        best = d * d;
+                        index = p;
+                    }
+                }
+                error += best;
+                indices |= index << (45 - 3 * (x * 4 + y));
+            }
+        }
+        return error;
+    }
+
+    void encodeEac(const Block block, int32_t quality, uint8_t *out) {
+        int32_t minimum = 255, maximum = 0;
+        for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+            minimum = MIN(minimum, static_cast<int32_t>(block[i][3]));
+            maximum = MAX(maximum, static_cast<int32_t>(block[i][3]));
+        }
+
+        int32_t range = (quality == TextureEncoder::Fast) ? 0 : ((quality == TextureEncoder::Best) ? 2 : 1);
+
+        uint32_t error = UINT32_MAX;
+        int32_t base = maximum, multiplier = 1, table = 13;
+        uint64_t indices = 0;
+        for(int32_t t = 0; t < 16 && error > 0; t++) {
+            int32_t low = eacModifiers[t][3];
+            int32_t high = eacModifiers[t][7];
+            int32_t m0 = MAX(static_cast<int32_t>((maximum - minimum) / float(high - low) + 0.5f), 1);
+            for(int32_t m = MAX(m0 - range, 1); m <= MIN(m0 + range, 15); m++) {
+                int32_t b0 = static_cast<int32_t>((maximum + minimum) * 0.5f - (high + low) * m * 0.5f + 0.5f);
+                for(int32_t b = MAX(b0 - range, 0); b <= MIN(b0 + range, 255); b++) {
+                    uint64_t n;
+                    uint32_t e = fitEac(block, b, m, t, n);
+                    if(e < error) {
+                        error = e;
+                        base = b;
+                        multiplier = m;
+                        table = t;
+                        indices = n;
+                    }
+                }
+            }
+        }
+
+        out[0] = base;
+        out[1] = (multiplier << 4) | table;
+        for(int32_t i = 0; i < 6; i++) {
+            out[2 + i] = (indices >> (40 - i * 8)) & 0xff;
+        }
+    }
+
+    void decodeEac(const uint8_t *in, Block block) {
+        int32_t base = in[0];
+        int32_t multiplier = in[1] >> 4;
+        int32_t table = in[1] & 15;
+        uint64_t indices = 0;
+        for(int32_t i = 0; i < 6; i++) {
+            indices = (indices << 8) | in[2 + i];
+        }
+        for(int32_t y = 0; y < 4; y++) {
+            for(int32_t x = 0; x < 4; x++) {
+                int32_t index = (indices >> (45 - 3 * (x * 4 + y))) & 7;
+                block[y * 4 + x][3] = clampByte(base + eacModifiers[table][index] * multiplier);
+            }
+        }
+    }
+
+    // BC7 block (mode 6 only)
+
+    class BitStream {
+    public:
+        explicit BitStream(uint8_t *data) :
+            m_pData(data),
+            m_Position(0) {
+
+        }
+
+        void write(uint32_t value, int32_t bits) {
+            for(int32_t i = 0; i < bits; i++) {
+                if((value >> i) & 1) {
+                    m_pData[m_Position >> 3] |= 1 << (m_Position & 7);
+                }
+                m_Position++;
+            }
+        }
+
+        uint32_t read(int32_t bits) {
+            uint32_t result = 0;
+            for(int32_t i = 0; i < bits; i++) {
+                result |= ((m_pData[m_Position >> 3] >> (m_Position & 7)) & 1) << i;
+                m_Position++;
+            }
+            return result;
+        }
+
+    protected:
+        uint8_t *m_pData;
+
+        int32_t m_Position;
+    };
+
+    uint32_t fitBC7(const Block block, const int32_t *e0, const int32_t *e1, uint8_t *indices) {
+        int32_t palette[16][4];
+        for(int32_t i = 0; i < 16; i++) {
+            for(int32_t c = 0; c < 4; c++) {
+                palette[i][c] = ((64 - bc7Weights[i]) * e0[c] + bc7Weights[i] * e1[c] + 32) >> 6;
+            }
+        }
+
+        uint32_t error = 0;
+        for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+            uint32_t best = UINT32_MAX;
+            for(int32_t p = 0; p < 16; p++) {
+                uint32_t d = distance(palette[p], block[i], 4);
+                if(d < best) {
+                    best = d;
+                    indices[i] = p;
+                }
+            }
+            error += best;
+        }
+        return error;
+    }
+
+    uint32_t quantizeBC7(const Block block, const float *f0, const float *f1, int32_t q[2][4], int32_t p[2], uint8_t *indices) {
+        uint32_t error = UINT32_MAX;
+        for(int32_t pbits = 0; pbits < 4; pbits++) {
+            int32_t p0 = pbits & 1;
+            int32_t p1 = pbits >> 1;
+            int32_t n[2][4];
+            int32_t e0[4], e1[4];
+            for(int32_t c = 0; c < 4; c++) {
+                n[0][c] = CLAMP(static_cast<int32_t>((f0[c] - p0) * 0.5f + 0.5f), 0, 127);
+                n[1][c] = CLAMP(static_cast<int32_t>((f1[c] - p1) * 0.5f + 0.5f), 0, 127);
+                e0[c] = (n[0][c] << 1) | p0;
+                e1[c] = (n[1][c] << 1) | p1;
+            }
+            uint8_t current[BLOCK_PIXELS];
+            uint32_t e = fitBC7(block, e0, e1, current);
+            if(e < error) {
+                error = e;
+                memcpy(q, n, sizeof(n));
+                p[0] = p0;
+                p[1] = p1;
+                memcpy(indices, current, BLOCK_PIXELS);
+            }
+        }
+        return error;
+    }
+
+    void encodeBC7(const Block block, int32_t quality, uint8_t *out) {
+        float f0[4], f1[4];
+        findEndpoints(block, 4, quality, f0, f1);
+
+        int32_t q[2][4];
+        int32_t p[2];
+        uint8_t indices[BLOCK_PIXELS];
+        uint32_t error = quantizeBC7(block, f0, f1, q, p, indices);
+
+        if(quality == TextureEncoder::Best) {
+            for(int32_t it = 0; it < 2 && error > 0; it++) {
+                float w[BLOCK_PIXELS];
+                for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+                    w[i] = 1.0f - bc7Weights[indices[i]] / 64.0f;
+                }
+                if(!refineEndpoints(block, 4, w, f0, f1)) {
+                    break;
+                }
+                int32_t nq[2][4];
+                int32_t np[2];
+                uint8_t ni[BLOCK_PIXELS];
+                uint32_t e = quantizeBC7(block, f0, f1, nq, np, ni);
+                if(e >= error) {
+                    break;
+                }
+                error = e;
+                memcpy(q, nq, sizeof(q));
+                memcpy(p, np, sizeof(p));
+                memcpy(indices, ni, sizeof(indices));
+            }
+        }
+
+        // The most significant bit of the first index is implicit zero
+        if(indices[0] & 8) {
+            for(int32_t c = 0; c < 4; c++) {
+                std::swap(q[0][c], q[1][c]);
+            }
+            std::swap(p[0], p[1]);
+            for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+                indices[i] = 15 - indices[i];
+            }
+        }
+
+        memset(out, 0, 16);
+        BitStream stream(out);
+        stream.write(1 << 6, 7);
+        for(int32_t c = 0; c < 4; c++) {
+            stream.write(q[0][c], 7);
+            stream.write(q[1][c], 7);
+        }
+        stream.write(p[0], 1);
+        stream.write(p[1], 1);
+        for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+            stream.write(indices[i], (i == 0) ? 3 : 4);
+        }
+    }
+
+    void decodeBC7(const uint8_t *in, Block block) {
+        uint8_t data[16];
+        memcpy(data, in, 16);
+        BitStream stream(data);
+        if(stream.read(7) != (1 << 6)) {
+            memset(block, 0, sizeof(Block));
+            return;
+        }
+        int32_t e[2][4];
+        for(int32_t c = 0; c < 4; c++) {
+            e[0][c] = stream.read(7) << 1;
+            e[1][c] = stream.read(7) << 1;
+        }
+        int32_t p0 = stream.read(1);
+        int32_t p1 = stream.read(1);
+        for(int32_t c = 0; c < 4; c++) {
+            e[0][c] |= p0;
+            e[1][c] |= p1;
+        }
+        for(int32_t i = 0; i < BLOCK_PIXELS; i++) {
+            int32_t w = bc7Weights[stream.read((i == 0) ? 3 : 4)];
+            for(int32_t c = 0; c < 4; c++) {
+                block[i][c] = ((64 - w) * e[0][c] + w * e[1][c] + 32) >> 6;
+            }
+        }
+    }
+
+    void encodeBlock(const Block block, int32_t compression, uint8_t channels, int32_t quality, uint8_t *out) {
+        switch(compression) {
+            case Texture::DXT1: {
+                encodeBC1(block, quality, out);
+            } break;
+            case Texture::DXT5: {
+                encodeAlpha(block, quality, out);
+                encodeBC1(block, quality, out + 8);
+            } break;
+            case Texture::ETC2: {
+                if(channels == 4) {
+                    encodeEac(block, quality, out);
+                    out += 8;
+                }
+                encodeEtc(block, quality, out);
+            } break;
+            case Texture::BC7: {
+                encodeBC7(block, quality, out);
+            } break;
+            default: break;
+        }
+    }
+
+    void decodeBlock(const uint8_t *in, int32_t compression, uint8_t channels, Block block) {
+        switch(compression) {
+            case Texture::DXT1: {
+                decodeBC1(in, false, block);
+            } break;
+            case Texture::DXT5: {
+                decodeBC1(in + 8, true, block);
+                decodeAlpha(in, block);
+            } break;
+            case Texture::ETC2: {
+                decodeEtc(in + ((channels == 4) ? 8 : 0), block);
+                if(channels == 4) {
+                    decodeEac(in, block);
+                }
+            } break;
+            case Texture::BC7: {
+                decodeBC7(in, block);
+            } break;
+            default: break;
+        }
+    }
+
+    class EncodeTask : public Object {
+    public:
+        EncodeTask(const uint8_t *rgba, int32_t width, int32_t height, int32_t compression, uint8_t channels, int32_t quality, uint8_t *out) :
+                m_pSource(rgba),
+                m_pOut(out),
+                m_Width(width),
+                m_Height(height),
+                m_Compression(compression),
+                m_Quality(quality),
+                m_First(0),
+                m_Last(0),
+                m_Channels(channels) {
+
+        }
+
+        void setRows(int32_t first, int32_t last) {
+            m_First = first;
+            m_Last = last;
+        }
+
+        void processEvents() override {
+            int32_t columns = (m_Width + 3) / 4;
+            int32_t size = TextureEncoder::blockSize(m_Compression, m_Channels);
+
+            Block block;
+            for(int32_t y = m_First; y < m_Last; y++) {
+                for(int32_t x = 0; x < columns; x++) {
+                    fetchBlock(m_pSource, m_Width, m_Height, x, y, block);
+                    encodeBlock(block, m_Compression, m_Channels, m_Quality, &m_pOut[(y * columns + x) * size]);
+                }
+            }
+        }
+
+    protected:
+        const uint8_t *m_pSource;
+
+        uint8_t *m_pOut;
+
+        int32_t m_Width;
+
+        int32_t m_Height;
+
+        int32_t m_Compression;
+
+        int32_t m_Quality;
+
+        int32_t m_First;
+
+        int32_t m_Last;
+
+        uint8_t m_Channels;
+    };
+}
+
+/*!
+    \class TextureEncoder
+    \brief Encodes images to the block-compressed texture formats.
+    \inmodule Editor
+
+    The TextureEncoder converts RGBA images to one of the Texture::CompressionType formats on CPU.
+    Each 4x4 block is encoded independently, so large images are split between several threads.
+
+    Supported formats:
+    \list
+        \li Texture::DXT1 - BC1 RGB, 8 bytes per block.
+        \li Texture::DXT5 - BC3 RGBA, 16 bytes per block.
+        \li Texture::ETC2 - ETC2 RGB (8 bytes per block) or ETC2 RGBA with EAC alpha (16 bytes per block).
+        \li Texture::BC7 - BC7 RGBA, 16 bytes per block. Only the mode 6 is used by the encoder.
+    \endlist
+*/
+
+/*!
+    \enum TextureEncoder::Quality
+
+    \value Fast \c The endpoints are taken from the bounding box of block colors.
+    \value Normal \c The endpoints are taken from the principal axis of block colors.
+    \value Best \c The endpoints are refined with a least squares fit and a wider search is used for ETC2.
+*/
+
+/*!
+    Encodes the \a rgba image with \a width and \a height dimensions to the \a compression format.
+    The \a rgba data must contain 4 bytes per pixel, the number of \a channels (3 or 4) defines whether the alpha channel should be stored.
+    The encoding \a quality is one of TextureEncoder::Quality values.
+    If the thread \a pool is provided and the image is big enough, the rows of blocks are split between the pool threads.
+    The same pool can be reused for all the images and levels of one conversion.
+    Returns the encoded data or an empty array in case of unsupported \a compression.
+*/
+ByteArray TextureEncoder::encode(const uint8_t *rgba, int32_t width, int32_t height, int32_t compression, uint8_t channels, int32_t quality, ThreadPool *pool) {
+    ByteArray result;
+    int32_t size = surfaceSize(width, height, compression, channels);
+    if(size == 0 || rgba == nullptr) {
+        return result;
+    }
+    result.resize(size);
+
+    int32_t rows = (height + 3) / 4;
+
+    uint32_t threads = (pool) ? MIN(pool->maxThreads(), static_cast<uint32_t>(rows / MIN_PARALLEL_ROWS)) : 1;
+
+    uint8_t *out = reinterpret_cast<uint8_t *>(&result[0]);
+    if(threads <= 1) {
+        EncodeTask task(rgba, width, height, compression, channels, quality, out);
+        task.setRows(0, rows);
+        task.processEvents();
+    } else {
+        list<EncodeTask> tasks;
+        int32_t step = (rows + threads - 1) / threads;
+        for(int32_t first = 0; first < rows; first += step) {
+            tasks.emplace_back(rgba, width, height, compression, channels, quality, out);
+            tasks.back().setRows(first, MIN(first + step, rows));
+            pool->start(tasks.back());
+        }
+        pool->waitForDone();
+    }
+
+    return result;
+}
+/*!
+    Decodes the compressed \a data with \a width and \a height dimensions from the \a compression format to RGBA image.
+    The number of \a channels must be the same as it was used for encoding.
+    Returns the decoded RGBA data with 4 bytes per pixel.
+    \note Only the blocks which can be produced by the encoder are supported: BC7 mode 6, ETC2 individual and differential modes.
+*/
+ByteArray TextureEncoder::decode(const ByteArray &data, int32_t width, int32_t height, int32_t compression, uint8_t channels) {
+    ByteArray result;
+    int32_t size = surfaceSize(width, height, compression, channels);
+    if(size == 0 || static_cast<int32_t>(data.size()) < size) {
+        return result;
+    }
+    result.resize(width * height * 4);
+
+    int32_t columns = (width + 3) / 4;
+    int32_t rows = (height + 3) / 4;
+    int32_t block = blockSize(compression, channels);
+
+    const uint8_t *in = reinterpret_cast<const uint8_t *>(&data[0]);
+    uint8_t *out = reinterpret_cast<uint8_t *>(&result[0]);
+
+    Block pixels;
+    for(int32_t y = 0; y < rows; y++) {
+        for(int32_t x = 0; x < columns; x++) {
+            decodeBlock(&in[(y * columns + x) * block], compression, channels, pixels);
+            storeBlock(out, width, height, x, y, pixels);
+        }
+    }
+    return result;
+}
+/*!
+    Returns the size of one 4x4 block in bytes for the \a compression format with the number of \a channels.
+    Returns 0 for the uncompressed data.
+*/
+int32_t TextureEncoder::blockSize(int32_t compression, uint8_t channels) {
+    switch(compression) {
+        case Texture::DXT1: return 8;
+        case Texture::DXT5: return 16;
+        case Texture::ETC2: return (channels == 4) ? 16 : 8;
+        case Texture::BC7:  return 16;
+        default: break;
+    }
+    return 0;
+}
+/*!
+    Returns the size in bytes of the compressed image with \a width and \a height dimensions for the \a compression format with the number of \a channels.
+*/
+int32_t TextureEncoder::surfaceSize(int32_t width, int32_t height, int32_t compression, uint8_t channels) {
+    return ((width + 3) / 4) * ((height + 3) / 4) * blockSize(compression, channels);
+}
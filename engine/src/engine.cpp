@@ -21,6 +21,7 @@
 #include "components/scene.h"
 #include "components/actor.h"
 #include "components/transform.h"
+#include "components/private/transformhierarchy.h"
 #include "components/camera.h"
 
 #include "components/armature.h"
@@ -48,10 +49,15 @@
 #include "resources/map.h"
 
 #include "systems/resourcesystem.h"
+#include "systems/rendersystem.h"
+
+#include "assetindex.h"
+#include "staticbatcher.h"
 
 #include "log.h"
 
 static const char *gIndex("index");
+static const char *gBinaryIndex("index.bin");
 
 static const char *gVersion("version");
 static const char *gContent("content");
@@ -60,6 +66,7 @@ static const char *gSettings("settings");
 static const char *gEntry(".entry");
 static const char *gCompany(".company");
 static const char *gProject(".project");
+static const char *gPipelined(".pipelined");
 
 static const char *TRANSFORM("Transform");
 
@@ -75,6 +82,11 @@ public:
     ~EnginePrivate() {
         m_Values.clear();
 
+        if(m_pIndexFile) {
+            m_pFile->_fclose(m_pIndexFile);
+            m_pIndexFile = nullptr;
+        }
+
         if(m_pPlatform) {
             m_pPlatform->destroy();
             delete m_pPlatform;
@@ -100,6 +112,8 @@ public:
 
     static File             *m_pFile;
 
+    static _FILE            *m_pIndexFile;
+
     string                   m_EntryLevel;
 
     static bool              m_Game;
@@ -124,6 +138,7 @@ public:
 };
 
 File *EnginePrivate::m_pFile   = nullptr;
+_FILE *EnginePrivate::m_pIndexFile = nullptr;
 
 bool              EnginePrivate::m_Game = false;
 VariantMap        EnginePrivate::m_Values;
@@ -167,6 +182,13 @@ typedef Vector4 Color;
 
     \sa unloadResource()
 */
+/*!
+    \fn T *Engine::loadResource(uint64_t hash)
+
+    Returns an instance of type T for loading resource by the provided path \a hash.
+
+    \sa AssetIndex::hash()
+*/
 /*!
     Constructs Engine.
     Using \a file and \a path parameters creates necessary platform adapters, register basic component types and resource types.
@@ -233,15 +255,18 @@ Engine::~Engine() {
 }
 /*!
     Initializes all engine systems. Returns true if successful; otherwise returns false.
+    \note A platform specific adaptor will be created only in case of no adaptor was set by setPlatformAdaptor() before this call.
 */
 bool Engine::init() {
     PROFILE_FUNCTION();
 
+    if(EnginePrivate::m_pPlatform == nullptr) {
 #ifdef THUNDER_MOBILE
-    EnginePrivate::m_pPlatform = new MobileAdaptor(this);
+        EnginePrivate::m_pPlatform = new MobileAdaptor(this);
 #else
-    EnginePrivate::m_pPlatform = new DesktopAdaptor(this);
+        EnginePrivate::m_pPlatform = new DesktopAdaptor(this);
 #endif
+    }
     bool result = EnginePrivate::m_pPlatform->init();
 
     Timer::init();
@@ -254,6 +279,7 @@ bool Engine::init() {
 /*!
     Starts the main game cycle.
     Also this method loads the first level of your game.
+    If the \c .pipelined setting is true, the frames are drawn on the separate render thread, see RenderSystem::setPipelined().
     Returns true if successful; otherwise returns false.
 */
 bool Engine::start() {
@@ -279,10 +305,11 @@ bool Engine::start() {
     EnginePrivate::m_Game = true;
 
     string path = value(gEntry, "").toString();
-    Log(Log::DBG) << "Level:" << path.c_str() << "loading...";
+    A_LOG(Log::DBG) << "Level:" << path.c_str() << "loading...";
     Actor *level = loadResource<Actor>(path);
     if(level) {
         level->setParent(p_ptr->m_pScene);
+        StaticBatcher::combine(level);
     } else {
         Log(Log::ERR) << "Unable to load" << path.c_str();
         p_ptr->m_pPlatform->stop();
@@ -291,7 +318,7 @@ bool Engine::start() {
 
     Camera *component   = p_ptr->m_pScene->findChild<Camera *>();
     if(component == nullptr) {
-        Log(Log::DBG) << "Camera not found creating new one.";
+        A_LOG(Log::DBG) << "Camera not found creating new one.";
         Actor *camera = Engine::objectCreate<Actor>("ActiveCamera", p_ptr->m_pScene);
         camera->addComponent("Transform");
         camera->transform()->setPosition(Vector3(0.0f));
@@ -302,11 +329,28 @@ bool Engine::start() {
     resize();
 
 #ifndef THUNDER_MOBILE
+    RenderSystem *render = nullptr;
+    if(value(gPipelined, false).toBool()) {
+        for(auto it : EnginePrivate::m_Serial) {
+            render = dynamic_cast<RenderSystem *>(it);
+            if(render) {
+                break;
+            }
+        }
+        if(render && !render->setPipelined(p_ptr->m_pPlatform)) {
+            Log(Log::WRN) << "Pipelined rendering is not supported by the platform";
+            render = nullptr;
+        }
+    }
+
     while(p_ptr->m_pPlatform->isValid()) {
         Timer::update();
 
         update(p_ptr->m_pScene);
     }
+    if(render) {
+        render->setPipelined(nullptr);
+    }
     p_ptr->m_pPlatform->stop();
 #endif
     return true;
@@ -325,13 +369,21 @@ void Engine::resize() {
 /*!
     This method launches all your game modules responsible for processing all the game logic.
     It calls on each iteration of the game cycle for the provided \a scene.
+    The fixed simulation steps accumulated by the Timer are processed first, followed by the variable step update.
+    World transforms modified by the game logic are recalculated before the systems are launched.
     \note Usually, this method calls internally and must not be called manually.
 */
 void Engine::update(Scene *scene) {
     PROFILE_FUNCTION();
 
+    for(int32_t i = 0; i < Timer::fixedSteps(); i++) {
+        fixedUpdate(scene);
+    }
+
     processEvents();
 
+    TransformHierarchy::instance()->update(&p_ptr->m_ThreadPool);
+
     for(auto it : EnginePrivate::m_Pool) {
         it->setActiveScene(scene);
         p_ptr->m_ThreadPool.start(*it);
@@ -365,6 +417,29 @@ void Engine::processEvents() {
         }
     }
 }
+/*!
+    \internal
+    Processes a single fixed simulation step for the provided \a scene.
+*/
+void Engine::fixedUpdate(Scene *scene) {
+    PROFILE_FUNCTION();
+
+    if(isGameMode()) {
+        for(auto it : m_ObjectList) {
+            NativeBehaviour *comp = dynamic_cast<NativeBehaviour *>(it);
+            if(comp && comp->isStarted() && comp->isEnabled() && comp->actor() && comp->actor()->scene() == scene) {
+                comp->fixedUpdate();
+            }
+        }
+    }
+
+    for(auto it : EnginePrivate::m_Pool) {
+        it->fixedUpdate(scene);
+    }
+    for(auto it : EnginePrivate::m_Serial) {
+        it->fixedUpdate(scene);
+    }
+}
 /*!
     \internal
 */
@@ -425,6 +500,21 @@ Object *Engine::loadResource(const string &path) {
 
     return EnginePrivate::m_pResourceSystem->loadResource(path);
 }
+/*!
+    Returns an instance for loading resource by the provided path \a hash.
+    The hash for the literal paths can be calculated at compile time with AssetIndex::hash().
+
+    \sa loadResource()
+*/
+Object *Engine::loadResource(uint64_t hash) {
+    PROFILE_FUNCTION();
+
+    const char *uuid = EnginePrivate::m_pResourceSystem->assetIndex().uuid(hash);
+    if(uuid) {
+        return EnginePrivate::m_pResourceSystem->loadResource(uuid);
+    }
+    return nullptr;
+}
 /*!
     Force unloads the resource located along the \a path from memory.
     \warning After this call, the reference on the resource may become an invalid at any time and must not be used anymore.
@@ -497,8 +587,52 @@ bool Engine::reloadBundle() {
     ResourceSystem::DictionaryMap &indices = EnginePrivate::m_pResourceSystem->indices();
     indices.clear();
 
+    AssetIndex &index = EnginePrivate::m_pResourceSystem->assetIndex();
+    index.close();
+
     File *file = Engine::file();
-    _FILE *fp = file->_fopen(gIndex, "r");
+    if(EnginePrivate::m_pIndexFile) {
+        file->_fclose(EnginePrivate::m_pIndexFile);
+        EnginePrivate::m_pIndexFile = nullptr;
+    }
+
+    // Only the packaged projects have the binary index
+    _FILE *fp = nullptr;
+    if(file->_exists(gBinaryIndex)) {
+        fp = file->_fopen(gBinaryIndex, "r");
+    }
+    if(fp) {
+        // The index from a package is used in place; the file stays open to keep the mapping valid
+        const uint8_t *data = file->_fmap(fp);
+        bool result = false;
+        if(data) {
+            result = index.open(data, file->_fsize(fp));
+            if(result) {
+                EnginePrivate::m_pIndexFile = fp;
+            }
+        } else {
+            vector<uint8_t> buffer(file->_fsize(fp));
+            file->_fread(buffer.data(), buffer.size(), 1, fp);
+            result = index.load(buffer);
+        }
+        if(EnginePrivate::m_pIndexFile == nullptr) {
+            file->_fclose(fp);
+        }
+
+        if(result) {
+            for(uint32_t i = 0; i < index.settingsCount(); i++) {
+                EnginePrivate::m_Values[index.settingKey(i)] = index.settingValue(i);
+            }
+
+            EnginePrivate::m_Application = value(gProject, "").toString();
+            EnginePrivate::m_Organization = value(gCompany, "").toString();
+
+            return true;
+        }
+        Log(Log::ERR) << "Invalid binary index";
+    }
+
+    fp = file->_fopen(gIndex, "r");
     if(fp) {
         ByteArray data;
         data.resize(file->_fsize(fp));
@@ -523,9 +657,14 @@ bool Engine::reloadBundle() {
                     indices[path] = pair<string, string>(type, it.first);
                 }
 
+                AssetIndex::Settings settings;
                 for(auto it : root[gSettings].toMap()) {
                     EnginePrivate::m_Values[it.first] = it.second;
+                    settings[it.first] = it.second.toString();
                 }
+                // Builds the same lookup table as the packaged index; the builder stores it as is
+                vector<uint8_t> buffer = AssetIndex::build(indices, settings);
+                index.load(buffer);
 
                 EnginePrivate::m_Application = value(gProject, "").toString();
                 EnginePrivate::m_Organization = value(gCompany, "").toString();
@@ -1,9 +1,48 @@
 #include "file.h"
 
 #include "log.h"
+#include "package.h"
 
 #include <physfs.h>
 
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+struct FileHandle {
+    FileHandle() :
+            file(nullptr),
+            data(nullptr),
+            size(0),
+            pos(0) {
+
+    }
+
+    PHYSFS_file *file;
+
+    const uint8_t *data;
+
+    _size_t size;
+
+    _size_t pos;
+
+    vector<uint8_t> buffer;
+};
+
+static vector<Package *> s_Packages;
+
+static const Package::Entry *findEntry(const char *path, Package *&package) {
+    // The packages mounted later override the previous ones
+    for(auto it = s_Packages.rbegin(); it != s_Packages.rend(); ++it) {
+        const Package::Entry *entry = (*it)->find(path);
+        if(entry) {
+            package = *it;
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
 /*!
     \class File
     \brief Basic file system I/O module.
@@ -15,6 +54,9 @@
     You can check for a file's existence using _exists(), and remove a file using _delete().
     You can create a directory using _mkdir(), list all files in directory using _flist() and retrive other basic information.
 
+    Besides the directories and zip archives the search path can contain Package files.
+    Packages are memory mapped and take precedence over the other search paths, the packages added later override the entries of the previously added ones (for example patches).
+
     The file can be opened with _open() and closed with _fclose(). Data is usually can be read with _fread() and written with _fwrite().
 
     Common usecase:
@@ -49,6 +91,16 @@ void File::finit(const char *argv0) {
     \note Usually, this method calls internally and must not be called manually.
 */
 void File::fsearchPathAdd(const char *path, bool isFirst) {
+    if(!isFirst && Package::isPackage(path)) {
+        Package *package = new Package;
+        if(package->open(path)) {
+            s_Packages.push_back(package);
+        } else {
+            delete package;
+            Log(Log::ERR) << "[ FileIO ] Failed to mount package." << path;
+        }
+        return;
+    }
     if(PHYSFS_addToSearchPath(path, isFirst ? 0 : 1) == 0) {
         Log(Log::ERR) << "[ FileIO ] Filed to add search path." << path << PHYSFS_getLastError();
     }
@@ -78,6 +130,25 @@ StringList File::_flist(const char *path) {
 
     PHYSFS_freeList(rc);
 
+    string dir(path);
+    if(!dir.empty() && dir.back() != '/') {
+        dir += '/';
+    }
+    if(dir == "/") {
+        dir.clear();
+    }
+    for(auto package : s_Packages) {
+        for(uint32_t i = 0; i < package->entryCount(); i++) {
+            string name = package->name(package->entry(i));
+            if(name.size() > dir.size() && name.compare(0, dir.size(), dir) == 0 && name.find('/', dir.size()) == string::npos) {
+                name = name.substr(dir.size());
+                if(find(result.begin(), result.end(), name) == result.end()) {
+                    result.push_back(name);
+                }
+            }
+        }
+    }
+
     return result;
 }
 /*!
@@ -102,6 +173,10 @@ bool File::_delete(const char *path) {
     Checks if a file by \a path exists. Returns true if operation succeeded; otherwise returns false.
 */
 bool File::_exists(const char *path) {
+    Package *package = nullptr;
+    if(findEntry(path, package)) {
+        return true;
+    }
     return PHYSFS_exists(path);
 }
 /*!
@@ -116,7 +191,16 @@ bool File::_isdir(const char *path) {
     Closes file \a stream. Returns 0 if succeeded; otherwise returns non-zero value.
 */
 int File::_fclose(_FILE *stream) {
-    return PHYSFS_close(static_cast<PHYSFS_file *>(stream));
+    FileHandle *handle = static_cast<FileHandle *>(stream);
+    if(handle->file) {
+        int result = PHYSFS_close(handle->file);
+        if(result != 0) {
+            delete handle;
+        }
+        return result;
+    }
+    delete handle;
+    return 1;
 }
 /*!
     Seek to a new position within a file \a stream.
@@ -127,8 +211,15 @@ int File::_fclose(_FILE *stream) {
     \sa _ftell()
  */
 _size_t File::_fseek(_FILE *stream, uint64_t origin) {
-    A_UNUSED(origin);
-    return static_cast<_size_t>(PHYSFS_seek(static_cast<PHYSFS_file *>(stream), origin));
+    FileHandle *handle = static_cast<FileHandle *>(stream);
+    if(handle->file) {
+        return static_cast<_size_t>(PHYSFS_seek(handle->file, origin));
+    }
+    if(origin > handle->size) {
+        return 0;
+    }
+    handle->pos = origin;
+    return 1;
 }
 /*!
     Opens the file whose name is specified in the \a path and associates it with a stream that can be identified in future operations.
@@ -143,17 +234,43 @@ _size_t File::_fseek(_FILE *stream, uint64_t origin) {
     Returns _FILE pointer to file stream if succeeded; otherwise returns nullptr value.
 */
 _FILE *File::_fopen(const char *path, const char *mode) {
-    _FILE *result = nullptr;
+    if(mode[0] == 'r') {
+        Package *package = nullptr;
+        const Package::Entry *entry = findEntry(path, package);
+        if(entry) {
+            FileHandle *handle = new FileHandle;
+            handle->size = entry->originalSize;
+            if(entry->compression == Package::None) {
+                handle->data = package->data(entry);
+            } else {
+                handle->buffer.resize(handle->size);
+                if(package->read(entry, handle->buffer.data())) {
+                    handle->data = handle->buffer.data();
+                }
+            }
+            if(handle->data == nullptr && handle->size > 0) {
+                Log(Log::ERR) << "[ FileIO ] Can't read package entry" << path;
+                delete handle;
+                return nullptr;
+            }
+            return handle;
+        }
+    }
+
+    PHYSFS_file *file = nullptr;
     switch (mode[0]) {
-        case 'r': result = static_cast<void *>(PHYSFS_openRead(path)); break;
-        case 'w': result = static_cast<void *>(PHYSFS_openWrite(path)); break;
-        case 'a': result = static_cast<void *>(PHYSFS_openAppend(path)); break;
+        case 'r': file = PHYSFS_openRead(path); break;
+        case 'w': file = PHYSFS_openWrite(path); break;
+        case 'a': file = PHYSFS_openAppend(path); break;
         default: break;
     }
-    if(result == nullptr) {
+    if(file == nullptr) {
         Log(Log::ERR) << "[ FileIO ] Can't open file" << path;
+        return nullptr;
     }
-    return result;
+    FileHandle *handle = new FileHandle;
+    handle->file = file;
+    return handle;
 }
 /*!
     Reads an array of \a count elements, each one with a size of \a size bytes, from the \a stream and stores them in the block of memory specified by \a ptr.
@@ -162,7 +279,17 @@ _FILE *File::_fopen(const char *path, const char *mode) {
     Returns number of objects read.
 */
 _size_t File::_fread(void *ptr, _size_t size, _size_t count, _FILE *stream) {
-    return static_cast<_size_t>(PHYSFS_read(static_cast<PHYSFS_file *>(stream), ptr, size, count));
+    FileHandle *handle = static_cast<FileHandle *>(stream);
+    if(handle->file) {
+        return static_cast<_size_t>(PHYSFS_read(handle->file, ptr, size, count));
+    }
+    if(size == 0) {
+        return 0;
+    }
+    count = MIN(count, (handle->size - handle->pos) / size);
+    memcpy(ptr, handle->data + handle->pos, size * count);
+    handle->pos += size * count;
+    return count;
 }
 /*!
     Writes an array of \a count elements, each one with a size of \a size bytes, from the block of memory pointed by \a ptr to the current position in the \a stream.
@@ -171,13 +298,21 @@ _size_t File::_fread(void *ptr, _size_t size, _size_t count, _FILE *stream) {
     Returns number of objects written.
 */
 _size_t File::_fwrite(const void *ptr, _size_t size, _size_t count, _FILE *stream) {
-    return static_cast<_size_t>(PHYSFS_write(static_cast<PHYSFS_file *>(stream), ptr, size, count));
+    FileHandle *handle = static_cast<FileHandle *>(stream);
+    if(handle->file) {
+        return static_cast<_size_t>(PHYSFS_write(handle->file, ptr, size, count));
+    }
+    return 0;
 }
 /*!
     Get total length of a file \a stream in bytes.
 */
 _size_t File::_fsize(_FILE *stream) {
-    return static_cast<_size_t>(PHYSFS_fileLength(static_cast<PHYSFS_file *>(stream)));
+    FileHandle *handle = static_cast<FileHandle *>(stream);
+    if(handle->file) {
+        return static_cast<_size_t>(PHYSFS_fileLength(handle->file));
+    }
+    return handle->size;
 }
 /*!
     Determine current position within a file \a stream.
@@ -187,5 +322,22 @@ _size_t File::_fsize(_FILE *stream) {
     \sa _fseek()
 */
 _size_t File::_ftell(_FILE *stream) {
-    return static_cast<_size_t>(PHYSFS_tell(static_cast<PHYSFS_file *>(stream)));
+    FileHandle *handle = static_cast<FileHandle *>(stream);
+    if(handle->file) {
+        return static_cast<_size_t>(PHYSFS_tell(handle->file));
+    }
+    return handle->pos;
+}
+/*!
+    Returns a pointer to the whole content of a file \a stream without copying.
+    The pointer stays valid until the \a stream is closed.
+
+    Returns nullptr if the file is not backed by a mounted package; use _fread() in this case.
+*/
+const uint8_t *File::_fmap(_FILE *stream) {
+    FileHandle *handle = static_cast<FileHandle *>(stream);
+    if(handle->file) {
+        return nullptr;
+    }
+    return handle->data;
 }
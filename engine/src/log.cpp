@@ -1,16 +1,226 @@
 #include "log.h"
 
-#include <sstream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <cstdio>
+#include <cstdarg>
+
+#define QUEUE_SIZE 1024
+#define QUEUE_MASK (QUEUE_SIZE - 1)
+
+#define WAIT_TIMEOUT 10
 
 static LogHandler *s_handler    = nullptr;
-static Log::LogTypes s_logLevel = Log::ERR;
+static atomic<int> s_logLevel(Log::ERR);
+
+namespace {
+    /*
+        Bounded multi-producer single-consumer queue based on the Dmitry Vyukov's algorithm.
+        When the queue is full the record is dropped and counted, error records wait for the free cell instead.
+    */
+    class LogQueue {
+    public:
+        LogQueue() :
+                m_Enqueue(0),
+                m_Dequeue(0),
+                m_Processed(0),
+                m_Dropped(0),
+                m_Reported(0),
+                m_Running(false),
+                m_Async(true) {
+            for(size_t i = 0; i < QUEUE_SIZE; i++) {
+                m_Cells[i].sequence.store(i, memory_order_relaxed);
+            }
+        }
+
+        bool push(Log::LogTypes type, string &text) {
+            // The consumer can't wait for itself
+            bool wait = (type == Log::ERR && this_thread::get_id() != m_Consumer.load());
+
+            Cell *cell;
+            size_t pos = m_Enqueue.load(memory_order_relaxed);
+            for(;;) {
+                cell = &m_Cells[pos & QUEUE_MASK];
+                size_t sequence = cell->sequence.load(memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+                if(diff == 0) {
+                    if(m_Enqueue.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                        break;
+                    }
+                } else if(diff < 0) {
+                    if(!wait) {
+                        m_Dropped.fetch_add(1, memory_order_relaxed);
+                        return false;
+                    }
+                    wake();
+                    this_thread::yield();
+                    pos = m_Enqueue.load(memory_order_relaxed);
+                } else {
+                    pos = m_Enqueue.load(memory_order_relaxed);
+                }
+            }
+            cell->type = type;
+            cell->text.swap(text);
+            cell->sequence.store(pos + 1, memory_order_release);
+            return true;
+        }
+
+        bool pop(Log::LogTypes &type, string &text) {
+            size_t pos = m_Dequeue.load(memory_order_relaxed);
+            Cell *cell = &m_Cells[pos & QUEUE_MASK];
+            size_t sequence = cell->sequence.load(memory_order_acquire);
+            if(static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) < 0) {
+                return false;
+            }
+            type = cell->type;
+            text.swap(cell->text);
+            cell->text.clear();
+            cell->sequence.store(pos + QUEUE_SIZE, memory_order_release);
+            m_Dequeue.store(pos + 1, memory_order_relaxed);
+            return true;
+        }
+
+        void start() {
+            unique_lock<mutex> locker(m_Mutex);
+            if(!m_Running) {
+                m_Running = true;
+                m_Thread = thread(&LogQueue::run, this);
+            }
+        }
+
+        void stop() {
+            {
+                unique_lock<mutex> locker(m_Mutex);
+                if(!m_Running) {
+                    return;
+                }
+                m_Running = false;
+            }
+            m_Condition.notify_one();
+            m_Thread.join();
+        }
+
+        void wake() {
+            m_Condition.notify_one();
+        }
+
+        void flush() {
+            if(!m_Running || this_thread::get_id() == m_Consumer.load()) {
+                return;
+            }
+            size_t target = m_Enqueue.load(memory_order_acquire);
+            wake();
+            while(m_Running && m_Processed.load(memory_order_acquire) < target) {
+                this_thread::yield();
+            }
+        }
+
+        void run() {
+            m_Consumer = this_thread::get_id();
+
+            Log::LogTypes type;
+            string text;
+            for(;;) {
+                drain(type, text);
+                unique_lock<mutex> locker(m_Mutex);
+                if(!m_Running) {
+                    break;
+                }
+                // Producers don't take the mutex, so a wake up can be missed; the timeout covers it
+                m_Condition.wait_for(locker, chrono::milliseconds(WAIT_TIMEOUT));
+            }
+            drain(type, text);
+        }
+
+        void drain(Log::LogTypes &type, string &text) {
+            while(pop(type, text)) {
+                if(s_handler) {
+                    s_handler->setRecord(type, text.c_str());
+                }
+                // Reported before the record is marked as processed to be visible after flush()
+                report();
+                m_Processed.fetch_add(1, memory_order_release);
+            }
+            report();
+        }
+
+        void report() {
+            uint64_t dropped = m_Dropped.load(memory_order_relaxed);
+            if(dropped != m_Reported) {
+                if(s_handler) {
+                    string record = " [ Log ] Dropped " + to_string(dropped - m_Reported) + " records";
+                    s_handler->setRecord(Log::WRN, record.c_str());
+                }
+                m_Reported = dropped;
+            }
+        }
+
+        struct Cell {
+            atomic<size_t> sequence;
+            Log::LogTypes type;
+            string text;
+        };
+
+        Cell m_Cells[QUEUE_SIZE];
+
+        atomic<size_t> m_Enqueue;
+
+        atomic<size_t> m_Dequeue;
+
+        atomic<size_t> m_Processed;
+
+        atomic<uint64_t> m_Dropped;
+
+        uint64_t m_Reported;
+
+        atomic<bool> m_Running;
+
+        atomic<bool> m_Async;
+
+        thread m_Thread;
+
+        atomic<thread::id> m_Consumer;
+
+        mutex m_Mutex;
+
+        condition_variable m_Condition;
+
+    };
+
+    LogQueue &logQueue() {
+        // Never destroyed, so the records can be written from the destructors of the other static objects
+        static LogQueue *queue = new LogQueue;
+        return *queue;
+    }
+}
 
 class LogPrivate {
 public:
-    std::stringstream       stream;
+    void append(const char *format, ...);
+
+    string                  record;
     Log::LogTypes           type;
+    bool                    field;
 };
 
+void LogPrivate::append(const char *format, ...) {
+    char buffer[64];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if(length > 0) {
+        if(!field) {
+            record.push_back(' ');
+        }
+        record.append(buffer, (length < static_cast<int>(sizeof(buffer))) ? length : sizeof(buffer) - 1);
+    }
+    field = false;
+}
+
 /*!
     \class Log
     \brief The Log class provides an output stream for logging information.
@@ -22,6 +232,16 @@ public:
     \code
     Log(Log::ERR) << "Loading level:" << 1;
     \endcode
+
+    The level is checked before formatting; the arguments of the filtered messages are not formatted.
+    The A_LOG macro also skips evaluation of the arguments and removes the messages above LOG_MAX_LEVEL at compile time:
+    \code
+    A_LOG(Log::DBG) << "Visible objects:" << count;
+    \endcode
+
+    The records are passed to the LogHandler on a background thread, so logging doesn't block the calling thread.
+    The queue is bounded; when it overflows the records are dropped and counted, see droppedRecords().
+    Error records are never dropped, they wait for the free place in the queue and are flushed before the Log is destroyed.
 */
 /*!
     \enum Log::LogTypes
@@ -33,21 +253,44 @@ public:
     \value INF \c Informational logging. Should be desabled in release.
     \value DBG \c Debug logging. Should be desabled in release.
 */
+/*!
+    \macro A_LOG(type)
+    \relates Log
+
+    Creates the Log stream with \a type only if the \a type is enabled.
+    The macro is a single expression, so it can be safely used as a branch of if statement without braces.
+*/
 /*!
     Constructs a log stream that writes to the handler for the message \a type.
 */
 Log::Log(LogTypes type) :
-        p_ptr(new LogPrivate()) {
-    p_ptr->type = type;
+        p_ptr(nullptr) {
+    if(isEnabled(type)) {
+        p_ptr = new LogPrivate();
+        p_ptr->type = type;
+        p_ptr->field = false;
+    }
 }
 /*!
     Flushes any pending data to be written and destroys the log stream.
 */
 Log::~Log() {
-    if(s_handler && p_ptr->type <= s_logLevel) {
-        s_handler->setRecord(p_ptr->type, p_ptr->stream.str().c_str());
+    if(p_ptr) {
+        LogQueue &queue = logQueue();
+        if(queue.m_Async) {
+            queue.start();
+            if(queue.push(p_ptr->type, p_ptr->record)) {
+                if(p_ptr->type == ERR) {
+                    queue.flush();
+                } else {
+                    queue.wake();
+                }
+            }
+        } else {
+            s_handler->setRecord(p_ptr->type, p_ptr->record.c_str());
+        }
+        delete p_ptr;
     }
-    delete p_ptr;
 }
 /*!
     Set a new Log \a handler.
@@ -56,6 +299,7 @@ Log::~Log() {
 */
 void Log::overrideHandler(LogHandler *handler) {
     if(handler) {
+        flush();
         s_handler   = handler;
     }
 }
@@ -70,90 +314,164 @@ LogHandler *Log::handler() {
     Messages wich are below this \a level will be descarded.
 */
 void Log::setLogLevel(LogTypes level) {
-    s_logLevel  = level;
+    s_logLevel.store(level, memory_order_relaxed);
+}
+/*!
+    Returns true if the messages with \a type will be passed to the handler; otherwise returns false.
+*/
+bool Log::isEnabled(LogTypes type) {
+    return s_handler && type <= s_logLevel.load(memory_order_relaxed);
+}
+/*!
+    Enables or disables the background writing of the records.
+    With \a async set to false the handler is called on the thread which writes the record.
+    Pending records are flushed before switching.
+*/
+void Log::setAsync(bool async) {
+    LogQueue &queue = logQueue();
+    if(!async) {
+        queue.stop();
+    }
+    queue.m_Async = async;
+}
+/*!
+    Blocks until all the records written before this call are passed to the handler.
+*/
+void Log::flush() {
+    logQueue().flush();
+}
+/*!
+    Returns the number of records which were dropped because of the queue overflow.
+*/
+uint64_t Log::droppedRecords() {
+    return logQueue().m_Dropped.load(memory_order_relaxed);
 }
 /*!
     Writes the boolean value, \a b, to the stream and returns a reference to the stream.
 */
 Log &Log::operator<<(bool b) {
-    p_ptr->stream << " "  << b;
-    to_string(b);
+    if(p_ptr) {
+        p_ptr->append("%d", b ? 1 : 0);
+    }
     return *this;
 }
 /*!
     Writes the unsinged 8 bit integer value, \a c, to the stream and returns a reference to the stream.
 */
 Log &Log::operator<<(unsigned char c) {
-    p_ptr->stream << " "  << c;
+    if(p_ptr) {
+        p_ptr->append("%c", c);
+    }
     return *this;
 }
 /*!
     Writes the singed 8 bit integer value, \a c, to the stream and returns a reference to the stream.
 */
 Log &Log::operator<<(char c) {
-    p_ptr->stream << " " << c;
+    if(p_ptr) {
+        p_ptr->append("%c", c);
+    }
     return *this;
 }
 /*!
     Writes the unsinged 16 bit integer value, \a s, to the stream and returns a reference to the stream.
 */
 Log &Log::operator<<(unsigned short s) {
-    p_ptr->stream << " " << s;
+    if(p_ptr) {
+        p_ptr->append("%hu", s);
+    }
     return *this;
 }
 /*!
     Writes the singed 16 bit integer value, \a s, to the stream and returns a reference to the stream.
 */
 Log &Log::operator<<(short s) {
-    p_ptr->stream << " " << s;
+    if(p_ptr) {
+        p_ptr->append("%hd", s);
+    }
     return *this;
 }
 /*!
     Writes the unsinged 32 bit integer value, \a i, to the stream and returns a reference to the stream.
 */
 Log &Log::operator<<(unsigned int i) {
-    p_ptr->stream << " " << i;
+    if(p_ptr) {
+        p_ptr->append("%u", i);
+    }
     return *this;
 }
 /*!
     Writes the singed 32 bit integer value, \a i, to the stream and returns a reference to the stream.
 */
 Log &Log::operator<<(int i) {
-    p_ptr->stream << " " << i;
+    if(p_ptr) {
+        p_ptr->append("%d", i);
+    }
     return *this;
 }
 /*!
     Writes the unsinged 64 bit integer value, \a i, to the stream and returns a reference to the stream.
 */
 Log &Log::operator<<(unsigned long long i) {
-    p_ptr->stream << " " << i;
+    if(p_ptr) {
+        p_ptr->append("%llu", i);
+    }
     return *this;
 }
 /*!
     Writes the singed 64 bit integer value, \a i, to the stream and returns a reference to the stream.
 */
 Log &Log::operator<<(long long i) {
-    p_ptr->stream << " " << i;
+    if(p_ptr) {
+        p_ptr->append("%lld", i);
+    }
     return *this;
 }
 /*!
     Writes the float value, \a f, to the stream and returns a reference to the stream.
 */
 Log &Log::operator<<(float f) {
-    p_ptr->stream << " " << f;
+    if(p_ptr) {
+        p_ptr->append("%g", f);
+    }
     return *this;
 }
 /*!
     Writes the float value with double precision, \a d, to the stream and returns a reference to the stream.
 */
 Log &Log::operator<<(double d) {
-    p_ptr->stream << " " << d;
+    if(p_ptr) {
+        p_ptr->append("%g", d);
+    }
     return *this;
 }
 /*!
     Writes the '\\0'-terminated \a string, to the stream and returns a reference to the stream.
 */
 Log &Log::operator<<(const char *string) {
-    p_ptr->stream << " " << string;
+    if(p_ptr) {
+        if(!p_ptr->field) {
+            p_ptr->record.push_back(' ');
+        }
+        p_ptr->record.append(string ? string : "(null)");
+        p_ptr->field = false;
+    }
+    return *this;
+}
+/*!
+    \fn Log &Log::field(const char *key, const T &value)
+
+    Writes the structured field with \a key and \a value in the "key=value" form and returns a reference to the stream.
+    \code
+    Log(Log::INF).field("path", path.c_str()).field("size", size) << "Resource loaded";
+    \endcode
+*/
+Log &Log::fieldKey(const char *key) {
+    if(p_ptr) {
+        p_ptr->record.push_back(' ');
+        p_ptr->record.append(key);
+        p_ptr->record.push_back('=');
+        p_ptr->field = true;
+    }
     return *this;
 }
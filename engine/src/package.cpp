@@ -0,0 +1,579 @@
+#include "package.h"
+
+#include "log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#define PACKAGE_MAGIC "TPAK"
+#define PACKAGE_VERSION 1
+
+#define PACKAGE_ALIGNMENT 4096
+
+#define FLAG_PATCH (1<<0)
+
+#define HASH_BITS 12
+#define MIN_MATCH 4
+#define LAST_LITERALS 5
+#define MATCH_LIMIT 12
+#define MAX_OFFSET 65535
+
+namespace {
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t flags;
+        uint32_t count;
+        uint64_t table;
+        uint64_t names;
+        uint64_t namesSize;
+    };
+
+    inline uint32_t read32(const uint8_t *ptr) {
+        uint32_t result;
+        memcpy(&result, ptr, sizeof(uint32_t));
+        return result;
+    }
+
+    inline void writeLength(vector<uint8_t> &out, uint64_t length) {
+        while(length >= 255) {
+            out.push_back(255);
+            length -= 255;
+        }
+        out.push_back(static_cast<uint8_t>(length));
+    }
+
+    inline bool readLength(const uint8_t *&ip, const uint8_t *end, uint64_t &length) {
+        uint8_t byte;
+        do {
+            if(ip >= end) {
+                return false;
+            }
+            byte = *ip++;
+            length += byte;
+        } while(byte == 255);
+        return true;
+    }
+
+    void writeSequence(vector<uint8_t> &out, const uint8_t *literals, uint64_t literalLength, uint32_t offset, uint64_t matchLength) {
+        uint8_t token = static_cast<uint8_t>(((literalLength < 15) ? literalLength : 15) << 4);
+        if(offset) {
+            uint64_t length = matchLength - MIN_MATCH;
+            token |= static_cast<uint8_t>((length < 15) ? length : 15);
+        }
+        out.push_back(token);
+        if(literalLength >= 15) {
+            writeLength(out, literalLength - 15);
+        }
+        out.insert(out.end(), literals, literals + literalLength);
+        if(offset) {
+            out.push_back(static_cast<uint8_t>(offset & 0xff));
+            out.push_back(static_cast<uint8_t>(offset >> 8));
+            if(matchLength - MIN_MATCH >= 15) {
+                writeLength(out, matchLength - MIN_MATCH - 15);
+            }
+        }
+    }
+}
+
+class PackagePrivate {
+public:
+    PackagePrivate() :
+#ifdef _WIN32
+            m_File(INVALID_HANDLE_VALUE),
+            m_Mapping(nullptr),
+#endif
+            m_pData(nullptr),
+            m_Size(0),
+            m_pHeader(nullptr),
+            m_pEntries(nullptr),
+            m_pNames(nullptr) {
+
+    }
+
+#ifdef _WIN32
+    HANDLE m_File;
+    HANDLE m_Mapping;
+#endif
+
+    const uint8_t *m_pData;
+
+    uint64_t m_Size;
+
+    const Header *m_pHeader;
+
+    const Package::Entry *m_pEntries;
+
+    const char *m_pNames;
+};
+
+class PackageWriterPrivate {
+public:
+    PackageWriterPrivate() :
+            m_pFile(nullptr),
+            m_Offset(0),
+            m_Patch(false) {
+
+    }
+
+    FILE *m_pFile;
+
+    uint64_t m_Offset;
+
+    vector<Package::Entry> m_Entries;
+
+    string m_Names;
+
+    bool m_Patch;
+};
+
+/*!
+    \class Package
+    \brief The read-only container of the game assets.
+    \inmodule Engine
+
+    The package consists of a header, the entries data and the table of entries sorted by the hash of entry path.
+    Each entry starts at 4K aligned offset and can be stored as is or compressed with the LZ4 block format.
+    The whole package is memory mapped, so the uncompressed entries are read directly from the page cache without any intermediate buffers.
+
+    A patch package has the same format; the entries of patch packages override the entries with the same path of previously mounted packages.
+
+    Packages are mounted by File::fsearchPathAdd() and usually are not used directly.
+
+    \sa PackageWriter
+*/
+
+Package::Package() :
+        p_ptr(new PackagePrivate) {
+
+}
+
+Package::~Package() {
+    close();
+
+    delete p_ptr;
+}
+/*!
+    Maps the package file with \a path into memory.
+    Returns true if the file is a valid package; otherwise returns false.
+*/
+bool Package::open(const string &path) {
+    close();
+
+#ifdef _WIN32
+    int32_t length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    wstring wide(length, 0);
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], length);
+
+    p_ptr->m_File = CreateFileW(wide.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(p_ptr->m_File == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(p_ptr->m_File, &size);
+    p_ptr->m_Size = size.QuadPart;
+    if(p_ptr->m_Size >= sizeof(Header)) {
+        p_ptr->m_Mapping = CreateFileMappingW(p_ptr->m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(p_ptr->m_Mapping) {
+            p_ptr->m_pData = static_cast<const uint8_t *>(MapViewOfFile(p_ptr->m_Mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd == -1) {
+        return false;
+    }
+    struct stat info;
+    if(fstat(fd, &info) == 0 && static_cast<uint64_t>(info.st_size) >= sizeof(Header)) {
+        p_ptr->m_Size = info.st_size;
+        void *ptr = mmap(nullptr, p_ptr->m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(ptr != MAP_FAILED) {
+            p_ptr->m_pData = static_cast<const uint8_t *>(ptr);
+        }
+    }
+    ::close(fd);
+#endif
+    if(p_ptr->m_pData == nullptr) {
+        close();
+        return false;
+    }
+
+    const Header *header = reinterpret_cast<const Header *>(p_ptr->m_pData);
+    if(memcmp(header->magic, PACKAGE_MAGIC, 4) != 0 || header->version != PACKAGE_VERSION ||
+       header->table + header->count * sizeof(Entry) > p_ptr->m_Size ||
+       header->names + header->namesSize > p_ptr->m_Size) {
+        Log(Log::ERR) << "[ Package ] Invalid package" << path.c_str();
+        close();
+        return false;
+    }
+
+    p_ptr->m_pHeader = header;
+    p_ptr->m_pEntries = reinterpret_cast<const Entry *>(p_ptr->m_pData + header->table);
+    p_ptr->m_pNames = reinterpret_cast<const char *>(p_ptr->m_pData + header->names);
+
+    return true;
+}
+/*!
+    Unmaps the package.
+*/
+void Package::close() {
+#ifdef _WIN32
+    if(p_ptr->m_pData) {
+        UnmapViewOfFile(p_ptr->m_pData);
+    }
+    if(p_ptr->m_Mapping) {
+        CloseHandle(p_ptr->m_Mapping);
+        p_ptr->m_Mapping = nullptr;
+    }
+    if(p_ptr->m_File != INVALID_HANDLE_VALUE) {
+        CloseHandle(p_ptr->m_File);
+        p_ptr->m_File = INVALID_HANDLE_VALUE;
+    }
+#else
+    if(p_ptr->m_pData) {
+        munmap(const_cast<uint8_t *>(p_ptr->m_pData), p_ptr->m_Size);
+    }
+#endif
+    p_ptr->m_pData = nullptr;
+    p_ptr->m_Size = 0;
+    p_ptr->m_pHeader = nullptr;
+    p_ptr->m_pEntries = nullptr;
+    p_ptr->m_pNames = nullptr;
+}
+/*!
+    Returns true if the package is a patch package.
+*/
+bool Package::isPatch() const {
+    return p_ptr->m_pHeader && (p_ptr->m_pHeader->flags & FLAG_PATCH);
+}
+/*!
+    Returns the number of entries in the package.
+*/
+uint32_t Package::entryCount() const {
+    return p_ptr->m_pHeader ? p_ptr->m_pHeader->count : 0;
+}
+/*!
+    Returns the entry with \a index.
+*/
+const Package::Entry *Package::entry(uint32_t index) const {
+    return (index < entryCount()) ? &p_ptr->m_pEntries[index] : nullptr;
+}
+/*!
+    Returns the entry for the provided \a path or nullptr if the package doesn't contain it.
+*/
+const Package::Entry *Package::find(const string &path) const {
+    if(p_ptr->m_pHeader == nullptr) {
+        return nullptr;
+    }
+    uint64_t key = hash(path);
+
+    const Entry *begin = p_ptr->m_pEntries;
+    const Entry *end = begin + p_ptr->m_pHeader->count;
+    const Entry *it = lower_bound(begin, end, key, [](const Entry &entry, uint64_t value) { return entry.hash < value; });
+    for(; it != end && it->hash == key; ++it) {
+        if(name(it) == path) {
+            return it;
+        }
+    }
+    return nullptr;
+}
+/*!
+    Returns the path of the \a entry.
+*/
+string Package::name(const Entry *entry) const {
+    if(entry == nullptr || entry->name >= p_ptr->m_pHeader->namesSize) {
+        return string();
+    }
+    return string(p_ptr->m_pNames + entry->name);
+}
+/*!
+    Returns the pointer to the stored data of the \a entry.
+    \note The data is compressed in case of the entry compression is not Package::None.
+*/
+const uint8_t *Package::data(const Entry *entry) const {
+    if(entry == nullptr || entry->offset + entry->size > p_ptr->m_Size) {
+        return nullptr;
+    }
+    return p_ptr->m_pData + entry->offset;
+}
+/*!
+    Reads the \a entry to the \a buffer which must be at least Entry::originalSize bytes.
+    Returns true if succeeded; otherwise returns false.
+*/
+bool Package::read(const Entry *entry, uint8_t *buffer) const {
+    const uint8_t *ptr = data(entry);
+    if(ptr == nullptr) {
+        return false;
+    }
+    switch(entry->compression) {
+        case None: {
+            memcpy(buffer, ptr, entry->size);
+            return true;
+        }
+        case LZ4: return decompress(ptr, entry->size, buffer, entry->originalSize);
+        default: break;
+    }
+    return false;
+}
+/*!
+    Returns true if the file with \a path is a package.
+*/
+bool Package::isPackage(const string &path) {
+    bool result = false;
+    FILE *fp = fopen(path.c_str(), "rb");
+    if(fp) {
+        char magic[4];
+        result = (fread(magic, 4, 1, fp) == 1 && memcmp(magic, PACKAGE_MAGIC, 4) == 0);
+        fclose(fp);
+    }
+    return result;
+}
+/*!
+    Returns the 64-bit FNV-1a hash of the \a path.
+*/
+uint64_t Package::hash(const string &path) {
+    uint64_t result = 14695981039346656037ULL;
+    for(auto it : path) {
+        result ^= static_cast<uint8_t>(it);
+        result *= 1099511628211ULL;
+    }
+    return result;
+}
+/*!
+    Compresses the \a data with \a size using the LZ4 block format.
+    The compressor is a greedy single pass; it trades the compression ratio for speed, the decompression speed is the same as for the reference implementation.
+*/
+vector<uint8_t> Package::compress(const uint8_t *data, uint64_t size) {
+    vector<uint8_t> result;
+    result.reserve(size + size / 255 + 16);
+
+    uint64_t anchor = 0;
+    if(size > MATCH_LIMIT) {
+        vector<int64_t> table(1 << HASH_BITS, -1);
+
+        uint64_t limit = size - MATCH_LIMIT;
+        uint64_t ip = 0;
+        while(ip < limit) {
+            uint32_t sequence = read32(data + ip);
+            uint32_t h = (sequence * 2654435761U) >> (32 - HASH_BITS);
+            int64_t ref = table[h];
+            table[h] = ip;
+            if(ref >= 0 && ip - ref <= MAX_OFFSET && read32(data + ref) == sequence) {
+                uint64_t length = MIN_MATCH;
+                while(ip + length < size - LAST_LITERALS && data[ref + length] == data[ip + length]) {
+                    length++;
+                }
+                writeSequence(result, data + anchor, ip - anchor, static_cast<uint32_t>(ip - ref), length);
+                ip += length;
+                anchor = ip;
+            } else {
+                ip++;
+            }
+        }
+    }
+    writeSequence(result, data + anchor, size - anchor, 0, 0);
+
+    return result;
+}
+/*!
+    Decompresses LZ4 block \a data with \a size to the \a buffer with \a bufferSize.
+    Returns true if the block was valid and filled exactly \a bufferSize bytes; otherwise returns false.
+*/
+bool Package::decompress(const uint8_t *data, uint64_t size, uint8_t *buffer, uint64_t bufferSize) {
+    const uint8_t *ip = data;
+    const uint8_t *end = data + size;
+    uint8_t *op = buffer;
+    uint8_t *outEnd = buffer + bufferSize;
+
+    while(ip < end) {
+        uint8_t token = *ip++;
+
+        uint64_t length = token >> 4;
+        if(length == 15 && !readLength(ip, end, length)) {
+            return false;
+        }
+        if(length > static_cast<uint64_t>(end - ip) || length > static_cast<uint64_t>(outEnd - op)) {
+            return false;
+        }
+        memcpy(op, ip, length);
+        ip += length;
+        op += length;
+
+        if(ip == end) {
+            break;
+        }
+
+        if(end - ip < 2) {
+            return false;
+        }
+        uint32_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if(offset == 0 || offset > static_cast<uint64_t>(op - buffer)) {
+            return false;
+        }
+
+        length = token & 0x0f;
+        if(length == 15 && !readLength(ip, end, length)) {
+            return false;
+        }
+        length += MIN_MATCH;
+        if(length > static_cast<uint64_t>(outEnd - op)) {
+            return false;
+        }
+        const uint8_t *match = op - offset;
+        if(offset >= length) {
+            memcpy(op, match, length);
+            op += length;
+        } else {
+            for(uint64_t i = 0; i < length; i++) {
+                *op++ = *match++;
+            }
+        }
+    }
+    return op == outEnd;
+}
+
+/*!
+    \class PackageWriter
+    \brief Creates Package files.
+    \inmodule Engine
+
+    Entries are written to the file one by one, so the writer doesn't keep the packaged data in memory.
+
+    \code
+    PackageWriter writer;
+    if(writer.open("base.pak")) {
+        writer.addEntry("index", data, size, Package::LZ4);
+        writer.close();
+    }
+    \endcode
+
+    \sa Package
+*/
+
+PackageWriter::PackageWriter() :
+        p_ptr(new PackageWriterPrivate) {
+
+}
+
+PackageWriter::~PackageWriter() {
+    close();
+
+    delete p_ptr;
+}
+/*!
+    Creates a new package file with \a path.
+    The \a patch flag marks the package as a patch package.
+    Returns true if succeeded; otherwise returns false.
+*/
+bool PackageWriter::open(const string &path, bool patch) {
+    close();
+
+    p_ptr->m_pFile = fopen(path.c_str(), "wb");
+    if(p_ptr->m_pFile == nullptr) {
+        return false;
+    }
+    p_ptr->m_Patch = patch;
+    p_ptr->m_Offset = 0;
+    p_ptr->m_Entries.clear();
+    p_ptr->m_Names.clear();
+
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    p_ptr->m_Offset = fwrite(&header, 1, sizeof(Header), p_ptr->m_pFile);
+
+    return p_ptr->m_Offset == sizeof(Header);
+}
+/*!
+    Writes the table of entries and closes the package file.
+    Returns true if succeeded; otherwise returns false.
+*/
+bool PackageWriter::close() {
+    if(p_ptr->m_pFile == nullptr) {
+        return false;
+    }
+    sort(p_ptr->m_Entries.begin(), p_ptr->m_Entries.end(), [](const Package::Entry &left, const Package::Entry &right) {
+        return left.hash < right.hash;
+    });
+
+    static const char padding[8] = {0};
+    uint64_t pad = (8 - p_ptr->m_Offset % 8) % 8;
+    fwrite(padding, 1, pad, p_ptr->m_pFile);
+
+    Header header;
+    memcpy(header.magic, PACKAGE_MAGIC, 4);
+    header.version = PACKAGE_VERSION;
+    header.flags = p_ptr->m_Patch ? FLAG_PATCH : 0;
+    header.count = p_ptr->m_Entries.size();
+    header.table = p_ptr->m_Offset + pad;
+    header.names = header.table + header.count * sizeof(Package::Entry);
+    header.namesSize = p_ptr->m_Names.size();
+
+    bool result = true;
+    if(!p_ptr->m_Entries.empty()) {
+        result &= (fwrite(&p_ptr->m_Entries[0], sizeof(Package::Entry), header.count, p_ptr->m_pFile) == header.count);
+    }
+    result &= (fwrite(p_ptr->m_Names.c_str(), 1, header.namesSize, p_ptr->m_pFile) == header.namesSize);
+
+    fseek(p_ptr->m_pFile, 0, SEEK_SET);
+    result &= (fwrite(&header, sizeof(Header), 1, p_ptr->m_pFile) == 1);
+
+    result &= (fclose(p_ptr->m_pFile) == 0);
+    p_ptr->m_pFile = nullptr;
+
+    return result;
+}
+/*!
+    Adds a new entry with \a path and \a data of \a size bytes to the package.
+    The entry will be compressed with the requested \a compression only in case of it reduces the entry size at least by 1/8.
+    Returns true if succeeded; otherwise returns false.
+*/
+bool PackageWriter::addEntry(const string &path, const uint8_t *data, uint64_t size, int compression) {
+    if(p_ptr->m_pFile == nullptr) {
+        return false;
+    }
+
+    Package::Entry entry;
+    entry.hash = Package::hash(path);
+    entry.originalSize = size;
+    entry.name = p_ptr->m_Names.size();
+    entry.compression = Package::None;
+
+    vector<uint8_t> compressed;
+    if(compression == Package::LZ4 && size > 0) {
+        compressed = Package::compress(data, size);
+        if(compressed.size() < size - size / 8) {
+            entry.compression = Package::LZ4;
+            data = compressed.data();
+            size = compressed.size();
+        }
+    }
+    entry.size = size;
+
+    static const char padding[PACKAGE_ALIGNMENT] = {0};
+    uint64_t pad = (PACKAGE_ALIGNMENT - p_ptr->m_Offset % PACKAGE_ALIGNMENT) % PACKAGE_ALIGNMENT;
+    if(fwrite(padding, 1, pad, p_ptr->m_pFile) != pad) {
+        return false;
+    }
+    entry.offset = p_ptr->m_Offset + pad;
+    if(fwrite(data, 1, size, p_ptr->m_pFile) != size) {
+        return false;
+    }
+    p_ptr->m_Offset = entry.offset + size;
+
+    p_ptr->m_Names.append(path);
+    p_ptr->m_Names.push_back('\0');
+    p_ptr->m_Entries.push_back(entry);
+
+    return true;
+}
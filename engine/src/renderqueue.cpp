@@ -0,0 +1,363 @@
+#include "renderqueue.h"
+
+#include "commandbuffer.h"
+#include "commandlist.h"
+
+#include "components/actor.h"
+#include "components/transform.h"
+#include "components/renderable.h"
+
+#include "resources/material.h"
+
+#include <threadpool.h>
+
+#include <unordered_map>
+#include <cstring>
+
+#define DEPTH_BITS 31
+
+#define CUSTOM_SHIFT 63
+#define MATERIAL_SHIFT 47
+#define MESH_SHIFT 31
+
+#define INVALID_ID 0xFFFF
+
+#define MIN_PARALLEL_ITEMS 1024
+
+namespace {
+    inline uint32_t depthBits(float depth) {
+        // The bit pattern of positive floats grows together with the value
+        depth = MAX(depth, 0.0f);
+        uint32_t result;
+        memcpy(&result, &depth, sizeof(float));
+        return result;
+    }
+
+    void radix(uint64_t *keys, uint32_t *values, uint64_t *tmpKeys, uint32_t *tmpValues, uint32_t count) {
+        uint64_t *srcKeys = keys;
+        uint32_t *srcValues = values;
+        uint64_t *dstKeys = tmpKeys;
+        uint32_t *dstValues = tmpValues;
+
+        for(uint32_t shift = 0; shift < 64; shift += 8) {
+            uint32_t histogram[256] = {0};
+            for(uint32_t i = 0; i < count; i++) {
+                histogram[(srcKeys[i] >> shift) & 0xFF]++;
+            }
+            // All keys share the digit, nothing to do in this pass
+            if(histogram[(srcKeys[0] >> shift) & 0xFF] == count) {
+                continue;
+            }
+
+            uint32_t offset = 0;
+            for(uint32_t i = 0; i < 256; i++) {
+                uint32_t size = histogram[i];
+                histogram[i] = offset;
+                offset += size;
+            }
+            for(uint32_t i = 0; i < count; i++) {
+                uint32_t index = histogram[(srcKeys[i] >> shift) & 0xFF]++;
+                dstKeys[index] = srcKeys[i];
+                dstValues[index] = srcValues[i];
+            }
+
+            swap(srcKeys, dstKeys);
+            swap(srcValues, dstValues);
+        }
+
+        if(srcKeys != keys) {
+            memcpy(keys, srcKeys, count * sizeof(uint64_t));
+            memcpy(values, srcValues, count * sizeof(uint32_t));
+        }
+    }
+}
+
+class RenderQueuePrivate {
+public:
+    struct Item {
+        Renderable *renderable;
+
+        Mesh *mesh;
+
+        MaterialInstance *material;
+
+        bool custom;
+    };
+
+    RenderQueuePrivate() :
+            m_Layer(0) {
+
+    }
+
+    uint16_t id(unordered_map<const void *, uint16_t> &map, const void *object) {
+        if(object == nullptr) {
+            return INVALID_ID;
+        }
+        auto it = map.find(object);
+        if(it != map.end()) {
+            return it->second;
+        }
+        uint16_t result = MIN(map.size(), static_cast<size_t>(INVALID_ID - 1));
+        map[object] = result;
+        return result;
+    }
+
+    bool isBatched(uint32_t first, uint32_t next) const {
+        const Item &item = m_Items[m_Order[first]];
+        const Item &neighbour = m_Items[m_Order[next]];
+        uint64_t mask = ~((1ULL << MESH_SHIFT) - 1);
+        return (m_Keys[next] & mask) == (m_Keys[first] & mask) && !neighbour.custom &&
+                neighbour.mesh == item.mesh && neighbour.material->material() == item.material->material();
+    }
+
+    void drawRange(ICommandBuffer &buffer, uint32_t first, uint32_t last, vector<Matrix4> &models) const {
+        for(uint32_t i = first; i < last; ) {
+            const Item &item = m_Items[m_Order[i]];
+            if(item.custom) {
+                item.renderable->draw(buffer, m_Layer);
+                i++;
+                continue;
+            }
+
+            // Instanceable neighbours with the same mesh and material form one batch
+            models.clear();
+            models.push_back(item.renderable->actor()->transform()->worldTransform());
+
+            uint32_t next = i + 1;
+            for(; next < last && isBatched(i, next); next++) {
+                models.push_back(m_Items[m_Order[next]].renderable->actor()->transform()->worldTransform());
+            }
+
+            if(models.size() == 1) {
+                buffer.drawMesh(models.front(), item.mesh, m_Layer, item.material);
+            } else {
+                buffer.drawMeshInstanced(&models[0], models.size(), item.mesh, m_Layer, item.material);
+            }
+            // Same state as MeshRender::draw leaves behind
+            buffer.setColor(Vector4(1.0f));
+            i = next;
+        }
+    }
+
+    vector<Item> m_Items;
+
+    vector<uint64_t> m_Keys;
+    vector<uint32_t> m_Order;
+
+    vector<uint64_t> m_TmpKeys;
+    vector<uint32_t> m_TmpOrder;
+
+    vector<Matrix4> m_Models;
+
+    unordered_map<const void *, uint16_t> m_Materials;
+    unordered_map<const void *, uint16_t> m_Meshes;
+
+    Matrix4 m_View;
+
+    uint32_t m_Layer;
+
+    list<CommandList> m_Lists;
+
+};
+
+class RecordTask : public Object {
+public:
+    RecordTask(const RenderQueuePrivate *queue, CommandList *list, uint32_t first, uint32_t last) :
+            m_pQueue(queue),
+            m_pList(list),
+            m_First(first),
+            m_Last(last) {
+
+    }
+
+    void processEvents() override {
+        m_pQueue->drawRange(*m_pList, m_First, m_Last, m_Models);
+    }
+
+protected:
+    const RenderQueuePrivate *m_pQueue;
+
+    CommandList *m_pList;
+
+    uint32_t m_First;
+
+    uint32_t m_Last;
+
+    vector<Matrix4> m_Models;
+
+};
+/*!
+    \class RenderQueue
+    \brief Orders the draw calls for the one rendering pass.
+    \inmodule Engine
+
+    Every Renderable pushed to the queue gets a 64-bit sort key.
+    For the opaque layers the key groups objects by material and mesh first and by view depth after, so the state changes are minimal and the geometry is drawn front to back.
+    Translucent objects are ordered back to front, the UI layer keeps the order of pushing.
+    Neighbours in the sorted queue which share the same mesh and material are drawn with a one instanced call.
+*/
+
+RenderQueue::RenderQueue() :
+        p_ptr(new RenderQueuePrivate) {
+
+}
+
+RenderQueue::~RenderQueue() {
+    delete p_ptr;
+}
+/*!
+    Clears the queue and starts a new pass for the \a layer.
+    The \a view matrix is used to calculate the depth of objects.
+*/
+void RenderQueue::begin(uint32_t layer, const Matrix4 &view) {
+    p_ptr->m_Layer = layer;
+    p_ptr->m_View = view;
+
+    p_ptr->m_Items.clear();
+    p_ptr->m_Keys.clear();
+    p_ptr->m_Order.clear();
+    p_ptr->m_Materials.clear();
+    p_ptr->m_Meshes.clear();
+}
+/*!
+    Adds the \a renderable to the queue.
+*/
+void RenderQueue::push(Renderable *renderable) {
+    uint32_t layer = p_ptr->m_Layer;
+
+    RenderQueuePrivate::Item item;
+    item.renderable = renderable;
+    item.mesh = nullptr;
+    item.material = nullptr;
+    item.custom = !renderable->instanceData(layer, &item.mesh, &item.material);
+    // Picking and translucent objects need a draw call per object anyway
+    if(layer & (ICommandBuffer::RAYCAST | ICommandBuffer::TRANSLUCENT | ICommandBuffer::UI)) {
+        item.custom = true;
+    }
+
+    uint64_t key = 0;
+    if(!(layer & ICommandBuffer::UI)) {
+        float depth = 0.0f;
+        Transform *transform = renderable->actor()->transform();
+        if(transform) {
+            depth = -(p_ptr->m_View * transform->worldPosition()).z;
+        }
+
+        uint16_t material = p_ptr->id(p_ptr->m_Materials, (item.material) ? item.material->material() : nullptr);
+        if(layer & ICommandBuffer::TRANSLUCENT) {
+            key = translucentKey(depth, material);
+        } else {
+            key = opaqueKey(material, p_ptr->id(p_ptr->m_Meshes, item.mesh), depth, item.custom);
+        }
+    }
+
+    p_ptr->m_Order.push_back(p_ptr->m_Items.size());
+    p_ptr->m_Items.push_back(item);
+    p_ptr->m_Keys.push_back(key);
+}
+/*!
+    Sorts the queue by keys.
+    The sorting is stable, so the objects with equal keys keep the order of pushing.
+*/
+void RenderQueue::sort() {
+    uint32_t count = p_ptr->m_Keys.size();
+    if(count < 2 || (p_ptr->m_Layer & ICommandBuffer::UI)) {
+        return;
+    }
+    if(p_ptr->m_TmpKeys.size() < count) {
+        p_ptr->m_TmpKeys.resize(count);
+        p_ptr->m_TmpOrder.resize(count);
+    }
+    radix(&p_ptr->m_Keys[0], &p_ptr->m_Order[0], &p_ptr->m_TmpKeys[0], &p_ptr->m_TmpOrder[0], count);
+}
+/*!
+    Sorts the queue and submits the draw calls to the \a buffer.
+    If the thread \a pool is provided and the queue is big enough, the instanceable geometry is recorded into the CommandList per thread.
+    The recorded lists are executed on the \a buffer in the sorted order, so the result is the same as for the serial drawing.
+    Objects with custom drawing are always drawn on the calling thread.
+*/
+void RenderQueue::draw(ICommandBuffer &buffer, ThreadPool *pool) {
+    sort();
+
+    uint32_t count = p_ptr->m_Order.size();
+    // Custom objects are placed after the all instanceable geometry
+    uint32_t instanced = 0;
+    while(instanced < count && !p_ptr->m_Items[p_ptr->m_Order[instanced]].custom) {
+        instanced++;
+    }
+
+    uint32_t threads = (pool) ? MIN(pool->maxThreads(), instanced / MIN_PARALLEL_ITEMS) : 1;
+    if(threads <= 1) {
+        p_ptr->drawRange(buffer, 0, count, p_ptr->m_Models);
+        return;
+    }
+
+    while(p_ptr->m_Lists.size() < threads) {
+        p_ptr->m_Lists.emplace_back();
+    }
+
+    // The ranges must not split a batch
+    list<RecordTask> tasks;
+    uint32_t step = (instanced + threads - 1) / threads;
+    uint32_t first = 0;
+    auto it = p_ptr->m_Lists.begin();
+    while(first < instanced) {
+        uint32_t last = MIN(first + step, instanced);
+        while(last < instanced && p_ptr->isBatched(last - 1, last)) {
+            last++;
+        }
+        it->begin(&buffer);
+        tasks.emplace_back(p_ptr, &(*it), first, last);
+        pool->start(tasks.back());
+        ++it;
+        first = last;
+    }
+    pool->waitForDone();
+
+    for(auto recorded = p_ptr->m_Lists.begin(); recorded != it; ++recorded) {
+        recorded->execute(buffer);
+    }
+
+    p_ptr->drawRange(buffer, instanced, count, p_ptr->m_Models);
+}
+/*!
+    Returns the number of objects in the queue.
+*/
+uint32_t RenderQueue::size() const {
+    return p_ptr->m_Keys.size();
+}
+/*!
+    Returns the sort key of object with \a index in the current order.
+*/
+uint64_t RenderQueue::key(uint32_t index) const {
+    return p_ptr->m_Keys[index];
+}
+/*!
+    Returns the sort key for the opaque object with \a material and \a mesh identifiers placed on the view \a depth.
+    The \a custom objects are drawn after the all instanceable geometry.
+*/
+uint64_t RenderQueue::opaqueKey(uint16_t material, uint16_t mesh, float depth, bool custom) {
+    return (static_cast<uint64_t>(custom) << CUSTOM_SHIFT) |
+           (static_cast<uint64_t>(material) << MATERIAL_SHIFT) |
+           (static_cast<uint64_t>(mesh) << MESH_SHIFT) |
+           (depthBits(depth) & ((1ULL << DEPTH_BITS) - 1));
+}
+/*!
+    Returns the sort key for the translucent object with \a material identifier placed on the view \a depth.
+    The farthest objects go first.
+*/
+uint64_t RenderQueue::translucentKey(float depth, uint16_t material) {
+    return (static_cast<uint64_t>(~depthBits(depth)) << 32) | (static_cast<uint64_t>(material) << 16);
+}
+/*!
+    Sorts \a count \a keys in the ascending order and moves the \a values along with them.
+    The least significant digit radix sort is stable, passes where all keys have the same digit are skipped.
+*/
+void RenderQueue::radixSort(uint64_t *keys, uint32_t *values, uint32_t count) {
+    if(count < 2) {
+        return;
+    }
+    vector<uint64_t> tmpKeys(count);
+    vector<uint32_t> tmpValues(count);
+    radix(keys, values, &tmpKeys[0], &tmpValues[0], count);
+}
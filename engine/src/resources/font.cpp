@@ -12,162 +12,149 @@
 
 #include "log.h"
 
+#include <threadpool.h>
+#include <distancefield.h>
+
+#include <mutex>
+#include <cstring>
+#include <condition_variable>
+
 #define HEADER  "Header"
 #define DATA    "Data"
 
+#define GLYPHS_READY (Event::UserType + 1)
+
 #define DF_GLYPH_SIZE 128
 #define DF_DEFAULT_SCALE 4
 
+class GlyphTask;
+
 class FontPrivate {
 public:
     FontPrivate() :
         m_pFace(nullptr),
         m_Scale(DF_GLYPH_SIZE * DF_DEFAULT_SCALE),
+        m_SpaceWidth(0.0f),
+        m_LineHeight(0.0f),
+        m_Version(0),
+        m_Pending(0),
         m_UseKerning(false) {
     }
 
+    void wait() {
+        unique_lock<mutex> locker(m_Mutex);
+        m_Condition.wait(locker, [this]() { return m_Pending == 0; });
+    }
+
+    void updateMetrics() {
+        m_SpaceWidth = 0.0f;
+        m_LineHeight = 0.0f;
+
+        FT_Error error = FT_Load_Glyph( m_pFace, FT_Get_Char_Index( m_pFace, ' ' ), FT_LOAD_DEFAULT );
+        if(!error) {
+            m_SpaceWidth = static_cast<float>(m_pFace->glyph->advance.x) / m_Scale / 64.0f;
+        }
+        error = FT_Load_Glyph( m_pFace, FT_Get_Char_Index( m_pFace, '\n' ), FT_LOAD_DEFAULT );
+        if(!error) {
+            m_LineHeight = static_cast<float>(m_pFace->glyph->metrics.height) / m_Scale / 32.0f;
+        }
+    }
+
     typedef unordered_map<uint32_t, uint32_t> GlyphMap;
-    typedef unordered_map<uint32_t, Vector2> SpecialMap;
+    typedef unordered_map<uint64_t, int32_t> KerningMap;
 
     GlyphMap m_GlyphMap;
+    KerningMap m_Kerning;
     ByteArray m_Data;
 
     FT_FaceRec_ *m_pFace;
 
     int32_t m_Scale;
 
-    bool m_UseKerning;
-};
+    float m_SpaceWidth;
+    float m_LineHeight;
 
-struct Point {
-    short dx, dy;
-    int f;
-};
+    uint32_t m_Version;
 
-struct Grid {
-    int32_t w, h;
-    Point *grid;
-};
+    list<GlyphTask *> m_Ready;
+
+    mutex m_Mutex;
+
+    // Kerning is requested from scripts and text components updated in the thread pool
+    mutex m_KerningMutex;
+
+    condition_variable m_Condition;
+
+    uint32_t m_Pending;
 
-static Point pointInside = { 0, 0, 0 };
-static Point pointEmpty = { 9999, 9999, 9999*9999 };
+    bool m_UseKerning;
+};
 
 static FT_Library library = nullptr;
 //FT_Done_FreeType(library);
 
-static inline Point get(Grid &g, int32_t x, int32_t y) {
-    return g.grid[y * (g.w + 2) + x];
+static ThreadPool &glyphPool() {
+    static ThreadPool pool;
+    return pool;
 }
 
-static inline void put(Grid &g, int32_t x, int32_t y, const Point &p) {
-    g.grid[y * (g.w + 2) + x] = p;
-}
-
-static inline void compare(Grid &g, Point &p, int32_t x, int32_t y, int32_t offsetx, int32_t offsety) {
-    int add;
-    Point other = get(g, x + offsetx, y + offsety);
-    if(offsety == 0) {
-        add = 2 * other.dx + 1;
-    } else if(offsetx == 0) {
-        add = 2 * other.dy + 1;
-    } else {
-        add = 2 * (other.dy + other.dx + 1);
-    }
-    other.f += add;
-    if(other.f < p.f) {
-        p.f = other.f;
-        if(offsety == 0) {
-            p.dx = other.dx + 1;
-            p.dy = other.dy;
-        } else if(offsetx == 0) {
-            p.dy = other.dy + 1;
-            p.dx = other.dx;
-        } else {
-            p.dy = other.dy + 1;
-            p.dx = other.dx + 1;
+class GlyphTask : public Object {
+public:
+    GlyphTask(Font *font, FontPrivate *data, const FT_Bitmap &bitmap, Texture *texture, int index) :
+            m_pFont(font),
+            m_pData(data),
+            m_pTexture(texture),
+            m_Index(index),
+            m_Width(texture->width()),
+            m_Height(texture->height()),
+            m_BitmapWidth(bitmap.width),
+            m_BitmapHeight(bitmap.rows) {
+
+        m_Buffer.resize(m_Width * m_Height);
+
+        // FreeType library isn't thread safe, so the worker gets only a copy of the rendered bitmap
+        m_Bitmap.resize(m_BitmapWidth * m_BitmapHeight);
+        for(int32_t y = 0; y < m_BitmapHeight; y++) {
+            memcpy(&m_Bitmap[y * m_BitmapWidth], bitmap.buffer + y * bitmap.pitch, m_BitmapWidth);
         }
     }
-}
 
-static void generateSDF(Grid &g) {
-    for(int32_t y = 1; y <= g.h; y++) {
-        for(int32_t x = 1; x <= g.w; x++) {
-            Point p = get(g, x, y);
-            compare(g, p, x, y, -1,  0);
-            compare(g, p, x, y,  0, -1);
-            compare(g, p, x, y, -1, -1);
-            compare(g, p, x, y,  1, -1);
-            put(g, x, y, p);
+    void processEvents() override {
+        if(m_BitmapWidth && m_BitmapHeight) {
+            DistanceField::generate(reinterpret_cast<const uint8_t *>(&m_Bitmap[0]), m_BitmapWidth, m_BitmapHeight, m_BitmapWidth,
+                                    reinterpret_cast<uint8_t *>(&m_Buffer[0]), m_Width, m_Height);
         }
-    }
+        m_Bitmap.clear();
 
-    for(int32_t y = g.h; y > 0; y--) {
-        for(int32_t x = g.w; x > 0; x--) {
-            Point p = get(g, x, y);
-            compare(g, p, x, y,  1,  0);
-            compare(g, p, x, y,  0,  1);
-            compare(g, p, x, y, -1,  1);
-            compare(g, p, x, y,  1,  1);
-            put(g, x, y, p);
+        unique_lock<mutex> locker(m_pData->m_Mutex);
+        m_pData->m_Ready.push_back(this);
+        if(m_pData->m_Ready.size() == 1) {
+            m_pFont->postEvent(new Event(GLYPHS_READY));
         }
+        m_pData->m_Pending--;
+        m_pData->m_Condition.notify_all();
     }
-}
 
-void calculateDF(int8_t *dst, const FT_Bitmap &src, int32_t dw, int32_t dh) {
-    PROFILE_FUNCTION();
+    Font *m_pFont;
 
-    Grid grid[2];
+    FontPrivate *m_pData;
 
-    int32_t w = src.width;
-    int32_t h = src.rows;
-    grid[0].w = grid[1].w = w;
-    grid[0].h = grid[1].h = h;
-    grid[0].grid = static_cast<Point*>(malloc(sizeof(Point) * (w + 2) * (h + 2)));
-    grid[1].grid = static_cast<Point*>(malloc(sizeof(Point) * (w + 2) * (h + 2)));
+    Texture *m_pTexture;
 
-    for(int32_t x = 0; x < w + 2; x++) {
-        put(grid[0], x, 0, pointInside);
-        put(grid[1], x, 0, pointEmpty);
-    }
-    for(int32_t y = 1; y <= h; y++) {
-        put(grid[0], 0, y, pointInside);
-        put(grid[1], 0, y, pointEmpty);
-
-        for(int32_t x = 1; x <= w; x++) {
-            uint32_t index = (y - 1) * w + (x - 1);
-
-            if(src.buffer[index] > 128) {
-                put(grid[0], x, y, pointEmpty);
-                put(grid[1], x, y, pointInside);
-            } else {
-                put(grid[0], x, y, pointInside);
-                put(grid[1], x, y, pointEmpty);
-            }
-        }
-        put(grid[0], w + 1, y, pointInside);
-        put(grid[1], w + 1, y, pointEmpty);
-    }
-    for(int32_t x = 0; x < w + 2; x++) {
-        put(grid[0], x, h + 1, pointInside);
-        put(grid[1], x, h + 1, pointEmpty);
-    }
-    generateSDF(grid[0]);
-    generateSDF(grid[1]);
-
-    for(int32_t y = 0; y < dh; y++) {
-        for(int32_t x = 0; x < dw; x++) {
-            int gx = x * w / (dw - 1);
-            int gy = y * h / (dh - 1);
-            double dist1 = sqrt((double)(get(grid[0], gx, gy).f + 1));
-            double dist2 = sqrt((double)(get(grid[1], gx, gy).f + 1));
-            double dist = dist1 - dist2;
-            uint32_t index = y * dw + x;
-            dst[index] = CLAMP(dist * 64 / 2.0f + 128, 0, 255);
-        }
-    }
-    free(grid[0].grid);
-    free(grid[1].grid);
-}
+    ByteArray m_Buffer;
+
+    ByteArray m_Bitmap;
+
+    int m_Index;
+
+    int32_t m_Width;
+
+    int32_t m_Height;
+
+    int32_t m_BitmapWidth;
+
+    int32_t m_BitmapHeight;
+};
 
 /*!
     \class Font
@@ -202,6 +189,8 @@ int Font::atlasIndex(int glyph) const {
 }
 /*!
     Requests \a characters to be added to the font atlas.
+    The new glyphs get their places in the atlas and metrics immediately, so the text can be composed right away.
+    The distance fields of glyphs are generated in background, glyphs stay blank until they are ready.
 */
 void Font::requestCharacters(const string &characters) {
     PROFILE_FUNCTION();
@@ -217,21 +206,14 @@ void Font::requestCharacters(const string &characters) {
                 FT_Glyph glyph;
                 error = FT_Get_Glyph(p_ptr->m_pFace->glyph, &glyph);
                 if(!error) {
-                    FT_Glyph_To_Bitmap(&glyph, ft_render_mode_normal, nullptr, true);
-                    FT_Bitmap &bitmap = reinterpret_cast<FT_BitmapGlyph>(glyph)->bitmap;
+                    FT_BBox bbox;
+                    FT_Glyph_Get_CBox(glyph, ft_glyph_bbox_pixels, &bbox);
 
-                    uint32_t w = bitmap.width / DF_DEFAULT_SCALE;
-                    uint32_t h = bitmap.rows / DF_DEFAULT_SCALE;
+                    uint32_t w = (bbox.xMax - bbox.xMin) / DF_DEFAULT_SCALE;
+                    uint32_t h = (bbox.yMax - bbox.yMin) / DF_DEFAULT_SCALE;
                     if(w && h) {
                         Texture::Surface s;
-                        ByteArray buffer;
-                        buffer.resize(w * h);
-                        calculateDF(&buffer[0], bitmap, w, h); /// \todo Must be moved into separate thread
-
-                        s.push_back(buffer);
-
-                        FT_BBox bbox;
-                        FT_Glyph_Get_CBox(glyph, ft_glyph_bbox_pixels, &bbox);
+                        s.push_back(ByteArray(w * h, 0));
 
                         Texture *t  = Engine::objectCreate<Texture>("", this);
                         t->setWidth(w);
@@ -249,27 +231,59 @@ void Font::requestCharacters(const string &characters) {
                         }
                         p_ptr->m_GlyphMap[ch] = index;
 
+                        // Glyph is rasterized on the calling thread, the distance field is generated in background
+                        FT_Glyph bitmap = glyph;
+                        error = FT_Glyph_To_Bitmap(&bitmap, ft_render_mode_normal, nullptr, false);
+                        FT_Bitmap empty = FT_Bitmap();
+                        GlyphTask *task = new GlyphTask(this, p_ptr, (error) ? empty : reinterpret_cast<FT_BitmapGlyph>(bitmap)->bitmap, t, index);
+                        if(!error) {
+                            FT_Done_Glyph(bitmap);
+                        }
+                        {
+                            unique_lock<mutex> locker(p_ptr->m_Mutex);
+                            p_ptr->m_Pending++;
+                        }
+                        glyphPool().start(*task);
+
                         isNew = true;
                     }
+                    FT_Done_Glyph(glyph);
                 }
             }
         }
     }
     if(isNew) {
+        int32_t width = texture()->width();
         pack(1);
+        if(texture()->width() != width) {
+            // Enlarged atlas moves all the glyphs, all composed texts must be rebuilt
+            p_ptr->m_Version++;
+            setState(Ready);
+        }
     }
 }
 /*!
     Returns the kerning offset between a \a glyph and \a previous glyph.
+    Offsets are cached per pair, so the font face is queried once for each pair.
+    This method is thread safe.
     \note In case of font doesn't support kerning this method will return 0.
 */
 int Font::requestKerning(int glyph, int previous) const {
     PROFILE_FUNCTION();
 
     if(p_ptr->m_UseKerning && previous)  {
+        uint64_t key = (static_cast<uint64_t>(previous) << 32) | static_cast<uint32_t>(glyph);
+
+        unique_lock<mutex> locker(p_ptr->m_KerningMutex);
+        auto it = p_ptr->m_Kerning.find(key);
+        if(it != p_ptr->m_Kerning.end()) {
+            return it->second;
+        }
         FT_Vector delta;
         FT_Get_Kerning( p_ptr->m_pFace, previous, glyph, FT_KERNING_DEFAULT, &delta );
-        return delta.x >> 6;
+        int32_t result = delta.x >> 6;
+        p_ptr->m_Kerning[key] = result;
+        return result;
     }
     return 0;
 }
@@ -282,27 +296,17 @@ int Font::length(const string &characters) const {
 }
 /*!
     Returns visual width of space character for the font in world units.
+    \note The value is cached when the font is loaded.
 */
 float Font::spaceWidth() const {
-    PROFILE_FUNCTION();
-
-    FT_Error error = FT_Load_Glyph( p_ptr->m_pFace, FT_Get_Char_Index( p_ptr->m_pFace, ' ' ), FT_LOAD_DEFAULT );
-    if(!error) {
-        return static_cast<float>(p_ptr->m_pFace->glyph->advance.x) / p_ptr->m_Scale / 64.0f;
-    }
-    return 0;
+    return p_ptr->m_SpaceWidth;
 }
 /*!
     Returns visual height for the font in world units.
+    \note The value is cached when the font is loaded.
 */
 float Font::lineHeight() const {
-    PROFILE_FUNCTION();
-
-    FT_Error error = FT_Load_Glyph( p_ptr->m_pFace, FT_Get_Char_Index( p_ptr->m_pFace, '\n' ), FT_LOAD_DEFAULT );
-    if(!error) {
-        return static_cast<float>(p_ptr->m_pFace->glyph->metrics.height) / p_ptr->m_Scale / 32.0f;
-    }
-    return 0;
+    return p_ptr->m_LineHeight;
 }
 /*!
     \internal
@@ -327,6 +331,7 @@ void Font::loadUserData(const VariantMap &data) {
                 return;
             }
             p_ptr->m_UseKerning = FT_HAS_KERNING( p_ptr->m_pFace );
+            p_ptr->updateMetrics();
         }
     }
 
@@ -356,6 +361,48 @@ VariantMap Font::saveUserData() const {
 void Font::clear() {
     PROFILE_FUNCTION();
 
+    p_ptr->wait();
+    for(auto it : p_ptr->m_Ready) {
+        delete it;
+    }
+    p_ptr->m_Ready.clear();
+
     p_ptr->m_GlyphMap.clear();
+    {
+        unique_lock<mutex> locker(p_ptr->m_KerningMutex);
+        p_ptr->m_Kerning.clear();
+    }
+    p_ptr->m_SpaceWidth = 0.0f;
+    p_ptr->m_LineHeight = 0.0f;
+    p_ptr->m_Version++;
+
     FT_Done_Face(p_ptr->m_pFace);
+    p_ptr->m_pFace = nullptr;
+}
+/*!
+    \internal
+    Moves the generated distance fields of glyphs to the atlas.
+*/
+bool Font::event(Event *ev) {
+    if(ev->type() == GLYPHS_READY) {
+        list<GlyphTask *> ready;
+        {
+            unique_lock<mutex> locker(p_ptr->m_Mutex);
+            ready.swap(p_ptr->m_Ready);
+        }
+        for(auto it : ready) {
+            it->m_pTexture->surface(0)[0] = it->m_Buffer;
+            updateElement(it->m_Index);
+            delete it;
+        }
+        return true;
+    }
+    return Sprite::event(ev);
+}
+/*!
+    \internal
+    Returns the revision of the glyph atlas; it changes each time when the glyphs are moved in the atlas.
+*/
+uint32_t Font::version() const {
+    return p_ptr->m_Version;
 }
@@ -7,7 +7,8 @@
 
 MaterialInstance::MaterialInstance(Material *material) :
         m_pMaterial(material),
-        m_SurfaceType(0) {
+        m_SurfaceType(0),
+        m_Overridden(false) {
 
 }
 
@@ -39,6 +40,7 @@ void MaterialInstance::setInteger(const char *name, int32_t *value, int32_t coun
     info.type = MetaType::INTEGER;
 
     m_Info[name] = info;
+    m_Overridden = true;
 }
 void MaterialInstance::setFloat(const char *name, float *value, int32_t count) {
     Info info;
@@ -47,6 +49,7 @@ void MaterialInstance::setFloat(const char *name, float *value, int32_t count) {
     info.type = MetaType::FLOAT;
 
     m_Info[name] = info;
+    m_Overridden = true;
 }
 void MaterialInstance::setVector2(const char *name, Vector2 *value, int32_t count) {
     Info info;
@@ -55,6 +58,7 @@ void MaterialInstance::setVector2(const char *name, Vector2 *value, int32_t coun
     info.type = MetaType::VECTOR2;
 
     m_Info[name] = info;
+    m_Overridden = true;
 }
 void MaterialInstance::setVector3(const char *name, Vector3 *value, int32_t count) {
     Info info;
@@ -63,6 +67,7 @@ void MaterialInstance::setVector3(const char *name, Vector3 *value, int32_t coun
     info.type = MetaType::VECTOR3;
 
     m_Info[name] = info;
+    m_Overridden = true;
 }
 void MaterialInstance::setVector4(const char *name, Vector4 *value, int32_t count) {
     Info info;
@@ -71,6 +76,7 @@ void MaterialInstance::setVector4(const char *name, Vector4 *value, int32_t coun
     info.type = MetaType::VECTOR4;
 
     m_Info[name] = info;
+    m_Overridden = true;
 }
 void MaterialInstance::setMatrix4(const char *name, Matrix4 *value, int32_t count) {
     Info info;
@@ -79,6 +85,7 @@ void MaterialInstance::setMatrix4(const char *name, Matrix4 *value, int32_t coun
     info.type = MetaType::MATRIX4;
 
     m_Info[name] = info;
+    m_Overridden = true;
 }
 
 void MaterialInstance::setTexture(const char *name, Texture *value, int32_t count) {
@@ -88,6 +95,7 @@ void MaterialInstance::setTexture(const char *name, Texture *value, int32_t coun
     info.type = 0;
 
     m_Info[name] = info;
+    m_Overridden = true;
 }
 
 uint16_t MaterialInstance::surfaceType() const {
@@ -98,6 +106,10 @@ void MaterialInstance::setSurfaceType(uint16_t type) {
     m_SurfaceType = type;
 }
 
+bool MaterialInstance::isOverridden() const {
+    return m_Overridden;
+}
+
 /*!
     \class Material
     \brief A Material is a resource which can be applied to a Mesh to control the visual look of the scene.
@@ -1,6 +1,7 @@
 #include <resources/mesh.h>
 
 #include <resources/material.h>
+#include <resources/meshbvh.h>
 
 #include <file.h>
 #include <log.h>
@@ -10,8 +11,10 @@
 
 #define HEADER      "Header"
 #define DATA        "Data"
+#define BVH         "Bvh"
 #define DEFAULTMESH ".embedded/DefaultMesh.mtl"
 
+
 /*!
     \class Lod
     \brief This class contains all necessary data of Level Of Detail for the Mesh.
@@ -166,6 +169,34 @@ public:
 
     }
 
+    ~MeshPrivate() {
+        resetTrees();
+    }
+
+    void resetTrees() {
+        for(auto it : m_Trees) {
+            delete it;
+        }
+        m_Trees.clear();
+    }
+
+    MeshBvh *tree(uint32_t index) {
+        if(m_Trees.size() != m_Lods.size()) {
+            resetTrees();
+            m_Trees.resize(m_Lods.size(), nullptr);
+        }
+        MeshBvh *result = m_Trees[index];
+        if(result == nullptr) {
+            result = new MeshBvh;
+            Lod &lod = m_Lods[index];
+            if(m_Mode == Mesh::Triangles) {
+                result->build(lod.m_Vertices, lod.m_Indices);
+            }
+            m_Trees[index] = result;
+        }
+        return result;
+    }
+
     bool m_Dynamic;
 
     uint8_t m_Flags;
@@ -175,6 +206,8 @@ public:
     LodQueue m_Lods;
 
     AABBox m_Box;
+
+    vector<MeshBvh *> m_Trees;
 };
 
 /*!
@@ -219,6 +252,7 @@ Mesh::~Mesh() {
 */
 void Mesh::clear() {
     p_ptr->m_Lods.clear();
+    p_ptr->resetTrees();
 }
 /*!
     Returns true in case of mesh can by changed at the runtime; otherwise returns false.
@@ -339,6 +373,29 @@ void Mesh::loadUserData(const VariantMap &data) {
         }
         p_ptr->m_Box.setBox(min, max);
     }
+
+    auto bvh = data.find(BVH);
+    if(bvh != data.end()) {
+        VariantList trees = (*bvh).second.value<VariantList>();
+        p_ptr->m_Trees.resize(p_ptr->m_Lods.size(), nullptr);
+
+        uint32_t index = 0;
+        for(auto &it : trees) {
+            if(index >= p_ptr->m_Lods.size()) {
+                break;
+            }
+            ByteArray buffer = it.toByteArray();
+            if(!buffer.empty()) {
+                MeshBvh *tree = new MeshBvh;
+                if(tree->load(buffer) && tree->trianglesCount() == p_ptr->m_Lods[index].m_Indices.size() / 3) {
+                    p_ptr->m_Trees[index] = tree;
+                } else { // Will be rebuilt on demand
+                    delete tree;
+                }
+            }
+            index++;
+        }
+    }
     setState(ToBeUpdated);
 }
 /*!
@@ -429,6 +486,22 @@ VariantMap Mesh::saveUserData() const {
     }
     result[DATA] = surface;
 
+    // Only already built hierarchies are stored
+    VariantList trees;
+    bool built = false;
+    for(uint32_t index = 0; index < p_ptr->m_Trees.size(); index++) {
+        MeshBvh *tree = p_ptr->m_Trees[index];
+        if(tree && !tree->isEmpty()) {
+            trees.push_back(tree->save());
+            built = true;
+        } else {
+            trees.push_back(ByteArray());
+        }
+    }
+    if(built) {
+        result[BVH] = trees;
+    }
+
     return result;
 }
 
@@ -512,44 +585,73 @@ void Mesh::setLod(int lod, Lod *data) {
 */
 void Mesh::batchMesh(Mesh *mesh, Matrix4 *transform) {
     if(mesh) {
+        bool empty = true;
+        for(auto &it : p_ptr->m_Lods) {
+            empty &= it.m_Vertices.empty();
+        }
+        Vector3 min(p_ptr->m_Box.center - p_ptr->m_Box.extent);
+        Vector3 max(p_ptr->m_Box.center + p_ptr->m_Box.extent);
+        if(empty) {
+            min = Vector3( FLT_MAX);
+            max = Vector3(-FLT_MAX);
+        }
+
+        Matrix3 rotation;
+        if(transform) {
+            rotation = transform->rotation();
+        }
+
         for(int i = 0; i < mesh->p_ptr->m_Lods.size(); i++) {
-            Lod lod = mesh->p_ptr->m_Lods[i];
-            if(transform) {
-                for(auto &v : lod.vertices()) {
-                    v = *transform * v;
-                }
+            const Lod &lod = mesh->p_ptr->m_Lods[i];
+            if(i >= p_ptr->m_Lods.size()) {
+                p_ptr->m_Lods.push_back(Lod());
+                p_ptr->m_Lods.back().m_Material = lod.m_Material;
+            }
+            // Attributes are appended in place, the source mesh is never copied
+            Lod &current = p_ptr->m_Lods[i];
+            uint32_t size = current.m_Vertices.size();
 
-                Matrix3 rotation = transform->rotation();
-                for(auto &n : lod.normals()) {
-                    n = rotation * n;
-                }
-                for(auto &t : lod.tangents()) {
-                    t = rotation * t;
-                }
+            current.m_Indices.reserve(current.m_Indices.size() + lod.m_Indices.size());
+            for(auto it : lod.m_Indices) {
+                current.m_Indices.push_back(it + size);
+            }
+
+            current.m_Vertices.reserve(size + lod.m_Vertices.size());
+            for(auto &it : lod.m_Vertices) {
+                Vector3 v = (transform) ? *transform * it : it;
+                min.x = MIN(min.x, v.x);
+                min.y = MIN(min.y, v.y);
+                min.z = MIN(min.z, v.z);
+
+                max.x = MAX(max.x, v.x);
+                max.y = MAX(max.y, v.y);
+                max.z = MAX(max.z, v.z);
+
+                current.m_Vertices.push_back(v);
             }
 
-            if(i < p_ptr->m_Lods.size()) {
-                Lod &current = p_ptr->m_Lods[i];
-                // Indices
-                auto &curIndex = current.indices();
-                uint32_t size = current.vertices().size();
-                auto &srcIndex = lod.indices();
-                for(auto &it : srcIndex) {
-                    it += size;
+            if(transform) {
+                current.m_Normals.reserve(current.m_Normals.size() + lod.m_Normals.size());
+                for(auto &it : lod.m_Normals) {
+                    current.m_Normals.push_back(rotation * it);
+                }
+                current.m_Tangents.reserve(current.m_Tangents.size() + lod.m_Tangents.size());
+                for(auto &it : lod.m_Tangents) {
+                    current.m_Tangents.push_back(rotation * it);
                 }
-                curIndex.insert(curIndex.end(), srcIndex.begin(), srcIndex.end());
-                // Vertex attributes
-                current.vertices().insert(current.vertices().end(), lod.vertices().begin(), lod.vertices().end());
-                current.tangents().insert(current.tangents().end(), lod.tangents().begin(), lod.tangents().end());
-                current.normals().insert(current.normals().end(), lod.normals().begin(), lod.normals().end());
-                current.colors().insert(current.colors().end(), lod.colors().begin(), lod.colors().end());
-                current.uv0().insert(current.uv0().end(), lod.uv0().begin(), lod.uv0().end());
-                current.uv1().insert(current.uv1().end(), lod.uv1().begin(), lod.uv1().end());
             } else {
-                p_ptr->m_Lods.push_back(lod);
+                current.m_Normals.insert(current.m_Normals.end(), lod.m_Normals.begin(), lod.m_Normals.end());
+                current.m_Tangents.insert(current.m_Tangents.end(), lod.m_Tangents.begin(), lod.m_Tangents.end());
             }
+            current.m_Colors.insert(current.m_Colors.end(), lod.m_Colors.begin(), lod.m_Colors.end());
+            current.m_Uv0.insert(current.m_Uv0.end(), lod.m_Uv0.begin(), lod.m_Uv0.end());
+            current.m_Uv1.insert(current.m_Uv1.end(), lod.m_Uv1.begin(), lod.m_Uv1.end());
+            current.m_Weights.insert(current.m_Weights.end(), lod.m_Weights.begin(), lod.m_Weights.end());
+            current.m_Bones.insert(current.m_Bones.end(), lod.m_Bones.begin(), lod.m_Bones.end());
         }
-        recalcBounds();
+
+        p_ptr->m_Box.setBox(min, max);
+        p_ptr->resetTrees();
         setState(ToBeUpdated);
     }
 }
@@ -560,7 +662,7 @@ void Mesh::recalcBounds() {
     Vector3 min( FLT_MAX);
     Vector3 max(-FLT_MAX);
 
-    for(auto l : p_ptr->m_Lods) {
+    for(auto &l : p_ptr->m_Lods) {
         for(uint32_t i = 0; i < l.vertices().size(); i++) {
             min.x = MIN(min.x, l.m_Vertices[i].x);
             min.y = MIN(min.y, l.m_Vertices[i].y);
@@ -573,6 +675,50 @@ void Mesh::recalcBounds() {
     }
 
     p_ptr->m_Box.setBox(min, max);
+    p_ptr->resetTrees();
+}
+/*!
+    Returns true if the \a ray intersects a triangle of the particular \a lod; otherwise returns false.
+    The \a ray must be in the mesh local space, output argument \a pt contains the closest point of intersection.
+    Both sides of triangles are tested. Only Mesh::Triangles mode is supported.
+
+    \sa bvh()
+*/
+bool Mesh::raycast(const Ray &ray, Vector3 *pt, int lod) const {
+    const MeshBvh *tree = bvh(lod);
+    return tree && tree->raycast(ray, pt);
+}
+/*!
+    Returns true if any triangle of the particular \a lod intersects the sphere at \a center with \a radius; otherwise returns false.
+    Indices of overlapped triangles are appended to \a triangles if provided.
+    The sphere must be in the mesh local space.
+
+    \sa bvh()
+*/
+bool Mesh::overlapSphere(const Vector3 &center, float radius, IndexVector *triangles, int lod) const {
+    const MeshBvh *tree = bvh(lod);
+    return tree && tree->overlapSphere(center, radius, triangles);
+}
+/*!
+    Finds the point on the surface of the particular \a lod closest to the given local space \a point.
+    Returns true and writes the result to \a pt if the Lod has triangles; otherwise returns false.
+
+    \sa bvh()
+*/
+bool Mesh::closestPoint(const Vector3 &point, Vector3 *pt, int lod) const {
+    const MeshBvh *tree = bvh(lod);
+    return tree && tree->closestPoint(point, pt);
+}
+/*!
+    Returns the triangle hierarchy for the particular \a lod; returns nullptr if the \a lod doesn't exist.
+    The hierarchy is built on the first call and cached until the geometry is changed with setLod(), addLod(), batchMesh() or recalcBounds().
+    Built hierarchies are stored with the mesh data, so imported meshes don't need to rebuild them at runtime.
+*/
+const MeshBvh *Mesh::bvh(int lod) const {
+    if(lod < 0 || lod >= lodsCount()) {
+        return nullptr;
+    }
+    return p_ptr->tree(lod);
 }
 /*!
     Returns Lod data for the \a lod index if exists; othewise returns nullptr.
@@ -0,0 +1,647 @@
+#include "resources/meshbvh.h"
+
+#include <cstring>
+#include <cfloat>
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define BVH_SSE
+#endif
+
+#define MAGIC       0x48564254 // TBVH
+#define VERSION     1
+
+#define BINS        16
+#define MAX_LEAF    8
+#define STACK_SIZE  64
+#define MAX_DEPTH   (STACK_SIZE - 2)
+
+#define TRAVERSAL_COST  1.0f
+#define TRIANGLE_COST   1.0f
+
+/*!
+    \class MeshBvh
+    \brief Bounding volume hierarchy over triangles of a single Lod.
+    \inmodule Resource
+
+    The hierarchy is built with the binned surface area heuristic.
+    Nodes are stored depth first in 32 byte records, the left child always follows its parent.
+    Triangles are copied in leaf order with precomputed edges, so the queries never touch the source vertex and index arrays.
+
+    Built data can be stored with save() and restored with load() to avoid rebuilding it at runtime.
+*/
+
+struct BvhNode {
+    float min[3];
+    // Leaf: the first triangle; Inner: index of the right child
+    uint32_t offset;
+    float max[3];
+    // Number of triangles in the leaf; 0 for inner nodes
+    uint32_t count;
+};
+
+struct BvhTriangle {
+    float v0[3];
+    float e1[3];
+    float e2[3];
+    // Index of the triangle in the source index array
+    uint32_t index;
+};
+
+struct BvhHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nodes;
+    uint32_t triangles;
+};
+
+class MeshBvhPrivate {
+public:
+    // Plain arrays keep the build loops free of out-of-line vector calls
+    struct Bounds {
+        Bounds() {
+            reset();
+        }
+
+        void reset() {
+            for(int32_t axis = 0; axis < 3; axis++) {
+                min[axis] = FLT_MAX;
+                max[axis] =-FLT_MAX;
+            }
+        }
+
+        void encapsulate(const float *bmin, const float *bmax) {
+            for(int32_t axis = 0; axis < 3; axis++) {
+                min[axis] = MIN(min[axis], bmin[axis]);
+                max[axis] = MAX(max[axis], bmax[axis]);
+            }
+        }
+
+        float area() const {
+            float x = max[0] - min[0];
+            float y = max[1] - min[1];
+            float z = max[2] - min[2];
+            return x * y + y * z + z * x;
+        }
+
+        float min[3];
+        float max[3];
+    };
+
+    struct Reference {
+        Bounds box;
+        float center[3];
+    };
+
+    struct Bin {
+        Bin() :
+                count(0) {
+
+        }
+
+        Bounds box;
+        uint32_t count;
+    };
+
+    uint32_t buildNode(const vector<Reference> &references, vector<uint32_t> &order, uint32_t begin, uint32_t end, uint32_t depth) {
+        uint32_t index = m_Nodes.size();
+        m_Nodes.push_back(BvhNode());
+
+        Bounds bounds;
+        Bounds centers;
+        for(uint32_t i = begin; i < end; i++) {
+            const Reference &ref = references[order[i]];
+            bounds.encapsulate(ref.box.min, ref.box.max);
+            centers.encapsulate(ref.center, ref.center);
+        }
+        // Conservative padding keeps rays lying exactly on a face inside the slab
+        BvhNode &node = m_Nodes[index];
+        for(int32_t axis = 0; axis < 3; axis++) {
+            float pad = (bounds.max[axis] - bounds.min[axis]) * 1e-5f + 1e-6f;
+            node.min[axis] = bounds.min[axis] - pad;
+            node.max[axis] = bounds.max[axis] + pad;
+        }
+
+        uint32_t count = end - begin;
+        if(count <= 2 || depth >= MAX_DEPTH) {
+            return makeLeaf(index, begin, count);
+        }
+
+        // Binned SAH over the centroid bounds
+        float leafCost = TRIANGLE_COST * count;
+        float bestCost = FLT_MAX;
+        int32_t bestAxis = -1;
+        int32_t bestSplit = 0;
+        for(int32_t axis = 0; axis < 3; axis++) {
+            float extent = centers.max[axis] - centers.min[axis];
+            if(extent <= 0.0f) {
+                continue;
+            }
+            float scale = BINS / extent;
+
+            Bin bins[BINS];
+            for(uint32_t i = begin; i < end; i++) {
+                const Reference &ref = references[order[i]];
+                int32_t b = MIN(static_cast<int32_t>((ref.center[axis] - centers.min[axis]) * scale), BINS - 1);
+                bins[b].box.encapsulate(ref.box.min, ref.box.max);
+                bins[b].count++;
+            }
+
+            float rightArea[BINS];
+            uint32_t rightCount[BINS];
+            Bin right;
+            for(int32_t b = BINS - 1; b > 0; b--) {
+                right.box.encapsulate(bins[b].box.min, bins[b].box.max);
+                right.count += bins[b].count;
+                rightArea[b] = right.count ? right.box.area() : 0.0f;
+                rightCount[b] = right.count;
+            }
+
+            Bin left;
+            for(int32_t b = 0; b < BINS - 1; b++) {
+                left.box.encapsulate(bins[b].box.min, bins[b].box.max);
+                left.count += bins[b].count;
+                if(left.count == 0 || rightCount[b + 1] == 0) {
+                    continue;
+                }
+                float cost = left.box.area() * left.count + rightArea[b + 1] * rightCount[b + 1];
+                if(cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b;
+                }
+            }
+        }
+
+        if(bestAxis < 0) {
+            return makeLeaf(index, begin, count);
+        }
+        bestCost = TRAVERSAL_COST + TRIANGLE_COST * bestCost / bounds.area();
+        if(bestCost >= leafCost && count <= MAX_LEAF) {
+            return makeLeaf(index, begin, count);
+        }
+
+        float origin = centers.min[bestAxis];
+        float scale = BINS / (centers.max[bestAxis] - origin);
+        auto middle = partition(order.begin() + begin, order.begin() + end, [&](uint32_t i) {
+            int32_t b = MIN(static_cast<int32_t>((references[i].center[bestAxis] - origin) * scale), BINS - 1);
+            return b <= bestSplit;
+        });
+        uint32_t split = static_cast<uint32_t>(middle - order.begin());
+
+        buildNode(references, order, begin, split, depth + 1);
+        uint32_t right = buildNode(references, order, split, end, depth + 1);
+
+        m_Nodes[index].offset = right;
+        m_Nodes[index].count = 0;
+        return index;
+    }
+
+    uint32_t makeLeaf(uint32_t index, uint32_t begin, uint32_t count) {
+        m_Nodes[index].offset = begin;
+        m_Nodes[index].count = count;
+        return index;
+    }
+
+    static inline bool slabTest(const BvhNode &node, const float *origin, const float *inverse, float distance, float &enter) {
+#ifdef BVH_SSE
+        __m128 o = _mm_loadu_ps(origin);
+        __m128 inv = _mm_loadu_ps(inverse);
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.min), o), inv);
+        __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.max), o), inv);
+        __m128 lo = _mm_min_ps(t1, t2);
+        __m128 hi = _mm_max_ps(t1, t2);
+        // Horizontal reduction over xyz, the w lane is ignored
+        __m128 tmin = _mm_max_ss(_mm_max_ss(lo, _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(1, 1, 1, 1))), _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(2, 2, 2, 2)));
+        __m128 tmax = _mm_min_ss(_mm_min_ss(hi, _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(1, 1, 1, 1))), _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(2, 2, 2, 2)));
+        enter = MAX(_mm_cvtss_f32(tmin), 0.0f);
+        float exit = MIN(_mm_cvtss_f32(tmax), distance);
+#else
+        enter = 0.0f;
+        float exit = distance;
+        for(int32_t axis = 0; axis < 3; axis++) {
+            float t1 = (node.min[axis] - origin[axis]) * inverse[axis];
+            float t2 = (node.max[axis] - origin[axis]) * inverse[axis];
+            enter = MAX(enter, MIN(t1, t2));
+            exit = MIN(exit, MAX(t1, t2));
+        }
+#endif
+        return enter <= exit;
+    }
+
+    static inline bool intersect(const BvhTriangle &tri, const Vector3 &origin, const Vector3 &dir, float &t) {
+        // Moller-Trumbore, both sides are tested
+        Vector3 e1(tri.e1[0], tri.e1[1], tri.e1[2]);
+        Vector3 e2(tri.e2[0], tri.e2[1], tri.e2[2]);
+        Vector3 p = dir.cross(e2);
+        float det = e1.dot(p);
+        if(det > -FLT_EPSILON * FLT_EPSILON && det < FLT_EPSILON * FLT_EPSILON) {
+            return false;
+        }
+        float inv = 1.0f / det;
+        Vector3 s = origin - Vector3(tri.v0[0], tri.v0[1], tri.v0[2]);
+        float u = s.dot(p) * inv;
+        if(u < 0.0f || u > 1.0f) {
+            return false;
+        }
+        Vector3 q = s.cross(e1);
+        float v = dir.dot(q) * inv;
+        if(v < 0.0f || u + v > 1.0f) {
+            return false;
+        }
+        t = e2.dot(q) * inv;
+        return t > 0.0f;
+    }
+
+    static inline float boxDistance(const BvhNode &node, const Vector3 &point) {
+        float result = 0.0f;
+        for(int32_t axis = 0; axis < 3; axis++) {
+            float d = 0.0f;
+            if(point[axis] < node.min[axis]) {
+                d = node.min[axis] - point[axis];
+            } else if(point[axis] > node.max[axis]) {
+                d = point[axis] - node.max[axis];
+            }
+            result += d * d;
+        }
+        return result;
+    }
+
+    static Vector3 closestOnTriangle(const BvhTriangle &tri, const Vector3 &p) {
+        // Real-Time Collision Detection, 5.1.5
+        Vector3 a(tri.v0[0], tri.v0[1], tri.v0[2]);
+        Vector3 ab(tri.e1[0], tri.e1[1], tri.e1[2]);
+        Vector3 ac(tri.e2[0], tri.e2[1], tri.e2[2]);
+
+        Vector3 ap = p - a;
+        float d1 = ab.dot(ap);
+        float d2 = ac.dot(ap);
+        if(d1 <= 0.0f && d2 <= 0.0f) {
+            return a;
+        }
+
+        Vector3 bp = ap - ab;
+        float d3 = ab.dot(bp);
+        float d4 = ac.dot(bp);
+        if(d3 >= 0.0f && d4 <= d3) {
+            return a + ab;
+        }
+
+        float vc = d1 * d4 - d3 * d2;
+        if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+            return a + ab * (d1 / (d1 - d3));
+        }
+
+        Vector3 cp = ap - ac;
+        float d5 = ab.dot(cp);
+        float d6 = ac.dot(cp);
+        if(d6 >= 0.0f && d5 <= d6) {
+            return a + ac;
+        }
+
+        float vb = d5 * d2 - d1 * d6;
+        if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+            return a + ac * (d2 / (d2 - d6));
+        }
+
+        float va = d3 * d6 - d5 * d4;
+        if(va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+            return a + ab + (ac - ab) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+
+        float denom = 1.0f / (va + vb + vc);
+        return a + ab * (vb * denom) + ac * (vc * denom);
+    }
+
+    vector<BvhNode> m_Nodes;
+
+    vector<BvhTriangle> m_Triangles;
+};
+
+MeshBvh::MeshBvh() :
+        p_ptr(new MeshBvhPrivate) {
+
+}
+
+MeshBvh::~MeshBvh() {
+    delete p_ptr;
+}
+/*!
+    Builds the hierarchy for triangles stitched by \a indices from \a vertices.
+    The previous content is replaced.
+*/
+void MeshBvh::build(const Vector3Vector &vertices, const IndexVector &indices) {
+    clear();
+
+    uint32_t count = indices.size() / 3;
+    if(count == 0) {
+        return;
+    }
+
+    vector<MeshBvhPrivate::Reference> references(count);
+    vector<uint32_t> order(count);
+    for(uint32_t i = 0; i < count; i++) {
+        const Vector3 &v0 = vertices[indices[i * 3]];
+        const Vector3 &v1 = vertices[indices[i * 3 + 1]];
+        const Vector3 &v2 = vertices[indices[i * 3 + 2]];
+
+        MeshBvhPrivate::Reference &ref = references[i];
+        for(int32_t axis = 0; axis < 3; axis++) {
+            ref.box.min[axis] = MIN(v0[axis], MIN(v1[axis], v2[axis]));
+            ref.box.max[axis] = MAX(v0[axis], MAX(v1[axis], v2[axis]));
+            ref.center[axis] = (ref.box.min[axis] + ref.box.max[axis]) * 0.5f;
+        }
+        order[i] = i;
+    }
+
+    p_ptr->m_Nodes.reserve(count / 2 + 1);
+    p_ptr->buildNode(references, order, 0, count, 0);
+    p_ptr->m_Nodes.shrink_to_fit();
+
+    p_ptr->m_Triangles.resize(count);
+    for(uint32_t i = 0; i < count; i++) {
+        uint32_t t = order[i];
+        const Vector3 &v0 = vertices[indices[t * 3]];
+        Vector3 e1 = vertices[indices[t * 3 + 1]] - v0;
+        Vector3 e2 = vertices[indices[t * 3 + 2]] - v0;
+
+        BvhTriangle &tri = p_ptr->m_Triangles[i];
+        for(int32_t axis = 0; axis < 3; axis++) {
+            tri.v0[axis] = v0[axis];
+            tri.e1[axis] = e1[axis];
+            tri.e2[axis] = e2[axis];
+        }
+        tri.index = t;
+    }
+}
+/*!
+    Removes all nodes and triangles.
+*/
+void MeshBvh::clear() {
+    p_ptr->m_Nodes.clear();
+    p_ptr->m_Triangles.clear();
+}
+/*!
+    Returns true if the hierarchy doesn't contain any triangle; otherwise returns false.
+*/
+bool MeshBvh::isEmpty() const {
+    return p_ptr->m_Nodes.empty();
+}
+/*!
+    Returns the number of nodes in the hierarchy.
+*/
+uint32_t MeshBvh::nodesCount() const {
+    return p_ptr->m_Nodes.size();
+}
+/*!
+    Returns the number of triangles in the hierarchy.
+*/
+uint32_t MeshBvh::trianglesCount() const {
+    return p_ptr->m_Triangles.size();
+}
+/*!
+    Returns the bounding box of the root node.
+*/
+AABBox MeshBvh::bound() const {
+    AABBox result;
+    if(!p_ptr->m_Nodes.empty()) {
+        const BvhNode &root = p_ptr->m_Nodes[0];
+        result.setBox(Vector3(root.min[0], root.min[1], root.min[2]), Vector3(root.max[0], root.max[1], root.max[2]));
+    }
+    return result;
+}
+/*!
+    Returns true if the \a ray intersects any triangle; otherwise returns false.
+    Output argument \a pt contains the closest point of intersection and \a triangle contains its index in the source index array.
+*/
+bool MeshBvh::raycast(const Ray &ray, Vector3 *pt, uint32_t *triangle) const {
+    if(p_ptr->m_Nodes.empty()) {
+        return false;
+    }
+
+    float origin[4] = {ray.pos.x, ray.pos.y, ray.pos.z, 0.0f};
+    float inverse[4] = {1.0f / ray.dir.x, 1.0f / ray.dir.y, 1.0f / ray.dir.z, 0.0f};
+
+    float distance = FLT_MAX;
+    const BvhTriangle *result = nullptr;
+
+    uint32_t stack[STACK_SIZE];
+    int32_t top = 0;
+
+    float enter;
+    if(!MeshBvhPrivate::slabTest(p_ptr->m_Nodes[0], origin, inverse, distance, enter)) {
+        return false;
+    }
+    stack[top++] = 0;
+    while(top > 0) {
+        const BvhNode &node = p_ptr->m_Nodes[stack[--top]];
+        if(node.count > 0) {
+            for(uint32_t i = node.offset; i < node.offset + node.count; i++) {
+                const BvhTriangle &tri = p_ptr->m_Triangles[i];
+                float t;
+                if(MeshBvhPrivate::intersect(tri, ray.pos, ray.dir, t) && t < distance) {
+                    distance = t;
+                    result = &tri;
+                }
+            }
+            continue;
+        }
+
+        uint32_t left = static_cast<uint32_t>(&node - &p_ptr->m_Nodes[0]) + 1;
+        uint32_t right = node.offset;
+        float enterLeft, enterRight;
+        bool hitLeft = MeshBvhPrivate::slabTest(p_ptr->m_Nodes[left], origin, inverse, distance, enterLeft);
+        bool hitRight = MeshBvhPrivate::slabTest(p_ptr->m_Nodes[right], origin, inverse, distance, enterRight);
+        if(top + 2 > STACK_SIZE) {
+            continue;
+        }
+        // The nearest child is visited first to shrink the distance early
+        if(hitLeft && hitRight) {
+            if(enterLeft < enterRight) {
+                stack[top++] = right;
+                stack[top++] = left;
+            } else {
+                stack[top++] = left;
+                stack[top++] = right;
+            }
+        } else if(hitLeft) {
+            stack[top++] = left;
+        } else if(hitRight) {
+            stack[top++] = right;
+        }
+    }
+
+    if(result) {
+        if(pt) {
+            *pt = ray.pos + ray.dir * distance;
+        }
+        if(triangle) {
+            *triangle = result->index;
+        }
+        return true;
+    }
+    return false;
+}
+/*!
+    Returns true if any triangle intersects the sphere at \a center with \a radius; otherwise returns false.
+    Indices of all overlapped triangles are appended to \a triangles if provided; otherwise the query stops at the first one.
+*/
+bool MeshBvh::overlapSphere(const Vector3 &center, float radius, IndexVector *triangles) const {
+    if(p_ptr->m_Nodes.empty()) {
+        return false;
+    }
+
+    float sqrRadius = radius * radius;
+    bool result = false;
+
+    uint32_t stack[STACK_SIZE];
+    int32_t top = 0;
+    stack[top++] = 0;
+    while(top > 0) {
+        uint32_t index = stack[--top];
+        const BvhNode &node = p_ptr->m_Nodes[index];
+        if(MeshBvhPrivate::boxDistance(node, center) > sqrRadius) {
+            continue;
+        }
+
+        if(node.count > 0) {
+            for(uint32_t i = node.offset; i < node.offset + node.count; i++) {
+                const BvhTriangle &tri = p_ptr->m_Triangles[i];
+                if((MeshBvhPrivate::closestOnTriangle(tri, center) - center).sqrLength() <= sqrRadius) {
+                    result = true;
+                    if(triangles == nullptr) {
+                        return true;
+                    }
+                    triangles->push_back(tri.index);
+                }
+            }
+        } else if(top + 2 <= STACK_SIZE) {
+            stack[top++] = node.offset;
+            stack[top++] = index + 1;
+        }
+    }
+    return result;
+}
+/*!
+    Finds the point on the surface closest to the given \a point.
+    Returns true if the hierarchy isn't empty and writes the result to \a pt and the index of the source triangle to \a triangle; otherwise returns false.
+*/
+bool MeshBvh::closestPoint(const Vector3 &point, Vector3 *pt, uint32_t *triangle) const {
+    if(p_ptr->m_Nodes.empty()) {
+        return false;
+    }
+
+    float distance = FLT_MAX;
+    const BvhTriangle *result = nullptr;
+    Vector3 closest;
+
+    uint32_t stack[STACK_SIZE];
+    int32_t top = 0;
+    stack[top++] = 0;
+    while(top > 0) {
+        uint32_t index = stack[--top];
+        const BvhNode &node = p_ptr->m_Nodes[index];
+        if(MeshBvhPrivate::boxDistance(node, point) >= distance) {
+            continue;
+        }
+
+        if(node.count > 0) {
+            for(uint32_t i = node.offset; i < node.offset + node.count; i++) {
+                const BvhTriangle &tri = p_ptr->m_Triangles[i];
+                Vector3 p = MeshBvhPrivate::closestOnTriangle(tri, point);
+                float d = (p - point).sqrLength();
+                if(d < distance) {
+                    distance = d;
+                    closest = p;
+                    result = &tri;
+                }
+            }
+        } else if(top + 2 <= STACK_SIZE) {
+            uint32_t left = index + 1;
+            uint32_t right = node.offset;
+            // The nearest child is visited first
+            if(MeshBvhPrivate::boxDistance(p_ptr->m_Nodes[left], point) < MeshBvhPrivate::boxDistance(p_ptr->m_Nodes[right], point)) {
+                stack[top++] = right;
+                stack[top++] = left;
+            } else {
+                stack[top++] = left;
+                stack[top++] = right;
+            }
+        }
+    }
+
+    if(pt) {
+        *pt = closest;
+    }
+    if(triangle) {
+        *triangle = result->index;
+    }
+    return true;
+}
+/*!
+    Returns the binary representation of the hierarchy.
+*/
+ByteArray MeshBvh::save() const {
+    BvhHeader header;
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.nodes = p_ptr->m_Nodes.size();
+    header.triangles = p_ptr->m_Triangles.size();
+
+    size_t nodes = sizeof(BvhNode) * header.nodes;
+    size_t triangles = sizeof(BvhTriangle) * header.triangles;
+
+    ByteArray result(sizeof(BvhHeader) + nodes + triangles);
+    memcpy(&result[0], &header, sizeof(BvhHeader));
+    if(nodes) {
+        memcpy(&result[sizeof(BvhHeader)], &p_ptr->m_Nodes[0], nodes);
+    }
+    if(triangles) {
+        memcpy(&result[sizeof(BvhHeader) + nodes], &p_ptr->m_Triangles[0], triangles);
+    }
+    return result;
+}
+/*!
+    Restores the hierarchy from \a data produced by save().
+    Returns true on success; otherwise returns false and leaves the hierarchy empty.
+*/
+bool MeshBvh::load(const ByteArray &data) {
+    clear();
+
+    if(data.size() < sizeof(BvhHeader)) {
+        return false;
+    }
+    BvhHeader header;
+    memcpy(&header, &data[0], sizeof(BvhHeader));
+    if(header.magic != MAGIC || header.version != VERSION) {
+        return false;
+    }
+
+    size_t nodes = sizeof(BvhNode) * header.nodes;
+    size_t triangles = sizeof(BvhTriangle) * header.triangles;
+    if(data.size() != sizeof(BvhHeader) + nodes + triangles) {
+        return false;
+    }
+
+    p_ptr->m_Nodes.resize(header.nodes);
+    p_ptr->m_Triangles.resize(header.triangles);
+    if(nodes) {
+        memcpy(&p_ptr->m_Nodes[0], &data[sizeof(BvhHeader)], nodes);
+    }
+    if(triangles) {
+        memcpy(&p_ptr->m_Triangles[0], &data[sizeof(BvhHeader) + nodes], triangles);
+    }
+
+    // Reject corrupted links to keep queries in bounds
+    for(uint32_t i = 0; i < header.nodes; i++) {
+        const BvhNode &node = p_ptr->m_Nodes[i];
+        bool valid = (node.count > 0) ? (node.offset + node.count <= header.triangles && node.offset + node.count > node.offset) :
+                                        (node.offset > i + 1 && node.offset < header.nodes && i + 1 < header.nodes);
+        if(!valid) {
+            clear();
+            return false;
+        }
+    }
+    return true;
+}
@@ -25,6 +25,7 @@
 #include "log.h"
 
 #include "commandbuffer.h"
+#include "renderqueue.h"
 
 #include <algorithm>
 
@@ -44,6 +45,7 @@
 
 Pipeline::Pipeline() :
         m_Buffer(nullptr),
+        m_pQueue(new RenderQueue),
         m_pSprite(nullptr),
         m_Target(0),
         m_Width(64),
@@ -114,6 +116,8 @@ Pipeline::Pipeline() :
 
 Pipeline::~Pipeline() {
     m_textureBuffers.clear();
+
+    delete m_pQueue;
 }
 
 void Pipeline::draw(Camera &camera) {
@@ -233,7 +237,6 @@ void Pipeline::analizeScene(Scene *scene, RenderSystem *system) {
 
     Camera *camera = Camera::current();
     m_Filter = Camera::frustumCulling(m_SceneComponents, Camera::frustumCorners(*camera));
-    sortByDistance(m_Filter, camera->actor()->transform()->position());
 
     if(!m_PostProcessSettings.empty()) {
         PostProcessSettings *settings = m_PostProcessSettings.front();
@@ -330,10 +333,16 @@ ICommandBuffer *Pipeline::buffer() const {
     return m_Buffer;
 }
 
+void Pipeline::setBuffer(ICommandBuffer *buffer) {
+    m_Buffer = buffer;
+}
+
 void Pipeline::drawComponents(uint32_t layer, list<Renderable *> &list) {
+    m_pQueue->begin(layer, m_Buffer->view());
     for(auto it : list) {
-        it->draw(*m_Buffer, layer);
+        m_pQueue->push(it);
     }
+    m_pQueue->draw(*m_Buffer, (m_pSystem) ? m_pSystem->threadPool() : nullptr);
 }
 
 void Pipeline::cleanShadowCache() {
@@ -398,7 +407,7 @@ void Pipeline::combineComponents(Object *object, bool update) {
         Object *child = it;
         if(child->isRenderable()) {
             Renderable *comp = static_cast<Renderable *>(child);
-            if(comp->actor()->isEnabledInHierarchy()) {
+            if(comp->isEnabled() && comp->actor()->isEnabledInHierarchy()) {
                 if(update) {
                     comp->update();
                 }
@@ -417,19 +426,3 @@ void Pipeline::combineComponents(Object *object, bool update) {
         }
     }
 }
-
-struct ObjectComp {
-    bool operator() (const Renderable *left, const Renderable *right) {
-        Matrix4 m1 = left->actor()->transform()->worldTransform();
-        Matrix4 m2 = right->actor()->transform()->worldTransform();
-        return origin.dot(Vector3(m1[12], m1[13], m1[14])) < origin.dot(Vector3(m2[12], m2[13], m2[14]));
-    }
-    Vector3 origin;
-};
-
-void Pipeline::sortByDistance(list<Renderable *> &in, const Vector3 &origin) {
-    ObjectComp comp;
-    comp.origin = origin;
-
-    in.sort(comp);
-}
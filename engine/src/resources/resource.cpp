@@ -1,6 +1,7 @@
 #include "resources/resource.h"
 
 #include <mutex>
+#include <atomic>
 
 class ResourcePrivate {
 public:
@@ -10,7 +11,8 @@ public:
         m_ReferenceCount(0) {
 
     }
-    Resource::ResourceState m_State;
+    // The state is checked by the render thread in the pipelined mode
+    atomic<Resource::ResourceState> m_State;
     Resource::ResourceState m_Last;
     uint32_t m_ReferenceCount;
     list<Resource::IObserver *> m_Observers;
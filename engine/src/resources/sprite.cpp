@@ -12,6 +12,7 @@
 #define MESHES  "Meshes"
 
 typedef deque<Texture *> Textures;
+typedef deque<AtlasNode *> Nodes;
 typedef unordered_map<int, Mesh *> Meshes;
 
 static Vector3Vector vertEmpty;
@@ -21,16 +22,71 @@ class SpritePrivate {
 public:
     SpritePrivate() :
         m_pTexture(nullptr),
-        m_pRoot(new AtlasNode) {
+        m_pRoot(new AtlasNode),
+        m_Padding(0) {
 
     }
+
+    bool place(uint32_t index, int32_t padding) {
+        Texture *it = m_Sources[index];
+
+        int32_t width  = (it->width() + padding * 2);
+        int32_t height = (it->height() + padding * 2);
+
+        AtlasNode *n = m_pRoot->insert(width, height);
+        if(n == nullptr) {
+            return false;
+        }
+        n->fill = true;
+        m_Nodes.push_back(n);
+
+        Mesh *m = m_Meshes[index];
+        Lod *lod = (m) ? m->lod(0) : nullptr;
+        if(lod) {
+            int32_t w = n->w - padding * 2;
+            int32_t h = n->h - padding * 2;
+
+            Vector4 uv;
+            uv.x = n->x / static_cast<float>(m_pRoot->w);
+            uv.y = (n->y + padding) / static_cast<float>(m_pRoot->h);
+            uv.z = uv.x + w / static_cast<float>(m_pRoot->w);
+            uv.w = uv.y + h / static_cast<float>(m_pRoot->h);
+
+            lod->setUv0({Vector2(uv.x, uv.y),
+                         Vector2(uv.z, uv.y),
+                         Vector2(uv.z, uv.w),
+                         Vector2(uv.x, uv.w)});
+        }
+        copy(index, padding);
+        return true;
+    }
+
+    void copy(uint32_t index, int32_t padding) {
+        Texture *it = m_Sources[index];
+        AtlasNode *n = m_Nodes[index];
+
+        int32_t w = n->w - padding * 2;
+        int32_t h = n->h - padding * 2;
+
+        int8_t *src = &(it->surface(0)[0])[0];
+        int8_t *dst = &(m_pTexture->surface(0)[0])[0];
+        for(int32_t y = 0; y < h; y++) {
+            memcpy(&dst[(y + n->y + padding) * m_pRoot->w + n->x], &src[y * w], w);
+        }
+    }
+
     Meshes m_Meshes;
 
     Texture *m_pTexture;
 
     Textures m_Sources;
 
+    // Atlas places of the packed sources, in the same order
+    Nodes m_Nodes;
+
     AtlasNode *m_pRoot;
+
+    int32_t m_Padding;
 };
 
 /*!
@@ -73,6 +129,14 @@ void Sprite::clearAtlas() {
         delete it;
     }
     p_ptr->m_Sources.clear();
+    p_ptr->m_Nodes.clear();
+
+    int32_t width = p_ptr->m_pRoot->w;
+    int32_t height = p_ptr->m_pRoot->h;
+    delete p_ptr->m_pRoot;
+    p_ptr->m_pRoot = new AtlasNode;
+    p_ptr->m_pRoot->w = width;
+    p_ptr->m_pRoot->h = height;
 }
 /*!
     Adds new sub \a texture as element to current sprite sheet.
@@ -105,49 +169,51 @@ int Sprite::addElement(Texture *texture) {
 /*!
     Packs all added elements int to a single sprite sheet.
     Parameter \a padding can be used to delimit elements.
+    The elements which are already packed keep their places, only the new ones are placed to the free space.
+    In case of the sprite sheet has no space left, it will be enlarged and all the elements will be repacked.
 
     \sa addElement()
 */
 void Sprite::pack(int padding) {
     PROFILE_FUNCTION();
 
-    for(size_t i = 0; i < p_ptr->m_Sources.size(); i++) {
-        Texture *it = p_ptr->m_Sources[i];
-        Mesh *m = mesh(i);
-        Lod *lod = m->lod(0);
-
-        int32_t width  = (it->width() + padding * 2);
-        int32_t height = (it->height() + padding * 2);
+    if(!p_ptr->m_Nodes.empty() && padding != p_ptr->m_Padding) {
+        // Places of the packed elements depend on padding
+        resize(p_ptr->m_pRoot->w, p_ptr->m_pRoot->h);
+    }
+    p_ptr->m_Padding = padding;
 
-        AtlasNode *n = p_ptr->m_pRoot->insert(width, height);
-        if(n && lod) {
-            n->fill = true;
-            int32_t w = n->w - padding * 2;
-            int32_t h = n->h - padding * 2;
+    for(uint32_t i = p_ptr->m_Nodes.size(); i < p_ptr->m_Sources.size(); i++) {
+        if(!p_ptr->place(i, padding)) {
+            break;
+        }
+        AtlasNode *n = p_ptr->m_Nodes[i];
+        p_ptr->m_pTexture->setDirtyRegion(n->x, n->y, n->w, n->h);
+    }
 
-            Vector4 uv;
-            uv.x = n->x / static_cast<float>(p_ptr->m_pRoot->w);
-            uv.y = (n->y + padding) / static_cast<float>(p_ptr->m_pRoot->h);
-            uv.z = uv.x + w / static_cast<float>(p_ptr->m_pRoot->w);
-            uv.w = uv.y + h / static_cast<float>(p_ptr->m_pRoot->h);
-
-            int8_t *src = &(it->surface(0)[0])[0];
-            int8_t *dst = &(p_ptr->m_pTexture->surface(0)[0])[0];
-            for(int32_t y = 0; y < h; y++) {
-                memcpy(&dst[(y + n->y + padding) * p_ptr->m_pRoot->w + n->x], &src[y * w], w);
+    while(p_ptr->m_Nodes.size() < p_ptr->m_Sources.size()) {
+        resize(p_ptr->m_pRoot->w * 2, p_ptr->m_pRoot->h * 2);
+        for(uint32_t i = 0; i < p_ptr->m_Sources.size(); i++) {
+            if(!p_ptr->place(i, padding)) {
+                break;
             }
-
-            lod->setUv0({Vector2(uv.x, uv.y),
-                         Vector2(uv.z, uv.y),
-                         Vector2(uv.z, uv.w),
-                         Vector2(uv.x, uv.w)});
-        } else {
-            resize(p_ptr->m_pRoot->w * 2, p_ptr->m_pRoot->h * 2);
-            pack(padding);
         }
     }
+}
+/*!
+    \internal
+    Copies the pixels of the element with \a key to the sprite sheet again.
+    Commonly used in case of the element texture was changed after packing.
+*/
+void Sprite::updateElement(int key) {
+    PROFILE_FUNCTION();
+
+    if(key >= 0 && key < static_cast<int>(p_ptr->m_Nodes.size())) {
+        p_ptr->copy(key, p_ptr->m_Padding);
 
-    p_ptr->m_pTexture->setDirty();
+        AtlasNode *n = p_ptr->m_Nodes[key];
+        p_ptr->m_pTexture->setDirtyRegion(n->x, n->y, n->w, n->h);
+    }
 }
 
 /*!
@@ -161,6 +227,7 @@ void Sprite::resize(int32_t width, int32_t height) {
         delete p_ptr->m_pRoot;
         p_ptr->m_pRoot = new AtlasNode;
     }
+    p_ptr->m_Nodes.clear();
     p_ptr->m_pRoot->w = width;
     p_ptr->m_pRoot->h = height;
 
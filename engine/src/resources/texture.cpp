@@ -16,7 +16,8 @@ public:
             m_Wrap(Texture::Clamp),
             m_Width(1),
             m_Height(1),
-            m_Depth(0) {
+            m_Depth(0),
+            m_Partial(false) {
 
     }
 
@@ -32,6 +33,10 @@ public:
 
     Vector2Vector m_Shape;
     Texture::Sides m_Sides;
+
+    int32_t m_Region[4];
+
+    bool m_Partial;
 };
 
 /*!
@@ -65,6 +70,16 @@ public:
     \value Depth \c Depth buffer texture format. Number bits per pixel depend on graphical settings and hardware. Can be 16, 24 or 32-bit per pixel.
 */
 
+/*!
+    \enum Texture::CompressionType
+
+    \value Uncompressed \c Texture data is stored as is.
+    \value DXT1 \c BC1 block compression. 8 bytes per 4x4 block, RGB only.
+    \value DXT5 \c BC3 block compression. 16 bytes per 4x4 block, RGB with interpolated alpha.
+    \value ETC2 \c ETC2 block compression. 8 bytes per 4x4 block for RGB8 format and 16 bytes for RGBA8 format with EAC alpha.
+    \value BC7 \c BC7 block compression. 16 bytes per 4x4 block, high quality RGBA.
+*/
+
 /*!
     \enum Texture::FilteringType
 
@@ -158,6 +173,50 @@ void Texture::addSurface(const Surface &surface) {
 void Texture::setDirty() {
     setState(ToBeUpdated);
 }
+/*!
+    Marks the region at \a x and \a y position with \a width and \a height dimensions as dirty.
+    Only the dirty regions will be reloaded, unless the whole texture is already marked as dirty.
+*/
+void Texture::setDirtyRegion(int x, int y, int width, int height) {
+    if(state() == ToBeUpdated) {
+        if(p_ptr->m_Partial) {
+            p_ptr->m_Region[0] = MIN(p_ptr->m_Region[0], x);
+            p_ptr->m_Region[1] = MIN(p_ptr->m_Region[1], y);
+            p_ptr->m_Region[2] = MAX(p_ptr->m_Region[2], x + width);
+            p_ptr->m_Region[3] = MAX(p_ptr->m_Region[3], y + height);
+        }
+        return;
+    }
+    Resource::setState(ToBeUpdated);
+
+    p_ptr->m_Region[0] = x;
+    p_ptr->m_Region[1] = y;
+    p_ptr->m_Region[2] = x + width;
+    p_ptr->m_Region[3] = y + height;
+    p_ptr->m_Partial = true;
+}
+/*!
+    \internal
+    Returns true and fills \a x, \a y, \a width and \a height with the bounds of the dirty region in case of only this region must be reloaded; otherwise returns false.
+*/
+bool Texture::dirtyRegion(int &x, int &y, int &width, int &height) const {
+    if(p_ptr->m_Partial) {
+        x = MAX(p_ptr->m_Region[0], 0);
+        y = MAX(p_ptr->m_Region[1], 0);
+        width = MIN(p_ptr->m_Region[2], p_ptr->m_Width) - x;
+        height = MIN(p_ptr->m_Region[3], p_ptr->m_Height) - y;
+        return true;
+    }
+    return false;
+}
+/*!
+    \internal
+    Any regular state change drops the dirty region, so the texture will be reloaded entirely.
+*/
+void Texture::setState(ResourceState state) {
+    p_ptr->m_Partial = false;
+    Resource::setState(state);
+}
 /*!
     Read pixels from GPU at \a x and \a y position with \a width and \a height dimensions into texture data.
 */
@@ -237,6 +296,21 @@ int Texture::format() const {
 void Texture::setFormat(int type) {
     p_ptr->m_Format = type;
 }
+/*!
+    Returns compression type of texture.
+    For more details please see the Texture::CompressionType enum.
+*/
+int Texture::compress() const {
+    return p_ptr->m_Compress;
+}
+/*!
+    Sets compression \a type of texture.
+    The format of texture describes the number of channels of compressed data.
+    For more details please see the Texture::CompressionType enum.
+*/
+void Texture::setCompress(int type) {
+    p_ptr->m_Compress = type;
+}
 /*!
     Returns filtering type of texture.
     For more details please see the Texture::FilteringType enum.
@@ -340,7 +414,11 @@ int32_t Texture::size(int32_t width, int32_t height) const {
     \internal
 */
 inline int32_t Texture::sizeDXTc(int32_t width, int32_t height) const {
-    return ((width + 3) / 4) * ((height + 3) / 4) * (p_ptr->m_Compress == DXT1 ? 8 : 16);
+    int32_t block = 16;
+    if(p_ptr->m_Compress == DXT1 || (p_ptr->m_Compress == ETC2 && components() == 3)) {
+        block = 8;
+    }
+    return ((width + 3) / 4) * ((height + 3) / 4) * block;
 }
 /*!
     \internal
@@ -0,0 +1,180 @@
+#include "staticbatcher.h"
+
+#include "engine.h"
+#include "commandbuffer.h"
+
+#include "components/actor.h"
+#include "components/transform.h"
+#include "components/meshrender.h"
+
+#include "resources/mesh.h"
+#include "resources/material.h"
+
+#include <map>
+#include <tuple>
+#include <algorithm>
+#include <cfloat>
+
+namespace {
+    const char *BATCH = "StaticBatch";
+
+    struct Item {
+        MeshRender *render;
+
+        Mesh *mesh;
+
+        Matrix4 transform;
+
+        Vector3 center;
+
+        uint32_t vertices;
+    };
+
+    typedef vector<Item> ItemList;
+    // Only the parts with the same material, layers and vertex format can share a draw call
+    typedef map<tuple<Material *, int, int>, ItemList> GroupMap;
+
+    void collect(Object *object, const Matrix4 &root, GroupMap &groups) {
+        for(auto it : object->getChildren()) {
+            Actor *actor = dynamic_cast<Actor *>(it);
+            if(actor == nullptr) {
+                continue;
+            }
+            Transform *transform = actor->transform();
+            if(actor->isStatic() && actor->isEnabledInHierarchy() && transform) {
+                for(auto child : actor->getChildren()) {
+                    if(!child->metaObject()->canCastTo(MeshRender::metaClass()->name())) {
+                        continue;
+                    }
+                    MeshRender *render = static_cast<MeshRender *>(child);
+                    Mesh *mesh = nullptr;
+                    MaterialInstance *instance = nullptr;
+                    // Renders with overridden material parameters are kept as is
+                    uint32_t layers = actor->layers() & ~ICommandBuffer::RAYCAST;
+                    if(!render->isEnabled() || !static_cast<Renderable *>(render)->instanceData(layers, &mesh, &instance) ||
+                       mesh->mode() != Mesh::Triangles || (mesh->flags() & Mesh::Skinned) || mesh->lodsCount() == 0) {
+                        continue;
+                    }
+
+                    // Clusters are built in the world space, but the geometry is placed to the space of root
+                    Item item;
+                    item.render = render;
+                    item.mesh = mesh;
+                    item.transform = root * transform->worldTransform();
+                    item.center = (mesh->bound() * transform->worldTransform()).center;
+                    item.vertices = mesh->lod(0)->vertices().size();
+
+                    groups[make_tuple(instance->material(), layers, mesh->flags())].push_back(item);
+                }
+            }
+            collect(actor, root, groups);
+        }
+    }
+
+    void split(ItemList::iterator first, ItemList::iterator last, uint32_t maxVertices, float clusterSize, vector<pair<ItemList::iterator, ItemList::iterator>> &clusters) {
+        Vector3 min( FLT_MAX);
+        Vector3 max(-FLT_MAX);
+        uint32_t vertices = 0;
+        for(auto it = first; it != last; ++it) {
+            min.x = MIN(min.x, it->center.x);
+            min.y = MIN(min.y, it->center.y);
+            min.z = MIN(min.z, it->center.z);
+
+            max.x = MAX(max.x, it->center.x);
+            max.y = MAX(max.y, it->center.y);
+            max.z = MAX(max.z, it->center.z);
+
+            vertices += it->vertices;
+        }
+
+        Vector3 size(max - min);
+        int axis = (size.x > size.y) ? ((size.x > size.z) ? 0 : 2) : ((size.y > size.z) ? 1 : 2);
+
+        if(distance(first, last) == 1 || (vertices <= maxVertices && size[axis] <= clusterSize)) {
+            clusters.push_back(make_pair(first, last));
+            return;
+        }
+        // Median split along the longest axis keeps clusters compact, so each one can be culled by own bound
+        ItemList::iterator middle = first + distance(first, last) / 2;
+        nth_element(first, middle, last, [axis](const Item &left, const Item &right) {
+            return left.center[axis] < right.center[axis];
+        });
+
+        split(first, middle, maxVertices, clusterSize, clusters);
+        split(middle, last, maxVertices, clusterSize, clusters);
+    }
+}
+/*!
+    \class StaticBatcher
+    \brief Merges the static geometry to reduce the number of draw calls.
+    \inmodule Engine
+
+    StaticBatcher looks for the MeshRender components on the Actors marked as static and merges the meshes which share the same Material into the combined meshes.
+    Merged geometry is split to the spatial clusters, every cluster has own bound box so it still can be culled by camera.
+*/
+
+/*!
+    Merges the static MeshRender components found in the hierarchy of \a root.
+    The combined meshes are limited by \a maxVertices and spread of the cluster is limited by \a clusterSize in world units.
+    Returns a new Actor which contains the MeshRender for every cluster grouped by the layers, or nullptr if nothing was merged.
+    The new Actor is a child of \a root and the merged geometry is placed to the local space of \a root.
+    The combined meshes don't take part in the raycasts, the source components still do.
+    The source components are disabled, but stay in the hierarchy.
+    \note Components with overridden material parameters, skinned or non triangle meshes are not merged.
+*/
+Actor *StaticBatcher::combine(Actor *root, uint32_t maxVertices, float clusterSize) {
+    if(root == nullptr) {
+        return nullptr;
+    }
+
+    Matrix4 inverse;
+    Transform *transform = root->transform();
+    if(transform) {
+        inverse = transform->worldTransform().inverse();
+    }
+
+    GroupMap groups;
+    collect(root, inverse, groups);
+
+    Actor *result = nullptr;
+    map<int, Actor *> batches;
+    for(auto &group : groups) {
+        ItemList &items = group.second;
+        vector<pair<ItemList::iterator, ItemList::iterator>> clusters;
+        split(items.begin(), items.end(), maxVertices, clusterSize, clusters);
+
+        for(auto &cluster : clusters) {
+            // A single item gains nothing from merging
+            if(distance(cluster.first, cluster.second) < 2) {
+                continue;
+            }
+
+            if(result == nullptr) {
+                result = Engine::objectCreate<Actor>(BATCH, root);
+                result->addComponent("Transform");
+            }
+
+            int layers = get<1>(group.first);
+            Actor *&batch = batches[layers];
+            if(batch == nullptr) {
+                batch = Engine::objectCreate<Actor>(BATCH, result);
+                batch->addComponent("Transform");
+                batch->setLayers(layers);
+                batch->setStatic(true);
+            }
+
+            Mesh *mesh = Engine::objectCreate<Mesh>(BATCH);
+            mesh->setFlags(get<2>(group.first));
+            for(auto it = cluster.first; it != cluster.second; ++it) {
+                mesh->batchMesh(it->mesh, &it->transform);
+                it->render->setEnabled(false);
+            }
+            mesh->lod(0)->setMaterial(get<0>(group.first));
+
+            MeshRender *render = static_cast<MeshRender *>(batch->addComponent("MeshRender"));
+            render->setMesh(mesh);
+        }
+    }
+
+    return result;
+}
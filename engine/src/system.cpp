@@ -2,9 +2,20 @@
 
 #include <components/component.h>
 
+#include <chrono>
+
 System::System() :
-    m_pScene(nullptr) {
+    m_pScene(nullptr),
+    m_UpdateTime(0.0f) {
+
+}
 
+/*!
+    Processes a single fixed simulation step for the provided \a scene.
+    This method is called Timer::fixedSteps() times per frame before update() with the Timer::fixedTimeStep() duration.
+*/
+void System::fixedUpdate(Scene *scene) {
+    A_UNUSED(scene);
 }
 
 void System::syncSettings() const {
@@ -22,5 +33,15 @@ void System::setActiveScene(Scene *scene) {
 void System::processEvents() {
     ObjectSystem::processEvents();
 
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
     update(m_pScene);
+
+    m_UpdateTime = std::chrono::duration_cast<std::chrono::duration<float, std::milli> >(std::chrono::high_resolution_clock::now() - start).count();
+}
+/*!
+    Returns the duration of the last update() call in milliseconds.
+*/
+float System::updateTime() const {
+    return m_UpdateTime;
 }
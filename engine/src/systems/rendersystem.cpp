@@ -19,19 +19,59 @@
 #include "resources/material.h"
 
 #include "commandbuffer.h"
+#include "commandlist.h"
+
+#include "adapters/platformadaptor.h"
+
+#include <threadpool.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #define DEFAULTSPRITE ".embedded/DefaultSprite.mtl"
 
 class RenderSystemPrivate {
 public:
+    struct Frame {
+        CommandList commands;
+
+        ICommandBuffer *buffer = nullptr;
+    };
+
     RenderSystemPrivate() :
-        m_Update(true) {
+        m_Update(true),
+        m_pPlatform(nullptr),
+        m_Back(0),
+        m_Pending(false),
+        m_Uploading(false),
+        m_Exit(false) {
 
     }
     static int32_t m_AtlasPageWidth;
     static int32_t m_AtlasPageHeight;
 
     bool m_Update;
+
+    ThreadPool m_Pool;
+
+    Frame m_Frames[2];
+
+    thread m_Thread;
+
+    mutex m_Mutex;
+
+    condition_variable m_Condition;
+
+    PlatformAdaptor *m_pPlatform;
+
+    uint32_t m_Back;
+
+    bool m_Pending;
+
+    bool m_Uploading;
+
+    bool m_Exit;
 };
 
 int32_t RenderSystemPrivate::m_AtlasPageWidth = 1024;
@@ -43,7 +83,9 @@ RenderSystem::RenderSystem() :
 }
 
 RenderSystem::~RenderSystem() {
+    setPipelined(nullptr);
 
+    delete p_ptr;
 }
 
 void RenderSystem::registerClasses() {
@@ -109,9 +151,25 @@ void RenderSystem::update(Scene *scene) {
     Camera *camera = Camera::current();
     if(camera) {
         Pipeline *pipe = camera->pipeline();
-        pipe->analizeScene(scene, this);
-        pipe->draw(*camera);
-        pipe->finish();
+        if(p_ptr->m_pPlatform) {
+            // Record the snapshot of this frame while the render thread is executing the previous one
+            RenderSystemPrivate::Frame &frame = p_ptr->m_Frames[p_ptr->m_Back];
+            frame.buffer = pipe->buffer();
+            frame.commands.begin(&p_ptr->m_Frames[p_ptr->m_Back ^ 1].commands, true);
+
+            pipe->setBuffer(&frame.commands);
+            pipe->analizeScene(scene, this);
+            pipe->draw(*camera);
+            pipe->finish();
+            pipe->setBuffer(frame.buffer);
+
+            synchronize();
+        } else {
+            pipe->buffer()->resetStatistics();
+            pipe->analizeScene(scene, this);
+            pipe->draw(*camera);
+            pipe->finish();
+        }
     }
 }
 
@@ -121,6 +179,128 @@ void RenderSystem::processEvents() {
     m_pScene->setToBeUpdated(false);
 }
 
+/*!
+    Returns the thread pool which is used to record the rendering commands in parallel.
+    This pool is separated from the Engine one, because the rendering is waiting for the own tasks only.
+*/
+ThreadPool *RenderSystem::threadPool() const {
+    return &p_ptr->m_Pool;
+}
+
+/*!
+    Enables the pipelined rendering for the \a platform, in this mode the frames are drawn on the separate render thread.
+    The update() extracts a snapshot of the frame to a CommandList and hands it to the render thread at the end of update, so the simulation of the next frame is overlapped with the rendering of the current one.
+    Passing nullptr stops the render thread and returns the graphics context to the calling thread.
+    Returns false in case of the \a platform can't move own graphics context to the other thread.
+
+    The ownership rules in this mode:
+    \list
+        \li Scene, components and the CPU side of resources belong to the main thread. Renderable::draw() is called on the main thread during the recording.
+        \li The snapshot holds copies of all per frame values: world matrices, camera values and material instance parameters.
+        \li Graphics context belongs to the render thread. The resources used by the snapshot are uploaded with upload() at the sync point, while the main thread is waiting, so the CPU side of resources can be rebuilt at any other time.
+        \li The execution of the snapshot uses only the data uploaded at the sync point and doesn't change the states of resources.
+        \li The ResourceSystem frees a resource one update after it was removed from the cache, when the snapshot which could use it has been executed.
+    \endlist
+*/
+bool RenderSystem::setPipelined(PlatformAdaptor *platform) {
+    if(p_ptr->m_pPlatform) {
+        {
+            unique_lock<mutex> locker(p_ptr->m_Mutex);
+            p_ptr->m_Exit = true;
+        }
+        p_ptr->m_Condition.notify_all();
+        p_ptr->m_Thread.join();
+
+        p_ptr->m_pPlatform->makeCurrent(true);
+        p_ptr->m_pPlatform = nullptr;
+    }
+
+    if(platform == nullptr || !platform->makeCurrent(false)) {
+        return false;
+    }
+
+    p_ptr->m_pPlatform = platform;
+    p_ptr->m_Pending = false;
+    p_ptr->m_Uploading = false;
+    p_ptr->m_Exit = false;
+    p_ptr->m_Thread = thread(&RenderSystem::renderThread, this);
+
+    return true;
+}
+/*!
+    Returns true if the frames are drawn on the separate render thread; otherwise returns false.
+*/
+bool RenderSystem::isPipelined() const {
+    return (p_ptr->m_pPlatform != nullptr);
+}
+/*!
+    Executes the recorded frame \a commands on the \a buffer.
+    This method is called on the render thread in the pipelined mode.
+*/
+void RenderSystem::submit(ICommandBuffer &buffer, const CommandList &commands) {
+    buffer.resetStatistics();
+    commands.execute(buffer);
+}
+/*!
+    Uploads the resources used by the recorded frame \a commands for the \a buffer.
+    This method is called on the render thread at the sync point, the main thread is waiting till it's done.
+    The default implementation does nothing.
+*/
+void RenderSystem::upload(ICommandBuffer &buffer, const CommandList &commands) {
+    A_UNUSED(buffer);
+    A_UNUSED(commands);
+}
+/*!
+    \internal
+    The sync point between the main and render threads.
+    Waits for the render thread to finish the previous frame and hands the recorded one.
+    Returns when the resources of the recorded frame are uploaded.
+*/
+void RenderSystem::synchronize() {
+    unique_lock<mutex> locker(p_ptr->m_Mutex);
+    p_ptr->m_Condition.wait(locker, [this]() { return !p_ptr->m_Pending; });
+
+    p_ptr->m_Back ^= 1;
+    p_ptr->m_Pending = true;
+    p_ptr->m_Uploading = true;
+    p_ptr->m_Condition.notify_all();
+
+    p_ptr->m_Condition.wait(locker, [this]() { return !p_ptr->m_Uploading; });
+}
+/*!
+    \internal
+*/
+void RenderSystem::renderThread() {
+    p_ptr->m_pPlatform->makeCurrent(true);
+
+    unique_lock<mutex> locker(p_ptr->m_Mutex);
+    while(true) {
+        p_ptr->m_Condition.wait(locker, [this]() { return p_ptr->m_Pending || p_ptr->m_Exit; });
+        if(!p_ptr->m_Pending) {
+            break;
+        }
+        RenderSystemPrivate::Frame &frame = p_ptr->m_Frames[p_ptr->m_Back ^ 1];
+        locker.unlock();
+
+        upload(*frame.buffer, frame.commands);
+
+        locker.lock();
+        p_ptr->m_Uploading = false;
+        p_ptr->m_Condition.notify_all();
+        locker.unlock();
+
+        submit(*frame.buffer, frame.commands);
+        p_ptr->m_pPlatform->swapBuffers();
+
+        locker.lock();
+        p_ptr->m_Pending = false;
+        p_ptr->m_Condition.notify_all();
+    }
+    locker.unlock();
+
+    p_ptr->m_pPlatform->makeCurrent(false);
+}
+
 void RenderSystem::atlasPageSize(int32_t &width, int32_t &height) {
     width = RenderSystemPrivate::m_AtlasPageWidth;
     height = RenderSystemPrivate::m_AtlasPageHeight;
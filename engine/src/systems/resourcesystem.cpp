@@ -4,12 +4,14 @@
 #include <json.h>
 
 #include "engine.h"
+#include "assetindex.h"
 
 #include "resources/resource.h"
 
 class ResourceSystemPrivate {
 public:
     ResourceSystem::DictionaryMap  m_IndexMap;
+    AssetIndex m_AssetIndex;
     unordered_map<string, Resource*> m_ResourceCache;
     unordered_map<Resource*, string> m_ReferenceCache;
 
@@ -22,6 +24,10 @@ ResourceSystem::ResourceSystem() :
 }
 
 ResourceSystem::~ResourceSystem() {
+    for(auto it : p_ptr->m_DeleteList) {
+        delete it;
+    }
+
     delete p_ptr;
 }
 
@@ -36,6 +42,12 @@ const char *ResourceSystem::name() const {
 void ResourceSystem::update(Scene *) {
     PROFILE_FUNCTION();
 
+    // Resources are freed one update after they left the cache, so the frame in flight of the render thread can't use them anymore
+    for(auto it : p_ptr->m_DeleteList) {
+        delete it;
+    }
+    p_ptr->m_DeleteList.clear();
+
     for(auto it = p_ptr->m_ResourceCache.begin(); it != p_ptr->m_ResourceCache.end();) {
         processState(it->second);
         ++it;
@@ -43,9 +55,7 @@ void ResourceSystem::update(Scene *) {
 
     for(auto it : p_ptr->m_DeleteList) {
         deleteFromCahe(it);
-        delete it;
     }
-    p_ptr->m_DeleteList.clear();
 }
 
 int ResourceSystem::threadPolicy() const {
@@ -62,8 +72,7 @@ void ResourceSystem::setResource(Resource *object, const string &uuid) {
 bool ResourceSystem::isResourceExist(const string &path) {
     PROFILE_FUNCTION();
 
-    auto it = p_ptr->m_IndexMap.find(path);
-    return (it != p_ptr->m_IndexMap.end());
+    return (p_ptr->m_AssetIndex.uuid(path) != nullptr);
 }
 
 Resource *ResourceSystem::loadResource(const string &path) {
@@ -138,6 +147,10 @@ ResourceSystem::DictionaryMap &ResourceSystem::indices() const {
     return p_ptr->m_IndexMap;
 }
 
+AssetIndex &ResourceSystem::assetIndex() const {
+    return p_ptr->m_AssetIndex;
+}
+
 void ResourceSystem::deleteFromCahe(Resource *resource) {
     PROFILE_FUNCTION();
     auto ref = p_ptr->m_ReferenceCache.find(resource);
@@ -196,9 +209,9 @@ void ResourceSystem::processState(Resource *resource) {
 
 Resource *ResourceSystem::resource(string &path) const {
     {
-        auto it = p_ptr->m_IndexMap.find(path);
-        if(it != p_ptr->m_IndexMap.end()) {
-            path = it->second.second;
+        const char *uuid = p_ptr->m_AssetIndex.uuid(path);
+        if(uuid) {
+            path = uuid;
         }
     }
     {
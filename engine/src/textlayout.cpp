@@ -0,0 +1,308 @@
+#include "textlayout.h"
+
+#include "engine.h"
+#include "utils.h"
+
+#include "components/textrender.h"
+
+#include "resources/mesh.h"
+#include "resources/font.h"
+
+class TextLayoutPrivate {
+public:
+    // Layout state right before the character with the same index
+    struct Cursor {
+        Vector3 pos;
+
+        Vector3 bb[2];
+
+        uint32_t previous;
+
+        uint32_t it;
+
+        uint32_t space;
+
+        uint32_t lines;
+    };
+
+    TextLayoutPrivate() :
+        m_pFont(nullptr),
+        m_Version(0),
+        m_Size(0),
+        m_Reused(0),
+        m_Kerning(false),
+        m_Wrap(false) {
+
+    }
+
+    bool isCompatible(Font *font, uint32_t version, int size, bool kerning, bool wrap, const Vector2 &boundaries) const {
+        // Word wrap can move already composed glyphs to the next line, so only the plain layout is resumable
+        return (font == m_pFont && version == m_Version && size == m_Size && kerning == m_Kerning &&
+                !wrap && !m_Wrap && boundaries == m_Boundaries);
+    }
+
+    u32string m_Text;
+
+    vector<Cursor> m_Cursors;
+
+    Vector3Vector m_Vertices;
+
+    Vector2Vector m_Uv;
+
+    vector<float> m_Width;
+
+    vector<uint32_t> m_Position;
+
+    Vector2 m_Boundaries;
+
+    Lod m_Lod;
+
+    Font *m_pFont;
+
+    uint32_t m_Version;
+
+    int32_t m_Size;
+
+    uint32_t m_Reused;
+
+    bool m_Kerning;
+
+    bool m_Wrap;
+};
+/*!
+    \class TextLayout
+    \brief Composes the text meshes and keeps the result for the next composition.
+    \inmodule Engine
+
+    The TextLayout keeps the glyph run of the last composed text.
+    When the next text shares a prefix with the previous one and the layout parameters are the same, only the changed suffix is composed.
+    This makes the frequent updates of counters and timers cheap.
+*/
+
+TextLayout::TextLayout() :
+        p_ptr(new TextLayoutPrivate) {
+
+}
+
+TextLayout::~TextLayout() {
+    delete p_ptr;
+}
+/*!
+    Composes the \a text with \a font of \a size into the \a mesh.
+    The text is aligned inside of \a boundaries according to \a alignment; \a kerning and word \a wrap are applied when enabled.
+*/
+void TextLayout::compose(Font *font, Mesh *mesh, int size, const string &text, int alignment, bool kerning, bool wrap, const Vector2 &boundaries) {
+    PROFILE_FUNCTION();
+
+    if(font == nullptr || mesh == nullptr) {
+        return;
+    }
+
+    string data = Engine::translate(text);
+    font->requestCharacters(data);
+
+    u32string u32 = Utils::utf8ToUtf32(data);
+    uint32_t length = u32.length();
+    if(length == 0) {
+        return;
+    }
+
+    float spaceWidth = font->spaceWidth() * size;
+    float spaceLine = font->lineHeight() * size;
+
+    uint32_t version = font->version();
+
+    uint32_t first = 0;
+    if(p_ptr->isCompatible(font, version, size, kerning, wrap, boundaries)) {
+        uint32_t common = MIN(length, static_cast<uint32_t>(p_ptr->m_Text.length()));
+        while(first < common && u32[first] == p_ptr->m_Text[first]) {
+            first++;
+        }
+    }
+
+    p_ptr->m_pFont = font;
+    p_ptr->m_Version = version;
+    p_ptr->m_Size = size;
+    p_ptr->m_Kerning = kerning;
+    p_ptr->m_Wrap = wrap;
+    p_ptr->m_Boundaries = boundaries;
+    p_ptr->m_Reused = first;
+    p_ptr->m_Text = u32;
+
+    TextLayoutPrivate::Cursor cursor;
+    if(first > 0) {
+        cursor = p_ptr->m_Cursors[first];
+    } else {
+        cursor.pos = Vector3(0.0, boundaries.y - size, 0.0f);
+        cursor.bb[0] = Vector3();
+        cursor.bb[1] = Vector3(0.0f, -spaceLine, 0.0f);
+        cursor.previous = 0;
+        cursor.it = 0;
+        cursor.space = 0;
+        cursor.lines = 0;
+    }
+
+    Vector3Vector &vertices = p_ptr->m_Vertices;
+    Vector2Vector &uv0 = p_ptr->m_Uv;
+    vector<float> &width = p_ptr->m_Width;
+    vector<uint32_t> &position = p_ptr->m_Position;
+
+    p_ptr->m_Cursors.resize(length + 1);
+    vertices.resize(length * 4);
+    uv0.resize(length * 4);
+    width.resize(cursor.lines);
+    position.resize(cursor.lines);
+
+    Vector3 &pos = cursor.pos;
+    Vector3 *bb = cursor.bb;
+    uint32_t &it = cursor.it;
+    uint32_t &space = cursor.space;
+    for(uint32_t i = first; i < length; i++) {
+        p_ptr->m_Cursors[i] = cursor;
+
+        uint32_t ch = u32[i];
+        switch(ch) {
+            case ' ': {
+                pos += Vector3(spaceWidth, 0.0f, 0.0f);
+                space = it;
+            } break;
+            case '\t': {
+                pos += Vector3(spaceWidth * 4, 0.0f, 0.0f);
+                space = it;
+            } break;
+            case '\r': break;
+            case '\n': {
+                width.push_back(pos.x);
+                bb[1].x = MAX(bb[1].x, pos.x);
+                position.push_back(it);
+                pos = Vector3(0.0f, pos.y - spaceLine, 0.0f);
+                bb[1].y = MAX(bb[1].y, pos.y);
+
+                space = 0;
+            } break;
+            default: {
+                if(kerning) {
+                    pos.x += font->requestKerning(ch, cursor.previous);
+                }
+                uint32_t index = font->atlasIndex(ch);
+
+                Mesh *m = font->mesh(index);
+                if(m == nullptr) {
+                    continue;
+                }
+                Lod *l = m->lod(0);
+
+                Vector3Vector &shape = l->vertices();
+                Vector2Vector &uv = l->uv0();
+
+                bb[0].x = MIN(bb[0].x, shape[0].x * size);
+                bb[0].y = MIN(bb[0].y, shape[0].y * size);
+
+                float x = pos.x + shape[2].x * size;
+                if(wrap && boundaries.x > 0.0f && boundaries.x < x && space > 0 && space < it) {
+                    float shift = vertices[space * 4].x;
+                    if((shift - spaceWidth) > 0.0f) {
+                        for(uint32_t s = space; s < it; s++) {
+                            vertices[s * 4 + 0] -= Vector3(shift, spaceLine, 0.0f);
+                            vertices[s * 4 + 1] -= Vector3(shift, spaceLine, 0.0f);
+                            vertices[s * 4 + 2] -= Vector3(shift, spaceLine, 0.0f);
+                            vertices[s * 4 + 3] -= Vector3(shift, spaceLine, 0.0f);
+                        }
+                        width.push_back(shift - spaceWidth);
+                        position.push_back(space);
+                        pos = Vector3(pos.x - shift, pos.y - spaceLine, 0.0f);
+
+                        bb[1].x = MAX(bb[1].x, shift - spaceWidth);
+                        bb[1].y = MAX(bb[1].y, pos.y);
+                    }
+                }
+
+                vertices[it * 4 + 0] = pos + shape[0] * size;
+                vertices[it * 4 + 1] = pos + shape[1] * size;
+                vertices[it * 4 + 2] = pos + shape[2] * size;
+                vertices[it * 4 + 3] = pos + shape[3] * size;
+
+                uv0[it * 4 + 0] = uv[0];
+                uv0[it * 4 + 1] = uv[1];
+                uv0[it * 4 + 2] = uv[2];
+                uv0[it * 4 + 3] = uv[3];
+
+                pos += Vector3(shape[2].x * size, 0.0f, 0.0f);
+                it++;
+            } break;
+        }
+        cursor.previous = ch;
+        cursor.lines = width.size();
+    }
+    p_ptr->m_Cursors[length] = cursor;
+
+    vertices.resize(it * 4);
+    uv0.resize(it * 4);
+
+    Vector3 box[2] = {bb[0], bb[1]};
+    if(wrap) {
+        box[1].x = boundaries.x;
+        box[1].y = -boundaries.y;
+    } else {
+        box[1].x = MAX(box[1].x, pos.x);
+        box[1].y = MAX(box[1].y, pos.y);
+    }
+
+    // The last line is not a part of the cursor, it's still open for the next characters
+    vector<float> lineWidth = width;
+    vector<uint32_t> linePosition = position;
+    lineWidth.push_back(pos.x);
+    linePosition.push_back(it);
+
+    Lod &lod = p_ptr->m_Lod;
+    Vector3Vector &result = lod.vertices();
+    IndexVector &indices = lod.indices();
+
+    lod.uv0() = uv0;
+    result.resize(vertices.size());
+
+    uint32_t composed = indices.size() / 6;
+    indices.resize(it * 6);
+    for(uint32_t i = composed; i < it; i++) {
+        indices[i * 6 + 0] = i * 4 + 0;
+        indices[i * 6 + 1] = i * 4 + 1;
+        indices[i * 6 + 2] = i * 4 + 2;
+
+        indices[i * 6 + 3] = i * 4 + 0;
+        indices[i * 6 + 4] = i * 4 + 2;
+        indices[i * 6 + 5] = i * 4 + 3;
+    }
+
+    uint32_t line = 0;
+    float shiftX = (!(alignment & Left)) ? (boundaries.x - lineWidth[line]) / ((alignment & Center) ? 2 : 1) : 0.0f;
+    float shiftY = (!(alignment & Top)) ? (boundaries.y - linePosition.size() * spaceLine) / ((alignment & Middle) ? 2 : 1) : 0.0f;
+    for(uint32_t i = 0; i < vertices.size(); i++) {
+        if(uint32_t(i / 4) >= linePosition[line]) {
+            line++;
+            shiftX = (!(alignment & Left)) ? (boundaries.x - lineWidth[line]) / ((alignment & Center) ? 2 : 1) : 0.0f;
+        }
+        result[i] = vertices[i];
+        result[i].x += shiftX;
+        result[i].y -= shiftY;
+    }
+
+    AABBox bound;
+    bound.setBox(box[0], box[1]);
+    mesh->setBound(bound);
+    mesh->setMode(Mesh::Triangles);
+    mesh->setLod(0, &lod);
+}
+/*!
+    Drops the kept glyph run, so the next composition starts from scratch.
+*/
+void TextLayout::reset() {
+    p_ptr->m_pFont = nullptr;
+    p_ptr->m_Text.clear();
+    p_ptr->m_Reused = 0;
+}
+/*!
+    Returns the number of characters which were taken from the previous composition instead of being composed again.
+*/
+uint32_t TextLayout::reused() const {
+    return p_ptr->m_Reused;
+}
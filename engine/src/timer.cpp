@@ -1,9 +1,21 @@
 #include "timer.h"
 
+#include <thread>
+#include <cmath>
+
 static TimePoint m_sLastTime;
 static float m_sTime        = 0.0;
 static float m_sDeltaTime   = 0.0;
+static float m_sUnscaled    = 0.0;
 static float m_sTimeScale   = 1.0;
+static float m_sFrameTime   = 0.0;
+
+static float m_sFixedStep   = 1.0f / 60.0f;
+static float m_sAccumulator = 0.0;
+static int32_t m_sMaxSteps  = 5;
+static int32_t m_sSteps     = 0;
+
+static int32_t m_sFrameRate = 0;
 
 /*!
     \class Timer
@@ -14,6 +26,11 @@ static float m_sTimeScale   = 1.0;
     This class is used in all systems which doing any animation
     Using deltaTime() method developers are able to calculate a logic based on delays for example shots or movements of your character.
     Time scale value can be used for the slow-motion effects because it applied for all deltaTime() values.
+
+    Besides the variable frame step the Timer drives the fixed step simulation.
+    Each frame the scaled elapsed time is accumulated and split to the fixedSteps() ticks of the fixedTimeStep() duration.
+    The systems and behaviours receive one fixedUpdate() call per tick, so the simulation results don't depend on the frame rate.
+    The remaining part of the accumulated time is available as interpolation() factor to blend the last two simulation states for rendering.
 */
 
 /*!
@@ -30,18 +47,40 @@ void Timer::init() {
 void Timer::reset() {
     m_sTime        = 0.0;
     m_sDeltaTime   = 0.0;
+    m_sUnscaled    = 0.0;
     m_sTimeScale   = 1.0;
+    m_sAccumulator = 0.0;
+    m_sSteps       = 0;
 }
 /*!
     Updates all Timer related variables.
     \note Usually, this method calls internally and must not be called manually.
 */
 void Timer::update() {
+    if(m_sFrameRate > 0) {
+        std::this_thread::sleep_until(m_sLastTime + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(std::chrono::duration<float>(1.0f / m_sFrameRate)));
+    }
+
     TimePoint current   = std::chrono::high_resolution_clock::now();
 
-    m_sDeltaTime = (std::chrono::duration_cast<std::chrono::duration<float> >(current - m_sLastTime)).count() * m_sTimeScale;
+    float delta = m_sFrameTime;
+    if(delta <= 0.0f) {
+        delta = (std::chrono::duration_cast<std::chrono::duration<float> >(current - m_sLastTime)).count();
+    }
+    m_sUnscaled = delta;
+    m_sDeltaTime = delta * m_sTimeScale;
     m_sTime += m_sDeltaTime;
     m_sLastTime = current;
+
+    m_sAccumulator += m_sDeltaTime;
+    m_sSteps = static_cast<int32_t>(m_sAccumulator / m_sFixedStep);
+    if(m_sSteps > m_sMaxSteps) {
+        // Drop the time which can't be simulated to avoid the spiral of death
+        m_sSteps = m_sMaxSteps;
+        m_sAccumulator = fmodf(m_sAccumulator, m_sFixedStep);
+    } else {
+        m_sAccumulator = MAX(m_sAccumulator - m_sSteps * m_sFixedStep, 0.0f);
+    }
 }
 /*!
     Returns the time in seconds since the start of the game.
@@ -57,6 +96,13 @@ float Timer::time() {
 float Timer::deltaTime() {
     return m_sDeltaTime;
 }
+/*!
+    Returns the time in seconds since the last frame without the time scale applied.
+    \note This value is updated in each frame. In case of calling multiple times in a single frame will return the same result.
+*/
+float Timer::unscaledDeltaTime() {
+    return m_sUnscaled;
+}
 /*!
     Return the time scale at which the time is passing.
 */
@@ -69,3 +115,73 @@ float Timer::scale() {
 void Timer::setScale(float scale) {
     m_sTimeScale = scale;
 }
+/*!
+    Returns the fixed duration of each frame in seconds.
+    Zero value means that the real elapsed time is used.
+*/
+float Timer::fixedFrameTime() {
+    return m_sFrameTime;
+}
+/*!
+    Sets the fixed duration of each frame to \a time in seconds.
+    In this mode deltaTime() doesn't depend on the real elapsed time which makes the game simulation reproducible (for example in automated tests and benchmarks).
+    Zero value switches the Timer back to the real elapsed time.
+*/
+void Timer::setFixedFrameTime(float time) {
+    m_sFrameTime = time;
+}
+/*!
+    Returns the duration of the fixed simulation step in seconds.
+    The default value is 1/60 of second.
+*/
+float Timer::fixedTimeStep() {
+    return m_sFixedStep;
+}
+/*!
+    Sets the duration of the fixed simulation \a step in seconds.
+*/
+void Timer::setFixedTimeStep(float step) {
+    if(step > 0.0f) {
+        m_sFixedStep = step;
+    }
+}
+/*!
+    Returns the maximum number of the fixed simulation steps which can be processed in a single frame.
+*/
+int32_t Timer::maxFixedSteps() {
+    return m_sMaxSteps;
+}
+/*!
+    Sets the maximum number of the fixed simulation \a steps which can be processed in a single frame.
+    When the frame takes longer than \a steps ticks the simulation slows down instead of trying to catch up.
+*/
+void Timer::setMaxFixedSteps(int32_t steps) {
+    m_sMaxSteps = MAX(steps, 1);
+}
+/*!
+    Returns the number of the fixed simulation steps which must be processed in the current frame.
+*/
+int32_t Timer::fixedSteps() {
+    return m_sSteps;
+}
+/*!
+    Returns the position between the last two fixed simulation steps in range [0, 1).
+    This value must be used to interpolate the simulation results for rendering.
+*/
+float Timer::interpolation() {
+    return m_sAccumulator / m_sFixedStep;
+}
+/*!
+    Returns the frame rate limit; zero value means unlimited.
+*/
+int32_t Timer::frameRate() {
+    return m_sFrameRate;
+}
+/*!
+    Sets the frame \a rate limit.
+    Each update() call will sleep the rest of the frame time instead of busy waiting.
+    Zero value means unlimited frame rate.
+*/
+void Timer::setFrameRate(int32_t rate) {
+    m_sFrameRate = MAX(rate, 0);
+}
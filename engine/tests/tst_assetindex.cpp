@@ -0,0 +1,81 @@
+#include "tst_common.h"
+
+#include "assetindex.h"
+
+#define COUNT 1000
+
+class AssetIndexTest : public QObject {
+    Q_OBJECT
+
+    AssetIndex::Items m_Items;
+
+private slots:
+
+void initTestCase() {
+    for(int32_t i = 0; i < COUNT; i++) {
+        string path = "Assets/folder" + to_string(i % 10) + "/asset" + to_string(i) + ".mtl";
+        m_Items[path] = pair<string, string>((i % 2) ? "Material" : "Texture", "{uuid-" + to_string(i) + "}");
+    }
+}
+
+void Lookup() {
+    AssetIndex::Settings settings;
+    settings[".project"] = "Test";
+    settings[".entry"] = "Assets/level.map";
+
+    vector<uint8_t> data = AssetIndex::build(m_Items, settings);
+    AssetIndex index;
+    QVERIFY(index.load(data));
+    QCOMPARE(index.size(), static_cast<uint32_t>(COUNT));
+
+    for(auto &it : m_Items) {
+        QCOMPARE(string(index.uuid(it.first)), it.second.second);
+        QCOMPARE(string(index.type(it.first)), it.second.first);
+        QCOMPARE(string(index.uuid(AssetIndex::hash(it.first))), it.second.second);
+    }
+    QVERIFY(index.uuid("Assets/missing.mtl") == nullptr);
+    QVERIFY(index.uuid("") == nullptr);
+
+    QCOMPARE(index.settingsCount(), 2U);
+    QCOMPARE(string(index.settingKey(0)), string(".entry"));
+    QCOMPARE(string(index.settingValue(1)), string("Test"));
+}
+
+void Compile_time_hash() {
+    constexpr uint64_t key = AssetIndex::hash("Assets/folder1/asset1.mtl");
+    QCOMPARE(key, AssetIndex::hash(string("Assets/folder1/asset1.mtl")));
+
+    vector<uint8_t> data = AssetIndex::build(m_Items, AssetIndex::Settings());
+    AssetIndex index;
+    QVERIFY(index.open(data.data(), data.size()));
+    QCOMPARE(string(index.uuid(key)), string("{uuid-1}"));
+}
+
+void Deterministic_output() {
+    AssetIndex::Items reversed;
+    reversed.reserve(m_Items.size() * 2);
+    reversed.insert(m_Items.begin(), m_Items.end());
+    QCOMPARE(AssetIndex::build(m_Items, AssetIndex::Settings()) == AssetIndex::build(reversed, AssetIndex::Settings()), true);
+}
+
+void Invalid_data() {
+    vector<uint8_t> data = AssetIndex::build(m_Items, AssetIndex::Settings());
+    AssetIndex index;
+    QCOMPARE(index.open(data.data(), data.size() / 2), false);
+    data[0] = 'X';
+    QCOMPARE(index.open(data.data(), data.size()), false);
+    QCOMPARE(index.isValid(), false);
+    QVERIFY(index.uuid("Assets/folder1/asset1.mtl") == nullptr);
+}
+
+void Empty_index() {
+    vector<uint8_t> data = AssetIndex::build(AssetIndex::Items(), AssetIndex::Settings());
+    AssetIndex index;
+    QVERIFY(index.load(data));
+    QCOMPARE(index.size(), 0U);
+    QVERIFY(index.uuid("Assets/folder1/asset1.mtl") == nullptr);
+}
+
+} REGISTER(AssetIndexTest)
+
+#include "tst_assetindex.moc"
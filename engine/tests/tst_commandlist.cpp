@@ -0,0 +1,159 @@
+#include "tst_common.h"
+#include "tst_helpers.h"
+
+#include "commandlist.h"
+#include "renderqueue.h"
+
+#include "components/actor.h"
+#include "components/transform.h"
+#include "components/meshrender.h"
+
+#include "resources/mesh.h"
+#include "resources/material.h"
+
+#include "systems/rendersystem.h"
+
+#include <threadpool.h>
+
+#define OBJECTS 8192
+
+class ParamsBuffer : public ICommandBuffer {
+public:
+    void drawMesh(const Matrix4 &model, Mesh *mesh, uint32_t layer, MaterialInstance *material) override {
+        A_UNUSED(model);
+        A_UNUSED(mesh);
+        A_UNUSED(layer);
+        m_Values.push_back(*static_cast<float *>(material->params()["uni.value"].ptr));
+    }
+
+    vector<float> m_Values;
+};
+
+class CommandListTest : public QObject {
+    Q_OBJECT
+
+private slots:
+
+void Record_execute() {
+    Engine system(nullptr, "");
+
+    Mesh *mesh = createMesh();
+    Material *material = Engine::objectCreate<Material>("Material");
+    MaterialInstance *instance = material->createInstance();
+
+    Matrix4 models[3];
+    models[1].translate(Vector3(1.0f, 2.0f, 3.0f));
+    models[2].scale(Vector3(2.0f));
+
+    Matrix4 view;
+    view.translate(Vector3(0.0f, 0.0f, -10.0f));
+
+    CommandList list;
+    list.begin();
+    list.setViewport(0, 0, 640, 480);
+    list.clearRenderTarget(true, Vector4(0.5f), true, 1.0f);
+    list.setViewProjection(view, Matrix4());
+    QCOMPARE(list.view(), view);
+    list.setGlobalValue("light.ambient", 0.2f);
+    list.drawMesh(models[1], mesh, ICommandBuffer::DEFAULT, instance);
+    list.drawMeshInstanced(models, 3, mesh, ICommandBuffer::DEFAULT, instance);
+    list.setColor(Vector4(1.0f, 0.0f, 0.0f, 1.0f));
+    list.enableScissor(10, 10, 100, 100);
+    list.disableScissor();
+    list.resetViewProjection();
+    QCOMPARE(list.view(), Matrix4());
+    QCOMPARE(list.size(), static_cast<uint32_t>(10));
+
+    // Replaying must produce the same stream
+    CommandList copy;
+    copy.begin();
+    list.execute(copy);
+    QCOMPARE(copy.size(), list.size());
+    QVERIFY(copy == list);
+
+    copy.clear();
+    QCOMPARE(copy.size(), static_cast<uint32_t>(0));
+    QVERIFY(!(copy == list));
+
+    delete instance;
+}
+
+void Snapshot_params() {
+    Engine system(nullptr, "");
+
+    Mesh *mesh = createMesh();
+    Material *material = Engine::objectCreate<Material>("Material");
+    MaterialInstance *instance = material->createInstance();
+
+    float value = 1.0f;
+    instance->setFloat("uni.value", &value);
+
+    CommandList list;
+    list.begin(nullptr, true);
+    list.drawMesh(Matrix4(), mesh, ICommandBuffer::DEFAULT, instance);
+    value = 2.0f;
+    list.drawMesh(Matrix4(), mesh, ICommandBuffer::DEFAULT, instance);
+    // The component is free to change the value after recording
+    value = 3.0f;
+
+    ParamsBuffer buffer;
+    list.execute(buffer);
+    QCOMPARE(buffer.m_Values.size(), static_cast<size_t>(2));
+    QCOMPARE(buffer.m_Values[0], 1.0f);
+    QCOMPARE(buffer.m_Values[1], 2.0f);
+
+    delete instance;
+}
+
+void Parallel_recording() {
+    Engine system(nullptr, "");
+    RenderSystem render;
+    render.registerClasses();
+
+    Mesh *meshes[4] = {createMesh(), createMesh(), createMesh(), createMesh()};
+    Material *materials[3] = {Engine::objectCreate<Material>("First"),
+                              Engine::objectCreate<Material>("Second"),
+                              Engine::objectCreate<Material>("Third")};
+
+    Actor *root = Engine::objectCreate<Actor>("Root");
+    list<Renderable *> renderables;
+    for(int32_t i = 0; i < OBJECTS; i++) {
+        Actor *actor = Engine::objectCreate<Actor>("Actor", root);
+        actor->addComponent("Transform");
+        actor->transform()->setPosition(Vector3(static_cast<float>(i % 64), static_cast<float>(i / 64), -static_cast<float>(i % 17)));
+
+        MeshRender *mesh = static_cast<MeshRender *>(actor->addComponent("MeshRender"));
+        mesh->setMesh(meshes[i % 4]);
+        mesh->setMaterial(materials[i % 3]);
+        renderables.push_back(mesh);
+    }
+
+    RenderQueue queue;
+
+    CommandList serial;
+    serial.begin();
+    queue.begin(ICommandBuffer::DEFAULT, Matrix4());
+    for(auto it : renderables) {
+        queue.push(it);
+    }
+    queue.draw(serial);
+
+    ThreadPool pool;
+    pool.setMaxThreads(4);
+
+    CommandList parallel;
+    parallel.begin();
+    queue.begin(ICommandBuffer::DEFAULT, Matrix4());
+    for(auto it : renderables) {
+        queue.push(it);
+    }
+    queue.draw(parallel, &pool);
+
+    // One instanced call and the color reset for every mesh and material pair
+    QCOMPARE(serial.size(), static_cast<uint32_t>(24));
+    QVERIFY(serial == parallel);
+}
+
+} REGISTER(CommandListTest)
+
+#include "tst_commandlist.moc"
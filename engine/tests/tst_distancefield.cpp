@@ -0,0 +1,139 @@
+#include "tst_common.h"
+
+#include "distancefield.h"
+
+#include <amath.h>
+
+#include <cmath>
+
+#define WIDTH   40
+#define HEIGHT  30
+
+#define SCALE   4
+
+class DistanceFieldTest : public QObject {
+    Q_OBJECT
+
+    vector<uint8_t> shape(int32_t width, int32_t height) {
+        vector<uint8_t> result(width * height);
+        int32_t r = MIN(width, height) / 3;
+        for(int32_t y = 0; y < height; y++) {
+            for(int32_t x = 0; x < width; x++) {
+                int32_t dx = x - width / 2;
+                int32_t dy = y - height / 2;
+                // Ring with the bar, so the field has concave and convex parts
+                int32_t d = dx * dx + dy * dy;
+                bool ring = (d < r * r && d > (r / 2) * (r / 2));
+                bool bar = (y > height / 8 && y < height / 4 && x > 2 && x < width - 3);
+                result[y * width + x] = (ring || bar) ? 255 : 0;
+            }
+        }
+        return result;
+    }
+
+    uint8_t bruteForce(const vector<uint8_t> &src, int32_t width, int32_t height, int32_t x, int32_t y) {
+        // Texels out of the bitmap are outside of the shape
+        auto inside = [&](int32_t i, int32_t j) {
+            return (i >= 0 && j >= 0 && i < width && j < height && src[j * width + i] > 128);
+        };
+
+        double toInside = HUGE_VAL;
+        double toOutside = HUGE_VAL;
+        for(int32_t j = -1; j <= height; j++) {
+            for(int32_t i = -1; i <= width; i++) {
+                double d = (i - x) * (i - x) + (j - y) * (j - y);
+                if(inside(i, j)) {
+                    toInside = MIN(toInside, d);
+                } else {
+                    toOutside = MIN(toOutside, d);
+                }
+            }
+        }
+        double dist = sqrt(toOutside + 1.0) - sqrt(toInside + 1.0);
+        return static_cast<uint8_t>(CLAMP(dist * 32.0 + 128.0, 0.0, 255.0));
+    }
+
+    void benchmark(int32_t size) {
+        vector<uint8_t> src = shape(size, size);
+        vector<uint8_t> dst((size / SCALE) * (size / SCALE));
+
+        QBENCHMARK {
+            DistanceField::generate(&src[0], size, size, size, &dst[0], size / SCALE, size / SCALE);
+        }
+    }
+
+private slots:
+
+void Exact_distance() {
+    vector<uint8_t> src = shape(WIDTH, HEIGHT);
+    vector<uint8_t> dst(WIDTH * HEIGHT);
+
+    DistanceField::generate(&src[0], WIDTH, HEIGHT, WIDTH, &dst[0], WIDTH, HEIGHT);
+
+    for(int32_t y = 0; y < HEIGHT; y++) {
+        for(int32_t x = 0; x < WIDTH; x++) {
+            QCOMPARE(dst[y * WIDTH + x], bruteForce(src, WIDTH, HEIGHT, x, y));
+        }
+    }
+}
+
+void Downsampled() {
+    vector<uint8_t> src = shape(WIDTH * SCALE, HEIGHT * SCALE);
+    vector<uint8_t> full(src.size());
+    vector<uint8_t> dst(WIDTH * HEIGHT);
+
+    DistanceField::generate(&src[0], WIDTH * SCALE, HEIGHT * SCALE, WIDTH * SCALE, &full[0], WIDTH * SCALE, HEIGHT * SCALE);
+    DistanceField::generate(&src[0], WIDTH * SCALE, HEIGHT * SCALE, WIDTH * SCALE, &dst[0], WIDTH, HEIGHT);
+
+    // Each texel takes the distance of the source texel in the middle of its block
+    for(int32_t y = 0; y < HEIGHT; y++) {
+        for(int32_t x = 0; x < WIDTH; x++) {
+            int32_t index = (y * SCALE + SCALE / 2) * WIDTH * SCALE + x * SCALE + SCALE / 2;
+            QCOMPARE(dst[y * WIDTH + x], full[index]);
+        }
+    }
+    QVERIFY(dst[0] < 128);
+}
+
+void Channel_layout() {
+    vector<uint8_t> src = shape(WIDTH, HEIGHT);
+    vector<uint8_t> expected(WIDTH * HEIGHT);
+    DistanceField::generate(&src[0], WIDTH, HEIGHT, WIDTH, &expected[0], WIDTH, HEIGHT);
+
+    vector<uint8_t> rgba(WIDTH * HEIGHT * 4);
+    for(int32_t i = 0; i < WIDTH * HEIGHT; i++) {
+        rgba[i * 4 + 0] = 10;
+        rgba[i * 4 + 1] = 20;
+        rgba[i * 4 + 2] = 30;
+        rgba[i * 4 + 3] = src[i];
+    }
+
+    // The field replaces alpha in place, colors stay untouched
+    DistanceField::Options options;
+    options.channels = 4;
+    options.channel = 3;
+    DistanceField::generate(&rgba[0], WIDTH, HEIGHT, WIDTH * 4, &rgba[0], WIDTH, HEIGHT, options);
+
+    for(int32_t i = 0; i < WIDTH * HEIGHT; i++) {
+        QCOMPARE(rgba[i * 4 + 0], static_cast<uint8_t>(10));
+        QCOMPARE(rgba[i * 4 + 1], static_cast<uint8_t>(20));
+        QCOMPARE(rgba[i * 4 + 2], static_cast<uint8_t>(30));
+        QCOMPARE(rgba[i * 4 + 3], expected[i]);
+    }
+}
+
+void Benchmark_glyph_64() {
+    benchmark(64);
+}
+
+void Benchmark_glyph_256() {
+    benchmark(256);
+}
+
+void Benchmark_glyph_512() {
+    benchmark(512);
+}
+
+} REGISTER(DistanceFieldTest)
+
+#include "tst_distancefield.moc"
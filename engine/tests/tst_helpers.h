@@ -0,0 +1,19 @@
+#ifndef TST_HELPERS_H
+#define TST_HELPERS_H
+
+#include "engine.h"
+
+#include "resources/mesh.h"
+
+// Single triangle mesh for the tests which only need a valid geometry
+inline Mesh *createMesh() {
+    Lod lod;
+    lod.setVertices({Vector3(0.0f), Vector3(1.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f)});
+    lod.setIndices({0, 1, 2});
+
+    Mesh *mesh = Engine::objectCreate<Mesh>("Mesh");
+    mesh->addLod(&lod);
+    return mesh;
+}
+
+#endif // TST_HELPERS_H
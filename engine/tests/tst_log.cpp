@@ -0,0 +1,147 @@
+#include "tst_common.h"
+
+#include "log.h"
+
+#include <thread>
+#include <mutex>
+
+#define THREADS 4
+#define RECORDS 500
+
+class TestHandler : public LogHandler {
+public:
+    void setRecord(Log::LogTypes type, const char *record) override {
+        unique_lock<mutex> locker(m_Mutex);
+        m_Types.push_back(type);
+        m_Records.push_back(record);
+    }
+
+    void clear() {
+        unique_lock<mutex> locker(m_Mutex);
+        m_Types.clear();
+        m_Records.clear();
+    }
+
+    mutex m_Mutex;
+    vector<Log::LogTypes> m_Types;
+    vector<string> m_Records;
+};
+
+class LogTest : public QObject {
+    Q_OBJECT
+
+    TestHandler m_Handler;
+
+    int32_t m_Evaluated;
+
+    int32_t evaluate() {
+        m_Evaluated++;
+        return m_Evaluated;
+    }
+
+private slots:
+
+void initTestCase() {
+    Log::overrideHandler(&m_Handler);
+    Log::setLogLevel(Log::INF);
+}
+
+void Level_filter() {
+    m_Handler.clear();
+    m_Evaluated = 0;
+
+    QCOMPARE(Log::isEnabled(Log::WRN), true);
+    QCOMPARE(Log::isEnabled(Log::DBG), false);
+
+    Log(Log::DBG) << "Filtered" << 1;
+    A_LOG(Log::DBG) << "Filtered" << evaluate();
+    A_LOG(Log::INF) << "Passed" << evaluate();
+    // The macro is a single statement, so the else belongs to the outer if
+    if(m_Evaluated < 0)
+        A_LOG(Log::INF) << "Skipped";
+    else
+        A_LOG(Log::INF) << "Branch" << evaluate();
+    Log::flush();
+
+    QCOMPARE(m_Evaluated, 2);
+    QCOMPARE(static_cast<int>(m_Handler.m_Records.size()), 2);
+    QCOMPARE(m_Handler.m_Records[0], string(" Passed 1"));
+    QCOMPARE(m_Handler.m_Types[0], Log::INF);
+    QCOMPARE(m_Handler.m_Records[1], string(" Branch 2"));
+}
+
+void Formatting() {
+    m_Handler.clear();
+
+    Log(Log::INF) << "Values:" << true << 'c' << static_cast<short>(-2) << 3U << -4LL << 0.5f;
+    Log(Log::INF).field("path", "a.map").field("size", 42) << "Loaded";
+    Log::flush();
+
+    QCOMPARE(static_cast<int>(m_Handler.m_Records.size()), 2);
+    QCOMPARE(m_Handler.m_Records[0], string(" Values: 1 c -2 3 -4 0.5"));
+    QCOMPARE(m_Handler.m_Records[1], string(" path=a.map size=42 Loaded"));
+}
+
+void Multithreaded_order() {
+    m_Handler.clear();
+    uint64_t dropped = Log::droppedRecords();
+
+    vector<thread> threads;
+    for(int32_t t = 0; t < THREADS; t++) {
+        threads.push_back(thread([t]() {
+            for(int32_t i = 0; i < RECORDS; i++) {
+                Log(Log::INF) << t << i;
+            }
+        }));
+    }
+    for(auto &it : threads) {
+        it.join();
+    }
+    Log::flush();
+
+    uint64_t lost = Log::droppedRecords() - dropped;
+    // Records from one thread keep their order
+    vector<int32_t> last(THREADS, -1);
+    uint64_t received = 0;
+    for(auto &it : m_Handler.m_Records) {
+        int32_t t, i;
+        if(sscanf(it.c_str(), " %d %d", &t, &i) == 2) {
+            QVERIFY(i > last[t]);
+            last[t] = i;
+            received++;
+        }
+    }
+    QCOMPARE(received + lost, static_cast<uint64_t>(THREADS * RECORDS));
+}
+
+void Errors_are_not_dropped() {
+    m_Handler.clear();
+    uint64_t dropped = Log::droppedRecords();
+
+    vector<thread> threads;
+    for(int32_t t = 0; t < THREADS; t++) {
+        threads.push_back(thread([t]() {
+            for(int32_t i = 0; i < RECORDS; i++) {
+                Log(Log::ERR) << t << i;
+            }
+        }));
+    }
+    for(auto &it : threads) {
+        it.join();
+    }
+
+    QCOMPARE(Log::droppedRecords(), dropped);
+    QCOMPARE(static_cast<int>(m_Handler.m_Records.size()), THREADS * RECORDS);
+}
+
+void Synchronous_mode() {
+    m_Handler.clear();
+    Log::setAsync(false);
+    Log(Log::WRN) << "Direct";
+    QCOMPARE(static_cast<int>(m_Handler.m_Records.size()), 1);
+    Log::setAsync(true);
+}
+
+} REGISTER(LogTest)
+
+#include "tst_log.moc"
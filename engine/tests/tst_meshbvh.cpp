@@ -0,0 +1,174 @@
+#include "tst_common.h"
+
+#include "resources/mesh.h"
+#include "resources/meshbvh.h"
+
+#include <cfloat>
+
+#define GRID 64
+#define RAYS 256
+
+class MeshBvhTest : public QObject {
+    Q_OBJECT
+
+    Vector3Vector m_Vertices;
+    IndexVector m_Indices;
+
+    vector<Ray> m_Rays;
+
+    bool bruteForce(const Ray &ray, Vector3 *pt) {
+        bool result = false;
+        float distance = FLT_MAX;
+        for(uint32_t i = 0; i < m_Indices.size(); i += 3) {
+            Ray r(ray.pos, ray.dir);
+            Vector3 point;
+            if(r.intersect(m_Vertices[m_Indices[i]], m_Vertices[m_Indices[i + 1]], m_Vertices[m_Indices[i + 2]], &point, true)) {
+                float d = (point - ray.pos).length();
+                if(d < distance) {
+                    distance = d;
+                    *pt = point;
+                    result = true;
+                }
+            }
+        }
+        return result;
+    }
+
+private slots:
+
+void initTestCase() {
+    // Wavy terrain patch
+    for(int32_t y = 0; y <= GRID; y++) {
+        for(int32_t x = 0; x <= GRID; x++) {
+            m_Vertices.push_back(Vector3(x * 0.25f, y * 0.25f, sinf(x * 0.3f) * cosf(y * 0.2f)));
+        }
+    }
+    for(uint32_t y = 0; y < GRID; y++) {
+        for(uint32_t x = 0; x < GRID; x++) {
+            uint32_t i = y * (GRID + 1) + x;
+            m_Indices.insert(m_Indices.end(), {i, i + 1, i + GRID + 1, i + 1, i + GRID + 2, i + GRID + 1});
+        }
+    }
+
+    srand(1);
+    for(int32_t i = 0; i < RAYS; i++) {
+        Vector3 origin(rand() % 160 * 0.1f, rand() % 160 * 0.1f, 5.0f);
+        Vector3 dir(rand() % 100 * 0.01f - 0.5f, rand() % 100 * 0.01f - 0.5f, -1.0f);
+        m_Rays.push_back(Ray(origin, dir));
+    }
+}
+
+void Raycast() {
+    MeshBvh bvh;
+    bvh.build(m_Vertices, m_Indices);
+    QCOMPARE(bvh.trianglesCount(), static_cast<uint32_t>(GRID * GRID * 2));
+
+    for(auto &ray : m_Rays) {
+        Vector3 expected, point;
+        // Edges shared by triangles may be missed by the reference test, but never the other way
+        if(bruteForce(ray, &expected)) {
+            QCOMPARE(bvh.raycast(ray, &point), true);
+            QVERIFY((point - expected).length() < 0.001f);
+        }
+    }
+
+    // Axis aligned rays along the grid lines, pointing away from the patch and towards it
+    QCOMPARE(bvh.raycast(Ray(Vector3(1.0f, 1.0f, 5.0f), Vector3(0.0f, 0.0f, 1.0f)), nullptr), false);
+    QCOMPARE(bvh.raycast(Ray(Vector3(1.0f, 1.0f, 5.0f), Vector3(0.0f, 0.0f,-1.0f)), nullptr), true);
+}
+
+void Overlap_sphere() {
+    MeshBvh bvh;
+    bvh.build(m_Vertices, m_Indices);
+
+    IndexVector triangles;
+    QCOMPARE(bvh.overlapSphere(Vector3(8.0f, 8.0f, 0.0f), 0.5f, &triangles), true);
+    QVERIFY(!triangles.empty());
+    for(auto it : triangles) {
+        QVERIFY(it < m_Indices.size() / 3);
+    }
+
+    QCOMPARE(bvh.overlapSphere(Vector3(8.0f, 8.0f, 10.0f), 1.0f), false);
+}
+
+void Closest_point() {
+    MeshBvh bvh;
+    bvh.build(m_Vertices, m_Indices);
+
+    Vector3 point;
+    QCOMPARE(bvh.closestPoint(Vector3(5.0f, 5.0f, 10.0f), &point), true);
+    // Nothing may be closer than the found point
+    float distance = (point - Vector3(5.0f, 5.0f, 10.0f)).length();
+    for(auto &it : m_Vertices) {
+        QVERIFY((it - Vector3(5.0f, 5.0f, 10.0f)).length() >= distance - 0.001f);
+    }
+
+    QCOMPARE(bvh.closestPoint(m_Vertices[100], &point), true);
+    QVERIFY((point - m_Vertices[100]).length() < 0.001f);
+}
+
+void Serialization() {
+    MeshBvh bvh;
+    bvh.build(m_Vertices, m_Indices);
+
+    ByteArray data = bvh.save();
+
+    MeshBvh restored;
+    QCOMPARE(restored.load(data), true);
+    QCOMPARE(restored.nodesCount(), bvh.nodesCount());
+    QCOMPARE(restored.save() == data, true);
+
+    for(auto &ray : m_Rays) {
+        Vector3 a, b;
+        QCOMPARE(restored.raycast(ray, &a), bvh.raycast(ray, &b));
+        QCOMPARE(a, b);
+    }
+
+    data.resize(data.size() - 1);
+    QCOMPARE(restored.load(data), false);
+    QCOMPARE(restored.isEmpty(), true);
+}
+
+void Mesh_queries() {
+    Lod lod;
+    lod.setVertices(m_Vertices);
+    lod.setIndices(m_Indices);
+
+    Mesh mesh;
+    mesh.addLod(&lod);
+
+    Vector3 point;
+    QCOMPARE(mesh.raycast(Ray(Vector3(2.0f, 2.0f, 5.0f), Vector3(0.0f, 0.0f,-1.0f)), &point), true);
+    QCOMPARE(mesh.closestPoint(Vector3(2.0f, 2.0f, 5.0f), &point), true);
+    QCOMPARE(mesh.overlapSphere(point, 0.01f), true);
+    QVERIFY(mesh.bvh(1) == nullptr);
+
+    mesh.setMode(Mesh::Lines);
+    mesh.recalcBounds();
+    QCOMPARE(mesh.raycast(Ray(Vector3(2.0f, 2.0f, 5.0f), Vector3(0.0f, 0.0f,-1.0f)), &point), false);
+}
+
+void Benchmark_brute_force() {
+    QBENCHMARK {
+        for(auto &ray : m_Rays) {
+            Vector3 point;
+            bruteForce(ray, &point);
+        }
+    }
+}
+
+void Benchmark_bvh() {
+    MeshBvh bvh;
+    bvh.build(m_Vertices, m_Indices);
+
+    QBENCHMARK {
+        for(auto &ray : m_Rays) {
+            Vector3 point;
+            bvh.raycast(ray, &point);
+        }
+    }
+}
+
+} REGISTER(MeshBvhTest)
+
+#include "tst_meshbvh.moc"
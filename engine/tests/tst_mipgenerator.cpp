@@ -0,0 +1,117 @@
+#include "tst_common.h"
+
+#include "editor/mipgenerator.h"
+
+#include <amath.h>
+
+#include <cmath>
+
+#define WIDTH   128
+#define HEIGHT  64
+
+class MipGeneratorTest : public QObject {
+    Q_OBJECT
+
+    vector<uint8_t> m_Image;
+
+private slots:
+
+void initTestCase() {
+    m_Image.resize(WIDTH * HEIGHT * 4);
+    for(int32_t y = 0; y < HEIGHT; y++) {
+        for(int32_t x = 0; x < WIDTH; x++) {
+            uint8_t *pixel = &m_Image[(y * WIDTH + x) * 4];
+            int32_t dx = (x % 16) - 8;
+            int32_t dy = (y % 16) - 8;
+            pixel[0] = 200;
+            pixel[1] = 100;
+            pixel[2] = 50;
+            pixel[3] = (dx * dx + dy * dy < 16) ? 255 : 0;
+        }
+    }
+}
+
+void Level_sizes() {
+    MipGenerator::Levels levels = MipGenerator::generate(&m_Image[0], WIDTH, HEIGHT, MipGenerator::Options());
+    QCOMPARE(static_cast<int32_t>(levels.size()), 8);
+
+    int32_t w = WIDTH;
+    int32_t h = HEIGHT;
+    for(auto &it : levels) {
+        QCOMPARE(static_cast<int32_t>(it.size()), w * h * 4);
+        w = MAX(w / 2, 1);
+        h = MAX(h / 2, 1);
+    }
+}
+
+void Solid_color() {
+    for(int32_t filter : {MipGenerator::Box, MipGenerator::Kaiser}) {
+        MipGenerator::Options options;
+        options.filter = filter;
+        MipGenerator::Levels levels = MipGenerator::generate(&m_Image[0], WIDTH, HEIGHT, options);
+        for(auto &it : levels) {
+            for(uint32_t i = 0; i < it.size(); i += 4) {
+                QVERIFY(abs(static_cast<uint8_t>(it[i + 0]) - 200) <= 1);
+                QVERIFY(abs(static_cast<uint8_t>(it[i + 1]) - 100) <= 1);
+                QVERIFY(abs(static_cast<uint8_t>(it[i + 2]) - 50) <= 1);
+            }
+        }
+    }
+}
+
+void Alpha_coverage() {
+    MipGenerator::Options options;
+    options.alphaCutoff = 0.5f;
+    MipGenerator::Levels levels = MipGenerator::generate(&m_Image[0], WIDTH, HEIGHT, options);
+
+    float reference = MipGenerator::alphaCoverage(&m_Image[0], WIDTH, HEIGHT, options.alphaCutoff);
+    // Only the first levels have enough pixels to represent the shape
+    for(int32_t i = 1; i < 3; i++) {
+        int32_t w = WIDTH >> i;
+        int32_t h = HEIGHT >> i;
+        float coverage = MipGenerator::alphaCoverage(reinterpret_cast<const uint8_t *>(levels[i].data()), w, h, options.alphaCutoff);
+        QVERIFY(fabsf(coverage - reference) < 0.06f);
+    }
+}
+
+void Normal_map() {
+    vector<uint8_t> normals(WIDTH * HEIGHT * 4);
+    for(int32_t y = 0; y < HEIGHT; y++) {
+        for(int32_t x = 0; x < WIDTH; x++) {
+            float nx = sinf(x * 0.3f) * 0.7f;
+            float ny = cosf(y * 0.2f) * 0.7f;
+            float nz = sqrtf(MAX(1.0f - nx * nx - ny * ny, 0.0f));
+            uint8_t *pixel = &normals[(y * WIDTH + x) * 4];
+            pixel[0] = static_cast<uint8_t>((nx * 0.5f + 0.5f) * 255.0f + 0.5f);
+            pixel[1] = static_cast<uint8_t>((ny * 0.5f + 0.5f) * 255.0f + 0.5f);
+            pixel[2] = static_cast<uint8_t>((nz * 0.5f + 0.5f) * 255.0f + 0.5f);
+            pixel[3] = 255;
+        }
+    }
+
+    MipGenerator::Options options;
+    options.sRGB = false;
+    options.normalMap = true;
+    MipGenerator::Levels levels = MipGenerator::generate(&normals[0], WIDTH, HEIGHT, options);
+    for(uint32_t l = 1; l < levels.size(); l++) {
+        const ByteArray &level = levels[l];
+        for(uint32_t i = 0; i < level.size(); i += 4) {
+            float x = static_cast<uint8_t>(level[i + 0]) / 127.5f - 1.0f;
+            float y = static_cast<uint8_t>(level[i + 1]) / 127.5f - 1.0f;
+            float z = static_cast<uint8_t>(level[i + 2]) / 127.5f - 1.0f;
+            QVERIFY(fabsf(sqrtf(x * x + y * y + z * z) - 1.0f) < 0.02f);
+        }
+    }
+}
+
+void Multithreaded_result() {
+    MipGenerator::Options options;
+    options.alphaCutoff = 0.5f;
+    MipGenerator::Levels single = MipGenerator::generate(&m_Image[0], WIDTH, HEIGHT, options, 1);
+    MipGenerator::Levels multi = MipGenerator::generate(&m_Image[0], WIDTH, HEIGHT, options, 4);
+    QCOMPARE(single == multi, true);
+}
+
+} REGISTER(MipGeneratorTest)
+
+#include "tst_mipgenerator.moc"
@@ -0,0 +1,104 @@
+#include "tst_common.h"
+
+#include "package.h"
+
+#include <cstdio>
+#include <cstring>
+
+class PackageTest : public QObject {
+    Q_OBJECT
+
+    vector<uint8_t> text(uint32_t size, uint32_t seed) {
+        const char *words[] = {"thunder ", "engine ", "package ", "asset ", "mesh ", "texture "};
+        vector<uint8_t> result;
+        uint32_t state = seed;
+        while(result.size() < size) {
+            state = state * 1103515245 + 12345;
+            const char *word = words[(state >> 16) % 6];
+            result.insert(result.end(), word, word + strlen(word));
+        }
+        result.resize(size);
+        return result;
+    }
+
+    vector<uint8_t> read(const Package &package, const string &path) {
+        const Package::Entry *entry = package.find(path);
+        if(entry == nullptr) {
+            return vector<uint8_t>();
+        }
+        vector<uint8_t> result(entry->originalSize);
+        if(!package.read(entry, result.data())) {
+            return vector<uint8_t>();
+        }
+        return result;
+    }
+
+private slots:
+
+void Compression_round_trip() {
+    for(uint32_t size : {0U, 5U, 13U, 1000U, 70000U}) {
+        vector<uint8_t> source = text(size, size);
+        vector<uint8_t> packed = Package::compress(source.data(), source.size());
+        if(size > 1000) {
+            QVERIFY(packed.size() < source.size());
+        }
+
+        vector<uint8_t> unpacked(source.size());
+        QVERIFY(Package::decompress(packed.data(), packed.size(), unpacked.data(), unpacked.size()));
+        QCOMPARE(unpacked == source, true);
+    }
+}
+
+void Write_and_read() {
+    string path = "tst_package.pak";
+    vector<uint8_t> first = text(20000, 1);
+    vector<uint8_t> second = text(300, 2);
+    {
+        PackageWriter writer;
+        QVERIFY(writer.open(path));
+        QVERIFY(writer.addEntry("first", first.data(), first.size(), Package::LZ4));
+        QVERIFY(writer.addEntry("second", second.data(), second.size(), Package::None));
+        QVERIFY(writer.close());
+    }
+    QVERIFY(Package::isPackage(path));
+
+    Package package;
+    QVERIFY(package.open(path));
+    QCOMPARE(package.isPatch(), false);
+    QCOMPARE(package.entryCount(), 2U);
+    QCOMPARE(package.find("first")->compression, static_cast<uint32_t>(Package::LZ4));
+    QCOMPARE(package.find("second")->compression, static_cast<uint32_t>(Package::None));
+    QCOMPARE(package.name(package.find("second")), string("second"));
+    QVERIFY(package.find("third") == nullptr);
+
+    QCOMPARE(read(package, "first") == first, true);
+    QCOMPARE(read(package, "second") == second, true);
+    // Uncompressed entries are accessible directly from the mapped memory
+    QCOMPARE(memcmp(package.data(package.find("second")), second.data(), second.size()), 0);
+
+    package.close();
+    remove(path.c_str());
+}
+
+void Patch_package() {
+    string path = "tst_patch.pak";
+    vector<uint8_t> data = text(100, 3);
+    {
+        PackageWriter writer;
+        QVERIFY(writer.open(path, true));
+        QVERIFY(writer.addEntry("first", data.data(), data.size()));
+        QVERIFY(writer.close());
+    }
+
+    Package package;
+    QVERIFY(package.open(path));
+    QCOMPARE(package.isPatch(), true);
+    QCOMPARE(read(package, "first") == data, true);
+
+    package.close();
+    remove(path.c_str());
+}
+
+} REGISTER(PackageTest)
+
+#include "tst_package.moc"
@@ -0,0 +1,258 @@
+#include "tst_common.h"
+#include "tst_helpers.h"
+
+#include "renderqueue.h"
+#include "commandbuffer.h"
+
+#include "components/actor.h"
+#include "components/transform.h"
+#include "components/meshrender.h"
+
+#include "resources/mesh.h"
+#include "resources/material.h"
+
+#include "systems/rendersystem.h"
+
+#include <algorithm>
+
+#define KEYS 100000
+
+class RecordingBuffer : public ICommandBuffer {
+public:
+    struct Call {
+        Mesh *mesh;
+        Material *material;
+        uint32_t count;
+        float depth;
+    };
+
+    void drawMesh(const Matrix4 &model, Mesh *mesh, uint32_t layer, MaterialInstance *material) override {
+        ICommandBuffer::drawMesh(model, mesh, layer, material);
+        m_Calls.push_back({mesh, material->material(), 1, -model[14]});
+    }
+
+    void drawMeshInstanced(const Matrix4 *models, uint32_t count, Mesh *mesh, uint32_t layer, MaterialInstance *material) override {
+        ICommandBuffer::drawMeshInstanced(models, count, mesh, layer, material);
+        m_Calls.push_back({mesh, material->material(), count, -models[0][14]});
+    }
+
+    void setColor(const Vector4 &color) override {
+        m_Color = color;
+    }
+
+    vector<Call> m_Calls;
+
+    Vector4 m_Color;
+};
+
+class RenderQueueTest : public QObject {
+    Q_OBJECT
+
+    MeshRender *createRender(Actor *parent, Mesh *mesh, Material *material, float depth) {
+        Actor *actor = Engine::objectCreate<Actor>("Actor", parent);
+        actor->addComponent("Transform");
+        actor->transform()->setPosition(Vector3(0.0f, 0.0f, -depth));
+
+        MeshRender *render = static_cast<MeshRender *>(actor->addComponent("MeshRender"));
+        render->setMesh(mesh);
+        render->setMaterial(material);
+        return render;
+    }
+
+private slots:
+
+void Radix_sort() {
+    vector<uint64_t> keys(KEYS);
+    vector<uint32_t> values(KEYS);
+    srand(1);
+    for(uint32_t i = 0; i < KEYS; i++) {
+        // Few distinct high digits, same as the real keys
+        keys[i] = (static_cast<uint64_t>(rand() % 8) << 47) | (static_cast<uint64_t>(rand()) << 16) | (rand() & 0xFF);
+        values[i] = i;
+    }
+
+    vector<pair<uint64_t, uint32_t>> expected;
+    for(uint32_t i = 0; i < KEYS; i++) {
+        expected.push_back(make_pair(keys[i], values[i]));
+    }
+    stable_sort(expected.begin(), expected.end(), [](const pair<uint64_t, uint32_t> &left, const pair<uint64_t, uint32_t> &right) {
+        return left.first < right.first;
+    });
+
+    RenderQueue::radixSort(&keys[0], &values[0], KEYS);
+    for(uint32_t i = 0; i < KEYS; i++) {
+        QCOMPARE(keys[i], expected[i].first);
+        QCOMPARE(values[i], expected[i].second);
+    }
+}
+
+void Sort_keys() {
+    // State goes first for opaque objects
+    QVERIFY(RenderQueue::opaqueKey(0, 1, 100.0f) < RenderQueue::opaqueKey(1, 0, 1.0f));
+    QVERIFY(RenderQueue::opaqueKey(0, 0, 100.0f) < RenderQueue::opaqueKey(0, 1, 1.0f));
+    QVERIFY(RenderQueue::opaqueKey(0, 0, 1.0f) < RenderQueue::opaqueKey(0, 0, 2.0f));
+    QVERIFY(RenderQueue::opaqueKey(1, 1, 100.0f) < RenderQueue::opaqueKey(0, 0, 1.0f, true));
+    // Behind the camera
+    QCOMPARE(RenderQueue::opaqueKey(0, 0, -5.0f), RenderQueue::opaqueKey(0, 0, 0.0f));
+
+    // Back to front for translucent
+    QVERIFY(RenderQueue::translucentKey(100.0f, 1) < RenderQueue::translucentKey(1.0f, 0));
+    QVERIFY(RenderQueue::translucentKey(1.0f, 0) < RenderQueue::translucentKey(1.0f, 1));
+}
+
+void Opaque_batching() {
+    Engine system(nullptr, "");
+    RenderSystem render;
+    render.registerClasses();
+
+    Mesh *meshes[2] = {createMesh(), createMesh()};
+    Material *materials[2] = {Engine::objectCreate<Material>("First"), Engine::objectCreate<Material>("Second")};
+
+    Actor *root = Engine::objectCreate<Actor>("Root");
+    list<Renderable *> renderables;
+    for(int32_t i = 0; i < 64; i++) {
+        renderables.push_back(createRender(root, meshes[i % 2], materials[(i / 2) % 2], 64.0f - i));
+    }
+
+    RenderQueue queue;
+    queue.begin(ICommandBuffer::DEFAULT, Matrix4());
+    for(auto it : renderables) {
+        queue.push(it);
+    }
+    QCOMPARE(queue.size(), static_cast<uint32_t>(64));
+
+    RecordingBuffer buffer;
+    queue.draw(buffer);
+
+    // One instanced call for every mesh and material pair
+    QCOMPARE(buffer.m_Calls.size(), static_cast<size_t>(4));
+    uint32_t switches = 0;
+    for(uint32_t i = 0; i < buffer.m_Calls.size(); i++) {
+        QCOMPARE(buffer.m_Calls[i].count, static_cast<uint32_t>(16));
+        if(i > 0 && buffer.m_Calls[i].material != buffer.m_Calls[i - 1].material) {
+            switches++;
+        }
+    }
+    QCOMPARE(switches, static_cast<uint32_t>(1));
+
+    for(uint32_t i = 1; i < queue.size(); i++) {
+        QVERIFY(queue.key(i - 1) <= queue.key(i));
+    }
+}
+
+void Draw_calls() {
+    Engine system(nullptr, "");
+    RenderSystem render;
+    render.registerClasses();
+
+    Mesh *mesh = createMesh();
+    Material *material = Engine::objectCreate<Material>("Material");
+
+    Actor *root = Engine::objectCreate<Actor>("Root");
+    list<Renderable *> renderables;
+    for(int32_t i = 0; i < 32; i++) {
+        renderables.push_back(createRender(root, mesh, material, static_cast<float>(i)));
+    }
+
+    RenderQueue queue;
+    queue.begin(ICommandBuffer::DEFAULT, Matrix4());
+    for(auto it : renderables) {
+        queue.push(it);
+    }
+
+    RecordingBuffer buffer;
+    buffer.m_Color = Vector4(0.5f);
+    buffer.resetStatistics();
+    queue.draw(buffer);
+
+    // The whole queue is one draw call and the color is reset after it
+    QCOMPARE(buffer.drawCalls(), static_cast<uint32_t>(1));
+    QCOMPARE(buffer.polygons(), static_cast<uint32_t>(32));
+    QCOMPARE(buffer.m_Color, Vector4(1.0f));
+
+    // Picking draws every object by itself
+    queue.begin(ICommandBuffer::RAYCAST, Matrix4());
+    for(auto it : renderables) {
+        queue.push(it);
+    }
+    buffer.resetStatistics();
+    queue.draw(buffer);
+
+    QCOMPARE(buffer.drawCalls(), static_cast<uint32_t>(32));
+    QCOMPARE(buffer.m_Color, Vector4(1.0f));
+}
+
+void Translucent_order() {
+    Engine system(nullptr, "");
+    RenderSystem render;
+    render.registerClasses();
+
+    Mesh *mesh = createMesh();
+    Material *material = Engine::objectCreate<Material>("Material");
+
+    Actor *root = Engine::objectCreate<Actor>("Root");
+    list<Renderable *> renderables;
+    float depth[] = {3.0f, 10.0f, 1.0f, 7.0f, 5.0f};
+    for(auto it : depth) {
+        renderables.push_back(createRender(root, mesh, material, it));
+    }
+
+    RecordingBuffer buffer;
+    RenderQueue queue;
+    queue.begin(ICommandBuffer::TRANSLUCENT, Matrix4());
+    for(auto it : renderables) {
+        queue.push(it);
+    }
+    queue.draw(buffer);
+
+    QCOMPARE(buffer.m_Calls.size(), static_cast<size_t>(5));
+    for(uint32_t i = 1; i < buffer.m_Calls.size(); i++) {
+        QCOMPARE(buffer.m_Calls[i].count, static_cast<uint32_t>(1));
+        QVERIFY(buffer.m_Calls[i - 1].depth > buffer.m_Calls[i].depth);
+    }
+
+    // Interface must keep the order of pushing
+    buffer.m_Calls.clear();
+    for(auto it : renderables) {
+        it->actor()->setLayers(ICommandBuffer::UI);
+    }
+    queue.begin(ICommandBuffer::UI, Matrix4());
+    for(auto it : renderables) {
+        queue.push(it);
+    }
+    queue.draw(buffer);
+
+    QCOMPARE(buffer.m_Calls.size(), static_cast<size_t>(5));
+    for(uint32_t i = 0; i < buffer.m_Calls.size(); i++) {
+        QCOMPARE(buffer.m_Calls[i].depth, depth[i]);
+    }
+}
+
+void Benchmark_list_sort() {
+    list<uint64_t> keys;
+    srand(1);
+    QBENCHMARK {
+        keys.clear();
+        for(uint32_t i = 0; i < KEYS; i++) {
+            keys.push_back((static_cast<uint64_t>(rand() % 8) << 47) | (static_cast<uint64_t>(rand()) << 16));
+        }
+        keys.sort();
+    }
+}
+
+void Benchmark_radix_sort() {
+    vector<uint64_t> keys(KEYS);
+    vector<uint32_t> values(KEYS);
+    srand(1);
+    QBENCHMARK {
+        for(uint32_t i = 0; i < KEYS; i++) {
+            keys[i] = (static_cast<uint64_t>(rand() % 8) << 47) | (static_cast<uint64_t>(rand()) << 16);
+            values[i] = i;
+        }
+        RenderQueue::radixSort(&keys[0], &values[0], KEYS);
+    }
+}
+
+} REGISTER(RenderQueueTest)
+
+#include "tst_renderqueue.moc"
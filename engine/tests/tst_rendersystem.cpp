@@ -0,0 +1,206 @@
+#include "tst_common.h"
+
+#include "adapters/platformadaptor.h"
+
+#include "file.h"
+
+#include "components/scene.h"
+#include "components/actor.h"
+#include "components/transform.h"
+#include "components/camera.h"
+
+#include "systems/rendersystem.h"
+
+#include "resources/pipeline.h"
+
+#include "commandbuffer.h"
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#define FRAMES 8
+#define TIMEOUT 1000
+
+class EmptyFile : public File {
+public:
+    _FILE *_fopen(const char *path, const char *mode) override { A_UNUSED(path); A_UNUSED(mode); return nullptr; }
+};
+
+class ContextAdaptor : public PlatformAdaptor {
+public:
+    ContextAdaptor() :
+        m_Frames(0),
+        m_Updates(0),
+        m_Overlapped(0),
+        m_Owner(this_thread::get_id()) {
+    }
+
+    bool init() override { return true; }
+    void update() override { }
+    bool start() override { return true; }
+    void stop() override { }
+    void destroy() override { }
+    bool isValid() override { return true; }
+
+    uint32_t screenWidth() override { return 640; }
+    uint32_t screenHeight() override { return 480; }
+
+    string inputString() override { return string(); }
+
+    bool makeCurrent(bool current) override {
+        if(current) {
+            m_Owner = this_thread::get_id();
+        } else {
+            m_Owner = thread::id();
+        }
+        return true;
+    }
+
+    void swapBuffers() override {
+        m_Presenter = this_thread::get_id();
+        // The frame is presented only when the main thread has returned from the update which recorded it
+        unique_lock<mutex> locker(m_Mutex);
+        uint32_t frame = m_Frames;
+        if(m_Condition.wait_for(locker, chrono::milliseconds(TIMEOUT), [&]() { return m_Updates > frame; })) {
+            m_Overlapped++;
+        }
+        m_Frames++;
+    }
+
+    void updated() {
+        unique_lock<mutex> locker(m_Mutex);
+        m_Updates++;
+        m_Condition.notify_all();
+    }
+
+    uint32_t updates() {
+        unique_lock<mutex> locker(m_Mutex);
+        return m_Updates;
+    }
+
+    atomic<uint32_t> m_Frames;
+
+    mutex m_Mutex;
+    condition_variable m_Condition;
+
+    uint32_t m_Updates;
+    uint32_t m_Overlapped;
+
+    thread::id m_Owner;
+    thread::id m_Presenter;
+};
+
+class FrameBuffer : public ICommandBuffer {
+public:
+    void setColor(const Vector4 &color) override {
+        m_Frames.push_back(static_cast<uint32_t>(color.x));
+        m_Threads.push_back(this_thread::get_id());
+    }
+
+    vector<uint32_t> m_Frames;
+    vector<thread::id> m_Threads;
+};
+
+class FramePipeline : public Pipeline {
+public:
+    FramePipeline() :
+        m_Frame(0) {
+        m_pOrigin = m_Buffer;
+        m_Buffer = &m_Target;
+    }
+
+    ~FramePipeline() {
+        m_Buffer = m_pOrigin;
+    }
+
+    void draw(Camera &camera) override {
+        A_UNUSED(camera);
+        m_Buffer->setColor(Vector4(static_cast<float>(m_Frame++)));
+    }
+
+    void finish() override { }
+
+    FrameBuffer m_Target;
+
+    ICommandBuffer *m_pOrigin;
+
+    uint32_t m_Frame;
+};
+
+class FrameRender : public RenderSystem {
+public:
+    explicit FrameRender(ContextAdaptor *platform) :
+        m_pPlatform(platform) {
+    }
+
+    void upload(ICommandBuffer &buffer, const CommandList &commands) override {
+        A_UNUSED(buffer);
+        A_UNUSED(commands);
+        // Number of the updates which were finished by the main thread when the frame is uploaded
+        m_Uploads.push_back(m_pPlatform->updates());
+    }
+
+    ContextAdaptor *m_pPlatform;
+
+    vector<uint32_t> m_Uploads;
+};
+
+class RenderSystemTest : public QObject {
+    Q_OBJECT
+
+private slots:
+
+void Pipelined_frames() {
+    EmptyFile file;
+    Engine system(&file, "");
+    ContextAdaptor platform;
+    FrameRender render(&platform);
+    render.registerClasses();
+
+    Scene *scene = Engine::objectCreate<Scene>("Scene");
+    Actor *actor = Engine::objectCreate<Actor>("Camera", scene);
+    actor->addComponent("Transform");
+    Camera *camera = static_cast<Camera *>(actor->addComponent("Camera"));
+    Camera::setCurrent(camera);
+
+    FramePipeline pipeline;
+    camera->setPipeline(&pipeline);
+
+    QVERIFY(render.setPipelined(&platform));
+    QVERIFY(render.isPipelined());
+
+    for(int32_t i = 0; i < FRAMES; i++) {
+        render.update(scene);
+        platform.updated();
+    }
+    render.setPipelined(nullptr);
+
+    QVERIFY(!render.isPipelined());
+    QCOMPARE(static_cast<uint32_t>(platform.m_Frames), static_cast<uint32_t>(FRAMES));
+    // Frames were presented on the render thread and the context is returned back
+    QVERIFY(platform.m_Presenter != this_thread::get_id());
+    QVERIFY(platform.m_Owner == this_thread::get_id());
+    // Snapshots were executed in order on the render thread
+    QCOMPARE(pipeline.m_Target.m_Frames.size(), static_cast<size_t>(FRAMES));
+    for(uint32_t i = 0; i < FRAMES; i++) {
+        QCOMPARE(pipeline.m_Target.m_Frames[i], i);
+        QVERIFY(pipeline.m_Target.m_Threads[i] == platform.m_Presenter);
+    }
+    // Each frame was uploaded while the main thread was waiting in the update which recorded it
+    QCOMPARE(render.m_Uploads.size(), static_cast<size_t>(FRAMES));
+    for(uint32_t i = 0; i < FRAMES; i++) {
+        QCOMPARE(render.m_Uploads[i], i);
+    }
+    // and presented after the main thread returned from that update to simulate the next frame
+    QCOMPARE(platform.m_Overlapped, static_cast<uint32_t>(FRAMES));
+
+    camera->setPipeline(nullptr);
+    Camera::setCurrent(nullptr);
+}
+
+} REGISTER(RenderSystemTest)
+
+#include "tst_rendersystem.moc"
@@ -0,0 +1,124 @@
+#include "tst_common.h"
+
+#include "adapters/replayadaptor.h"
+#include "timer.h"
+
+#include <objectsystem.h>
+
+#include <cstdio>
+
+#define FRAMES 4
+
+class InputAdaptor : public PlatformAdaptor {
+public:
+    InputAdaptor() :
+        m_Frame(0) {
+    }
+
+    bool init() override { return true; }
+    void update() override { m_Frame++; }
+    bool start() override { return true; }
+    void stop() override { }
+    void destroy() override { }
+    bool isValid() override { return true; }
+
+    uint32_t screenWidth() override { return 640; }
+    uint32_t screenHeight() override { return 480; }
+
+    bool key(Input::KeyCode code) override { return code == Input::KEY_W && (m_Frame % 2); }
+    bool keyPressed(Input::KeyCode code) override { return code == Input::KEY_SPACE && m_Frame == 2; }
+
+    string inputString() override { return (m_Frame == 1) ? "abc" : ""; }
+
+    Vector4 mousePosition() override { return Vector4(m_Frame * 10.0f, 5.0f, 0.5f, 0.25f); }
+    bool mouseButton(Input::MouseButton button) override { return button == Input::RIGHT && m_Frame == 3; }
+
+    uint32_t joystickCount() override { return 1; }
+    Vector2 joystickTriggers(uint32_t) override { return Vector2(m_Frame * 0.25f, 0.0f); }
+
+    uint32_t m_Frame;
+};
+
+class ReplayAdaptorTest : public QObject {
+    Q_OBJECT
+
+    struct Sample {
+        bool w;
+        bool space;
+        bool right;
+        string input;
+        Vector4 mouse;
+        Vector2 triggers;
+        uint32_t uuid;
+    };
+
+    void run(ReplayAdaptor &adaptor, InputAdaptor *input, vector<Sample> &result) {
+        result.clear();
+        adaptor.init();
+        adaptor.start();
+        while(adaptor.isValid() && result.size() < FRAMES) {
+            if(input) {
+                Timer::setFixedFrameTime(0.01f * (result.size() + 1));
+            }
+            Timer::update();
+
+            Sample sample;
+            sample.w = adaptor.key(Input::KEY_W);
+            sample.space = adaptor.keyPressed(Input::KEY_SPACE);
+            sample.right = adaptor.mouseButton(Input::RIGHT);
+            sample.input = adaptor.inputString();
+            sample.mouse = adaptor.mousePosition();
+            sample.triggers = adaptor.joystickTriggers(0);
+            sample.uuid = ObjectSystem::generateUUID();
+            if(input) {
+                QCOMPARE(Timer::unscaledDeltaTime(), 0.01f * (result.size() + 1));
+            }
+            result.push_back(sample);
+
+            adaptor.update();
+        }
+        adaptor.stop();
+    }
+
+private slots:
+
+void Record_and_replay() {
+    string path = "tst_replay.bin";
+
+    vector<Sample> recorded;
+    {
+        ReplayAdaptor adaptor(new InputAdaptor, path, ReplayAdaptor::Record, 42);
+        run(adaptor, static_cast<InputAdaptor *>(adaptor.platform()), recorded);
+    }
+    Timer::setFixedFrameTime(0.0f);
+
+    vector<Sample> replayed;
+    {
+        ReplayAdaptor adaptor(new InputAdaptor, path, ReplayAdaptor::Replay);
+        // The replay ignores the input devices of the wrapped adaptor
+        static_cast<InputAdaptor *>(adaptor.platform())->m_Frame = 100;
+        run(adaptor, nullptr, replayed);
+        QCOMPARE(adaptor.screenWidth(), 640U);
+    }
+    remove(path.c_str());
+
+    QCOMPARE(static_cast<int>(recorded.size()), FRAMES);
+    QCOMPARE(recorded.size(), replayed.size());
+    for(uint32_t i = 0; i < recorded.size(); i++) {
+        QCOMPARE(recorded[i].w, replayed[i].w);
+        QCOMPARE(recorded[i].space, replayed[i].space);
+        QCOMPARE(recorded[i].right, replayed[i].right);
+        QCOMPARE(recorded[i].input == replayed[i].input, true);
+        QCOMPARE(recorded[i].mouse == replayed[i].mouse, true);
+        QCOMPARE(recorded[i].triggers == replayed[i].triggers, true);
+        QCOMPARE(recorded[i].uuid, replayed[i].uuid);
+    }
+    QCOMPARE(recorded[1].w, true);
+    QCOMPARE(recorded[1].input == "abc", true);
+    QCOMPARE(recorded[2].space, true);
+    QCOMPARE(recorded[3].right, true);
+}
+
+} REGISTER(ReplayAdaptorTest)
+
+#include "tst_replayadaptor.moc"
@@ -0,0 +1,119 @@
+#include "tst_common.h"
+
+#include "resources/sprite.h"
+#include "resources/texture.h"
+
+#define SIZE 1024
+
+class RegionTexture : public Texture {
+public:
+    using Texture::dirtyRegion;
+
+    void setReady() {
+        setState(Ready);
+    }
+};
+
+class TestSprite : public Sprite {
+public:
+    using Sprite::updateElement;
+};
+
+class SpriteTest : public QObject {
+    Q_OBJECT
+
+    Texture *addElement(Sprite *sprite, int32_t width, int32_t height, int8_t value) {
+        Texture::Surface s;
+        s.push_back(ByteArray(width * height, value));
+
+        Texture *t = Engine::objectCreate<Texture>("", sprite);
+        t->setWidth(width);
+        t->setHeight(height);
+        t->addSurface(s);
+
+        sprite->addElement(t);
+        return t;
+    }
+
+    int8_t atlasPixel(Sprite *sprite, int key) {
+        Texture *atlas = sprite->texture();
+        Vector2 uv = sprite->mesh(key)->lod(0)->uv0()[0];
+
+        int32_t x = static_cast<int32_t>(uv.x * atlas->width());
+        int32_t y = static_cast<int32_t>(uv.y * atlas->height());
+        return (atlas->surface(0)[0])[y * atlas->width() + x];
+    }
+
+private slots:
+
+void Incremental_pack() {
+    Engine system(nullptr, "");
+
+    TestSprite sprite;
+    RegionTexture *texture = new RegionTexture;
+    sprite.setTexture(texture);
+    texture->resize(SIZE, SIZE);
+
+    Texture *first = addElement(&sprite, 16, 16, 1);
+    for(int8_t i = 1; i < 3; i++) {
+        addElement(&sprite, 16, 16, i + 1);
+    }
+    sprite.pack(1);
+
+    Vector2Vector uv = sprite.mesh(0)->lod(0)->uv0();
+    texture->setReady();
+
+    for(int8_t i = 3; i < 5; i++) {
+        addElement(&sprite, 16, 16, i + 1);
+    }
+    sprite.pack(1);
+
+    // Packed elements must keep their places, only the new ones are uploaded
+    QVERIFY(sprite.mesh(0)->lod(0)->uv0() == uv);
+    int32_t x, y, w, h;
+    QVERIFY(texture->dirtyRegion(x, y, w, h));
+    QVERIFY(w < SIZE && h < SIZE);
+    for(int32_t i = 0; i < 5; i++) {
+        QCOMPARE(atlasPixel(&sprite, i), static_cast<int8_t>(i + 1));
+    }
+
+    // Changed element goes to the same place
+    texture->setReady();
+    first->surface(0)[0] = ByteArray(16 * 16, 10);
+    sprite.updateElement(0);
+    QVERIFY(sprite.mesh(0)->lod(0)->uv0() == uv);
+    QCOMPARE(atlasPixel(&sprite, 0), static_cast<int8_t>(10));
+    QVERIFY(texture->dirtyRegion(x, y, w, h));
+    QCOMPARE(w, 18);
+    QCOMPARE(h, 18);
+}
+
+void Overflow() {
+    Engine system(nullptr, "");
+
+    TestSprite sprite;
+    RegionTexture *texture = new RegionTexture;
+    sprite.setTexture(texture);
+    texture->resize(SIZE, SIZE);
+
+    for(int8_t i = 0; i < 4; i++) {
+        addElement(&sprite, 16, 16, i + 1);
+    }
+    sprite.pack(1);
+    texture->setReady();
+
+    addElement(&sprite, SIZE, SIZE, 5);
+    sprite.pack(1);
+
+    // Enlarged sheet must be reloaded entirely
+    QCOMPARE(texture->width(), SIZE * 2);
+    int32_t x, y, w, h;
+    QVERIFY(!texture->dirtyRegion(x, y, w, h));
+    for(int32_t i = 0; i < 5; i++) {
+        QCOMPARE(atlasPixel(&sprite, i), static_cast<int8_t>(i + 1));
+    }
+}
+
+} REGISTER(SpriteTest)
+
+#include "tst_sprite.moc"
@@ -0,0 +1,194 @@
+#include "tst_common.h"
+
+#include "staticbatcher.h"
+
+#include "components/actor.h"
+#include "components/transform.h"
+#include "components/meshrender.h"
+
+#include "resources/mesh.h"
+#include "resources/material.h"
+
+#include "systems/rendersystem.h"
+
+#include "commandbuffer.h"
+
+#define GRID 32
+
+class StaticBatcherTest : public QObject {
+    Q_OBJECT
+
+    Mesh *createCube() {
+        Lod lod;
+        lod.setVertices({Vector3(-0.5f,-0.5f, 0.5f), Vector3( 0.5f,-0.5f, 0.5f), Vector3( 0.5f, 0.5f, 0.5f), Vector3(-0.5f, 0.5f, 0.5f),
+                         Vector3(-0.5f,-0.5f,-0.5f), Vector3( 0.5f,-0.5f,-0.5f), Vector3( 0.5f, 0.5f,-0.5f), Vector3(-0.5f, 0.5f,-0.5f)});
+        lod.setNormals(Vector3Vector(8, Vector3(0.0f, 0.0f, 1.0f)));
+        lod.setIndices({0, 1, 2, 0, 2, 3, 4, 6, 5, 4, 7, 6});
+
+        Mesh *mesh = Engine::objectCreate<Mesh>("Cube");
+        mesh->setFlags(Mesh::Normals);
+        mesh->addLod(&lod);
+        return mesh;
+    }
+
+    // Grid of static actors, materials are alternated
+    Actor *createLevel(Mesh *mesh, Material *first, Material *second, float step) {
+        Actor *level = Engine::objectCreate<Actor>("Level");
+        level->addComponent("Transform");
+        for(int32_t y = 0; y < GRID; y++) {
+            for(int32_t x = 0; x < GRID; x++) {
+                Actor *actor = Engine::objectCreate<Actor>("Box", level);
+                actor->addComponent("Transform");
+                actor->transform()->setPosition(Vector3(x * step, 0.0f, y * step));
+                actor->setStatic(true);
+
+                MeshRender *render = static_cast<MeshRender *>(actor->addComponent("MeshRender"));
+                render->setMesh(mesh);
+                render->setMaterial(((x + y) % 2) ? second : first);
+            }
+        }
+        return level;
+    }
+
+    void countRenders(Object *object, int32_t &enabled, int32_t &disabled) {
+        for(auto it : object->getChildren()) {
+            MeshRender *render = dynamic_cast<MeshRender *>(it);
+            if(render) {
+                (render->isEnabled()) ? enabled++ : disabled++;
+            } else {
+                countRenders(it, enabled, disabled);
+            }
+        }
+    }
+
+private slots:
+
+void Batch_mesh() {
+    Engine system(nullptr, "");
+    RenderSystem render;
+    render.registerClasses();
+
+    Mesh *cube = createCube();
+    Mesh *mesh = Engine::objectCreate<Mesh>("Mesh");
+
+    Matrix4 transform;
+    transform.translate(Vector3(10.0f, 0.0f, 0.0f));
+    mesh->batchMesh(cube);
+    mesh->batchMesh(cube, &transform);
+
+    Lod *lod = mesh->lod(0);
+    QCOMPARE(lod->vertices().size(), static_cast<size_t>(16));
+    QCOMPARE(lod->normals().size(), static_cast<size_t>(16));
+    QCOMPARE(lod->indices().size(), static_cast<size_t>(24));
+    QCOMPARE(lod->indices()[12], static_cast<uint32_t>(8));
+    QCOMPARE(lod->vertices()[9], Vector3(10.5f,-0.5f, 0.5f));
+    // Source mesh stays untouched
+    QCOMPARE(cube->lod(0)->vertices()[1], Vector3(0.5f,-0.5f, 0.5f));
+
+    Vector3 min, max;
+    mesh->bound().box(min, max);
+    QCOMPARE(min, Vector3(-0.5f));
+    QCOMPARE(max, Vector3(10.5f, 0.5f, 0.5f));
+}
+
+void Combine() {
+    Engine system(nullptr, "");
+    RenderSystem render;
+    render.registerClasses();
+
+    Mesh *cube = createCube();
+    Material *first = Engine::objectCreate<Material>("First");
+    Material *second = Engine::objectCreate<Material>("Second");
+
+    Actor *level = createLevel(cube, first, second, 1.0f);
+
+    // Dynamic actors must be kept as is
+    Actor *dynamic = Engine::objectCreate<Actor>("Dynamic", level);
+    dynamic->addComponent("Transform");
+    static_cast<MeshRender *>(dynamic->addComponent("MeshRender"))->setMesh(cube);
+
+    Actor *batch = StaticBatcher::combine(level, 65536, 1000.0f);
+    QVERIFY(batch != nullptr);
+
+    int32_t enabled = 0;
+    int32_t disabled = 0;
+    countRenders(batch, enabled, disabled);
+    // One combined mesh per material
+    QCOMPARE(enabled, 2);
+    QCOMPARE(disabled, 0);
+
+    enabled = 0;
+    countRenders(level, enabled, disabled);
+    QCOMPARE(enabled, 3);
+    QCOMPARE(disabled, GRID * GRID);
+
+    MeshRender *result = static_cast<MeshRender *>(batch->componentInChild("MeshRender"));
+    QCOMPARE(result->mesh()->lod(0)->vertices().size(), static_cast<size_t>(GRID * GRID / 2 * 8));
+    QCOMPARE(result->mesh()->flags(), static_cast<int>(Mesh::Normals));
+
+    // Nothing left to merge
+    QVERIFY(StaticBatcher::combine(level) == nullptr);
+}
+
+void Clusters() {
+    Engine system(nullptr, "");
+    RenderSystem render;
+    render.registerClasses();
+
+    Mesh *cube = createCube();
+    Material *first = Engine::objectCreate<Material>("First");
+    Material *second = Engine::objectCreate<Material>("Second");
+
+    Actor *level = createLevel(cube, first, second, 4.0f);
+
+    Actor *batch = StaticBatcher::combine(level, 512, 32.0f);
+    QVERIFY(batch != nullptr);
+
+    int32_t enabled = 0;
+    int32_t disabled = 0;
+    countRenders(batch, enabled, disabled);
+    QVERIFY(enabled > 2);
+    QVERIFY(enabled < GRID * GRID / 8);
+
+    // Every cluster respects the limits
+    for(auto it : batch->getChildren()) {
+        for(auto child : it->getChildren()) {
+            MeshRender *render = dynamic_cast<MeshRender *>(child);
+            if(render) {
+                QVERIFY(render->mesh()->lod(0)->vertices().size() <= 512);
+                QVERIFY(render->mesh()->bound().extent.x * 2.0f <= 32.0f + 1.0f);
+                QVERIFY(render->mesh()->bound().extent.z * 2.0f <= 32.0f + 1.0f);
+            }
+        }
+    }
+}
+
+void Root_transform() {
+    Engine system(nullptr, "");
+    RenderSystem render;
+    render.registerClasses();
+
+    Mesh *cube = createCube();
+    Material *first = Engine::objectCreate<Material>("First");
+
+    Actor *level = createLevel(cube, first, first, 1.0f);
+    level->transform()->setPosition(Vector3(100.0f, 0.0f, 0.0f));
+    level->transform()->setScale(Vector3(2.0f));
+
+    Actor *batch = StaticBatcher::combine(level, 65536, 1000.0f);
+    QVERIFY(batch != nullptr);
+
+    MeshRender *result = static_cast<MeshRender *>(batch->componentInChild("MeshRender"));
+    QVERIFY(result != nullptr);
+    // Merged geometry stays at the same place in the world
+    Vector3 min, max;
+    (result->mesh()->bound() * result->actor()->transform()->worldTransform()).box(min, max);
+    QVERIFY((min - Vector3(99.0f,-1.0f,-1.0f)).length() < 0.001f);
+    QVERIFY((max - Vector3(163.0f, 1.0f, 63.0f)).length() < 0.001f);
+    // Batch is not pickable, the source actors are
+    QVERIFY((result->actor()->layers() & ICommandBuffer::RAYCAST) == 0);
+}
+
+} REGISTER(StaticBatcherTest)
+
+#include "tst_staticbatcher.moc"
@@ -0,0 +1,194 @@
+#include "tst_common.h"
+
+#include "textlayout.h"
+
+#include "components/textrender.h"
+
+#include "resources/font.h"
+#include "resources/mesh.h"
+#include "resources/texture.h"
+
+#include <fstream>
+#include <algorithm>
+
+#define ROBOTO "../../worldeditor/bin/engine/fonts/Roboto.ttf"
+
+class TextLayoutTest : public QObject {
+    Q_OBJECT
+
+    Font *createFont() {
+        Font *font = Engine::objectCreate<Font>("Font");
+
+        Texture::Surface s;
+        s.push_back(ByteArray(16, 0xFF));
+
+        Texture *t = Engine::objectCreate<Texture>("", font);
+        t->setWidth(4);
+        t->setHeight(4);
+        t->addSurface(s);
+        // All characters are mapped to the first glyph of the atlas
+        font->addElement(t);
+        font->pack(1);
+
+        return font;
+    }
+
+    uint16_t readU16(const ByteArray &data, uint32_t offset) {
+        return (static_cast<uint8_t>(data[offset]) << 8) | static_cast<uint8_t>(data[offset + 1]);
+    }
+
+    uint32_t readU32(const ByteArray &data, uint32_t offset) {
+        return (readU16(data, offset) << 16) | readU16(data, offset + 2);
+    }
+
+    void writeU16(ByteArray &data, uint32_t offset, uint16_t value) {
+        data[offset] = value >> 8;
+        data[offset + 1] = value & 0xFF;
+    }
+
+    void writeU32(ByteArray &data, uint32_t offset, uint32_t value) {
+        writeU16(data, offset, value >> 16);
+        writeU16(data, offset + 2, value & 0xFFFF);
+    }
+
+    // Rebuilds the TrueType font with the 'kern' table which contains the one pair
+    ByteArray addKerning(const ByteArray &font, uint16_t left, uint16_t right, int16_t value) {
+        ByteArray kern(24, 0);
+        writeU16(kern, 2, 1);       // Number of subtables
+        writeU16(kern, 6, 20);      // Subtable length
+        writeU16(kern, 8, 1);       // Horizontal kerning in format 0
+        writeU16(kern, 10, 1);      // Number of pairs
+        writeU16(kern, 12, 6);      // Search range
+        writeU16(kern, 18, left);
+        writeU16(kern, 20, right);
+        writeU16(kern, 22, static_cast<uint16_t>(value));
+
+        struct Table {
+            uint32_t tag;
+            uint32_t checksum;
+            ByteArray data;
+        };
+        vector<Table> tables;
+        uint16_t count = readU16(font, 4);
+        for(uint16_t i = 0; i < count; i++) {
+            uint32_t record = 12 + i * 16;
+            uint32_t offset = readU32(font, record + 8);
+            uint32_t length = readU32(font, record + 12);
+            tables.push_back({readU32(font, record), readU32(font, record + 4), ByteArray(font.begin() + offset, font.begin() + offset + length)});
+        }
+        tables.push_back({0x6B65726E, 0, kern});
+        sort(tables.begin(), tables.end(), [](const Table &a, const Table &b) { return a.tag < b.tag; });
+
+        count = tables.size();
+        uint16_t selector = 0;
+        while((2 << selector) <= count) {
+            selector++;
+        }
+        ByteArray result(12 + count * 16, 0);
+        writeU32(result, 0, readU32(font, 0));
+        writeU16(result, 4, count);
+        writeU16(result, 6, (1 << selector) * 16);
+        writeU16(result, 8, selector);
+        writeU16(result, 10, count * 16 - (1 << selector) * 16);
+        for(uint16_t i = 0; i < count; i++) {
+            uint32_t record = 12 + i * 16;
+            writeU32(result, record, tables[i].tag);
+            writeU32(result, record + 4, tables[i].checksum);
+            writeU32(result, record + 8, result.size());
+            writeU32(result, record + 12, tables[i].data.size());
+            result.insert(result.end(), tables[i].data.begin(), tables[i].data.end());
+            result.resize((result.size() + 3) & ~3);
+        }
+        return result;
+    }
+
+    bool compare(Mesh *left, Mesh *right) {
+        Lod *l = left->lod(0);
+        Lod *r = right->lod(0);
+        if(l == nullptr || r == nullptr) {
+            return false;
+        }
+        return (l->vertices() == r->vertices() && l->uv0() == r->uv0() && l->indices() == r->indices());
+    }
+
+private slots:
+
+void Suffix_update() {
+    Engine system(nullptr, "");
+
+    Font *font = createFont();
+    Mesh *mesh = Engine::objectCreate<Mesh>("Mesh");
+    Mesh *expected = Engine::objectCreate<Mesh>("Expected");
+
+    Vector2 boundaries(400.0f, 100.0f);
+
+    TextLayout layout;
+    layout.compose(font, mesh, 16, "Score: 100\nTime: 10", Left | Top, true, false, boundaries);
+    QCOMPARE(layout.reused(), static_cast<uint32_t>(0));
+
+    // Only the changed suffix must be composed
+    layout.compose(font, mesh, 16, "Score: 100\nTime: 11", Left | Top, true, false, boundaries);
+    QCOMPARE(layout.reused(), static_cast<uint32_t>(18));
+    TextRender::composeMesh(font, expected, 16, "Score: 100\nTime: 11", Left | Top, true, false, boundaries);
+    QVERIFY(compare(mesh, expected));
+
+    // Shorter text with the other alignment
+    layout.compose(font, mesh, 16, "Score: 1", Center | Bottom, true, false, boundaries);
+    QCOMPARE(layout.reused(), static_cast<uint32_t>(8));
+    TextRender::composeMesh(font, expected, 16, "Score: 1", Center | Bottom, true, false, boundaries);
+    QVERIFY(compare(mesh, expected));
+
+    // Any change of the layout parameters requires the full composition
+    layout.compose(font, mesh, 24, "Score: 12", Center | Bottom, true, false, boundaries);
+    QCOMPARE(layout.reused(), static_cast<uint32_t>(0));
+    TextRender::composeMesh(font, expected, 24, "Score: 12", Center | Bottom, true, false, boundaries);
+    QVERIFY(compare(mesh, expected));
+
+    layout.compose(font, mesh, 24, "Score: 123", Center | Bottom, true, true, boundaries);
+    QCOMPARE(layout.reused(), static_cast<uint32_t>(0));
+}
+
+void Resumed_lines() {
+    Engine system(nullptr, "");
+
+    string path = string(__FILE__);
+    path = path.substr(0, path.find_last_of("/\\") + 1) + ROBOTO;
+    ifstream file(path, ios::binary);
+    ByteArray data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    QVERIFY(!data.empty());
+
+    // The layout queries kerning by characters, so the pair is stored for the codes of 'A' and 'V'
+    Font *font = Engine::objectCreate<Font>("Font");
+    font->loadUserData({{"Data", addKerning(data, 'A', 'V', -400)}});
+
+    QVERIFY(font->spaceWidth() > 0.0f);
+    QVERIFY(font->lineHeight() > 0.0f);
+    QVERIFY(font->requestKerning('V', 'A') < 0);
+    QCOMPARE(font->requestKerning('A', 'V'), 0);
+
+    Mesh *mesh = Engine::objectCreate<Mesh>("Mesh");
+    Mesh *expected = Engine::objectCreate<Mesh>("Expected");
+
+    Vector2 boundaries(400.0f, 100.0f);
+
+    TextLayout layout;
+    layout.compose(font, mesh, 16, "AV AV\nVA A1", Left | Top, true, false, boundaries);
+
+    // The resumed glyph is kerned against the last reused one on the second line
+    layout.compose(font, mesh, 16, "AV AV\nVA AV", Left | Top, true, false, boundaries);
+    QCOMPARE(layout.reused(), static_cast<uint32_t>(10));
+    TextRender::composeMesh(font, expected, 16, "AV AV\nVA AV", Left | Top, true, false, boundaries);
+    QVERIFY(compare(mesh, expected));
+
+    // Alignment is applied after the layout, the glyph run is still reused
+    layout.compose(font, mesh, 16, "AV AV\nVA AV\n A", Right | Bottom, true, false, boundaries);
+    QCOMPARE(layout.reused(), static_cast<uint32_t>(11));
+    layout.compose(font, mesh, 16, "AV AV\nVA AV\n AV", Right | Bottom, true, false, boundaries);
+    QCOMPARE(layout.reused(), static_cast<uint32_t>(14));
+    TextRender::composeMesh(font, expected, 16, "AV AV\nVA AV\n AV", Right | Bottom, true, false, boundaries);
+    QVERIFY(compare(mesh, expected));
+}
+
+} REGISTER(TextLayoutTest)
+
+#include "tst_textlayout.moc"
@@ -0,0 +1,170 @@
+#include "tst_common.h"
+
+#include "resources/texture.h"
+
+#include "editor/textureencoder.h"
+
+#include <threadpool.h>
+
+#include <cmath>
+
+#define WIDTH   130
+#define HEIGHT  66
+
+class TextureEncoderTest : public QObject {
+    Q_OBJECT
+
+    vector<uint8_t> m_Image;
+
+    // Shared by all the encoding calls of the test
+    ThreadPool m_Pool;
+
+    double psnr(const ByteArray &decoded, int32_t first, int32_t last) {
+        double mse = 0.0;
+        for(int32_t i = 0; i < WIDTH * HEIGHT; i++) {
+            for(int32_t c = first; c < last; c++) {
+                double d = static_cast<uint8_t>(decoded[i * 4 + c]) - m_Image[i * 4 + c];
+                mse += d * d;
+            }
+        }
+        mse /= WIDTH * HEIGHT * (last - first);
+        return (mse > 0.0) ? 10.0 * log10(255.0 * 255.0 / mse) : 100.0;
+    }
+
+    void check(int32_t compression, uint8_t channels, double rgb, double alpha) {
+        ByteArray data = TextureEncoder::encode(&m_Image[0], WIDTH, HEIGHT, compression, channels, TextureEncoder::Normal, &m_Pool);
+        QCOMPARE(static_cast<int32_t>(data.size()), TextureEncoder::surfaceSize(WIDTH, HEIGHT, compression, channels));
+
+        ByteArray decoded = TextureEncoder::decode(data, WIDTH, HEIGHT, compression, channels);
+        QCOMPARE(static_cast<int32_t>(decoded.size()), WIDTH * HEIGHT * 4);
+
+        QVERIFY(psnr(decoded, 0, 3) > rgb);
+        if(channels == 4) {
+            QVERIFY(psnr(decoded, 3, 4) > alpha);
+        }
+    }
+
+    // Blocks are composed by hand from the format specifications, all rows of the block decode to the same pixels.
+    // The image of the expected pixels must be encoded back to the same block, unless the format has several equal encodings.
+    void reference(const vector<uint8_t> &block, int32_t compression, uint8_t channels, const vector<uint8_t> &row, bool unique = true) {
+        ByteArray data(block.begin(), block.end());
+        ByteArray decoded = TextureEncoder::decode(data, 4, 4, compression, channels);
+        QCOMPARE(static_cast<int32_t>(decoded.size()), 4 * 4 * 4);
+        for(int32_t i = 0; i < 16 * 4; i++) {
+            QCOMPARE(static_cast<uint8_t>(decoded[i]), row[i % 16]);
+        }
+
+        vector<uint8_t> image(16 * 4);
+        for(int32_t i = 0; i < 16 * 4; i++) {
+            image[i] = row[i % 16];
+        }
+        for(int32_t quality : {TextureEncoder::Normal, TextureEncoder::Best}) {
+            ByteArray encoded = TextureEncoder::encode(&image[0], 4, 4, compression, channels, quality);
+            if(unique) {
+                QCOMPARE(encoded == data, true);
+            } else {
+                QCOMPARE(TextureEncoder::decode(encoded, 4, 4, compression, channels) == decoded, true);
+            }
+        }
+    }
+
+private slots:
+
+void initTestCase() {
+    m_Pool.setMaxThreads(4);
+
+    m_Image.resize(WIDTH * HEIGHT * 4);
+    for(int32_t y = 0; y < HEIGHT; y++) {
+        for(int32_t x = 0; x < WIDTH; x++) {
+            uint8_t *pixel = &m_Image[(y * WIDTH + x) * 4];
+            pixel[0] = x * 255 / WIDTH;
+            pixel[1] = y * 255 / HEIGHT;
+            pixel[2] = static_cast<uint8_t>(128.0 + 100.0 * sin(x * 0.05) * cos(y * 0.07));
+            pixel[3] = (x + y) % 256;
+        }
+    }
+}
+
+void Block_sizes() {
+    QCOMPARE(TextureEncoder::blockSize(Texture::DXT1, 3), 8);
+    QCOMPARE(TextureEncoder::blockSize(Texture::DXT5, 4), 16);
+    QCOMPARE(TextureEncoder::blockSize(Texture::ETC2, 3), 8);
+    QCOMPARE(TextureEncoder::blockSize(Texture::ETC2, 4), 16);
+    QCOMPARE(TextureEncoder::blockSize(Texture::BC7, 4), 16);
+    QCOMPARE(TextureEncoder::blockSize(Texture::Uncompressed, 4), 0);
+
+    QCOMPARE(TextureEncoder::surfaceSize(5, 5, Texture::DXT1, 3), 32);
+    QCOMPARE(TextureEncoder::surfaceSize(1, 1, Texture::BC7, 4), 16);
+}
+
+void Reference_blocks() {
+    // BC1 with red and blue endpoints, each row uses indices 0, 1, 2 and 3
+    reference({0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4}, Texture::DXT1, 3,
+              {255, 0, 0, 255,  0, 0, 255, 255,  170, 0, 85, 255,  85, 0, 170, 255});
+
+    // BC3 alpha with the 255 and 0 endpoints alternated by columns
+    reference({0xFF, 0x00, 0x08, 0x82, 0x20, 0x08, 0x82, 0x20,
+               0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4}, Texture::DXT5, 4,
+              {255, 0, 0, 255,  0, 0, 255, 0,  170, 0, 85, 255,  85, 0, 170, 0});
+
+    // ETC2 individual mode, red left and blue right halves, the table 0 adds 2 to all channels
+    reference({0xF0, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00}, Texture::ETC2, 3,
+              {255, 2, 2, 255,  255, 2, 2, 255,  2, 2, 255, 255,  2, 2, 255, 255});
+
+    // EAC alpha with the base 128, multiplier 1 and index 4 which adds 2
+    reference({0x80, 0x10, 0x92, 0x49, 0x24, 0x92, 0x49, 0x24,
+               0xF0, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00}, Texture::ETC2, 4,
+              {255, 2, 2, 130,  255, 2, 2, 130,  2, 2, 255, 130,  2, 2, 255, 130}, false);
+
+    // BC7 mode 6 with the white and transparent black endpoints alternated by columns
+    reference({0xC0, 0x3F, 0xE0, 0x0F, 0xF8, 0x03, 0xFE, 0x80,
+               0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0}, Texture::BC7, 4,
+              {255, 255, 255, 255,  0, 0, 0, 0,  255, 255, 255, 255,  0, 0, 0, 0});
+}
+
+void Encode_BC1() {
+    check(Texture::DXT1, 3, 38.0, 0.0);
+}
+
+void Encode_BC3() {
+    check(Texture::DXT5, 4, 38.0, 50.0);
+}
+
+void Encode_ETC2() {
+    check(Texture::ETC2, 3, 36.0, 0.0);
+    check(Texture::ETC2, 4, 36.0, 50.0);
+}
+
+void Encode_BC7() {
+    check(Texture::BC7, 4, 40.0, 44.0);
+}
+
+void Solid_color() {
+    for(int32_t compression : {Texture::DXT1, Texture::DXT5, Texture::ETC2, Texture::BC7}) {
+        uint8_t channels = (compression == Texture::DXT1) ? 3 : 4;
+        vector<uint8_t> solid(16 * 4);
+        for(int32_t i = 0; i < 16; i++) {
+            solid[i * 4 + 0] = 255;
+            solid[i * 4 + 1] = 0;
+            solid[i * 4 + 2] = 0;
+            solid[i * 4 + 3] = 255;
+        }
+        ByteArray decoded = TextureEncoder::decode(TextureEncoder::encode(&solid[0], 4, 4, compression, channels), 4, 4, compression, channels);
+        // ETC2 modifiers and BC7 shared p-bits don't allow to represent some colors exactly
+        for(int32_t i = 0; i < 16 * 4; i++) {
+            QVERIFY(abs(static_cast<uint8_t>(decoded[i]) - solid[i]) <= 2);
+        }
+    }
+}
+
+void Multithreaded_result() {
+    for(int32_t quality : {TextureEncoder::Fast, TextureEncoder::Normal}) {
+        ByteArray single = TextureEncoder::encode(&m_Image[0], WIDTH, HEIGHT, Texture::DXT5, 4, quality);
+        ByteArray multi = TextureEncoder::encode(&m_Image[0], WIDTH, HEIGHT, Texture::DXT5, 4, quality, &m_Pool);
+        QCOMPARE(single == multi, true);
+    }
+}
+
+} REGISTER(TextureEncoderTest)
+
+#include "tst_textureencoder.moc"
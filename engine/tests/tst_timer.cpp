@@ -0,0 +1,59 @@
+#include "tst_common.h"
+
+#include "timer.h"
+
+#include <cmath>
+
+class TimerTest : public QObject {
+    Q_OBJECT
+
+private slots:
+
+void init() {
+    Timer::reset();
+    Timer::init();
+    Timer::setFixedFrameTime(0.05f);
+    Timer::setFixedTimeStep(0.02f);
+    Timer::setMaxFixedSteps(5);
+}
+
+void cleanup() {
+    Timer::setFixedFrameTime(0.0f);
+    Timer::setFixedTimeStep(1.0f / 60.0f);
+    Timer::reset();
+}
+
+void Fixed_steps() {
+    Timer::update();
+    QCOMPARE(Timer::fixedSteps(), 2);
+    QVERIFY(fabsf(Timer::interpolation() - 0.5f) < 0.001f);
+
+    Timer::update();
+    QCOMPARE(Timer::fixedSteps(), 3);
+    QVERIFY(Timer::interpolation() < 0.001f);
+
+    QVERIFY(fabsf(Timer::time() - 0.1f) < 0.001f);
+}
+
+void Time_scale() {
+    Timer::setScale(0.5f);
+    Timer::update();
+    QCOMPARE(Timer::fixedSteps(), 1);
+    QVERIFY(fabsf(Timer::deltaTime() - 0.025f) < 0.001f);
+    QVERIFY(fabsf(Timer::interpolation() - 0.25f) < 0.001f);
+}
+
+void Catch_up_limit() {
+    Timer::setFixedFrameTime(1.0f);
+    Timer::update();
+    QCOMPARE(Timer::fixedSteps(), 5);
+    QVERIFY(Timer::interpolation() < 1.0f);
+
+    Timer::setFixedFrameTime(0.02f);
+    Timer::update();
+    QVERIFY(Timer::fixedSteps() <= 2);
+}
+
+} REGISTER(TimerTest)
+
+#include "tst_timer.moc"
@@ -0,0 +1,215 @@
+#include "tst_common.h"
+
+#include "components/transform.h"
+#include "components/private/transformhierarchy.h"
+
+#include <threadpool.h>
+
+#define ROOTS 64
+#define DEPTH 64
+
+// Builds and changes own chains of transforms like a script running on the pool thread
+class CrowdTask : public Object {
+public:
+    void processEvents() override {
+        for(int32_t i = 0; i < 32; i++) {
+            Transform *parent = nullptr;
+            for(int32_t d = 0; d < 16; d++) {
+                Transform *transform = new Transform;
+                transform->setPosition(Vector3(1.0f, 0.0f, 0.0f));
+                transform->setParentTransform(parent, true);
+                m_List.push_back(transform);
+                parent = transform;
+            }
+            m_List[i * 16 + 8]->setParentTransform(m_List[i * 16], true);
+            m_List[i * 16]->setRotation(Vector3(0.0f, i * 10.0f, 0.0f));
+            m_List[i * 16 + 1]->setScale(Vector3(2.0f));
+        }
+    }
+
+    vector<Transform *> m_List;
+
+};
+
+class TransformTest : public QObject {
+    Q_OBJECT
+
+    Matrix4 reference(Transform *transform) {
+        Matrix4 local(transform->position(), transform->quaternion(), transform->scale());
+        Transform *parent = transform->parentTransform();
+        return (parent) ? reference(parent) * local : local;
+    }
+
+    bool compare(const Matrix4 &left, const Matrix4 &right) {
+        for(int32_t i = 0; i < 16; i++) {
+            if(fabsf(left[i] - right[i]) > 0.001f) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Chains of transforms, every chain starts from own root
+    void createCrowd(vector<Transform *> &list, int32_t roots, int32_t depth) {
+        for(int32_t r = 0; r < roots; r++) {
+            Transform *parent = nullptr;
+            for(int32_t d = 0; d < depth; d++) {
+                Transform *transform = new Transform;
+                transform->setPosition(Vector3(d == 0 ? r * 2.0f : 0.0f, 0.1f, 0.0f));
+                transform->setRotation(Vector3(0.0f, 1.0f, 0.0f));
+                transform->setParentTransform(parent, true);
+                list.push_back(transform);
+                parent = transform;
+            }
+        }
+    }
+
+    void destroyCrowd(vector<Transform *> &list) {
+        for(auto it = list.rbegin(); it != list.rend(); ++it) {
+            delete *it;
+        }
+        list.clear();
+    }
+
+private slots:
+
+void Lazy_world_values() {
+    Transform parent;
+    Transform child;
+    child.setParentTransform(&parent, true);
+    child.setPosition(Vector3(1.0f, 0.0f, 0.0f));
+
+    parent.setPosition(Vector3(0.0f, 2.0f, 0.0f));
+    QCOMPARE(child.worldPosition(), Vector3(1.0f, 2.0f, 0.0f));
+
+    parent.setScale(Vector3(2.0f));
+    QCOMPARE(child.worldPosition(), Vector3(2.0f, 2.0f, 0.0f));
+    QCOMPARE(child.worldScale(), Vector3(2.0f));
+
+    parent.setRotation(Vector3(0.0f, 0.0f, 90.0f));
+    QVERIFY(compare(child.worldTransform(), reference(&child)));
+    QCOMPARE(child.worldRotation(), Vector3(0.0f, 0.0f, 90.0f));
+}
+
+void Reparent() {
+    Transform a;
+    Transform b;
+    Transform c;
+    a.setPosition(Vector3(1.0f, 0.0f, 0.0f));
+    b.setPosition(Vector3(0.0f, 3.0f, 0.0f));
+    c.setPosition(Vector3(5.0f, 5.0f, 5.0f));
+
+    // Parent is created after the child, so the order has to be rebuilt
+    c.setParentTransform(&b);
+    b.setParentTransform(&a);
+    QVERIFY((c.worldPosition() - Vector3(5.0f, 5.0f, 5.0f)).length() < 0.001f);
+
+    TransformHierarchy::instance()->update();
+    QVERIFY((c.worldPosition() - Vector3(5.0f, 5.0f, 5.0f)).length() < 0.001f);
+
+    a.setPosition(Vector3(2.0f, 0.0f, 0.0f));
+    TransformHierarchy::instance()->update();
+    QVERIFY((c.worldPosition() - Vector3(6.0f, 5.0f, 5.0f)).length() < 0.001f);
+
+    // Detached transform keeps the local values
+    c.setParentTransform(nullptr);
+    a.setPosition(Vector3(0.0f));
+    TransformHierarchy::instance()->update();
+    QCOMPARE(c.worldPosition(), c.position());
+    QVERIFY((b.worldPosition() - Vector3(-1.0f, 3.0f, 0.0f)).length() < 0.001f);
+}
+
+void Hierarchy_update() {
+    vector<Transform *> list;
+    createCrowd(list, 8, 16);
+
+    TransformHierarchy::instance()->update();
+    for(auto it : list) {
+        QVERIFY(compare(it->worldTransform(), reference(it)));
+    }
+
+    // Partially read before the pass, the rest of the modified subtrees must be updated anyway
+    list[0]->setPosition(Vector3(0.0f, 5.0f, 0.0f));
+    list[16 + 4]->setScale(Vector3(0.5f));
+    QVERIFY(compare(list[2]->worldTransform(), reference(list[2])));
+    TransformHierarchy::instance()->update();
+    for(auto it : list) {
+        QVERIFY(compare(it->worldTransform(), reference(it)));
+    }
+
+    destroyCrowd(list);
+}
+
+void Parallel_update() {
+    // Twice the parallel threshold, so the pass must be split
+    vector<Transform *> list;
+    createCrowd(list, ROOTS * 2, DEPTH);
+
+    ThreadPool pool;
+    pool.setMaxThreads(4);
+    TransformHierarchy::instance()->update(&pool);
+
+    for(int32_t r = 0; r < ROOTS * 2; r++) {
+        list[r * DEPTH]->setRotation(Vector3(0.0f, r * 3.0f, 0.0f));
+    }
+    QVERIFY(TransformHierarchy::instance()->update(&pool) > 1);
+    for(auto it : list) {
+        QVERIFY(compare(it->worldTransform(), reference(it)));
+    }
+
+    destroyCrowd(list);
+}
+
+void Concurrent_changes() {
+    vector<Transform *> list;
+    createCrowd(list, 8, 16);
+    TransformHierarchy::instance()->update();
+
+    ThreadPool pool;
+    pool.setMaxThreads(4);
+
+    CrowdTask tasks[4];
+    for(auto &it : tasks) {
+        pool.start(it);
+    }
+    // The main thread keeps reading and changing own transforms while the hierarchy grows
+    for(int32_t i = 0; i < 1000; i++) {
+        list[(i % 8) * 16]->setPosition(Vector3(0.0f, i * 0.01f, 0.0f));
+        QVERIFY(compare(list[(i % 8) * 16 + 15]->worldTransform(), reference(list[(i % 8) * 16 + 15])));
+    }
+    pool.waitForDone();
+
+    TransformHierarchy::instance()->update();
+    for(auto &task : tasks) {
+        for(auto it : task.m_List) {
+            QVERIFY(compare(it->worldTransform(), reference(it)));
+        }
+        destroyCrowd(task.m_List);
+    }
+    for(auto it : list) {
+        QVERIFY(compare(it->worldTransform(), reference(it)));
+    }
+
+    destroyCrowd(list);
+}
+
+void Benchmark_update() {
+    vector<Transform *> list;
+    createCrowd(list, ROOTS, DEPTH);
+    TransformHierarchy::instance()->update();
+
+    float angle = 0.0f;
+    QBENCHMARK {
+        angle += 1.0f;
+        for(int32_t r = 0; r < ROOTS; r++) {
+            list[r * DEPTH]->setRotation(Vector3(0.0f, angle, 0.0f));
+        }
+        TransformHierarchy::instance()->update();
+    }
+
+    destroyCrowd(list);
+}
+
+} REGISTER(TransformTest)
+
+#include "tst_transform.moc"
@@ -0,0 +1,36 @@
+#ifndef GRIDLAYOUT_H
+#define GRIDLAYOUT_H
+
+#include "components/layout.h"
+
+class GridLayoutPrivate;
+
+class GridLayout : public Layout {
+    A_REGISTER(GridLayout, Layout, Components/UI)
+
+    A_PROPERTIES(
+        A_PROPERTY(int, columns, GridLayout::columns, GridLayout::setColumns),
+        A_PROPERTY(Vector2, cellSize, GridLayout::cellSize, GridLayout::setCellSize)
+    )
+    A_NOMETHODS()
+
+public:
+    GridLayout();
+    ~GridLayout();
+
+    int columns() const;
+    void setColumns(int columns);
+
+    Vector2 cellSize() const;
+    void setCellSize(const Vector2 &size);
+
+    Vector2 sizeHint(const list<RectTransform *> &children) const override;
+
+    void arrange(const Vector2 &size, const list<RectTransform *> &children) override;
+
+private:
+    GridLayoutPrivate *p_ptr;
+
+};
+
+#endif // GRIDLAYOUT_H
@@ -0,0 +1,19 @@
+#ifndef HORIZONTALLAYOUT_H
+#define HORIZONTALLAYOUT_H
+
+#include "components/layout.h"
+
+class HorizontalLayout : public Layout {
+    A_REGISTER(HorizontalLayout, Layout, Components/UI)
+
+    A_NOPROPERTIES()
+    A_NOMETHODS()
+
+public:
+    Vector2 sizeHint(const list<RectTransform *> &children) const override;
+
+    void arrange(const Vector2 &size, const list<RectTransform *> &children) override;
+
+};
+
+#endif // HORIZONTALLAYOUT_H
@@ -35,9 +35,11 @@ public:
     string item() const;
     void setItem(const string &item);
 
-private:
-    void draw(ICommandBuffer &buffer, uint32_t layer) override;
+    Mesh *mesh() const override;
+
+    MaterialInstance *materialInstance() const override;
 
+private:
     void loadUserData(const VariantMap &data) override;
     VariantMap saveUserData() const override;
 
@@ -48,9 +48,11 @@ public:
     bool kerning() const;
     void setKerning(const bool kerning);
 
-private:
-    void draw(ICommandBuffer &buffer, uint32_t layer) override;
+    Mesh *mesh() const override;
+
+    MaterialInstance *materialInstance() const override;
 
+private:
     void loadData(const VariantList &data) override;
     void loadUserData(const VariantMap &data) override;
     VariantMap saveUserData() const override;
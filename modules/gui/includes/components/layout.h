@@ -0,0 +1,43 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <components/component.h>
+
+class RectTransform;
+
+class LayoutPrivate;
+
+class Layout : public Component {
+    A_REGISTER(Layout, Component, Components/UI)
+
+    A_PROPERTIES(
+        A_PROPERTY(float, spacing, Layout::spacing, Layout::setSpacing),
+        A_PROPERTY(Vector4, padding, Layout::padding, Layout::setPadding)
+    )
+    A_NOMETHODS()
+
+public:
+    Layout();
+    ~Layout();
+
+    float spacing() const;
+    void setSpacing(float spacing);
+
+    Vector4 padding() const;
+    void setPadding(const Vector4 &padding);
+
+    virtual Vector2 sizeHint(const list<RectTransform *> &children) const;
+
+    virtual void arrange(const Vector2 &size, const list<RectTransform *> &children);
+
+    void setParent(Object *parent, int32_t position = -1, bool force = false) override;
+
+protected:
+    void invalidate();
+
+private:
+    LayoutPrivate *p_ptr;
+
+};
+
+#endif // LAYOUT_H
@@ -5,6 +5,7 @@
 
 class RectTransformPrivate;
 class Widget;
+class Layout;
 
 class RectTransform : public Transform {
     A_REGISTER(RectTransform, Transform, General)
@@ -32,12 +33,28 @@ class RectTransform : public Transform {
     Vector2 maxAnchors() const;
     void setMaxAnchors(const Vector2 &anchors);
 
+    Vector2 sizeHint() const;
+
     bool isHovered(float x, float y) const;
 
+    RectTransform *hitTest(float x, float y);
+
+    void layout();
+
+    void invalidateLayout();
+
     void subscribe(Widget *widget);
     void unsubscribe(Widget *widget);
 
+    void setParent(Object *parent, int32_t position = -1, bool force = false) override;
+
+protected:
+    void setDirty() override;
+
 private:
+    friend class RectTransformPrivate;
+    friend class HitGrid;
+
     RectTransformPrivate *p_ptr;
 };
 
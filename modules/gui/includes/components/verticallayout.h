@@ -0,0 +1,19 @@
+#ifndef VERTICALLAYOUT_H
+#define VERTICALLAYOUT_H
+
+#include "components/layout.h"
+
+class VerticalLayout : public Layout {
+    A_REGISTER(VerticalLayout, Layout, Components/UI)
+
+    A_NOPROPERTIES()
+    A_NOMETHODS()
+
+public:
+    Vector2 sizeHint(const list<RectTransform *> &children) const override;
+
+    void arrange(const Vector2 &size, const list<RectTransform *> &children) override;
+
+};
+
+#endif // VERTICALLAYOUT_H
@@ -6,6 +6,8 @@
 class WidgetPrivate;
 
 class RectTransform;
+class Mesh;
+class MaterialInstance;
 
 class Widget : public Renderable {
     A_REGISTER(Widget, Renderable, Components/UI)
@@ -27,6 +29,13 @@ public:
 
     virtual void composeComponent();
 
+    virtual Mesh *mesh() const;
+
+    virtual MaterialInstance *materialInstance() const;
+
+    bool isDirty() const;
+    void setDirty(bool dirty = true);
+
 protected:
     void update() override;
 
@@ -34,6 +43,8 @@ protected:
 
     AABBox bound() const override;
 
+    bool raycast(const Ray &ray, Vector3 *pt) const override;
+
     void actorParentChanged() override;
 
 #ifdef NEXT_SHARED
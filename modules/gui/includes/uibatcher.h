@@ -0,0 +1,77 @@
+#ifndef UIBATCHER_H
+#define UIBATCHER_H
+
+#include <unordered_map>
+
+#include <resources/mesh.h>
+
+class Widget;
+class MaterialInstance;
+class ICommandBuffer;
+
+class UiBatcher {
+public:
+    UiBatcher();
+    ~UiBatcher();
+
+    void draw(ICommandBuffer &buffer, uint32_t layer, Widget *root);
+
+    uint32_t batchesCount() const;
+
+    static bool isCompatible(MaterialInstance *left, MaterialInstance *right);
+
+private:
+    struct Item {
+        Vector3Vector vertices;
+
+        Vector2Vector uv0;
+
+        IndexVector indices;
+
+        Matrix4 transform;
+
+        Vector4 rect;
+
+        MaterialInstance *material;
+
+        int flags;
+
+        uint32_t frame;
+
+        bool rebuilt;
+    };
+
+    struct Batch {
+        vector<Item *> items;
+
+        Vector4 rect;
+
+        Mesh *mesh;
+
+        MaterialInstance *material;
+
+        int flags;
+    };
+
+    void collectWidgets(Widget *widget);
+
+    bool updateItem(Widget *widget, Item &item);
+
+    void composeBatch(Batch &batch);
+
+private:
+    typedef unordered_map<Widget *, Item> ItemMap;
+
+    ItemMap m_Items;
+
+    vector<Widget *> m_Widgets;
+
+    vector<Batch> m_Batches;
+
+    uint32_t m_BatchesCount;
+
+    uint32_t m_Frame;
+
+};
+
+#endif // UIBATCHER_H
@@ -107,7 +107,22 @@ void AbstractButton::update() {
         if(t) {
             Vector4 color(p_ptr->m_normalColor);
 
-            bool hover = t->isHovered(pos.x, pos.y);
+            RectTransform *root = t;
+            RectTransform *parent = dynamic_cast<RectTransform *>(root->parentTransform());
+            while(parent) {
+                root = parent;
+                parent = dynamic_cast<RectTransform *>(root->parentTransform());
+            }
+
+            bool hover = false;
+            Transform *hit = root->hitTest(pos.x, pos.y);
+            while(hit) {
+                if(hit == t) {
+                    hover = true;
+                    break;
+                }
+                hit = hit->parentTransform();
+            }
             if(p_ptr->m_Hovered != hover) {
                 p_ptr->m_currentFade = 0.0f;
                 p_ptr->m_Hovered = hover;
@@ -0,0 +1,92 @@
+#include "components/gridlayout.h"
+
+#include "components/recttransform.h"
+
+class GridLayoutPrivate {
+public:
+    GridLayoutPrivate() :
+        m_CellSize(100.0f),
+        m_Columns(1) {
+
+    }
+
+    Vector2 m_CellSize;
+
+    int32_t m_Columns;
+};
+
+/*!
+    \class GridLayout
+    \brief Places the children in a grid of cells with the same size.
+    \inmodule Gui
+
+    The items fill the grid row by row starting from the top left corner.
+*/
+
+GridLayout::GridLayout() :
+        p_ptr(new GridLayoutPrivate) {
+
+}
+
+GridLayout::~GridLayout() {
+    delete p_ptr;
+}
+/*!
+    Returns the number of columns in the grid.
+*/
+int GridLayout::columns() const {
+    return p_ptr->m_Columns;
+}
+/*!
+    Changes the number of \a columns in the grid.
+*/
+void GridLayout::setColumns(int columns) {
+    p_ptr->m_Columns = MAX(columns, 1);
+    invalidate();
+}
+/*!
+    Returns the size of the grid cell.
+*/
+Vector2 GridLayout::cellSize() const {
+    return p_ptr->m_CellSize;
+}
+/*!
+    Changes the \a size of the grid cell.
+*/
+void GridLayout::setCellSize(const Vector2 &size) {
+    p_ptr->m_CellSize = size;
+    invalidate();
+}
+/*!
+    \internal
+*/
+Vector2 GridLayout::sizeHint(const list<RectTransform *> &children) const {
+    int32_t count = children.size();
+    int32_t columns = MIN(count, p_ptr->m_Columns);
+    int32_t rows = (count + p_ptr->m_Columns - 1) / p_ptr->m_Columns;
+
+    Vector2 result(0.0f);
+    if(count > 0) {
+        result.x = p_ptr->m_CellSize.x * columns + spacing() * (columns - 1);
+        result.y = p_ptr->m_CellSize.y * rows + spacing() * (rows - 1);
+    }
+    return result + Layout::sizeHint(children);
+}
+/*!
+    \internal
+*/
+void GridLayout::arrange(const Vector2 &size, const list<RectTransform *> &children) {
+    Vector4 pad = padding();
+    Vector2 cell = p_ptr->m_CellSize;
+
+    int32_t index = 0;
+    for(auto it : children) {
+        int32_t column = index % p_ptr->m_Columns;
+        int32_t row = index / p_ptr->m_Columns;
+
+        it->setSize(cell);
+        it->setPosition(Vector3(pad.x + column * (cell.x + spacing()),
+                                size.y - pad.y - cell.y - row * (cell.y + spacing()), 0.0f));
+        index++;
+    }
+}
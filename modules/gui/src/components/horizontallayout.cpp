@@ -0,0 +1,42 @@
+#include "components/horizontallayout.h"
+
+#include "components/recttransform.h"
+
+/*!
+    \class HorizontalLayout
+    \brief Places the children in a row from left to right.
+    \inmodule Gui
+
+    The width of each item is taken from its size hint, the height of items matches the height of the container.
+*/
+
+/*!
+    \internal
+*/
+Vector2 HorizontalLayout::sizeHint(const list<RectTransform *> &children) const {
+    Vector2 result(0.0f);
+    for(auto it : children) {
+        Vector2 hint = it->sizeHint();
+        result.x += hint.x;
+        result.y = MAX(result.y, hint.y);
+    }
+    if(!children.empty()) {
+        result.x += spacing() * (children.size() - 1);
+    }
+    return result + Layout::sizeHint(children);
+}
+/*!
+    \internal
+*/
+void HorizontalLayout::arrange(const Vector2 &size, const list<RectTransform *> &children) {
+    Vector4 pad = padding();
+    float height = MAX(size.y - pad.y - pad.w, 0.0f);
+
+    float x = pad.x;
+    for(auto it : children) {
+        Vector2 hint = it->sizeHint();
+        it->setSize(Vector2(hint.x, height));
+        it->setPosition(Vector3(x, pad.w, 0.0f));
+        x += hint.x + spacing();
+    }
+}
@@ -65,6 +65,7 @@ public:
                 SpriteRender::composeMesh(m_pSprite, m_Hash, m_pCustomMesh, size, false, false, 100.0f);
             }
         }
+        m_pImage->setDirty();
     }
 
     Vector4 m_Color;
@@ -95,19 +96,15 @@ Image::~Image() {
 /*!
     \internal
 */
-void Image::draw(ICommandBuffer &buffer, uint32_t layer) {
-    Actor *a = actor();
-    if(p_ptr->m_pCustomMesh) {
-        if(layer & ICommandBuffer::RAYCAST) {
-            buffer.setColor(ICommandBuffer::idToColor(a->uuid()));
-        }
-        buffer.drawMesh(a->transform()->worldTransform(),
-                        p_ptr->m_pCustomMesh,
-                        layer, (p_ptr->m_pCustomMaterial) ? p_ptr->m_pCustomMaterial : p_ptr->m_pMaterial);
-        buffer.setColor(Vector4(1.0f));
-    }
+Mesh *Image::mesh() const {
+    return p_ptr->m_pCustomMesh;
+}
+/*!
+    \internal
+*/
+MaterialInstance *Image::materialInstance() const {
+    return (p_ptr->m_pCustomMaterial) ? p_ptr->m_pCustomMaterial : p_ptr->m_pMaterial;
 }
-
 /*!
     Returns an instantiated Material assigned to SpriteRender.
 */
@@ -127,6 +124,8 @@ void Image::setMaterial(Material *material) {
             p_ptr->m_pCustomMaterial = nullptr;
         }
 
+        setDirty();
+
         if(material) {
             p_ptr->m_pCustomMaterial = material->createInstance();
             p_ptr->m_pCustomMaterial->setVector4(COLOR, &p_ptr->m_Color);
@@ -12,6 +12,7 @@
 #include <resources/font.h>
 
 #include <commandbuffer.h>
+#include <textlayout.h>
 
 #define FONT     "Font"
 #define MATERIAL "Material"
@@ -30,7 +31,8 @@ public:
         m_Size(16),
         m_Alignment(Left),
         m_Kerning(true),
-        m_Wrap(false) {
+        m_Wrap(false),
+        m_Dirty(false) {
 
         m_pMesh->makeDynamic();
         m_pMesh->setFlags(Mesh::Uv0);
@@ -50,17 +52,28 @@ public:
 
     void resourceUpdated(const Resource *resource, Resource::ResourceState state) override {
         if(resource == m_pFont && state == Resource::Ready) {
-            composeMesh();
+            m_Layout.reset();
+            invalidate();
         }
     }
 
+    void invalidate() {
+        m_Dirty = true;
+        m_pLabel->setDirty();
+    }
+
     void composeMesh() {
-        RectTransform *t = dynamic_cast<RectTransform *>(m_pLabel->actor()->transform());
-        if(t) {
-            TextRender::composeMesh(m_pFont, m_pMesh, m_Size, m_Text, m_Alignment, m_Kerning, m_Wrap, t->size());
+        if(m_Dirty) {
+            RectTransform *t = dynamic_cast<RectTransform *>(m_pLabel->actor()->transform());
+            if(t) {
+                m_Layout.compose(m_pFont, m_pMesh, m_Size, m_Text, m_Alignment, m_Kerning, m_Wrap, t->size());
+            }
+            m_Dirty = false;
         }
     }
 
+    TextLayout m_Layout;
+
     string m_Text;
 
     Vector4 m_Color;
@@ -80,6 +93,8 @@ public:
     bool m_Kerning;
 
     bool m_Wrap;
+
+    bool m_Dirty;
 };
 
 /*!
@@ -88,6 +103,7 @@ public:
     \inmodule Gui
 
     The Label component allows you to display a text in UI.
+    The text mesh is composed lazily when the UI is batched, so any number of property changes per frame costs a single composition.
 */
 
 Label::Label() :
@@ -101,15 +117,18 @@ Label::~Label() {
 /*!
     \internal
 */
-void Label::draw(ICommandBuffer &buffer, uint32_t layer) {
-    Actor *a = actor();
-    if(p_ptr->m_pMesh && !p_ptr->m_Text.empty()) {
-        if(layer & ICommandBuffer::RAYCAST) {
-            buffer.setColor(ICommandBuffer::idToColor(a->uuid()));
-        }
-        buffer.drawMesh(a->transform()->worldTransform(), p_ptr->m_pMesh, layer, p_ptr->m_pMaterial);
-        buffer.setColor(Vector4(1.0f));
+Mesh *Label::mesh() const {
+    if(p_ptr->m_Text.empty()) {
+        return nullptr;
     }
+    p_ptr->composeMesh();
+    return p_ptr->m_pMesh;
+}
+/*!
+    \internal
+*/
+MaterialInstance *Label::materialInstance() const {
+    return p_ptr->m_pMaterial;
 }
 /*!
     Returns the text which will be drawn.
@@ -122,7 +141,7 @@ string Label::text() const {
 */
 void Label::setText(const string &text) {
     p_ptr->m_Text = text;
-    p_ptr->composeMesh();
+    p_ptr->invalidate();
 }
 /*!
     Returns the font which will be used to draw a text.
@@ -144,7 +163,7 @@ void Label::setFont(Font *font) {
             p_ptr->m_pMaterial->setTexture(OVERRIDE, p_ptr->m_pFont->texture());
         }
     }
-    p_ptr->composeMesh();
+    p_ptr->invalidate();
 }
 /*!
     Returns the size of the font.
@@ -157,7 +176,7 @@ int Label::fontSize() const {
 */
 void Label::setFontSize(int size) {
     p_ptr->m_Size = size;
-    p_ptr->composeMesh();
+    p_ptr->invalidate();
 }
 /*!
     Returns the color of the text to be drawn.
@@ -182,7 +201,7 @@ bool Label::wordWrap() const {
 */
 void Label::setWordWrap(bool wrap) {
     p_ptr->m_Wrap = wrap;
-    p_ptr->composeMesh();
+    p_ptr->invalidate();
 }
 /*!
     Returns text alignment policy.
@@ -195,7 +214,7 @@ int Label::align() const {
 */
 void Label::setAlign(int alignment) {
     p_ptr->m_Alignment = alignment;
-    p_ptr->composeMesh();
+    p_ptr->invalidate();
 }
 /*!
     Returns true if glyph kerning enabled; otherwise returns false.
@@ -209,14 +228,14 @@ bool Label::kerning() const {
 */
 void Label::setKerning(const bool kerning) {
     p_ptr->m_Kerning = kerning;
-    p_ptr->composeMesh();
+    p_ptr->invalidate();
 }
 /*!
     \internal
 */
 void Label::loadData(const VariantList &data) {
     Component::loadData(data);
-    p_ptr->composeMesh();
+    p_ptr->invalidate();
 }
 /*!
     \internal
@@ -249,7 +268,7 @@ VariantMap Label::saveUserData() const {
 */
 bool Label::event(Event *ev) {
     if(ev->type() == Event::LanguageChange) {
-        p_ptr->composeMesh();
+        p_ptr->invalidate();
     }
     return true;
 }
@@ -258,5 +277,5 @@ bool Label::event(Event *ev) {
 */
 void Label::boundChanged() {
     Widget::boundChanged();
-    p_ptr->composeMesh();
+    p_ptr->invalidate();
 }
@@ -0,0 +1,96 @@
+#include "components/layout.h"
+
+#include "components/recttransform.h"
+
+#include <components/actor.h>
+
+class LayoutPrivate {
+public:
+    LayoutPrivate() :
+        m_Padding(0.0f),
+        m_Spacing(0.0f) {
+
+    }
+
+    Vector4 m_Padding;
+
+    float m_Spacing;
+};
+
+/*!
+    \class Layout
+    \brief Base class for the layout containers.
+    \inmodule Gui
+
+    The Layout component arranges the child rectangles of the RectTransform attached to the same Actor.
+    The layout is applied lazily during the layout pass of the RectTransform hierarchy.
+*/
+
+Layout::Layout() :
+        p_ptr(new LayoutPrivate) {
+
+}
+
+Layout::~Layout() {
+    delete p_ptr;
+}
+/*!
+    Returns the spacing between the items.
+*/
+float Layout::spacing() const {
+    return p_ptr->m_Spacing;
+}
+/*!
+    Changes the \a spacing between the items.
+*/
+void Layout::setSpacing(float spacing) {
+    p_ptr->m_Spacing = spacing;
+    invalidate();
+}
+/*!
+    Returns the padding of the container in order: left, top, right, bottom.
+*/
+Vector4 Layout::padding() const {
+    return p_ptr->m_Padding;
+}
+/*!
+    Changes the \a padding of the container in order: left, top, right, bottom.
+*/
+void Layout::setPadding(const Vector4 &padding) {
+    p_ptr->m_Padding = padding;
+    invalidate();
+}
+/*!
+    Measures the preferred size of the container to fit all \a children.
+*/
+Vector2 Layout::sizeHint(const list<RectTransform *> &children) const {
+    A_UNUSED(children);
+    return Vector2(p_ptr->m_Padding.x + p_ptr->m_Padding.z, p_ptr->m_Padding.y + p_ptr->m_Padding.w);
+}
+/*!
+    Places the \a children inside of the container with provided \a size.
+*/
+void Layout::arrange(const Vector2 &size, const list<RectTransform *> &children) {
+    A_UNUSED(size);
+    A_UNUSED(children);
+}
+/*!
+    \internal
+*/
+void Layout::setParent(Object *parent, int32_t position, bool force) {
+    Component::setParent(parent, position, force);
+
+    invalidate();
+}
+/*!
+    Requests a new layout pass for the container.
+*/
+void Layout::invalidate() {
+    Actor *a = actor();
+    if(a) {
+        RectTransform *rect = dynamic_cast<RectTransform *>(a->transform());
+        if(rect) {
+            rect->invalidateLayout();
+        }
+    }
+}
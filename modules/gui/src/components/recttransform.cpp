@@ -1,15 +1,134 @@
 #include "components/recttransform.h"
 
 #include "components/widget.h"
+#include "components/layout.h"
+
+#include <components/actor.h>
+
+#include <cfloat>
+
+#define CELL_SIZE 64.0f
+#define MAX_CELLS 64
+
+class HitGrid {
+public:
+    struct Entry {
+        RectTransform *rect;
+
+        Vector4 bound;
+    };
+
+    HitGrid() :
+        m_Columns(0),
+        m_Rows(0) {
+
+    }
+
+    void build(RectTransform *root) {
+        m_Entries.clear();
+        collect(root);
+
+        m_Bound = Vector4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for(auto &it : m_Entries) {
+            m_Bound.x = MIN(m_Bound.x, it.bound.x);
+            m_Bound.y = MIN(m_Bound.y, it.bound.y);
+            m_Bound.z = MAX(m_Bound.z, it.bound.z);
+            m_Bound.w = MAX(m_Bound.w, it.bound.w);
+        }
+
+        m_Cells.clear();
+        if(m_Entries.empty()) {
+            m_Columns = 0;
+            m_Rows = 0;
+            return;
+        }
+
+        m_Cell.x = MAX((m_Bound.z - m_Bound.x) / MAX_CELLS, CELL_SIZE);
+        m_Cell.y = MAX((m_Bound.w - m_Bound.y) / MAX_CELLS, CELL_SIZE);
+
+        m_Columns = MAX(static_cast<int32_t>(ceilf((m_Bound.z - m_Bound.x) / m_Cell.x)), 1);
+        m_Rows = MAX(static_cast<int32_t>(ceilf((m_Bound.w - m_Bound.y) / m_Cell.y)), 1);
+        m_Cells.resize(m_Columns * m_Rows);
+
+        // Entries are stored in drawing order, so the last entry in a cell is the topmost one
+        for(uint32_t i = 0; i < m_Entries.size(); i++) {
+            const Vector4 &b = m_Entries[i].bound;
+            int32_t x0 = column(b.x);
+            int32_t x1 = column(b.z);
+            int32_t y0 = row(b.y);
+            int32_t y1 = row(b.w);
+            for(int32_t y = y0; y <= y1; y++) {
+                for(int32_t x = x0; x <= x1; x++) {
+                    m_Cells[y * m_Columns + x].push_back(i);
+                }
+            }
+        }
+    }
+
+    RectTransform *hitTest(float x, float y) const {
+        if(m_Cells.empty() || x < m_Bound.x || x > m_Bound.z || y < m_Bound.y || y > m_Bound.w) {
+            return nullptr;
+        }
+        const vector<uint32_t> &cell = m_Cells[row(y) * m_Columns + column(x)];
+        for(auto it = cell.rbegin(); it != cell.rend(); ++it) {
+            const Entry &entry = m_Entries[*it];
+            if(x > entry.bound.x && x < entry.bound.z &&
+               y > entry.bound.y && y < entry.bound.w) {
+                // Enabling an actor doesn't change the geometry, so the disabled rectangles stay in the grid
+                Actor *actor = entry.rect->actor();
+                if(actor && !actor->isEnabledInHierarchy()) {
+                    continue;
+                }
+                return entry.rect;
+            }
+        }
+        return nullptr;
+    }
+
+protected:
+    void collect(RectTransform *rect);
+
+    int32_t column(float x) const {
+        return CLAMP(static_cast<int32_t>((x - m_Bound.x) / m_Cell.x), 0, m_Columns - 1);
+    }
+
+    int32_t row(float y) const {
+        return CLAMP(static_cast<int32_t>((y - m_Bound.y) / m_Cell.y), 0, m_Rows - 1);
+    }
+
+    vector<Entry> m_Entries;
+
+    vector<vector<uint32_t>> m_Cells;
+
+    Vector4 m_Bound;
+
+    Vector2 m_Cell;
+
+    int32_t m_Columns;
+
+    int32_t m_Rows;
+};
 
 class RectTransformPrivate {
 public:
-    RectTransformPrivate() :
+    RectTransformPrivate(RectTransform *transform) :
         m_Size(1.0f),
         m_Pivot(0.0f),
         m_minAnchors(0.5f),
-        m_maxAnchors(0.5f) {
+        m_maxAnchors(0.5f),
+        m_ArrangedSize(1.0f),
+        m_pTransform(transform),
+        m_pGrid(nullptr),
+        m_Dirty(false),
+        m_ChildDirty(false),
+        m_HintValid(false),
+        m_GridDirty(true),
+        m_Arranging(false) {
+
+    }
 
+    ~RectTransformPrivate() {
+        delete m_pGrid;
     }
 
     void notify() {
@@ -18,15 +137,132 @@ public:
         }
     }
 
+    RectTransform *parent() const {
+        return dynamic_cast<RectTransform *>(m_pTransform->parentTransform());
+    }
+
+    Layout *layout() const {
+        Actor *actor = m_pTransform->actor();
+        if(actor) {
+            return static_cast<Layout *>(actor->component("Layout"));
+        }
+        return nullptr;
+    }
+
+    list<RectTransform *> childRects() const {
+        list<RectTransform *> result;
+        for(auto it : m_pTransform->children()) {
+            RectTransform *child = dynamic_cast<RectTransform *>(it);
+            if(child) {
+                result.push_back(child);
+            }
+        }
+        return result;
+    }
+
+    void setLayoutDirty() {
+        m_Dirty = true;
+        m_HintValid = false;
+
+        // Container has to re-arrange its items when one of them changed the size
+        RectTransform *p = parent();
+        if(p && !p->p_ptr->m_Arranging && p->p_ptr->layout()) {
+            p->p_ptr->setLayoutDirty();
+            return;
+        }
+
+        while(p) {
+            RectTransformPrivate *ptr = p->p_ptr;
+            if(ptr->m_ChildDirty && !ptr->m_HintValid) {
+                break;
+            }
+            ptr->m_ChildDirty = true;
+            ptr->m_HintValid = false;
+            p = ptr->parent();
+        }
+        setGridDirty();
+    }
+
+    void setGridDirty() {
+        RectTransformPrivate *ptr = this;
+        while(ptr && !ptr->m_GridDirty) {
+            ptr->m_GridDirty = true;
+            RectTransform *p = ptr->parent();
+            ptr = (p) ? p->p_ptr : nullptr;
+        }
+    }
+
+    void arrange() {
+        m_Arranging = true;
+
+        list<RectTransform *> children = childRects();
+        Layout *l = layout();
+        if(l) {
+            l->arrange(m_Size, children);
+        } else {
+            Vector2 d = m_Size - m_ArrangedSize;
+            if(d.x != 0.0f || d.y != 0.0f) {
+                for(auto child : children) {
+                    Vector2 minAnchors = child->minAnchors();
+                    child->setSize(child->size() + d * (child->maxAnchors() - minAnchors));
+                    child->setPosition(child->position() + Vector3(d * minAnchors, 0.0f));
+                }
+            }
+        }
+        m_ArrangedSize = m_Size;
+
+        m_Arranging = false;
+    }
+
     Vector2 m_Size;
     Vector2 m_Pivot;
     Vector2 m_minAnchors;
     Vector2 m_maxAnchors;
+
+    Vector2 m_ArrangedSize;
+    mutable Vector2 m_Hint;
+
     list<Widget *> m_Subscribers;
+
+    RectTransform *m_pTransform;
+
+    HitGrid *m_pGrid;
+
+    bool m_Dirty;
+    bool m_ChildDirty;
+    mutable bool m_HintValid;
+    bool m_GridDirty;
+    bool m_Arranging;
 };
 
+void HitGrid::collect(RectTransform *rect) {
+    Vector3 pos = rect->worldPosition() + Vector3(rect->pivot(), 0.0f);
+    Vector2 size = rect->size();
+
+    Entry entry;
+    entry.rect = rect;
+    entry.bound = Vector4(pos.x, pos.y, pos.x + size.x, pos.y + size.y);
+    m_Entries.push_back(entry);
+
+    for(auto child : rect->p_ptr->childRects()) {
+        collect(child);
+    }
+    rect->p_ptr->m_GridDirty = false;
+}
+
+/*!
+    \class RectTransform
+    \brief Position, size, anchors and pivot of a rectangle used by UI widgets.
+    \inmodule Gui
+
+    The RectTransform uses a retained layout model.
+    Changes of the size, anchors or layout settings only mark the transform as dirty, the actual geometry is recalculated with a layout() call.
+    The layout consists of two passes: measure, which calculates sizeHint() from the bottom to the top of hierarchy, and arrange, which applies sizes and positions to the children.
+    Only dirty transforms, their containers and the children affected by the changes are visited during the layout pass.
+*/
+
 RectTransform::RectTransform() :
-    p_ptr(new RectTransformPrivate) {
+    p_ptr(new RectTransformPrivate(this)) {
 
 }
 
@@ -37,51 +273,82 @@ RectTransform::~RectTransform() {
     }
     delete p_ptr;
 }
-
+/*!
+    Returns the size of the rectangle.
+*/
 Vector2 RectTransform::size() const {
     return p_ptr->m_Size;
 }
+/*!
+    Changes the \a size of the rectangle.
+    The children will be resized according to their anchors during the next layout() call.
+*/
 void RectTransform::setSize(const Vector2 &size) {
     if(p_ptr->m_Size != size) {
-        Vector2 d = size - p_ptr->m_Size;
-        for(auto &it : children()) {
-            RectTransform *child = dynamic_cast<RectTransform *>(it);
-            if(child) {
-                Vector2 minAnchors = child->minAnchors();
-                child->setSize(child->size() + d * (child->maxAnchors() - minAnchors));
-                child->setPosition(child->position() + Vector3(d * minAnchors, 0.0f));
-            }
-        }
-
         p_ptr->m_Size = size;
-        p_ptr->notify();
+        p_ptr->setLayoutDirty();
     }
 }
-
+/*!
+    Returns the pivot point of the rectangle.
+*/
 Vector2 RectTransform::pivot() const {
     return p_ptr->m_Pivot;
 }
+/*!
+    Changes the \a pivot point of the rectangle.
+*/
 void RectTransform::setPivot(const Vector2 &pivot) {
     if(p_ptr->m_Pivot != pivot) {
         p_ptr->m_Pivot = pivot;
-        p_ptr->notify();
+        p_ptr->setLayoutDirty();
     }
 }
-
+/*!
+    Returns the anchor of the bottom left corner of the rectangle in the parent space.
+*/
 Vector2 RectTransform::minAnchors() const {
     return p_ptr->m_minAnchors;
 }
+/*!
+    Changes the \a anchors of the bottom left corner of the rectangle in the parent space.
+*/
 void RectTransform::setMinAnchors(const Vector2 &anchors) {
-    p_ptr->m_minAnchors = anchors;
+    if(p_ptr->m_minAnchors != anchors) {
+        p_ptr->m_minAnchors = anchors;
+        p_ptr->setLayoutDirty();
+    }
 }
-
+/*!
+    Returns the anchor of the top right corner of the rectangle in the parent space.
+*/
 Vector2 RectTransform::maxAnchors() const {
     return p_ptr->m_maxAnchors;
 }
+/*!
+    Changes the \a anchors of the top right corner of the rectangle in the parent space.
+*/
 void RectTransform::setMaxAnchors(const Vector2 &anchors) {
-    p_ptr->m_maxAnchors = anchors;
+    if(p_ptr->m_maxAnchors != anchors) {
+        p_ptr->m_maxAnchors = anchors;
+        p_ptr->setLayoutDirty();
+    }
 }
-
+/*!
+    Returns the preferred size of the rectangle.
+    For the rectangles with attached Layout the size is measured from the children; otherwise returns size().
+*/
+Vector2 RectTransform::sizeHint() const {
+    if(!p_ptr->m_HintValid) {
+        Layout *l = p_ptr->layout();
+        p_ptr->m_Hint = (l) ? l->sizeHint(p_ptr->childRects()) : p_ptr->m_Size;
+        p_ptr->m_HintValid = true;
+    }
+    return p_ptr->m_Hint;
+}
+/*!
+    Returns true in case of point with \a x and \a y coordinates is inside the rectangle; otherwise returns false.
+*/
 bool RectTransform::isHovered(float x, float y) const {
     Actor *parent = actor();
     if(parent) {
@@ -93,11 +360,86 @@ bool RectTransform::isHovered(float x, float y) const {
     }
     return false;
 }
+/*!
+    Returns the topmost rectangle in the hierarchy of this transform which contains the point with \a x and \a y coordinates; otherwise returns nullptr.
+    The lookup uses a spatial grid which is rebuilt only when the hierarchy has been changed.
+    Rectangles of the disabled actors are skipped.
+*/
+RectTransform *RectTransform::hitTest(float x, float y) {
+    layout();
+
+    if(p_ptr->m_pGrid == nullptr) {
+        p_ptr->m_pGrid = new HitGrid;
+        p_ptr->m_GridDirty = true;
+    }
+    if(p_ptr->m_GridDirty) {
+        p_ptr->m_pGrid->build(this);
+    }
+    return p_ptr->m_pGrid->hitTest(x, y);
+}
+/*!
+    Performs the layout pass for the dirty part of the hierarchy.
+    Subscribed widgets of the changed rectangles will be notified.
+*/
+void RectTransform::layout() {
+    if(!p_ptr->m_Dirty && !p_ptr->m_ChildDirty) {
+        return;
+    }
+
+    if(p_ptr->m_Dirty) {
+        p_ptr->m_Dirty = false;
+        p_ptr->arrange();
+        p_ptr->notify();
+    }
+    p_ptr->m_ChildDirty = false;
 
+    for(auto child : p_ptr->childRects()) {
+        child->layout();
+    }
+}
+/*!
+    Marks the rectangle as required to be re-arranged during the next layout() call.
+*/
+void RectTransform::invalidateLayout() {
+    p_ptr->setLayoutDirty();
+}
+/*!
+    \internal
+*/
 void RectTransform::subscribe(Widget *widget) {
     p_ptr->m_Subscribers.push_back(widget);
 }
-
+/*!
+    \internal
+*/
 void RectTransform::unsubscribe(Widget *widget) {
     p_ptr->m_Subscribers.remove(widget);
 }
+/*!
+    \internal
+    Pending changes of the new parent must be applied before adoption to not affect the new child.
+*/
+void RectTransform::setParent(Object *parent, int32_t position, bool force) {
+    Actor *actor = dynamic_cast<Actor *>(parent);
+    if(actor) {
+        actor = dynamic_cast<Actor *>(actor->parent());
+        if(actor) {
+            RectTransform *rect = dynamic_cast<RectTransform *>(actor->transform());
+            if(rect) {
+                rect->layout();
+            }
+        }
+    }
+
+    Transform::setParent(parent, position, force);
+
+    p_ptr->setLayoutDirty();
+}
+/*!
+    \internal
+*/
+void RectTransform::setDirty() {
+    Transform::setDirty();
+
+    p_ptr->setGridDirty();
+}
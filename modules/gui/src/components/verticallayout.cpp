@@ -0,0 +1,43 @@
+#include "components/verticallayout.h"
+
+#include "components/recttransform.h"
+
+/*!
+    \class VerticalLayout
+    \brief Places the children in a column from top to bottom.
+    \inmodule Gui
+
+    The height of each item is taken from its size hint, the width of items matches the width of the container.
+*/
+
+/*!
+    \internal
+*/
+Vector2 VerticalLayout::sizeHint(const list<RectTransform *> &children) const {
+    Vector2 result(0.0f);
+    for(auto it : children) {
+        Vector2 hint = it->sizeHint();
+        result.x = MAX(result.x, hint.x);
+        result.y += hint.y;
+    }
+    if(!children.empty()) {
+        result.y += spacing() * (children.size() - 1);
+    }
+    return result + Layout::sizeHint(children);
+}
+/*!
+    \internal
+*/
+void VerticalLayout::arrange(const Vector2 &size, const list<RectTransform *> &children) {
+    Vector4 pad = padding();
+    float width = MAX(size.x - pad.x - pad.z, 0.0f);
+
+    float y = size.y - pad.y;
+    for(auto it : children) {
+        Vector2 hint = it->sizeHint();
+        y -= hint.y;
+        it->setSize(Vector2(width, hint.y));
+        it->setPosition(Vector3(pad.x, y, 0.0f));
+        y -= spacing();
+    }
+}
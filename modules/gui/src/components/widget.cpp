@@ -2,6 +2,8 @@
 
 #include "components/recttransform.h"
 
+#include "uibatcher.h"
+
 #include <components/actor.h>
 #include <components/transform.h>
 #include <components/camera.h>
@@ -14,12 +16,22 @@ class WidgetPrivate {
 public:
     WidgetPrivate() :
         m_pParent(nullptr),
-        m_pTransform(nullptr) {
+        m_pTransform(nullptr),
+        m_pBatcher(nullptr),
+        m_Dirty(true) {
+
+    }
 
+    ~WidgetPrivate() {
+        delete m_pBatcher;
     }
 
     Widget *m_pParent;
     RectTransform *m_pTransform;
+
+    UiBatcher *m_pBatcher;
+
+    bool m_Dirty;
 };
 
 Widget::Widget() :
@@ -38,18 +50,42 @@ void Widget::update() {
     Renderable::update();
 }
 
+/*!
+    \internal
+    In the UI layer only the root widget submits geometry, it draws the whole widget hierarchy in batches.
+    All other layers (e.g. RAYCAST) are drawn per widget.
+*/
 void Widget::draw(ICommandBuffer &buffer, uint32_t layer) {
-    A_UNUSED(buffer);
-    A_UNUSED(layer);
-
-    if(p_ptr->m_pParent == nullptr && (layer == ICommandBuffer::UI)) {
-        Camera *camera = Camera::current();
-        if(camera) {
-            Pipeline *pipeline = camera->pipeline();
-            if(pipeline && p_ptr->m_pTransform) {
-                p_ptr->m_pTransform->setSize(Vector2(pipeline->screenWidth(), pipeline->screenHeight()));
+    if(layer == ICommandBuffer::UI) {
+        if(p_ptr->m_pParent == nullptr) {
+            Camera *camera = Camera::current();
+            if(camera) {
+                Pipeline *pipeline = camera->pipeline();
+                if(pipeline && p_ptr->m_pTransform) {
+                    p_ptr->m_pTransform->setSize(Vector2(pipeline->screenWidth(), pipeline->screenHeight()));
+                }
             }
+            if(p_ptr->m_pTransform) {
+                p_ptr->m_pTransform->layout();
+            }
+
+            if(p_ptr->m_pBatcher == nullptr) {
+                p_ptr->m_pBatcher = new UiBatcher;
+            }
+            p_ptr->m_pBatcher->draw(buffer, layer, this);
         }
+        return;
+    }
+
+    Mesh *m = mesh();
+    MaterialInstance *instance = materialInstance();
+    if(m && instance) {
+        Actor *a = actor();
+        if(layer & ICommandBuffer::RAYCAST) {
+            buffer.setColor(ICommandBuffer::idToColor(a->uuid()));
+        }
+        buffer.drawMesh(a->transform()->worldTransform(), m, layer, instance);
+        buffer.setColor(Vector4(1.0f));
     }
 }
 
@@ -61,10 +97,40 @@ AABBox Widget::bound() const {
 
     return result * actor()->transform()->worldTransform();
 }
+/*!
+    \internal
+*/
+bool Widget::raycast(const Ray &ray, Vector3 *pt) const {
+    return raycastMesh(mesh(), ray, pt);
+}
 
 void Widget::boundChanged() {
 
 }
+/*!
+    Returns the mesh which represents the widget geometry; returns nullptr if the widget has nothing to draw.
+*/
+Mesh *Widget::mesh() const {
+    return nullptr;
+}
+/*!
+    Returns the material instance which should be used to draw the widget mesh().
+*/
+MaterialInstance *Widget::materialInstance() const {
+    return nullptr;
+}
+/*!
+    Returns true if the widget geometry has been changed since the last batching; otherwise returns false.
+*/
+bool Widget::isDirty() const {
+    return p_ptr->m_Dirty;
+}
+/*!
+    Marks the widget geometry as \a dirty which means it must be rebuilt by the UI batcher.
+*/
+void Widget::setDirty(bool dirty) {
+    p_ptr->m_Dirty = dirty;
+}
 
 Widget *Widget::parentWidget() {
     return p_ptr->m_pParent;
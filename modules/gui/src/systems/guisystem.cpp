@@ -8,6 +8,11 @@
 
 #include "components/recttransform.h"
 
+#include "components/layout.h"
+#include "components/horizontallayout.h"
+#include "components/verticallayout.h"
+#include "components/gridlayout.h"
+
 #include "components/widget.h"
 #include "components/image.h"
 #include "components/label.h"
@@ -20,6 +25,11 @@ GuiSystem::GuiSystem() :
 
     RectTransform::registerClassFactory(this);
 
+    Layout::registerClassFactory(this);
+    HorizontalLayout::registerClassFactory(this);
+    VerticalLayout::registerClassFactory(this);
+    GridLayout::registerClassFactory(this);
+
     Widget::registerClassFactory(this);
     Image::registerClassFactory(this);
     Label::registerClassFactory(this);
@@ -42,6 +52,11 @@ GuiSystem::~GuiSystem() {
     Image::unregisterClassFactory(this);
     Widget::unregisterClassFactory(this);
 
+    GridLayout::unregisterClassFactory(this);
+    VerticalLayout::unregisterClassFactory(this);
+    HorizontalLayout::unregisterClassFactory(this);
+    Layout::unregisterClassFactory(this);
+
     RectTransform::unregisterClassFactory(this);
 }
 
@@ -0,0 +1,282 @@
+#include "uibatcher.h"
+
+#include "components/widget.h"
+
+#include <components/actor.h>
+#include <components/transform.h>
+
+#include <resources/material.h>
+
+#include <commandbuffer.h>
+
+#include <cstring>
+#include <cfloat>
+
+namespace  {
+    bool overlaps(const Vector4 &left, const Vector4 &right) {
+        return (left.x < right.z && right.x < left.z &&
+                left.y < right.w && right.y < left.w);
+    }
+
+    void unite(Vector4 &rect, const Vector4 &other) {
+        rect.x = MIN(rect.x, other.x);
+        rect.y = MIN(rect.y, other.y);
+        rect.z = MAX(rect.z, other.z);
+        rect.w = MAX(rect.w, other.w);
+    }
+
+    uint32_t paramSize(uint32_t type) {
+        switch(type) {
+            case MetaType::INTEGER: return sizeof(int32_t);
+            case MetaType::FLOAT:   return sizeof(float);
+            case MetaType::VECTOR2: return sizeof(Vector2);
+            case MetaType::VECTOR3: return sizeof(Vector3);
+            case MetaType::VECTOR4: return sizeof(Vector4);
+            case MetaType::MATRIX4: return sizeof(Matrix4);
+            default: break;
+        }
+        return 0;
+    }
+}
+
+/*!
+    \class UiBatcher
+    \brief Collects the geometry of a widget hierarchy into a minimal number of draw calls.
+    \inmodule Gui
+
+    The UiBatcher transforms geometry of each widget into the screen space and merges widgets with compatible materials into shared dynamic meshes.
+    Widget can be moved to an earlier batch only if it doesn't overlap any batch drawn in between; this keeps the drawing order of overlapped widgets.
+    The geometry of a widget is rebuilt only when the widget is marked as dirty or its world transform has been changed.
+
+    \note Only widgets with triangle meshes are supported.
+*/
+
+UiBatcher::UiBatcher() :
+        m_BatchesCount(0),
+        m_Frame(0) {
+
+}
+
+UiBatcher::~UiBatcher() {
+    for(auto &it : m_Batches) {
+        delete it.mesh;
+    }
+}
+/*!
+    Draws the hierarchy of the \a root widget to the \a buffer for the provided \a layer.
+*/
+void UiBatcher::draw(ICommandBuffer &buffer, uint32_t layer, Widget *root) {
+    PROFILE_FUNCTION();
+
+    m_Frame++;
+
+    m_Widgets.clear();
+    collectWidgets(root);
+
+    vector<Batch> batches;
+    for(auto widget : m_Widgets) {
+        Item &item = m_Items[widget];
+        if(!updateItem(widget, item)) {
+            continue;
+        }
+
+        Batch *target = nullptr;
+        for(auto it = batches.rbegin(); it != batches.rend(); ++it) {
+            if(it->flags == item.flags && isCompatible(it->material, item.material)) {
+                target = &(*it);
+                break;
+            }
+            if(overlaps(it->rect, item.rect)) {
+                break;
+            }
+        }
+
+        if(target == nullptr) {
+            Batch batch;
+            batch.rect = item.rect;
+            batch.mesh = nullptr;
+            batch.material = item.material;
+            batch.flags = item.flags;
+            batches.push_back(batch);
+            target = &batches.back();
+        }
+        target->items.push_back(&item);
+        unite(target->rect, item.rect);
+    }
+
+    for(auto it = m_Items.begin(); it != m_Items.end(); ) {
+        if(it->second.frame != m_Frame) {
+            it = m_Items.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if(m_Batches.size() < batches.size()) {
+        m_Batches.resize(batches.size());
+    }
+
+    m_BatchesCount = batches.size();
+    for(uint32_t i = 0; i < m_BatchesCount; i++) {
+        Batch &current = m_Batches[i];
+        Batch &batch = batches[i];
+
+        bool changed = (current.mesh == nullptr || current.items != batch.items);
+        if(!changed) {
+            for(auto item : batch.items) {
+                if(item->rebuilt) {
+                    changed = true;
+                    break;
+                }
+            }
+        }
+
+        batch.mesh = current.mesh;
+        current = batch;
+        if(changed) {
+            composeBatch(current);
+        }
+
+        buffer.drawMesh(Matrix4(), current.mesh, layer, current.material);
+    }
+}
+/*!
+    Returns the number of batches which were submitted during the last draw() call.
+*/
+uint32_t UiBatcher::batchesCount() const {
+    return m_BatchesCount;
+}
+/*!
+    Returns true if \a left and \a right material instances can be drawn with one draw call; otherwise returns false.
+    Instances are compatible if they share the same material, surface type, textures and parameter values.
+*/
+bool UiBatcher::isCompatible(MaterialInstance *left, MaterialInstance *right) {
+    if(left == right) {
+        return true;
+    }
+    if(left == nullptr || right == nullptr) {
+        return false;
+    }
+    if(left->material() != right->material() || left->surfaceType() != right->surfaceType()) {
+        return false;
+    }
+
+    MaterialInstance::InfoMap &l = left->params();
+    MaterialInstance::InfoMap &r = right->params();
+    if(l.size() != r.size()) {
+        return false;
+    }
+    for(auto &it : l) {
+        auto other = r.find(it.first);
+        if(other == r.end()) {
+            return false;
+        }
+        const MaterialInstance::Info &a = it.second;
+        const MaterialInstance::Info &b = other->second;
+        if(a.type != b.type || a.count != b.count) {
+            return false;
+        }
+        if(a.ptr != b.ptr) {
+            uint32_t size = paramSize(a.type) * a.count;
+            // Textures and unknown types can be compared by the pointers only
+            if(size == 0 || a.ptr == nullptr || b.ptr == nullptr || memcmp(a.ptr, b.ptr, size) != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void UiBatcher::collectWidgets(Widget *widget) {
+    Actor *actor = widget->actor();
+    if(actor == nullptr) {
+        return;
+    }
+    for(auto it : actor->getChildren()) {
+        Widget *w = dynamic_cast<Widget *>(it);
+        if(w && w->isEnabled()) {
+            m_Widgets.push_back(w);
+        }
+    }
+    for(auto it : actor->getChildren()) {
+        Actor *child = dynamic_cast<Actor *>(it);
+        if(child && child->isEnabled()) {
+            Widget *w = static_cast<Widget *>(child->component("Widget"));
+            if(w) {
+                collectWidgets(w);
+            }
+        }
+    }
+}
+
+bool UiBatcher::updateItem(Widget *widget, Item &item) {
+    item.rebuilt = false;
+    item.material = widget->materialInstance();
+
+    Mesh *mesh = widget->mesh();
+    if(mesh == nullptr || item.material == nullptr || mesh->mode() != Mesh::Triangles) {
+        return false;
+    }
+    Lod *lod = mesh->lod(0);
+    if(lod == nullptr || lod->vertices().empty() || lod->indices().empty()) {
+        return false;
+    }
+
+    const Matrix4 &world = widget->actor()->transform()->worldTransform();
+    if(widget->isDirty() || item.frame == 0 || item.transform != world) {
+        Vector3Vector &vertices = lod->vertices();
+        uint32_t count = vertices.size();
+
+        item.vertices.resize(count);
+        item.rect = Vector4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for(uint32_t i = 0; i < count; i++) {
+            Vector3 v = world * vertices[i];
+            item.vertices[i] = v;
+            unite(item.rect, Vector4(v.x, v.y, v.x, v.y));
+        }
+
+        item.uv0 = lod->uv0();
+        item.uv0.resize(count);
+        item.indices = lod->indices();
+
+        item.transform = world;
+        item.flags = mesh->flags();
+        item.rebuilt = true;
+
+        widget->setDirty(false);
+    }
+    item.frame = m_Frame;
+
+    return true;
+}
+
+void UiBatcher::composeBatch(Batch &batch) {
+    if(batch.mesh == nullptr) {
+        batch.mesh = Engine::objectCreate<Mesh>();
+        batch.mesh->makeDynamic();
+    }
+    batch.mesh->setFlags(batch.flags);
+
+    uint32_t vertices = 0;
+    uint32_t indices = 0;
+    for(auto item : batch.items) {
+        vertices += item->vertices.size();
+        indices += item->indices.size();
+    }
+
+    Lod lod;
+    lod.vertices().reserve(vertices);
+    lod.uv0().reserve(vertices);
+    lod.indices().reserve(indices);
+
+    for(auto item : batch.items) {
+        uint32_t offset = lod.vertices().size();
+        lod.vertices().insert(lod.vertices().end(), item->vertices.begin(), item->vertices.end());
+        lod.uv0().insert(lod.uv0().end(), item->uv0.begin(), item->uv0.end());
+        for(auto index : item->indices) {
+            lod.indices().push_back(index + offset);
+        }
+    }
+
+    batch.mesh->setLod(0, &lod);
+}
@@ -0,0 +1,145 @@
+#include "tst_common.h"
+
+#include "components/recttransform.h"
+#include "components/widget.h"
+
+#include <components/actor.h>
+
+#include <systems/rendersystem.h>
+
+class BoundWidget : public Widget {
+public:
+    BoundWidget() :
+            m_Changes(0) {
+
+    }
+
+    void boundChanged() override {
+        m_Changes++;
+    }
+
+    int32_t m_Changes;
+
+};
+
+class RectTransformTest : public QObject {
+    Q_OBJECT
+
+    RectTransform *createRect(Actor *parent, const Vector2 &size, const Vector2 &minAnchors, const Vector2 &maxAnchors) {
+        Actor *actor = Engine::objectCreate<Actor>("Rect", parent);
+        RectTransform *rect = static_cast<RectTransform *>(actor->addComponent("RectTransform"));
+        rect->setSize(size);
+        rect->setMinAnchors(minAnchors);
+        rect->setMaxAnchors(maxAnchors);
+        return rect;
+    }
+
+private slots:
+
+void Anchors_layout() {
+    Engine system(nullptr, "");
+    RenderSystem render;
+    render.registerClasses();
+    RectTransform::registerClassFactory(&render);
+
+    Actor *root = Engine::objectCreate<Actor>("Root");
+    RectTransform *parent = static_cast<RectTransform *>(root->addComponent("RectTransform"));
+    parent->setSize(Vector2(100.0f));
+
+    RectTransform *stretched = createRect(root, Vector2(10.0f), Vector2(0.0f), Vector2(1.0f));
+    RectTransform *pinned = createRect(root, Vector2(10.0f), Vector2(1.0f), Vector2(1.0f));
+    parent->layout();
+
+    parent->setSize(Vector2(200.0f, 150.0f));
+    parent->layout();
+
+    QCOMPARE(stretched->size(), Vector2(110.0f, 60.0f));
+    QCOMPARE(stretched->position(), Vector3(0.0f));
+
+    QCOMPARE(pinned->size(), Vector2(10.0f));
+    QCOMPARE(pinned->position(), Vector3(100.0f, 50.0f, 0.0f));
+
+    // Changed anchors are applied to the next resize of the parent
+    stretched->setMinAnchors(Vector2(0.5f, 0.0f));
+    parent->setSize(Vector2(300.0f, 150.0f));
+    parent->layout();
+
+    QCOMPARE(stretched->size(), Vector2(160.0f, 60.0f));
+    QCOMPARE(stretched->position(), Vector3(50.0f, 0.0f, 0.0f));
+}
+
+void Anchors_dirty() {
+    Engine system(nullptr, "");
+    RenderSystem render;
+    render.registerClasses();
+    RectTransform::registerClassFactory(&render);
+
+    Actor *root = Engine::objectCreate<Actor>("Root");
+    RectTransform *parent = static_cast<RectTransform *>(root->addComponent("RectTransform"));
+    parent->setSize(Vector2(100.0f));
+
+    RectTransform *child = createRect(root, Vector2(10.0f), Vector2(0.0f), Vector2(1.0f));
+    parent->layout();
+
+    BoundWidget widget;
+    child->subscribe(&widget);
+
+    // The same anchors don't invalidate anything
+    child->setMinAnchors(Vector2(0.0f));
+    child->setMaxAnchors(Vector2(1.0f));
+    parent->layout();
+    QCOMPARE(widget.m_Changes, 0);
+
+    child->setMaxAnchors(Vector2(0.5f));
+    parent->layout();
+    QCOMPARE(widget.m_Changes, 1);
+
+    child->setMinAnchors(Vector2(0.5f));
+    parent->layout();
+    QCOMPARE(widget.m_Changes, 2);
+
+    child->unsubscribe(&widget);
+}
+
+void Hit_disabled() {
+    Engine system(nullptr, "");
+    RenderSystem render;
+    render.registerClasses();
+    RectTransform::registerClassFactory(&render);
+
+    Actor *root = Engine::objectCreate<Actor>("Root");
+    RectTransform *parent = static_cast<RectTransform *>(root->addComponent("RectTransform"));
+    parent->setSize(Vector2(100.0f));
+
+    RectTransform *button = createRect(root, Vector2(40.0f), Vector2(0.0f), Vector2(0.0f));
+    button->setPosition(Vector3(10.0f, 10.0f, 0.0f));
+
+    // The panel covers the button and has a child of its own
+    RectTransform *panel = createRect(root, Vector2(100.0f), Vector2(0.0f), Vector2(0.0f));
+    RectTransform *label = createRect(panel->actor(), Vector2(10.0f), Vector2(0.0f), Vector2(0.0f));
+    label->setPosition(Vector3(70.0f, 70.0f, 0.0f));
+
+    QCOMPARE(parent->hitTest(20.0f, 20.0f), panel);
+    QCOMPARE(parent->hitTest(75.0f, 75.0f), label);
+
+    // The grid was built before the panel has been hidden
+    panel->actor()->setEnabled(false);
+    QCOMPARE(parent->hitTest(20.0f, 20.0f), button);
+    QCOMPARE(parent->hitTest(75.0f, 75.0f), parent);
+
+    panel->actor()->setEnabled(true);
+    QCOMPARE(parent->hitTest(20.0f, 20.0f), panel);
+    QCOMPARE(parent->hitTest(75.0f, 75.0f), label);
+
+    // Changes inside of the subtree which was hidden during the build still reach the root
+    panel->actor()->setEnabled(false);
+    QCOMPARE(parent->hitTest(20.0f, 20.0f), button);
+    label->setPosition(Vector3(20.0f, 20.0f, 0.0f));
+    label->setSize(Vector2(20.0f));
+    panel->actor()->setEnabled(true);
+    QCOMPARE(parent->hitTest(25.0f, 25.0f), label);
+}
+
+} REGISTER(RectTransformTest)
+
+#include "tst_recttransform.moc"
@@ -0,0 +1,124 @@
+#include "tst_common.h"
+
+#include "uibatcher.h"
+
+#include "components/widget.h"
+
+#include <components/actor.h>
+#include <components/transform.h>
+
+#include <resources/mesh.h>
+#include <resources/material.h>
+
+#include <systems/rendersystem.h>
+
+#include <commandbuffer.h>
+
+#define WIDGETS 32
+
+class QuadWidget : public Widget {
+public:
+    A_REGISTER(QuadWidget, Widget, Components/UI);
+
+    A_NOPROPERTIES()
+    A_NOMETHODS()
+
+    QuadWidget() :
+            m_pMesh(nullptr),
+            m_pInstance(nullptr) {
+
+    }
+
+    Mesh *mesh() const override {
+        return m_pMesh;
+    }
+
+    MaterialInstance *materialInstance() const override {
+        return m_pInstance;
+    }
+
+    Mesh *m_pMesh;
+
+    MaterialInstance *m_pInstance;
+
+};
+
+class UiBatcherTest : public QObject {
+    Q_OBJECT
+
+    Mesh *createQuad() {
+        Lod lod;
+        lod.setVertices({Vector3(0.0f), Vector3(1.0f, 0.0f, 0.0f), Vector3(1.0f, 1.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f)});
+        lod.setIndices({0, 1, 2, 0, 2, 3});
+
+        Mesh *mesh = Engine::objectCreate<Mesh>("Quad");
+        mesh->addLod(&lod);
+        return mesh;
+    }
+
+    QuadWidget *createWidget(Actor *parent, Mesh *mesh, MaterialInstance *instance, const Vector3 &position) {
+        Actor *actor = Engine::objectCreate<Actor>("Widget", parent);
+        actor->addComponent("Transform");
+        actor->transform()->setPosition(position);
+
+        QuadWidget *widget = static_cast<QuadWidget *>(actor->addComponent("QuadWidget"));
+        widget->m_pMesh = mesh;
+        widget->m_pInstance = instance;
+        return widget;
+    }
+
+private slots:
+
+void Draw_calls() {
+    Engine system(nullptr, "");
+    RenderSystem render;
+    render.registerClasses();
+    Widget::registerClassFactory(&render);
+    QuadWidget::registerClassFactory(&render);
+
+    Mesh *quad = createQuad();
+    Material *material = Engine::objectCreate<Material>("Material");
+    MaterialInstance *first = material->createInstance();
+    MaterialInstance *second = material->createInstance();
+
+    Actor *root = Engine::objectCreate<Actor>("Root");
+    root->addComponent("Transform");
+    Widget *widget = static_cast<Widget *>(root->addComponent("Widget"));
+
+    // Compatible widgets in a row, each one is a separate draw call without batching
+    vector<QuadWidget *> widgets;
+    for(int32_t i = 0; i < WIDGETS; i++) {
+        widgets.push_back(createWidget(root, quad, (i % 2) ? first : second, Vector3(i * 2.0f, 0.0f, 0.0f)));
+    }
+
+    UiBatcher batcher;
+    ICommandBuffer buffer;
+    batcher.draw(buffer, ICommandBuffer::UI, widget);
+
+    QCOMPARE(buffer.drawCalls(), static_cast<uint32_t>(1));
+    QCOMPARE(buffer.polygons(), static_cast<uint32_t>(WIDGETS * 2));
+    QCOMPARE(batcher.batchesCount(), static_cast<uint32_t>(1));
+
+    // Incompatible overlapped widgets keep the drawing order
+    Material *other = Engine::objectCreate<Material>("Other");
+    MaterialInstance *third = other->createInstance();
+    createWidget(root, quad, third, Vector3(0.5f, 0.5f, 0.0f));
+    createWidget(root, quad, first, Vector3(0.0f, 0.0f, 0.0f));
+
+    buffer.resetStatistics();
+    batcher.draw(buffer, ICommandBuffer::UI, widget);
+    QCOMPARE(buffer.drawCalls(), static_cast<uint32_t>(3));
+
+    // Disabled widgets are skipped
+    for(auto it : widgets) {
+        it->setEnabled(false);
+    }
+    buffer.resetStatistics();
+    batcher.draw(buffer, ICommandBuffer::UI, widget);
+    QCOMPARE(buffer.drawCalls(), static_cast<uint32_t>(2));
+    QCOMPARE(buffer.polygons(), static_cast<uint32_t>(4));
+}
+
+} REGISTER(UiBatcherTest)
+
+#include "tst_uibatcher.moc"
@@ -22,6 +22,8 @@ public:
 
     void update(Scene *) override;
 
+    void fixedUpdate(Scene *) override;
+
     int threadPolicy() const override;
 
 protected:
@@ -35,6 +35,8 @@ public:
 protected:
     virtual void createCollider();
 
+    virtual void interpolate(float factor);
+
     void dirtyContacts();
 
     void cleanContacts();
@@ -52,6 +52,10 @@ protected:
 
     void createCollider() override;
 
+    void interpolate(float factor) override;
+
+    void applyTransform(const Vector3 &position, const Quaternion &rotation);
+
 protected:
     float m_Mass;
 
@@ -61,6 +65,14 @@ protected:
     int32_t m_LockRotation;
 
     bool m_Kinematic;
+
+    bool m_Sleeping;
+
+    Vector3 m_Position;
+    Vector3 m_PrevPosition;
+
+    Quaternion m_Rotation;
+    Quaternion m_PrevRotation;
 };
 
 #endif // RIGIDBODY_H
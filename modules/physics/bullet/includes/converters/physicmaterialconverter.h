@@ -14,6 +14,7 @@ class PhysicMaterialConverter : public IConverter {
 private:
     QStringList suffixes() const Q_DECL_OVERRIDE { return {"fix"}; }
     uint8_t convertFile(IConverterSettings *settings) Q_DECL_OVERRIDE;
+    bool isThreadSafe(IConverterSettings *) const Q_DECL_OVERRIDE { return true; }
     IConverterSettings *createSettings() const Q_DECL_OVERRIDE;
 
     QString templatePath() const Q_DECL_OVERRIDE { return ":/Templates/Physical_Material.fix"; }
@@ -85,6 +85,20 @@ const char *BulletSystem::name() const {
 void BulletSystem::update(Scene *scene) {
     PROFILE_FUNCTION();
 
+    if(Engine::isGameMode()) {
+        float factor = Timer::interpolation();
+        for(auto &it : m_ObjectList) {
+            Collider *body = static_cast<Collider *>(it);
+            if(body->world() && body->actor()->scene() == scene) {
+                body->interpolate(factor);
+            }
+        }
+    }
+}
+
+void BulletSystem::fixedUpdate(Scene *scene) {
+    PROFILE_FUNCTION();
+
     if(Engine::isGameMode()) {
         btDynamicsWorld *world = nullptr;
         auto it = m_Worlds.find(scene->uuid());
@@ -123,7 +137,8 @@ void BulletSystem::update(Scene *scene) {
             body->cleanContacts();
         }
 
-        world->stepSimulation(Timer::deltaTime(), 4);
+        float step = Timer::fixedTimeStep();
+        world->stepSimulation(step, 0, step);
     }
 }
 
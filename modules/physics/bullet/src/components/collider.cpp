@@ -39,6 +39,10 @@ void Collider::createCollider() {
 
 }
 
+void Collider::interpolate(float factor) {
+    A_UNUSED(factor);
+}
+
 void Collider::destroyShape() {
     delete m_pCollisionShape;
     m_pCollisionShape = nullptr;
@@ -13,7 +13,8 @@ RigidBody::RigidBody() :
         m_Mass(1.0f),
         m_LockPosition(0),
         m_LockRotation(0),
-        m_Kinematic(false) {
+        m_Kinematic(false),
+        m_Sleeping(false) {
 
     m_pCollisionShape = new btCompoundShape;
 }
@@ -25,6 +26,10 @@ RigidBody::~RigidBody() {
 }
 
 void RigidBody::update() {
+    // Store the previous simulation state for the interpolation
+    m_PrevPosition = m_Position;
+    m_PrevRotation = m_Rotation;
+
     for(auto it : m_Colliders) {
         if(it->isDirty()) {
             btCompoundShape *compound = static_cast<btCompoundShape *>(m_pCollisionShape);
@@ -53,6 +58,9 @@ void RigidBody::update() {
         Quaternion &q = t->worldQuaternion();
         Vector3 &p = t->worldPosition();
 
+        m_Position = p;
+        m_Rotation = q;
+
         static_cast<btRigidBody *>(m_pCollisionObject)->setWorldTransform(btTransform(btQuaternion(q.x, q.y, q.z, q.w),
                                                                                       btVector3(p.x, p.y, p.z)));
     }
@@ -132,21 +140,41 @@ void RigidBody::getWorldTransform(btTransform &worldTrans) const {
 }
 
 void RigidBody::setWorldTransform(const btTransform &worldTrans) {
+    // The Transform will be updated in interpolate() call
+    btQuaternion q = worldTrans.getRotation();
+    m_Rotation.x = q.getX();
+    m_Rotation.y = q.getY();
+    m_Rotation.z = q.getZ();
+    m_Rotation.w = q.getW();
+
+    btVector3 p = worldTrans.getOrigin();
+    m_Position = Vector3(p.x(), p.y(), p.z());
+}
+
+void RigidBody::interpolate(float factor) {
+    if(m_pCollisionObject && !m_Kinematic) {
+        if(m_pCollisionObject->isActive()) {
+            m_Sleeping = false;
+
+            Quaternion rotation;
+            rotation.mix(m_PrevRotation, m_Rotation, factor);
+
+            applyTransform(m_PrevPosition + (m_Position - m_PrevPosition) * factor, rotation);
+        } else if(!m_Sleeping) {
+            // The last interpolated pose lags behind the simulation, snap to it once the body falls asleep
+            m_Sleeping = true;
+
+            applyTransform(m_Position, m_Rotation);
+        }
+    }
+}
+
+void RigidBody::applyTransform(const Vector3 &position, const Quaternion &rotation) {
     Actor *a = actor();
     if(a) {
         Transform *t = a->transform();
-        btQuaternion q = worldTrans.getRotation();
 
-        Quaternion rot;
-        rot.x = q.getX();
-        rot.y = q.getY();
-        rot.z = q.getZ();
-        rot.w = q.getW();
-
-        t->setQuaternion(rot);
-
-        btVector3 p = worldTrans.getOrigin();
-        Vector3 position(p.x(), p.y(), p.z());
+        t->setQuaternion(rotation);
 
         Transform *parent = t->parentTransform();
         if(parent) {
@@ -179,6 +207,10 @@ void RigidBody::createCollider() {
         }
     }
 
+    Transform *t = actor()->transform();
+    m_Position = m_PrevPosition = t->worldPosition();
+    m_Rotation = m_PrevRotation = t->worldQuaternion();
+
     btRigidBody *body = new btRigidBody(m_Mass, this, m_pCollisionShape);
     m_pCollisionObject = body;
 
@@ -17,6 +17,8 @@
 
 #define INSTANCE_ATRIB  8
 
+#define GLOBAL_BIND     0
+
 class CommandBufferGL : public ICommandBuffer {
     A_OVERRIDE(CommandBufferGL, ICommandBuffer, System)
 
@@ -57,10 +59,38 @@ public:
 
     Texture *texture(const char *name) const override;
 
+    static void resetState();
+
+    static void releaseProgram(uint32_t program);
+
+    static bool isDrawOnly();
+    static void setDrawOnly(bool flag);
+
+    static void setFrameInFlight(bool flag);
+    static void waitForFrame();
+
 protected:
     void putUniforms(uint32_t program, MaterialInstance *instance);
 
+    void bindGlobals();
+
+    void updateVersion();
+
 protected:
+    // Per frame values shared by all shaders, the layout matches the std140 Camera block
+    struct Global {
+        Matrix4 view;
+        Matrix4 projection;
+        Matrix4 projectionInv;
+        Matrix4 screenToWorld;
+        Matrix4 worldToScreen;
+        Vector4 position;
+        Vector4 target;
+        Vector4 screen;
+    };
+
+    Global m_Global;
+
     Matrix4 m_View;
 
     Matrix4 m_Projection;
@@ -76,6 +106,12 @@ protected:
     Matrix4 m_SaveView;
 
     Matrix4 m_SaveProjection;
+
+    uint32_t m_GlobalBuffer;
+
+    uint32_t m_Version;
+
+    bool m_GlobalDirty;
 };
 
 #endif // COMMANDBUFFERGL_H
@@ -6,6 +6,7 @@
 #include <systems/rendersystem.h>
 
 class Engine;
+class Resource;
 
 class RenderGLSystem : public RenderSystem {
 public:
@@ -26,9 +27,16 @@ public:
     QWindow *createRhiWindow() const override;
 #endif
 
+protected:
+    void upload(ICommandBuffer &buffer, const CommandList &commands) override;
+
+    void submit(ICommandBuffer &buffer, const CommandList &commands) override;
+
 private:
     Engine *m_pEngine;
 
+    vector<Resource *> m_Resources;
+
     bool m_registered;
 
 };
@@ -28,16 +28,41 @@ class MaterialGL : public Material {
 
     typedef unordered_map<uint32_t, uint32_t> ObjectMap;
 
+    struct BindState {
+        TextureMap textures;
+
+        int32_t blend;
+
+        int32_t type;
+
+        bool depthTest;
+
+        bool depthWrite;
+
+        bool doubleSided;
+    };
+
 public:
+    MaterialGL();
+    ~MaterialGL();
+
     void loadUserData(const VariantMap &data) override;
 
+    void update();
+
+    void prepare();
+
     uint32_t bind(uint32_t layer, uint16_t vertex);
 
     uint32_t getProgram(uint16_t type);
 
     TextureMap textures() const { return m_Textures; }
 
+    const TextureMap &boundTextures() const;
+
 protected:
+    void captureState();
+
     uint32_t buildShader(uint16_t type, const string &src = string());
 
     uint32_t buildProgram(uint32_t vertex, uint32_t fragment);
@@ -51,6 +76,8 @@ private:
 
     map<uint16_t, string> m_ShaderSources;
 
+    BindState m_Bound;
+
 };
 
 #endif // MATERIALGL_H
@@ -25,11 +25,19 @@ public:
 
 public:
     MeshGL();
+    ~MeshGL();
 
-    void bindVao(CommandBufferGL *buffer, uint32_t lod);
+    bool update(CommandBufferGL *buffer);
+
+    bool bindVao(CommandBufferGL *buffer, uint32_t lod);
 
     uint32_t instance() const;
 
+    int32_t drawMode() const;
+
+    uint32_t vertexCount(uint32_t lod) const;
+    uint32_t indexCount(uint32_t lod) const;
+
 protected:
     void updateVao(uint32_t lod);
     void updateVbo(CommandBufferGL *buffer);
@@ -52,6 +60,13 @@ public:
 
     uint32_t m_InstanceBuffer;
 
+    IndexVector m_VertexCounts;
+    IndexVector m_IndexCounts;
+
+    int32_t m_Mode;
+
+    uint8_t m_Flags;
+
     typedef vector<list<VaoStruct *>> VaoVector;
 
     VaoVector m_Vao;
@@ -12,6 +12,9 @@ class RenderTargetGL : public RenderTarget {
 
 public:
     RenderTargetGL();
+    ~RenderTargetGL();
+
+    void update(uint32_t level);
 
     void bindBuffer(uint32_t level);
 
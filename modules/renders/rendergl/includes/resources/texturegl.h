@@ -13,20 +13,28 @@ class TextureGL : public Texture {
 
 public:
     TextureGL();
+    ~TextureGL();
 
     uint32_t nativeHandle();
 
+    uint32_t target() const;
+
 private:
     void readPixels(int x, int y, int width, int height) override;
 
     void updateTexture();
+    bool updateRegion(int32_t x, int32_t y, int32_t width, int32_t height);
     void destroyTexture();
 
+    void formats(uint32_t &internal, uint32_t &glformat, uint32_t &type);
+
     bool uploadTexture(const Sides *sides, uint32_t imageIndex, uint32_t target, uint32_t internal, uint32_t format, uint32_t type);
     bool uploadTextureCubemap(const Sides *sides, uint32_t target, uint32_t internal, uint32_t format, uint32_t type);
 
     uint32_t m_ID;
 
+    uint32_t m_Target;
+
 };
 
 #endif // TEXTUREGL_H
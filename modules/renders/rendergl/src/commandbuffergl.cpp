@@ -10,6 +10,11 @@
 #include <log.h>
 #include <timer.h>
 
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <condition_variable>
+
 #define MODEL_UNIFORM   0
 #define VIEW_UNIFORM    1
 #define PROJ_UNIFORM    2
@@ -18,13 +23,77 @@
 #define CLIP_BIND   4
 #define TIMER_BIND  5
 
-CommandBufferGL::CommandBufferGL() {
+#define MAX_TEXTURE_UNITS 32
+
+namespace {
+    struct ProgramState {
+        ProgramState() :
+                version(0),
+                time(-1.0f),
+                color(-1.0f) {
+
+        }
+
+        unordered_map<string, int32_t> locations;
+
+        uint32_t version;
+
+        float time;
+
+        Vector4 color;
+    };
+
+    struct GlobalField {
+        const char *name;
+        size_t offset;
+        size_t size;
+    };
+
+    // The GL state is shared by all command buffers in the context
+    unordered_map<uint32_t, ProgramState> s_Programs;
+
+    uint32_t s_Program = 0;
+    uint32_t s_ActiveUnit = 0;
+    uint32_t s_Textures[MAX_TEXTURE_UNITS];
+    uint32_t s_GlobalBuffer = 0;
+
+    uint32_t s_Version = 0;
+
+    // Snapshot is drawn with the data uploaded at the sync point, the resources are not updated
+    bool s_DrawOnly = false;
+
+    // Resources can't be destroyed while the render thread is using them
+    mutex s_FrameMutex;
+    condition_variable s_FrameCondition;
+    bool s_FrameInFlight = false;
+
+    int32_t location(ProgramState &state, uint32_t program, const string &name) {
+        auto it = state.locations.find(name);
+        if(it != state.locations.end()) {
+            return it->second;
+        }
+        int32_t result = glGetUniformLocation(program, name.c_str());
+        state.locations[name] = result;
+        return result;
+    }
+}
+
+CommandBufferGL::CommandBufferGL() :
+        m_GlobalBuffer(0),
+        m_Version(++s_Version),
+        m_GlobalDirty(true) {
     PROFILE_FUNCTION();
 
+    resetState();
 }
 
 CommandBufferGL::~CommandBufferGL() {
-
+    if(m_GlobalBuffer) {
+        if(s_GlobalBuffer == m_GlobalBuffer) {
+            s_GlobalBuffer = 0;
+        }
+        glDeleteBuffers(1, &m_GlobalBuffer);
+    }
 }
 
 void CommandBufferGL::clearRenderTarget(bool clearColor, const Vector4 &color, bool clearDepth, float depth) {
@@ -44,41 +113,59 @@ void CommandBufferGL::clearRenderTarget(bool clearColor, const Vector4 &color, b
 }
 
 void CommandBufferGL::putUniforms(uint32_t program, MaterialInstance *instance) {
-    int32_t location;
-
-    glUniformMatrix4fv(VIEW_UNIFORM, 1, GL_FALSE, m_View.mat);
-    glUniformMatrix4fv(PROJ_UNIFORM, 1, GL_FALSE, m_Projection.mat);
-
-    glUniform1f   (TIMER_BIND, Timer::time());
-    glUniform1f   (CLIP_BIND,  0.99f);
-    glUniform4fv  (COLOR_BIND, 1, m_Color.v);
-
-    // Push uniform values to shader
-    for(const auto &it : m_Uniforms) {
-        location = glGetUniformLocation(program, it.first.c_str());
-        if(location > -1) {
-            const Variant &data = it.second;
-            switch(data.type()) {
-                case MetaType::VECTOR2: glUniform2fv      (location, 1, data.toVector2().v); break;
-                case MetaType::VECTOR3: glUniform3fv      (location, 1, data.toVector3().v); break;
-                case MetaType::VECTOR4: glUniform4fv      (location, 1, data.toVector4().v); break;
-                case MetaType::MATRIX4: glUniformMatrix4fv(location, 1, GL_FALSE, data.toMatrix4().mat); break;
-                default:                glUniform1f       (location, data.toFloat()); break;
+    if(s_Program != program) {
+        glUseProgram(program);
+        s_Program = program;
+    }
+
+    bindGlobals();
+
+    ProgramState &state = s_Programs[program];
+
+    // Global values are pushed only when they were changed since the last draw with this program
+    if(state.version != m_Version) {
+        glUniformMatrix4fv(VIEW_UNIFORM, 1, GL_FALSE, m_View.mat);
+        glUniformMatrix4fv(PROJ_UNIFORM, 1, GL_FALSE, m_Projection.mat);
+
+        glUniform1f   (CLIP_BIND,  0.99f);
+
+        for(const auto &it : m_Uniforms) {
+            int32_t index = location(state, program, it.first);
+            if(index > -1) {
+                const Variant &data = it.second;
+                switch(data.type()) {
+                    case MetaType::VECTOR2: glUniform2fv      (index, 1, data.toVector2().v); break;
+                    case MetaType::VECTOR3: glUniform3fv      (index, 1, data.toVector3().v); break;
+                    case MetaType::VECTOR4: glUniform4fv      (index, 1, data.toVector4().v); break;
+                    case MetaType::MATRIX4: glUniformMatrix4fv(index, 1, GL_FALSE, data.toMatrix4().mat); break;
+                    default:                glUniform1f       (index, data.toFloat()); break;
+                }
             }
         }
+        state.version = m_Version;
+    }
+
+    float time = Timer::time();
+    if(state.time != time) {
+        glUniform1f(TIMER_BIND, time);
+        state.time = time;
+    }
+    if(state.color != m_Color) {
+        glUniform4fv(COLOR_BIND, 1, m_Color.v);
+        state.color = m_Color;
     }
 
     for(const auto &it : instance->params()) {
-        location = glGetUniformLocation(program, it.first.c_str());
-        if(location > -1) {
+        int32_t index = location(state, program, it.first);
+        if(index > -1) {
             const MaterialInstance::Info &data = it.second;
             switch(data.type) {
-                case MetaType::INTEGER: glUniform1iv      (location, data.count, static_cast<const int32_t *>(data.ptr)); break;
-                case MetaType::FLOAT:   glUniform1fv      (location, data.count, static_cast<const float *>(data.ptr)); break;
-                case MetaType::VECTOR2: glUniform2fv      (location, data.count, static_cast<const float *>(data.ptr)); break;
-                case MetaType::VECTOR3: glUniform3fv      (location, data.count, static_cast<const float *>(data.ptr)); break;
-                case MetaType::VECTOR4: glUniform4fv      (location, data.count, static_cast<const float *>(data.ptr)); break;
-                case MetaType::MATRIX4: glUniformMatrix4fv(location, data.count, GL_FALSE, static_cast<const float *>(data.ptr)); break;
+                case MetaType::INTEGER: glUniform1iv      (index, data.count, static_cast<const int32_t *>(data.ptr)); break;
+                case MetaType::FLOAT:   glUniform1fv      (index, data.count, static_cast<const float *>(data.ptr)); break;
+                case MetaType::VECTOR2: glUniform2fv      (index, data.count, static_cast<const float *>(data.ptr)); break;
+                case MetaType::VECTOR3: glUniform3fv      (index, data.count, static_cast<const float *>(data.ptr)); break;
+                case MetaType::VECTOR4: glUniform4fv      (index, data.count, static_cast<const float *>(data.ptr)); break;
+                case MetaType::MATRIX4: glUniformMatrix4fv(index, data.count, GL_FALSE, static_cast<const float *>(data.ptr)); break;
                 default: break;
             }
         }
@@ -87,7 +174,7 @@ void CommandBufferGL::putUniforms(uint32_t program, MaterialInstance *instance)
     MaterialGL *mat = static_cast<MaterialGL *>(instance->material());
 
     uint8_t i = 0;
-    for(auto &it : mat->textures()) {
+    for(auto &it : mat->boundTextures()) {
         Texture *tex = it.second;
         Texture *tmp = instance->texture(it.first.c_str());
         if(tmp) {
@@ -100,42 +187,96 @@ void CommandBufferGL::putUniforms(uint32_t program, MaterialInstance *instance)
         }
 
         if(tex) {
-            glActiveTexture(GL_TEXTURE0 + i);
-            uint32_t texture = GL_TEXTURE_2D;
-            if(tex->isCubemap()) {
-                texture = GL_TEXTURE_CUBE_MAP;
+            TextureGL *t = static_cast<TextureGL *>(tex);
+            uint32_t handle = t->nativeHandle();
+            if(i >= MAX_TEXTURE_UNITS || s_Textures[i] != handle) {
+                if(s_ActiveUnit != i) {
+                    glActiveTexture(GL_TEXTURE0 + i);
+                    s_ActiveUnit = i;
+                }
+                glBindTexture(t->target(), handle);
+                if(i < MAX_TEXTURE_UNITS) {
+                    s_Textures[i] = handle;
+                }
             }
-            glBindTexture(texture, static_cast<TextureGL *>(tex)->nativeHandle());
         }
         i++;
     }
 }
 
+void CommandBufferGL::bindGlobals() {
+    if(m_GlobalDirty) {
+        if(m_GlobalBuffer == 0) {
+            glGenBuffers(1, &m_GlobalBuffer);
+            glBindBuffer(GL_UNIFORM_BUFFER, m_GlobalBuffer);
+            glBufferData(GL_UNIFORM_BUFFER, sizeof(Global), &m_Global, GL_DYNAMIC_DRAW);
+        } else {
+            glBindBuffer(GL_UNIFORM_BUFFER, m_GlobalBuffer);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Global), &m_Global);
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        m_GlobalDirty = false;
+    }
+    if(s_GlobalBuffer != m_GlobalBuffer) {
+        glBindBufferBase(GL_UNIFORM_BUFFER, GLOBAL_BIND, m_GlobalBuffer);
+        s_GlobalBuffer = m_GlobalBuffer;
+    }
+}
+
+void CommandBufferGL::updateVersion() {
+    m_Version = ++s_Version;
+}
+void CommandBufferGL::resetState() {
+    s_Program = 0;
+    s_ActiveUnit = MAX_TEXTURE_UNITS;
+    memset(s_Textures, 0xFF, sizeof(s_Textures));
+    s_GlobalBuffer = 0;
+}
+void CommandBufferGL::releaseProgram(uint32_t program) {
+    s_Programs.erase(program);
+    if(s_Program == program) {
+        s_Program = 0;
+    }
+}
+
+bool CommandBufferGL::isDrawOnly() {
+    return s_DrawOnly;
+}
+void CommandBufferGL::setDrawOnly(bool flag) {
+    s_DrawOnly = flag;
+}
+
+void CommandBufferGL::setFrameInFlight(bool flag) {
+    unique_lock<mutex> locker(s_FrameMutex);
+    s_FrameInFlight = flag;
+    s_FrameCondition.notify_all();
+}
+void CommandBufferGL::waitForFrame() {
+    unique_lock<mutex> locker(s_FrameMutex);
+    s_FrameCondition.wait(locker, []() { return !s_FrameInFlight; });
+}
+
 void CommandBufferGL::drawMesh(const Matrix4 &model, Mesh *mesh, uint32_t layer, MaterialInstance *material) {
     PROFILE_FUNCTION();
 
     if(mesh && material) {
         MeshGL *m = static_cast<MeshGL *>(mesh);
         uint32_t lod = 0;
-        Lod *l = mesh->lod(lod);
-        if(l == nullptr) {
-            return;
-        }
 
         MaterialGL *mat = static_cast<MaterialGL *>(material->material());
         uint32_t program = mat->bind(layer, material->surfaceType());
         if(program) {
-            glUseProgram(program);
+            putUniforms(program, material);
 
             glUniformMatrix4fv(MODEL_UNIFORM, 1, GL_FALSE, model.mat);
 
-            putUniforms(program, material);
-
-            m->bindVao(this, lod);
+            if(!m->bindVao(this, lod)) {
+                return;
+            }
 
-            Mesh::TriangleModes mode = static_cast<Mesh::TriangleModes>(mesh->mode());
+            Mesh::TriangleModes mode = static_cast<Mesh::TriangleModes>(m->drawMode());
             if(mode > Mesh::Lines) {
-                uint32_t vert = l->vertices().size();
+                uint32_t vert = m->vertexCount(lod);
                 int32_t glMode = GL_TRIANGLE_STRIP;
                 switch(mode) {
                 case Mesh::LineStrip:   glMode = GL_LINE_STRIP; break;
@@ -144,12 +285,15 @@ void CommandBufferGL::drawMesh(const Matrix4 &model, Mesh *mesh, uint32_t layer,
                 }
                 glDrawArrays(glMode, 0, vert);
                 PROFILER_STAT(POLYGONS, vert - 2);
+                m_Polygons += vert - 2;
             } else {
-                uint32_t index = l->indices().size();
+                uint32_t index = m->indexCount(lod);
                 glDrawElements((mode == Mesh::Triangles) ? GL_TRIANGLES : GL_LINES, index, GL_UNSIGNED_INT, nullptr);
                 PROFILER_STAT(POLYGONS, index / 3);
+                m_Polygons += index / 3;
             }
             PROFILER_STAT(DRAWCALLS, 1);
+            m_DrawCalls++;
 
             glBindVertexArray(0);
         }
@@ -162,37 +306,53 @@ void CommandBufferGL::drawMeshInstanced(const Matrix4 *models, uint32_t count, M
     if(mesh && material) {
         MeshGL *m = static_cast<MeshGL *>(mesh);
         uint32_t lod = 0;
-        Lod *l = mesh->lod(lod);
-        if(l == nullptr) {
-            return;
-        }
 
         MaterialGL *mat = static_cast<MaterialGL *>(material->material());
-        uint32_t program = mat->bind(layer, material->surfaceType());
+        uint16_t type = material->surfaceType();
+        if(type == MaterialGL::Static) {
+            type = MaterialGL::Instanced;
+            // Picking and shadows use the simple fragment variant, same as MaterialGL::bind
+            uint16_t fragment = MaterialGL::Default;
+            if((layer & ICommandBuffer::RAYCAST) || (layer & ICommandBuffer::SHADOWCAST)) {
+                fragment = MaterialGL::Simple;
+            }
+            // Materials built without the instancing variant are drawn one by one
+            if(mat->getProgram(type * fragment) == 0) {
+                for(uint32_t i = 0; i < count; i++) {
+                    drawMesh(models[i], mesh, layer, material);
+                }
+                return;
+            }
+        }
+        uint32_t program = mat->bind(layer, type);
 
         if(program) {
-            glUseProgram(program);
+            putUniforms(program, material);
 
             glUniformMatrix4fv(MODEL_UNIFORM, 1, GL_FALSE, Matrix4().mat);
 
+            // The instance buffer is created with the mesh buffers
+            if(!m->bindVao(this, lod)) {
+                return;
+            }
+
             glBindBuffer(GL_ARRAY_BUFFER, m->instance());
             glBufferData(GL_ARRAY_BUFFER, count * sizeof(Matrix4), models, GL_DYNAMIC_DRAW);
 
-            putUniforms(program, material);
-
-            m->bindVao(this, lod);
-
-            Mesh::TriangleModes mode = static_cast<Mesh::TriangleModes>(mesh->mode());
+            Mesh::TriangleModes mode = static_cast<Mesh::TriangleModes>(m->drawMode());
             if(mode > Mesh::Lines) {
-                uint32_t vert = l->vertices().size();
+                uint32_t vert = m->vertexCount(lod);
                 glDrawArraysInstanced((mode == Mesh::TriangleStrip) ? GL_TRIANGLE_STRIP : GL_LINE_STRIP, 0, vert, count);
-                PROFILER_STAT(POLYGONS, index - 2 * count);
+                PROFILER_STAT(POLYGONS, (vert - 2) * count);
+                m_Polygons += (vert - 2) * count;
             } else {
-                uint32_t index = l->indices().size();
+                uint32_t index = m->indexCount(lod);
                 glDrawElementsInstanced((mode == Mesh::Triangles) ? GL_TRIANGLES : GL_LINES, index, GL_UNSIGNED_INT, nullptr, count);
                 PROFILER_STAT(POLYGONS, (index / 3) * count);
+                m_Polygons += (index / 3) * count;
             }
             PROFILER_STAT(DRAWCALLS, 1);
+            m_DrawCalls++;
 
             glBindVertexArray(0);
         }
@@ -227,6 +387,8 @@ void CommandBufferGL::setColor(const Vector4 &color) {
 void CommandBufferGL::resetViewProjection() {
     m_View = m_SaveView;
     m_Projection = m_SaveProjection;
+
+    updateVersion();
 }
 
 void CommandBufferGL::setViewProjection(const Matrix4 &view, const Matrix4 &projection) {
@@ -235,10 +397,40 @@ void CommandBufferGL::setViewProjection(const Matrix4 &view, const Matrix4 &proj
 
     m_View = view;
     m_Projection = projection;
+
+    updateVersion();
 }
 
 void CommandBufferGL::setGlobalValue(const char *name, const Variant &value) {
+    static const GlobalField fields[] = {
+        {"camera.view",          offsetof(Global, view),          sizeof(Matrix4)},
+        {"camera.projection",    offsetof(Global, projection),    sizeof(Matrix4)},
+        {"camera.projectionInv", offsetof(Global, projectionInv), sizeof(Matrix4)},
+        {"camera.screenToWorld", offsetof(Global, screenToWorld), sizeof(Matrix4)},
+        {"camera.worldToScreen", offsetof(Global, worldToScreen), sizeof(Matrix4)},
+        {"camera.position",      offsetof(Global, position),      sizeof(Vector4)},
+        {"camera.target",        offsetof(Global, target),        sizeof(Vector4)},
+        {"camera.screen",        offsetof(Global, screen),        sizeof(Vector4)}
+    };
+
+    for(auto &it : fields) {
+        if(strcmp(it.name, name) == 0) {
+            uint8_t *ptr = reinterpret_cast<uint8_t *>(&m_Global) + it.offset;
+            if(it.size == sizeof(Matrix4)) {
+                Matrix4 data = value.toMatrix4();
+                memcpy(ptr, data.mat, it.size);
+            } else {
+                Vector4 data = value.toVector4();
+                memcpy(ptr, data.v, it.size);
+            }
+            m_GlobalDirty = true;
+            break;
+        }
+    }
+    // Materials built before the Camera block are still supplied through the plain uniforms
     m_Uniforms[name] = value;
+
+    updateVersion();
 }
 
 void CommandBufferGL::setGlobalTexture(const char *name, Texture *value) {
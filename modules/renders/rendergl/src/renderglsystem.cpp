@@ -7,6 +7,10 @@
 
 #include <resources/pipeline.h>
 
+#include <commandlist.h>
+
+#include "resources/meshgl.h"
+#include "resources/materialgl.h"
 #include "resources/texturegl.h"
 #include "resources/rendertargetgl.h"
 
@@ -28,7 +32,7 @@ void _CheckGLError(const char* file, int line) {
             case GL_OUT_OF_MEMORY:      error="OUT_OF_MEMORY";          break;
             case GL_INVALID_FRAMEBUFFER_OPERATION:  error="GL_INVALID_FRAMEBUFFER_OPERATION";  break;
         }
-        Log(Log::DBG) << error.c_str() <<" - " << file << ":" << line;
+        A_LOG(Log::DBG) << error.c_str() <<" - " << file << ":" << line;
         err = glGetError();
     }
     return;
@@ -125,14 +129,74 @@ void RenderGLSystem::update(Scene *scene) {
 
     Camera *camera = Camera::current();
     if(camera && CommandBufferGL::isInited()) {
-        int32_t target;
-        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &target);
+        // The context is owned by the render thread in the pipelined mode
+        if(!isPipelined()) {
+            int32_t target;
+            glGetIntegerv(GL_FRAMEBUFFER_BINDING, &target);
+
+            // Somebody else could use the context between the frames
+            CommandBufferGL::resetState();
 
-        Pipeline *pipe = camera->pipeline();
-        pipe->setTarget(target);
+            Pipeline *pipe = camera->pipeline();
+            pipe->setTarget(target);
+        }
         RenderSystem::update(scene);
     }
 }
+/*!
+    Uploads the resources used by the frame snapshot while the main thread is waiting.
+*/
+void RenderGLSystem::upload(ICommandBuffer &buffer, const CommandList &commands) {
+    PROFILE_FUNCTION();
+
+    // Resources can't be destroyed until the snapshot is executed
+    CommandBufferGL::setFrameInFlight(true);
+
+    int32_t target;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &target);
+
+    CommandBufferGL::resetState();
+
+    CommandBufferGL *gl = static_cast<CommandBufferGL *>(&buffer);
+
+    commands.resources(m_Resources);
+    for(auto it : m_Resources) {
+        MeshGL *mesh = dynamic_cast<MeshGL *>(it);
+        if(mesh) {
+            mesh->update(gl);
+            continue;
+        }
+        MaterialGL *material = dynamic_cast<MaterialGL *>(it);
+        if(material) {
+            material->prepare();
+            continue;
+        }
+        TextureGL *texture = dynamic_cast<TextureGL *>(it);
+        if(texture) {
+            texture->nativeHandle();
+            continue;
+        }
+        RenderTargetGL *renderTarget = dynamic_cast<RenderTargetGL *>(it);
+        if(renderTarget) {
+            renderTarget->update(0);
+        }
+    }
+
+    // Render targets were bound by the update
+    glBindFramebuffer(GL_FRAMEBUFFER, target);
+}
+/*!
+    Executes the frame snapshot on the render thread.
+*/
+void RenderGLSystem::submit(ICommandBuffer &buffer, const CommandList &commands) {
+    CommandBufferGL::resetState();
+
+    CommandBufferGL::setDrawOnly(true);
+    RenderSystem::submit(buffer, commands);
+    CommandBufferGL::setDrawOnly(false);
+
+    CommandBufferGL::setFrameInFlight(false);
+}
 
 #if defined(NEXT_SHARED)
 #include "editor/rhiwrapper.h"
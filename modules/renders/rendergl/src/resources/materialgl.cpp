@@ -9,6 +9,14 @@
 #include <file.h>
 #include <log.h>
 
+MaterialGL::MaterialGL() {
+    captureState();
+}
+
+MaterialGL::~MaterialGL() {
+    CommandBufferGL::waitForFrame();
+}
+
 void MaterialGL::loadUserData(const VariantMap &data) {
     Material::loadUserData(data);
 
@@ -56,10 +64,11 @@ void MaterialGL::loadUserData(const VariantMap &data) {
     setState(ToBeUpdated);
 }
 
-uint32_t MaterialGL::getProgram(uint16_t type) {
+void MaterialGL::update() {
     switch(state()) {
         case Suspend: {
             for(auto it : m_Programs) {
+                CommandBufferGL::releaseProgram(it.second);
                 glDeleteProgram(it.second);
             }
             m_Programs.clear();
@@ -68,6 +77,7 @@ uint32_t MaterialGL::getProgram(uint16_t type) {
         } break;
         case ToBeUpdated: {
             for(auto it : m_Programs) {
+                CommandBufferGL::releaseProgram(it.second);
                 glDeleteProgram(it.second);
             }
             m_Programs.clear();
@@ -86,11 +96,33 @@ uint32_t MaterialGL::getProgram(uint16_t type) {
                     }
                 }
             }
+            // Building of programs changes the current program
+            CommandBufferGL::resetState();
 
             setState(Ready);
         } break;
         default: break;
     }
+}
+
+void MaterialGL::prepare() {
+    update();
+    captureState();
+
+    // The render thread draws with the textures which were set at the sync point
+    m_Bound.textures = m_Textures;
+    for(auto &it : m_Bound.textures) {
+        TextureGL *texture = static_cast<TextureGL *>(it.second);
+        if(texture) {
+            texture->nativeHandle();
+        }
+    }
+}
+
+uint32_t MaterialGL::getProgram(uint16_t type) {
+    if(!CommandBufferGL::isDrawOnly()) {
+        update();
+    }
 
     auto it = m_Programs.find(type);
     if(it != m_Programs.end()) {
@@ -100,7 +132,11 @@ uint32_t MaterialGL::getProgram(uint16_t type) {
 }
 
 uint32_t MaterialGL::bind(uint32_t layer, uint16_t vertex) {
-    int32_t b = blendMode();
+    if(!CommandBufferGL::isDrawOnly()) {
+        captureState();
+    }
+
+    int32_t b = m_Bound.blend;
 
     if((layer & ICommandBuffer::DEFAULT || layer & ICommandBuffer::SHADOWCAST) &&
        (b == Material::Additive || b == Material::Translucent)) {
@@ -119,18 +155,18 @@ uint32_t MaterialGL::bind(uint32_t layer, uint16_t vertex) {
         return 0;
     }
 
-    if(!m_DepthTest) {
+    if(!m_Bound.depthTest) {
         glDisable(GL_DEPTH_TEST);
     } else {
         glEnable(GL_DEPTH_TEST);
         //glDepthFunc((layer & ICommandBuffer::DEFAULT) ? GL_EQUAL : GL_LEQUAL);
 
-        glDepthMask((m_DepthWrite) ? GL_TRUE : GL_FALSE);
+        glDepthMask((m_Bound.depthWrite) ? GL_TRUE : GL_FALSE);
     }
 
-    if(!doubleSided() && !(layer & ICommandBuffer::RAYCAST)) {
+    if(!m_Bound.doubleSided && !(layer & ICommandBuffer::RAYCAST)) {
         glEnable( GL_CULL_FACE );
-        if(m_MaterialType == LightFunction) {
+        if(m_Bound.type == LightFunction) {
             glCullFace(GL_FRONT);
         } else {
             glCullFace(GL_BACK);
@@ -154,6 +190,21 @@ uint32_t MaterialGL::bind(uint32_t layer, uint16_t vertex) {
     return program;
 }
 
+const MaterialGL::TextureMap &MaterialGL::boundTextures() const {
+    if(CommandBufferGL::isDrawOnly()) {
+        return m_Bound.textures;
+    }
+    return m_Textures;
+}
+
+void MaterialGL::captureState() {
+    m_Bound.blend = blendMode();
+    m_Bound.type = m_MaterialType;
+    m_Bound.depthTest = m_DepthTest;
+    m_Bound.depthWrite = m_DepthWrite;
+    m_Bound.doubleSided = doubleSided();
+}
+
 uint32_t MaterialGL::buildShader(uint16_t type, const string &src) {
     const char *data = src.c_str();
 
@@ -191,6 +242,11 @@ uint32_t MaterialGL::buildProgram(uint32_t vertex, uint32_t fragment) {
         glDeleteShader(vertex);
         glDeleteShader(fragment);
 
+        uint32_t block = glGetUniformBlockIndex(result, "Camera");
+        if(block != GL_INVALID_INDEX) {
+            glUniformBlockBinding(result, block, GLOBAL_BIND);
+        }
+
         glUseProgram(result);
         uint8_t t = 0;
         for(auto &it : m_Textures) {
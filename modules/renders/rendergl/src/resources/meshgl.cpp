@@ -5,10 +5,16 @@
 #include "commandbuffergl.h"
 
 MeshGL::MeshGL() :
-        m_InstanceBuffer(0) {
+        m_InstanceBuffer(0),
+        m_Mode(Mesh::Triangles),
+        m_Flags(0) {
 }
 
-void MeshGL::bindVao(CommandBufferGL *buffer, uint32_t lod) {
+MeshGL::~MeshGL() {
+    CommandBufferGL::waitForFrame();
+}
+
+bool MeshGL::update(CommandBufferGL *buffer) {
     switch(state()) {
         case ToBeUpdated: {
             updateVbo(buffer);
@@ -21,9 +27,20 @@ void MeshGL::bindVao(CommandBufferGL *buffer, uint32_t lod) {
             destroyVao(buffer);
 
             setState(ToBeDeleted);
-            return;
+            return false;
         }
-        default: return;
+        default: return false;
+    }
+    return true;
+}
+
+bool MeshGL::bindVao(CommandBufferGL *buffer, uint32_t lod) {
+    // Snapshot is drawn only with the buffers uploaded at the sync point
+    if(!CommandBufferGL::isDrawOnly() && !update(buffer)) {
+        return false;
+    }
+    if(lod >= m_Vao.size() || lod >= m_vertices.size()) {
+        return false;
     }
 
     uint32_t *id = nullptr;
@@ -35,7 +52,7 @@ void MeshGL::bindVao(CommandBufferGL *buffer, uint32_t lod) {
                 break;
             } else if(glIsVertexArray(it->vao)) {
                 glBindVertexArray(it->vao);
-                return;
+                return true;
             }
         }
     }
@@ -51,6 +68,8 @@ void MeshGL::bindVao(CommandBufferGL *buffer, uint32_t lod) {
     glBindVertexArray(*id);
 
     updateVao(lod);
+
+    return true;
 }
 
 void MeshGL::updateVao(uint32_t lod) {
@@ -61,7 +80,7 @@ void MeshGL::updateVao(uint32_t lod) {
     glEnableVertexAttribArray(VERTEX_ATRIB);
     glVertexAttribPointer(VERTEX_ATRIB, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
 
-    uint8_t flag = flags();
+    uint8_t flag = m_Flags;
 
     if(flag & Mesh::Normals) {
         glBindBuffer(GL_ARRAY_BUFFER, m_normals[lod]);
@@ -109,6 +128,12 @@ void MeshGL::updateVbo(CommandBufferGL *buffer) {
     uint32_t count = lodsCount();
     uint8_t flag = flags();
 
+    // Draw calls use only the uploaded data, the lods can be changed by the main thread meanwhile
+    m_Flags = flag;
+    m_Mode = mode();
+    m_VertexCounts.resize(count);
+    m_IndexCounts.resize(count);
+
     if(m_triangles.size() < count) {
         m_triangles.resize(count);
         m_vertices.resize(count);
@@ -143,6 +168,8 @@ void MeshGL::updateVbo(CommandBufferGL *buffer) {
         Lod *l = lod(i);
 
         uint32_t vCount = l->vertices().size();
+        m_VertexCounts[i] = vCount;
+        m_IndexCounts[i] = l->indices().size();
         if(!l->vertices().empty()) {
             glBindBuffer(GL_ARRAY_BUFFER, m_vertices[i]);
             glBufferData(GL_ARRAY_BUFFER, sizeof(Vector3) * vCount, &l->vertices()[0], (dynamic) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
@@ -187,8 +214,8 @@ void MeshGL::updateVbo(CommandBufferGL *buffer) {
 }
 
 void MeshGL::destroyVao(CommandBufferGL *buffer) {
-    for(int32_t l = 0; l < lodsCount(); l++) {
-        for(auto &it : m_Vao[l]) {
+    for(auto &l : m_Vao) {
+        for(auto &it : l) {
             if(it->buffer == buffer) {
                 glDeleteVertexArrays(1, &(it->vao));
             }
@@ -238,3 +265,15 @@ void MeshGL::destroyVbo() {
 uint32_t MeshGL::instance() const {
     return m_InstanceBuffer;
 }
+
+int32_t MeshGL::drawMode() const {
+    return m_Mode;
+}
+
+uint32_t MeshGL::vertexCount(uint32_t lod) const {
+    return (lod < m_VertexCounts.size()) ? m_VertexCounts[lod] : 0;
+}
+
+uint32_t MeshGL::indexCount(uint32_t lod) const {
+    return (lod < m_IndexCounts.size()) ? m_IndexCounts[lod] : 0;
+}
@@ -4,12 +4,18 @@
 
 #include "resources/texturegl.h"
 
+#include "commandbuffergl.h"
+
 RenderTargetGL::RenderTargetGL() :
         m_Buffer(0) {
 
 }
 
-void RenderTargetGL::bindBuffer(uint32_t level) {
+RenderTargetGL::~RenderTargetGL() {
+    CommandBufferGL::waitForFrame();
+}
+
+void RenderTargetGL::update(uint32_t level) {
     switch(state()) {
         case Suspend: {
             destroyBuffer();
@@ -27,6 +33,18 @@ void RenderTargetGL::bindBuffer(uint32_t level) {
     updateBuffer(level);
 }
 
+void RenderTargetGL::bindBuffer(uint32_t level) {
+    // Snapshot is drawn only with the attachments bound at the sync point
+    if(CommandBufferGL::isDrawOnly()) {
+        if(m_Buffer) {
+            glBindFramebuffer(GL_FRAMEBUFFER, m_Buffer);
+        }
+        return;
+    }
+
+    update(level);
+}
+
 bool RenderTargetGL::updateBuffer(uint32_t level) {
     if(m_Buffer == 0) {
         glGenFramebuffers(1, &m_Buffer);
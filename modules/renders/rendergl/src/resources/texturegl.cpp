@@ -3,22 +3,46 @@
 #include <cstring>
 
 #include "agl.h"
+#include "commandbuffergl.h"
 
 #define DATA    "Data"
 
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+    #define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+    #define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+    #define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
 TextureGL::TextureGL() :
-        m_ID(0) {
+        m_ID(0),
+        m_Target(GL_TEXTURE_2D) {
+
+}
 
+TextureGL::~TextureGL() {
+    CommandBufferGL::waitForFrame();
 }
 
 uint32_t TextureGL::nativeHandle() {
+    // Snapshot is drawn only with the textures uploaded at the sync point
+    if(CommandBufferGL::isDrawOnly()) {
+        return m_ID;
+    }
+
     switch(state()) {
         case Suspend: {
             destroyTexture();
             setState(ToBeDeleted);
         } break;
         case ToBeUpdated: {
-            updateTexture();
+            int32_t x, y, w, h;
+            if(m_ID == 0 || !dirtyRegion(x, y, w, h) || !updateRegion(x, y, w, h)) {
+                updateTexture();
+            }
             setState(Ready);
         } break;
         default: break;
@@ -27,6 +51,10 @@ uint32_t TextureGL::nativeHandle() {
     return m_ID;
 }
 
+uint32_t TextureGL::target() const {
+    return m_Target;
+}
+
 void TextureGL::readPixels(int x, int y, int width, int height) {
     bool depth = (format() == Depth);
 
@@ -47,7 +75,9 @@ void TextureGL::updateTexture() {
     }
 
     uint32_t target = isCubemap() ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+    m_Target = target;
     glBindTexture(target, m_ID);
+    CommandBufferGL::resetState();
 
     Texture::Sides *sides = getSides();
 
@@ -75,9 +105,65 @@ void TextureGL::updateTexture() {
     glTexParameteri(target, GL_TEXTURE_WRAP_T, glwrap);
     glTexParameteri(target, GL_TEXTURE_WRAP_R, glwrap);
 
-    uint32_t internal   = GL_RGBA8;
-    uint32_t glformat   = GL_RGBA;
-    uint32_t type       = GL_UNSIGNED_BYTE;
+    uint32_t internal;
+    uint32_t glformat;
+    uint32_t type;
+    formats(internal, glformat, type);
+
+    switch(target) {
+        case GL_TEXTURE_CUBE_MAP: {
+            uploadTextureCubemap(sides, target, internal, glformat, type);
+        } break;
+        default: {
+            uploadTexture(sides, 0, target, internal, glformat, type);
+        } break;
+    }
+
+    //glTexParameterf(target, GL_TEXTURE_LOD_BIAS, 0.0);
+
+    //float aniso = 0.0f;
+    //glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &aniso);
+    //glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, aniso);
+}
+
+bool TextureGL::updateRegion(int32_t x, int32_t y, int32_t width, int32_t height) {
+    Texture::Sides *sides = getSides();
+    if(isCubemap() || isCompressed() || sides->empty() || sides->at(0).size() != 1) {
+        return false;
+    }
+    if(width <= 0 || height <= 0) {
+        return true;
+    }
+
+    uint32_t internal;
+    uint32_t glformat;
+    uint32_t type;
+    formats(internal, glformat, type);
+
+    glBindTexture(GL_TEXTURE_2D, m_ID);
+    CommandBufferGL::resetState();
+
+    int32_t pixel = size(1, 1);
+    const int8_t *data = &(sides->at(0)[0])[0] + (y * this->width() + x) * pixel;
+
+    GLint alignment = -1;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, this->width());
+
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, glformat, type, data);
+    CheckGLError();
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+
+    return true;
+}
+
+void TextureGL::formats(uint32_t &internal, uint32_t &glformat, uint32_t &type) {
+    internal    = GL_RGBA8;
+    glformat    = GL_RGBA;
+    type        = GL_UNSIGNED_BYTE;
 
     switch(format()) {
         case R8: {
@@ -120,20 +206,13 @@ void TextureGL::updateTexture() {
         default: break;
     }
 
-    switch(target) {
-        case GL_TEXTURE_CUBE_MAP: {
-            uploadTextureCubemap(sides, target, internal, glformat, type);
-        } break;
-        default: {
-            uploadTexture(sides, 0, target, internal, glformat, type);
-        } break;
+    switch(compress()) {
+        case DXT1: internal = GL_COMPRESSED_RGB_S3TC_DXT1_EXT; break;
+        case DXT5: internal = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+        case ETC2: internal = (format() == RGB8) ? GL_COMPRESSED_RGB8_ETC2 : GL_COMPRESSED_RGBA8_ETC2_EAC; break;
+        case BC7:  internal = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+        default: break;
     }
-
-    //glTexParameterf(target, GL_TEXTURE_LOD_BIAS, 0.0);
-
-    //float aniso = 0.0f;
-    //glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &aniso);
-    //glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, aniso);
 }
 
 void TextureGL::destroyTexture() {
@@ -141,6 +220,8 @@ void TextureGL::destroyTexture() {
         glDeleteTextures(1, &m_ID);
         CheckGLError();
         m_ID = 0;
+
+        CommandBufferGL::resetState();
     }
 }
 
@@ -156,7 +237,9 @@ bool TextureGL::uploadTexture(const Sides *sides, uint32_t imageIndex, uint32_t
             // load all mipmaps
             for(uint32_t i = 0; i < image.size(); i++) {
                 const int8_t *data = &(image[i])[0];
-                glCompressedTexImage2D(target, i, internal, (w >> i), (h >> i), 0, size((w >> i), (h >> i)), data);
+                int32_t mipW = MAX(w >> i, 1);
+                int32_t mipH = MAX(h >> i, 1);
+                glCompressedTexImage2D(target, i, internal, mipW, mipH, 0, size(mipW, mipH), data);
                 CheckGLError();
             }
         } else {
@@ -28,6 +28,8 @@ public:
 
     void update(Scene *);
 
+    void fixedUpdate(Scene *);
+
     int threadPolicy() const;
 
     void reload();
@@ -24,6 +24,7 @@ public:
 
     asIScriptFunction *scriptStart() const;
     asIScriptFunction *scriptUpdate() const;
+    asIScriptFunction *scriptFixedUpdate() const;
 
     void createObject();
 
@@ -98,6 +99,7 @@ protected:
 
     asIScriptFunction *m_pStart;
     asIScriptFunction *m_pUpdate;
+    asIScriptFunction *m_pFixedUpdate;
 
     MetaObject *m_pMetaObject;
 };
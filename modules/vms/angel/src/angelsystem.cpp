@@ -128,6 +128,23 @@ void AngelSystem::update(Scene *scene) {
     }
 }
 
+void AngelSystem::fixedUpdate(Scene *scene) {
+    PROFILE_FUNCTION();
+
+    if(Engine::isGameMode()) {
+        for(auto it : m_ObjectList) {
+            AngelBehaviour *component = static_cast<AngelBehaviour *>(it);
+            if(component->isStarted() && component->isEnabled() && component->actor() && component->actor()->scene() == scene) {
+                asIScriptObject *object = component->scriptObject();
+                if(object) {
+                    execute(object, component->scriptFixedUpdate());
+                    object->Release();
+                }
+            }
+        }
+    }
+}
+
 int AngelSystem::threadPolicy() const {
     return Pool;
 }
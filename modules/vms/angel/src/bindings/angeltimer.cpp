@@ -10,6 +10,8 @@ void registerTimer(asIScriptEngine *engine) {
     engine->RegisterGlobalFunction("float deltaTime()", asFUNCTION(Timer::deltaTime), asCALL_CDECL);
     engine->RegisterGlobalFunction("float scale()", asFUNCTION(Timer::scale), asCALL_CDECL);
     engine->RegisterGlobalFunction("void setScale(float)", asFUNCTION(Timer::setScale), asCALL_CDECL);
+    engine->RegisterGlobalFunction("float fixedTimeStep()", asFUNCTION(Timer::fixedTimeStep), asCALL_CDECL);
+    engine->RegisterGlobalFunction("float interpolation()", asFUNCTION(Timer::interpolation), asCALL_CDECL);
 
     engine->SetDefaultNamespace("");
 }
@@ -18,6 +18,7 @@ AngelBehaviour::AngelBehaviour() :
         m_pObject(nullptr),
         m_pStart(nullptr),
         m_pUpdate(nullptr),
+        m_pFixedUpdate(nullptr),
         m_pMetaObject(nullptr) {
     PROFILE_FUNCTION();
 }
@@ -103,6 +104,7 @@ void AngelBehaviour::setScriptObject(asIScriptObject *object) {
             }
             m_pStart = info->GetMethodByDecl("void start()");
             m_pUpdate = info->GetMethodByDecl("void update()");
+            m_pFixedUpdate = info->GetMethodByDecl("void fixedUpdate()");
 
             updateMeta();
         }
@@ -214,6 +216,11 @@ asIScriptFunction *AngelBehaviour::scriptUpdate() const {
     return m_pUpdate;
 }
 
+asIScriptFunction *AngelBehaviour::scriptFixedUpdate() const {
+    PROFILE_FUNCTION();
+    return m_pFixedUpdate;
+}
+
 const MetaObject *AngelBehaviour::metaObject() const {
     PROFILE_FUNCTION();
     if(m_pMetaObject) {
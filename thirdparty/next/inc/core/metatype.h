@@ -5,6 +5,7 @@
 #include <unordered_map>
 #include <typeinfo>
 #include <typeindex>
+#include <atomic>
 #include <stdint.h>
 
 #include "global.h"
@@ -88,7 +89,15 @@ public:
 
     template<typename T>
     static uint32_t         type                        () {
-        return type(typeid(T));
+        // Revision and id are packed to one word, so the concurrent callers never see a half updated cache
+        static atomic<uint64_t> cache(0);
+        uint32_t revision = s_Revision.load(memory_order_acquire);
+        uint64_t value = cache.load(memory_order_acquire);
+        if(static_cast<uint32_t>(value >> 32) != revision) {
+            value = (static_cast<uint64_t>(revision) << 32) | type(typeid(T));
+            cache.store(value, memory_order_release);
+        }
+        return static_cast<uint32_t>(value);
     }
 
     static const char      *name                        (uint32_t type);
@@ -111,6 +120,8 @@ private:
     const Table            *m_pTable;
 
     static uint32_t         s_NextId;
+
+    static atomic<uint32_t> s_Revision;
 };
 
 template<typename T>
@@ -51,6 +51,8 @@ public:
 
     static uint32_t                     generateUUID            ();
 
+    static void                         setUUIDSeed             (uint32_t seed);
+
     static void                         replaceUUID             (Object *object, uint32_t uuid);
 
     static Object                      *findRoot                (Object *object);
@@ -1,6 +1,7 @@
 #include "core/metatype.h"
 
 #include <list>
+#include <cstring>
 
 #include "math/amath.h"
 #include "core/variant.h"
@@ -15,6 +16,7 @@
     \fn uint32_t MetaType::type()
 
     Returns the type ID for type T.
+    The ID is cached per type and looked up again only after the set of registered types has changed.
 */
 #define DECLARE_BUILT_TYPE(TYPE) \
     { \
@@ -34,6 +36,7 @@
     }
 
 typedef map<string, uint32_t>           NameMap;
+typedef unordered_map<type_index, uint32_t> IndexMap;
 typedef map<uint32_t, map<uint32_t, MetaType::converterCallback> > ConverterMap;
 
 bool toBoolean(void *to, const void *from, const uint32_t fromType) {
@@ -262,6 +265,7 @@ bool toQuaternion(void *to, const void *from, const uint32_t fromType) {
 }
 
 uint32_t MetaType::s_NextId = MetaType::USERTYPE;
+atomic<uint32_t> MetaType::s_Revision(1);
 static MetaType::TypeMap s_Types = {
     {MetaType::BOOLEAN,     DECLARE_BUILT_TYPE(bool)},
     {MetaType::INTEGER,     DECLARE_BUILT_TYPE(int)},
@@ -326,6 +330,34 @@ static ConverterMap s_Converters= {
     {MetaType::MATRIX4,    {{MetaType::VARIANTLIST, &toMatrix4}}}
 };
 
+// Direct access to converters between built-in types, indexed as [to][from]
+struct ConverterTable {
+    explicit ConverterTable(const ConverterMap &converters) {
+        memset(functions, 0, sizeof(functions));
+        for(auto &t : converters) {
+            for(auto &it : t.second) {
+                if(t.first < MetaType::USERTYPE && it.first < MetaType::USERTYPE) {
+                    functions[t.first][it.first] = it.second;
+                }
+            }
+        }
+    }
+
+    MetaType::converterCallback functions[MetaType::USERTYPE][MetaType::USERTYPE];
+};
+
+static ConverterTable s_Table(s_Converters);
+
+static IndexMap buildIndices() {
+    IndexMap result;
+    for(auto &it : s_Types) {
+        result[it.second.index()] = it.first;
+    }
+    return result;
+}
+
+static IndexMap s_Indices = buildIndices();
+
 static NameMap s_Names = {
     {"bool",            MetaType::BOOLEAN},
     {"int",             MetaType::INTEGER},
@@ -494,6 +526,8 @@ uint32_t MetaType::registerType(Table &table) {
     uint32_t result = ++MetaType::s_NextId;
     s_Types[result] = table;
     s_Names[table.name] = result;
+    s_Indices[table.index()] = result;
+    ++MetaType::s_Revision;
     return result;
 }
 /*!
@@ -506,9 +540,14 @@ void MetaType::unregisterType(Table &table) {
         uint32_t id = it->second;
         auto name = s_Types.find(id);
         if(name != s_Types.end()) {
+            auto index = s_Indices.find(name->second.index());
+            if(index != s_Indices.end() && index->second == id) {
+                s_Indices.erase(index);
+            }
             s_Types.erase(name);
         }
         s_Names.erase(it);
+        ++MetaType::s_Revision;
     }
 }
 /*!
@@ -529,10 +568,9 @@ uint32_t MetaType::type(const char *name) {
 */
 uint32_t MetaType::type(const type_info &type) {
     PROFILE_FUNCTION();
-    for(auto it : s_Types) {
-        if(it.second.index() == type_index(type) ) {
-            return it.first;
-        }
+    auto it = s_Indices.find(type_index(type));
+    if(it != s_Indices.end()) {
+        return it->second;
     }
     return INVALID;
 }
@@ -625,6 +663,10 @@ bool MetaType::compare(const void *left, const void *right, uint32_t type) {
 */
 bool MetaType::convert(const void *from, uint32_t fromType, void *to, uint32_t toType) {
     PROFILE_FUNCTION();
+    if(fromType < USERTYPE && toType < USERTYPE) {
+        converterCallback function = s_Table.functions[toType][fromType];
+        return (function) ? (*function)(to, from, fromType) : false;
+    }
     auto t = s_Converters.find(toType);
     if(t != s_Converters.end()) {
         auto it = t->second.find(fromType);
@@ -646,6 +688,10 @@ bool MetaType::registerConverter(uint32_t from, uint32_t to, converterCallback f
         return false;
     }
 
+    if(from < USERTYPE && to < USERTYPE) {
+        s_Table.functions[to][from] = function;
+    }
+
     auto t = s_Converters.find(to);
     if(t != s_Converters.end()) {
         t->second[from] = function;
@@ -661,6 +707,9 @@ bool MetaType::registerConverter(uint32_t from, uint32_t to, converterCallback f
 */
 bool MetaType::hasConverter(uint32_t from, uint32_t to) {
     PROFILE_FUNCTION();
+    if(from < USERTYPE && to < USERTYPE) {
+        return (s_Table.functions[to][from] != nullptr);
+    }
     auto t = s_Converters.find(to);
     if(t != s_Converters.end()) {
         auto it = t->second.find(from);
@@ -8,9 +8,13 @@
 
 #include "math/amath.h"
 
+#include <mutex>
+
 static ObjectSystem::FactoryMap s_Factories;
 static ObjectSystem::GroupMap   s_Groups;
 
+static mutex s_UUIDMutex;
+
 /*!
     \class ObjectSystem
     \brief The ObjectSystem responds for object management.
@@ -349,11 +353,24 @@ Object *ObjectSystem::toObject(const Variant &variant, Object *root) {
 }
 /*!
     Returns the new unique ID based on random number generator.
+    \note This method is thread safe.
 */
 uint32_t ObjectSystem::generateUUID() {
     PROFILE_FUNCTION();
+    unique_lock<mutex> locker(s_UUIDMutex);
     return dist(mt);
 }
+/*!
+    Reinitializes the random number generator used by generateUUID() with the \a seed.
+    The same \a seed produces the same sequence of IDs, which allows to reproduce the object hierarchies (for example for replays).
+    \note This method is thread safe.
+*/
+void ObjectSystem::setUUIDSeed(uint32_t seed) {
+    PROFILE_FUNCTION();
+    unique_lock<mutex> locker(s_UUIDMutex);
+    mt.seed(seed);
+    dist.reset();
+}
 /*!
     Replaces current \a uuid of the \a object with the new one.
 */
@@ -9,6 +9,14 @@
 #include <iomanip>
 #include <codecvt>
 
+struct TestStruct {
+    int value;
+
+    bool operator== (const TestStruct &right) const {
+        return value == right.value;
+    }
+};
+
 class VariantTest : public QObject {
     Q_OBJECT
 
@@ -185,6 +193,50 @@ void Compare_Variants_Advanced() {
     }
 }
 
+void Meta_Type_Ids() {
+    QCOMPARE(MetaType::type<int>(),         static_cast<uint32_t>(MetaType::INTEGER));
+    QCOMPARE(MetaType::type<Vector3>(),     static_cast<uint32_t>(MetaType::VECTOR3));
+    QCOMPARE(MetaType::type<VariantList>(), static_cast<uint32_t>(MetaType::VARIANTLIST));
+
+    QCOMPARE(MetaType::type<TestStruct>(),  static_cast<uint32_t>(MetaType::INVALID));
+    uint32_t id = registerMetaType<TestStruct>("TestStruct");
+    QCOMPARE(MetaType::type<TestStruct>(),  id);
+    QCOMPARE(MetaType::type("TestStruct"),  id);
+
+    TestStruct test = { 5 };
+    QCOMPARE(Variant(id, &test).value<TestStruct>().value, 5);
+
+    unregisterMetaType<TestStruct>("TestStruct");
+    QCOMPARE(MetaType::type<TestStruct>(),  static_cast<uint32_t>(MetaType::INVALID));
+}
+
+void Benchmark_Round_Trip() {
+    Vector3 vector(1.0f, 2.0f, 3.0f);
+    QBENCHMARK {
+        Variant value = Variant::fromValue(vector);
+        vector = value.value<Vector3>();
+    }
+    QCOMPARE(vector, Vector3(1.0f, 2.0f, 3.0f));
+}
+
+void Benchmark_Convert() {
+    Variant value = 5;
+    float result = 0.0f;
+    QBENCHMARK {
+        result += value.value<float>();
+    }
+    QVERIFY(result > 0.0f);
+}
+
+void Benchmark_Convert_List() {
+    Variant value = Vector4(1.0f, 2.0f, 3.0f, 4.0f);
+    Vector4 result;
+    QBENCHMARK {
+        result = Variant(value.toList()).toVector4();
+    }
+    QCOMPARE(result, Vector4(1.0f, 2.0f, 3.0f, 4.0f));
+}
+
 } REGISTER(VariantTest)
 
 #include "tst_variant.moc"
@@ -1,4 +1,4 @@
-layout(location = 10) uniform struct Camera {
+layout(std140, binding = 0) uniform Camera {
     mat4    view;
     mat4    projection;
     mat4    projectionInv;
@@ -22,14 +22,12 @@
 #include <QVariant>
 #include <QColor>
 
-#define SELECT_MAP  "selectMap"
 #define DEPTH_MAP   "depthMap"
 #define OUTLINE_MAP "outlineMap"
 #define OUTDEPTH_MAP "outdepthMap"
 
 #define G_EMISSIVE  "emissiveMap"
 
-#define SEL_TARGET  "objectSelect"
 #define OUT_TARGET  "outLine"
 #define FINAL_TARGET "finalTarget"
 
@@ -65,18 +63,10 @@ EditorPipeline::EditorPipeline() :
         m_pGizmo(nullptr),
         m_pController(nullptr),
         m_pOutline(new Outline()),
-        m_pDepth(nullptr),
-        m_pSelect(nullptr),
         m_ObjectId(0),
         m_MouseX(0),
         m_MouseY(0) {
 
-    {
-        Texture *select = Engine::objectCreate<Texture>();
-        select->setFormat(Texture::RGBA8);
-        m_textureBuffers[SELECT_MAP] = select;
-        m_Buffer->setGlobalTexture(SELECT_MAP, select);
-    }
     {
         Texture *depth = Engine::objectCreate<Texture>();
         depth->setFormat(Texture::Depth);
@@ -91,21 +81,6 @@ EditorPipeline::EditorPipeline() :
         m_Buffer->setGlobalTexture(OUTLINE_MAP, outline);
     }
 
-    m_pSelect = Engine::objectCreate<Texture>();
-    m_pSelect->setFormat(Texture::RGBA8);
-    m_pSelect->resize(1, 1);
-
-    m_pDepth = Engine::objectCreate<Texture>();
-    m_pDepth->setFormat(Texture::Depth);
-    m_pDepth->setDepthBits(24);
-    m_pDepth->setWidth(1);
-    m_pDepth->setHeight(1);
-
-    RenderTarget *object = Engine::objectCreate<RenderTarget>();
-    object->setColorAttachment(0, m_textureBuffers[SELECT_MAP]);
-    object->setDepthAttachment(m_textureBuffers[DEPTH_MAP]);
-    m_renderTargets[SEL_TARGET] = object;
-
     RenderTarget *out = Engine::objectCreate<RenderTarget>();
     out->setColorAttachment(0, m_textureBuffers[OUTLINE_MAP]);
     out->setDepthAttachment(m_textureBuffers[OUTDEPTH_MAP]);
@@ -183,6 +158,34 @@ void EditorPipeline::setMousePosition(int32_t x, int32_t y) {
     m_MouseY = y;
 }
 
+/*!
+    Returns uuids of actors which bounds intersect the screen area at \a position with \a size in pixels.
+*/
+list<uint32_t> EditorPipeline::objectsInRect(const Vector2 &position, const Vector2 &size) const {
+    float x0 = position.x / (float)m_Width;
+    float y0 = position.y / (float)m_Height;
+    float x1 = (position.x + size.x) / (float)m_Width;
+    float y1 = (position.y + size.y) / (float)m_Height;
+
+    array<Vector3, 8> corners;
+    for(int32_t i = 0; i < 2; i++) {
+        float z = static_cast<float>(i);
+        corners[i * 4 + 0] = Camera::unproject(Vector3(x0, y1, z), m_View, m_Projection);
+        corners[i * 4 + 1] = Camera::unproject(Vector3(x1, y1, z), m_View, m_Projection);
+        corners[i * 4 + 2] = Camera::unproject(Vector3(x1, y0, z), m_View, m_Projection);
+        corners[i * 4 + 3] = Camera::unproject(Vector3(x0, y0, z), m_View, m_Projection);
+    }
+
+    list<uint32_t> result;
+    for(auto it : m_Picker.frustum(corners)) {
+        uint32_t uuid = it->actor()->uuid();
+        if(find(result.begin(), result.end(), uuid) == result.end()) {
+            result.push_back(uuid);
+        }
+    }
+    return result;
+}
+
 void EditorPipeline::setDragObjects(const ObjectList &list) {
     m_DragList.clear();
     for(auto it : list) {
@@ -211,27 +214,26 @@ QStringList EditorPipeline::targets() const {
 
 void EditorPipeline::draw(Camera &camera) {
     // Retrive object id
-    m_Buffer->setRenderTarget(m_renderTargets[SEL_TARGET]);
-    m_Buffer->clearRenderTarget();
-
-    m_Buffer->setViewport(0, 0, m_Width, m_Height);
-
     cameraReset(camera);
-    drawComponents(ICommandBuffer::RAYCAST, m_Filter);
-    drawComponents(ICommandBuffer::RAYCAST, m_UiComponents);
-
-    Vector3 screen((float)m_MouseX / (float)m_Width, (float)m_MouseY / (float)m_Height, 0.0f);
-
-    m_pSelect->readPixels(m_MouseX, m_MouseY, 1, 1);
-    m_ObjectId = m_pSelect->getPixel(0, 0);
-    if(m_ObjectId) {
-        m_pDepth->readPixels(m_MouseX, m_MouseY, 1, 1);
-        uint32_t pixel = m_pDepth->getPixel(0, 0);
-        memcpy(&screen.z, &pixel, sizeof(float));
-
-        m_MouseWorld = Camera::unproject(screen, camera.viewMatrix(), camera.projectionMatrix());
+    m_View = camera.viewMatrix();
+    m_Projection = camera.projectionMatrix();
+
+    RenderList pickable(m_Filter);
+    pickable.insert(pickable.end(), m_UiComponents.begin(), m_UiComponents.end());
+    m_Picker.build(pickable);
+
+    float x = (float)m_MouseX / (float)m_Width;
+    float y = (float)m_MouseY / (float)m_Height;
+    Vector3 origin = Camera::unproject(Vector3(x, y, 0.0f), m_View, m_Projection);
+    Vector3 dir = Camera::unproject(Vector3(x, y, 1.0f), m_View, m_Projection) - origin;
+    dir.normalize();
+    Ray ray(origin, dir);
+
+    m_ObjectId = 0;
+    Renderable *hit = m_Picker.raycast(ray, &m_MouseWorld);
+    if(hit) {
+        m_ObjectId = hit->actor()->uuid();
     } else {
-        Ray ray = camera.castRay(screen.x, screen.y);
         m_MouseWorld = (ray.dir * 10.0f) + ray.pos;
     }
     for(auto it : m_DragList) {
@@ -3,6 +3,8 @@
 
 #include "pipeline.h"
 
+#include "scenepicker.h"
+
 #include <QObject>
 
 class CameraCtrl;
@@ -24,6 +26,8 @@ public:
 
     void setMousePosition(int32_t x, int32_t y);
 
+    list<uint32_t> objectsInRect(const Vector2 &position, const Vector2 &size) const;
+
     void setDragObjects(const ObjectList &list);
 
     void setTarget(const QString &string = QString());
@@ -55,8 +59,10 @@ protected:
 
     list<Renderable *> m_DragList;
 
-    Texture *m_pDepth;
-    Texture *m_pSelect;
+    ScenePicker m_Picker;
+
+    Matrix4 m_View;
+    Matrix4 m_Projection;
 
     uint32_t m_ObjectId;
     int32_t m_MouseX;
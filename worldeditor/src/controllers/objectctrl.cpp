@@ -60,6 +60,7 @@ ObjectCtrl::ObjectCtrl(QWidget *view) :
         m_Modified(false),
         m_Drag(false),
         m_Canceled(false),
+        m_SelectArea(false),
         m_Axes(0),
         m_pMap(nullptr),
         m_pPipeline(nullptr),
@@ -138,7 +139,7 @@ void ObjectCtrl::drawHandles() {
     Vector2 position, size;
     selectGeometry(position, size);
 
-    Vector3 screen = Vector3(position.x / m_Screen.x, position.y / m_Screen.y, 0.0f);
+    Vector3 screen = Vector3(m_MousePosition.x / m_Screen.x, m_MousePosition.y / m_Screen.y, 0.0f);
     Handles::s_Mouse = Vector2(screen.x, screen.y);
     Handles::s_Screen = m_Screen;
 
@@ -158,23 +159,51 @@ void ObjectCtrl::drawHandles() {
     }
 
     if(m_pPipeline) {
-        uint32_t result = 0;
-        if(position.x >= 0.0f && position.y >= 0.0f &&
-           position.x < m_Screen.x && position.y < m_Screen.y) {
+        if(m_SelectArea && size.x > 1.0f && size.y > 1.0f) {
+            m_ObjectsList = m_pPipeline->objectsInRect(position, size);
+            drawSelectArea(position, size);
+        } else {
+            uint32_t result = 0;
+            if(m_MousePosition.x >= 0.0f && m_MousePosition.y >= 0.0f &&
+               m_MousePosition.x < m_Screen.x && m_MousePosition.y < m_Screen.y) {
 
-            m_pPipeline->setMousePosition(int32_t(position.x), int32_t(position.y));
-            result = m_pPipeline->objectId();
-        }
+                m_pPipeline->setMousePosition(int32_t(m_MousePosition.x), int32_t(m_MousePosition.y));
+                result = m_pPipeline->objectId();
+            }
 
-        if(result) {
-            if(m_ObjectsList.empty()) {
-                m_ObjectsList = { result };
+            if(result) {
+                if(m_ObjectsList.empty()) {
+                    m_ObjectsList = { result };
+                }
             }
         }
         m_MouseWorld = m_pPipeline->mouseWorld();
     }
 }
 
+void ObjectCtrl::drawSelectArea(const Vector2 &position, const Vector2 &size) {
+    if(m_pActiveCamera == nullptr) {
+        return;
+    }
+    Matrix4 view = m_pActiveCamera->viewMatrix();
+    Matrix4 projection = m_pActiveCamera->projectionMatrix();
+
+    float x0 = position.x / m_Screen.x;
+    float y0 = position.y / m_Screen.y;
+    float x1 = (position.x + size.x) / m_Screen.x;
+    float y1 = (position.y + size.y) / m_Screen.y;
+
+    Vector3Vector points = { Camera::unproject(Vector3(x0, y0, 0.5f), view, projection),
+                             Camera::unproject(Vector3(x1, y0, 0.5f), view, projection),
+                             Camera::unproject(Vector3(x1, y1, 0.5f), view, projection),
+                             Camera::unproject(Vector3(x0, y1, 0.5f), view, projection) };
+    IndexVector indices = {0, 1, 1, 2, 2, 3, 3, 0};
+
+    Handles::s_Color = Handles::s_Selected;
+    Handles::drawLines(Matrix4(), points, indices);
+    Handles::s_Color = Handles::s_Normal;
+}
+
 void ObjectCtrl::clear(bool signal) {
     m_Selected.clear();
     if(signal) {
@@ -203,8 +232,13 @@ void ObjectCtrl::drawHelpers(Object &object) {
 }
 
 void ObjectCtrl::selectGeometry(Vector2 &pos, Vector2 &size) {
-    pos = Vector2(m_MousePosition.x, m_MousePosition.y);
-    size = Vector2(1, 1);
+    if(m_SelectArea) {
+        pos = Vector2(MIN(m_SelectOrigin.x, m_MousePosition.x), MIN(m_SelectOrigin.y, m_MousePosition.y));
+        size = Vector2(fabs(m_MousePosition.x - m_SelectOrigin.x), fabs(m_MousePosition.y - m_SelectOrigin.y));
+    } else {
+        pos = Vector2(m_MousePosition.x, m_MousePosition.y);
+        size = Vector2(1, 1);
+    }
 }
 
 void ObjectCtrl::setDrag(bool drag) {
@@ -460,6 +494,7 @@ void ObjectCtrl::onInputEvent(QInputEvent *pe) {
                 if(Handles::s_Axes) {
                     m_Axes = Handles::s_Axes;
                 }
+                m_SelectOrigin = Vector2(e->pos().x(), m_Screen.y - e->pos().y());
                 if(m_Drag) {
                     if(m_pActiveTool) {
                         m_pActiveTool->cancelControl();
@@ -480,6 +515,7 @@ void ObjectCtrl::onInputEvent(QInputEvent *pe) {
                     } else {
                         m_Canceled = false;
                     }
+                    m_SelectArea = false;
                 } else {
                     if(m_pActiveTool) {
                         m_pActiveTool->endControl();
@@ -534,8 +570,10 @@ void ObjectCtrl::onInputEvent(QInputEvent *pe) {
                     }
                     setDrag(Handles::s_Axes);
                 }
+                m_SelectArea = !m_Drag && !m_Canceled;
             } else {
                 setDrag(false);
+                m_SelectArea = false;
             }
 
             if(m_pActiveTool->cursor().shape() != Qt::ArrowCursor) {
@@ -627,11 +665,14 @@ DuplicateObjects::DuplicateObjects(ObjectCtrl *ctrl, const QString &name, QUndoC
 
 }
 void DuplicateObjects::undo() {
+    if(isObsolete()) {
+        return;
+    }
     m_Dump.clear();
     for(auto it : m_Objects) {
         Object *object = m_pController->findObject(it);
         if(object) {
-            m_Dump.push_back(ObjectSystem::toVariant(object));
+            m_Dump.push_back(UndoManager::instance()->snapshot(object));
             delete object;
         }
     }
@@ -642,6 +683,9 @@ void DuplicateObjects::undo() {
     m_pController->selectActors(m_Selected);
 }
 void DuplicateObjects::redo() {
+    if(isObsolete()) {
+        return;
+    }
     if(m_Dump.empty()) {
         for(auto it : m_pController->selected()) {
             m_Selected.push_back(it->uuid());
@@ -654,8 +698,10 @@ void DuplicateObjects::redo() {
         }
     } else {
         for(auto &it : m_Dump) {
-            Object *obj = ObjectSystem::toObject(it, m_pController->map());
-            m_Objects.push_back(obj->uuid());
+            Object *obj = UndoManager::instance()->restore(it, m_pController->map());
+            if(obj) {
+                m_Objects.push_back(obj->uuid());
+            }
         }
     }
 
@@ -664,17 +710,24 @@ void DuplicateObjects::redo() {
     m_pController->clear(false);
     m_pController->selectActors(m_Objects);
 }
+void DuplicateObjects::release() {
+    UndoObject::release();
+    m_Dump.clear();
+}
 
 CreateObjectSerial::CreateObjectSerial(Object::ObjectList &list, ObjectCtrl *ctrl, const QString &name, QUndoCommand *group) :
         UndoObject(ctrl, name, group) {
 
     for(auto it : list) {
-        m_Dump.push_back(ObjectSystem::toVariant(it));
+        m_Dump.push_back(UndoManager::instance()->snapshot(it));
         m_Parents.push_back(it->parent()->uuid());
         delete it;
     }
 }
 void CreateObjectSerial::undo() {
+    if(isObsolete()) {
+        return;
+    }
     for(auto it : m_pController->selected()) {
         delete it;
     }
@@ -682,6 +735,9 @@ void CreateObjectSerial::undo() {
     m_pController->selectActors(m_Objects);
 }
 void CreateObjectSerial::redo() {
+    if(isObsolete()) {
+        return;
+    }
     m_Objects.clear();
     for(auto it : m_pController->selected()) {
         m_Objects.push_back(it->uuid());
@@ -690,7 +746,7 @@ void CreateObjectSerial::redo() {
 
     list<uint32_t> objects;
     for(auto &ref : m_Dump) {
-        Object *object = Engine::toObject(ref);
+        Object *object = UndoManager::instance()->restore(ref);
         if(object) {
             object->setParent(m_pController->findObject(*it));
             objects.push_back(object->uuid());
@@ -704,6 +760,10 @@ void CreateObjectSerial::redo() {
     m_pController->clear(false);
     m_pController->selectActors(objects);
 }
+void CreateObjectSerial::release() {
+    UndoObject::release();
+    m_Dump.clear();
+}
 
 DeleteActors::DeleteActors(const Object::ObjectList &objects, ObjectCtrl *ctrl, const QString &name, QUndoCommand *group) :
         UndoObject(ctrl, name, group) {
@@ -713,11 +773,14 @@ DeleteActors::DeleteActors(const Object::ObjectList &objects, ObjectCtrl *ctrl,
     }
 }
 void DeleteActors::undo() {
+    if(isObsolete()) {
+        return;
+    }
     auto it = m_parents.begin();
     auto index = m_indices.begin();
     for(auto &ref : m_dump) {
         Object *parent = m_pController->findObject(*it);
-        Object *object = Engine::toObject(ref, parent);
+        Object *object = UndoManager::instance()->restore(ref, parent);
         if(object) {
             object->setParent(parent, *index);
             m_objects.push_back(object->uuid());
@@ -740,12 +803,16 @@ void DeleteActors::undo() {
     }
 }
 void DeleteActors::redo() {
+    if(isObsolete()) {
+        return;
+    }
     m_parents.clear();
     m_dump.clear();
+    m_indices.clear();
     for(auto it : m_objects)  {
         Object *object = m_pController->findObject(it);
         if(object) {
-            m_dump.push_back(Engine::toVariant(object));
+            m_dump.push_back(UndoManager::instance()->snapshot(object));
             m_parents.push_back(object->parent()->uuid());
 
             QList<Object *> children = QList<Object *>::fromStdList(object->parent()->getChildren());
@@ -764,6 +831,10 @@ void DeleteActors::redo() {
 
     emit m_pController->mapUpdated();
 }
+void DeleteActors::release() {
+    UndoObject::release();
+    m_dump.clear();
+}
 
 RemoveComponent::RemoveComponent(const Component *component, ObjectCtrl *ctrl, const QString &name, QUndoCommand *group) :
         UndoObject(ctrl, name + " " + component->typeName().c_str(), group) {
@@ -771,8 +842,11 @@ RemoveComponent::RemoveComponent(const Component *component, ObjectCtrl *ctrl, c
     m_uuid = component->uuid();
 }
 void RemoveComponent::undo() {
+    if(isObsolete()) {
+        return;
+    }
     Object *parent = m_pController->findObject(m_parent);
-    Object *object = Engine::toObject(m_dump, parent);
+    Object *object = UndoManager::instance()->restore(m_dump, parent);
     if(object) {
         object->setParent(parent, m_index);
 
@@ -782,11 +856,14 @@ void RemoveComponent::undo() {
     }
 }
 void RemoveComponent::redo() {
-    m_dump = Variant();
+    if(isObsolete()) {
+        return;
+    }
+    m_dump.reset();
     m_parent = 0;
     Object *object = m_pController->findObject(m_uuid);
     if(object) {
-        m_dump = Engine::toVariant(object, true);
+        m_dump = UndoManager::instance()->snapshot(object, true);
         m_parent = object->parent()->uuid();
 
         QList<Object *> children = QList<Object *>::fromStdList(object->parent()->getChildren());
@@ -799,6 +876,10 @@ void RemoveComponent::redo() {
     emit m_pController->objectsUpdated();
     emit m_pController->mapUpdated();
 }
+void RemoveComponent::release() {
+    UndoObject::release();
+    m_dump.reset();
+}
 
 ParentingObjects::ParentingObjects(const Object::ObjectList &objects, Object *origin, ObjectCtrl *ctrl, const QString &name, QUndoCommand *group) :
         UndoObject(ctrl, name, group) {
@@ -839,28 +920,30 @@ void ParentingObjects::redo() {
 }
 
 PropertyObject::PropertyObject(Object *object, const QString &property, const Variant &value, ObjectCtrl *ctrl, const QString &name, QUndoCommand *group) :
-        UndoObject(ctrl, name, group) {
+        UndoObject(ctrl, name, group),
+        m_New(value),
+        m_Object(object->uuid()),
+        m_Property(object->metaObject()->indexOfProperty(qPrintable(property))),
+        m_Captured(false) {
 
-    m_Value = value;
-    m_Property = property;
-    m_Object = object->uuid();
 }
 void PropertyObject::undo() {
-    PropertyObject::redo();
+    Object *object = m_pController->findObject(m_Object);
+    if(object && m_Property > -1) {
+        object->metaObject()->property(m_Property).write(object, m_Old);
+    }
+    emit m_pController->objectsUpdated();
 }
 void PropertyObject::redo() {
-    Variant value = m_Value;
-
     Object *object = m_pController->findObject(m_Object);
-    if(object) {
-        const MetaObject *meta = object->metaObject();
-        int index = meta->indexOfProperty(qPrintable(m_Property));
-        if(index > -1) {
-            MetaProperty property = meta->property(index);
-            m_Value = property.read(object);
-
-            property.write(object, value);
+    if(object && m_Property > -1) {
+        MetaProperty property = object->metaObject()->property(m_Property);
+        // The previous value is taken on the first apply only, the object may be already modified by the caller
+        if(!m_Captured) {
+            m_Old = property.read(object);
+            m_Captured = true;
         }
+        property.write(object, m_New);
     }
     emit m_pController->objectsUpdated();
 }
@@ -102,6 +102,8 @@ protected:
 
     void selectGeometry(Vector2 &, Vector2 &size);
 
+    void drawSelectArea(const Vector2 &position, const Vector2 &size);
+
 private slots:
     void onApplySettings();
 
@@ -116,6 +118,7 @@ protected:
 
     bool m_Drag;
     bool m_Canceled;
+    bool m_SelectArea;
 
     uint8_t m_Axes;
 
@@ -128,6 +131,7 @@ protected:
     QString m_DragMap;
 
     Vector2 m_MousePosition;
+    Vector2 m_SelectOrigin;
     Vector2 m_Screen;
 
     Vector3 m_MouseWorld;
@@ -141,10 +145,10 @@ protected:
     QMenu *m_pMenu;
 };
 
-class UndoObject : public QUndoCommand {
+class UndoObject : public UndoCommand {
 public:
     UndoObject(ObjectCtrl *ctrl, const QString &name, QUndoCommand *group = nullptr) :
-            QUndoCommand(name, group) {
+            UndoCommand(name, group) {
         m_pController = ctrl;
     }
 protected:
@@ -175,10 +179,11 @@ public:
     DuplicateObjects(ObjectCtrl *ctrl, const QString &name = QObject::tr("Paste Objects"), QUndoCommand *group = nullptr);
     void undo() override;
     void redo() override;
+    void release() override;
 protected:
     list<uint32_t> m_Objects;
     list<uint32_t> m_Selected;
-    VariantList m_Dump;
+    list<UndoSnapshot> m_Dump;
 };
 
 class CreateObjectSerial : public UndoObject {
@@ -186,8 +191,9 @@ public:
     CreateObjectSerial(Object::ObjectList &list, ObjectCtrl *ctrl, const QString &name = QObject::tr("Create Object"), QUndoCommand *group = nullptr);
     void undo() override;
     void redo() override;
+    void release() override;
 protected:
-    VariantList m_Dump;
+    list<UndoSnapshot> m_Dump;
     list<uint32_t> m_Parents;
     list<uint32_t> m_Objects;
 };
@@ -197,8 +203,9 @@ public:
     DeleteActors(const Object::ObjectList &objects, ObjectCtrl *ctrl, const QString &name = QObject::tr("Delete Actors"), QUndoCommand *group = nullptr);
     void undo() override;
     void redo() override;
+    void release() override;
 protected:
-    VariantList m_dump;
+    list<UndoSnapshot> m_dump;
     list<uint32_t> m_parents;
     list<uint32_t> m_objects;
     list<uint32_t> m_indices;
@@ -209,8 +216,9 @@ public:
     RemoveComponent(const Component *component, ObjectCtrl *ctrl, const QString &name = QObject::tr("Remove Component"), QUndoCommand *group = nullptr);
     void undo() override;
     void redo() override;
+    void release() override;
 protected:
-    Variant m_dump;
+    UndoSnapshot m_dump;
     uint32_t m_parent;
     uint32_t m_uuid;
     int32_t m_index;
@@ -234,9 +242,11 @@ public:
     void undo() override;
     void redo() override;
 protected:
-    QString m_Property;
-    Variant m_Value;
+    Variant m_Old;
+    Variant m_New;
     uint32_t m_Object;
+    int32_t m_Property;
+    bool m_Captured;
 };
 
 #endif // OBJECTCTRL_H
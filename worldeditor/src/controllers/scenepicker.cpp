@@ -0,0 +1,192 @@
+#include "scenepicker.h"
+
+#include <components/actor.h>
+
+#include <commandbuffer.h>
+
+#include <algorithm>
+#include <cfloat>
+
+#define LEAF_SIZE   4
+#define STACK_SIZE  64
+
+static bool rayTest(Ray &ray, const Vector3 &min, const Vector3 &max, float scale, float distance) {
+    AABBox box;
+    box.setBox(min, max);
+
+    // Boxes entered farther than the closest hit can't contain a better one
+    Vector3 point;
+    return ray.intersect(box, &point) && (point - ray.pos).dot(ray.dir) * scale <= distance;
+}
+
+static bool frustumTest(const Vector3 &min, const Vector3 &max, const Plane *planes) {
+    AABBox box;
+    box.setBox(min, max);
+    return box.intersect(planes, 6);
+}
+
+void ScenePicker::build(const RenderList &list) {
+    m_Nodes.clear();
+    m_Items.clear();
+    m_Unbounded.clear();
+
+    m_Items.reserve(list.size());
+    for(auto it : list) {
+        Actor *actor = it->actor();
+        if(actor == nullptr || !(actor->layers() & ICommandBuffer::RAYCAST)) {
+            continue;
+        }
+
+        AABBox box = it->bound();
+        if(box.extent.x < 0.0f) {
+            m_Unbounded.push_back(it);
+            continue;
+        }
+
+        Item item;
+        item.renderable = it;
+        box.box(item.min, item.max);
+        item.center = box.center;
+        m_Items.push_back(item);
+    }
+
+    if(!m_Items.empty()) {
+        m_Nodes.reserve(m_Items.size() / LEAF_SIZE * 2 + 1);
+        buildNode(0, m_Items.size());
+    }
+}
+
+Renderable *ScenePicker::raycast(const Ray &ray, Vector3 *pt) const {
+    Renderable *result = nullptr;
+    float distance = FLT_MAX;
+    // Distances are measured in ray parameter units
+    float scale = 1.0f / ray.dir.sqrLength();
+
+    auto test = [&](Renderable *renderable) {
+        Vector3 point;
+        if(renderable->raycast(ray, &point)) {
+            float d = (point - ray.pos).dot(ray.dir) * scale;
+            if(d < distance) {
+                distance = d;
+                result = renderable;
+                if(pt) {
+                    *pt = point;
+                }
+            }
+        }
+    };
+
+    for(auto it : m_Unbounded) {
+        test(it);
+    }
+
+    if(m_Nodes.empty()) {
+        return result;
+    }
+
+    Ray r(ray);
+    uint32_t stack[STACK_SIZE];
+    int32_t top = 0;
+    stack[top++] = 0;
+    while(top > 0) {
+        uint32_t index = stack[--top];
+        const Node &node = m_Nodes[index];
+        if(!rayTest(r, node.min, node.max, scale, distance)) {
+            continue;
+        }
+
+        if(node.count > 0) {
+            for(uint32_t i = node.offset; i < node.offset + node.count; i++) {
+                const Item &item = m_Items[i];
+                if(rayTest(r, item.min, item.max, scale, distance)) {
+                    test(item.renderable);
+                }
+            }
+        } else if(top + 2 <= STACK_SIZE) {
+            stack[top++] = node.offset;
+            stack[top++] = index + 1;
+        }
+    }
+
+    return result;
+}
+
+RenderList ScenePicker::frustum(const array<Vector3, 8> &corners) const {
+    Plane planes[6];
+    planes[0] = Plane(corners[1], corners[0], corners[4]); // top
+    planes[1] = Plane(corners[7], corners[3], corners[2]); // bottom
+    planes[2] = Plane(corners[3], corners[7], corners[0]); // left
+    planes[3] = Plane(corners[2], corners[1], corners[6]); // right
+    planes[4] = Plane(corners[0], corners[1], corners[3]); // near
+    planes[5] = Plane(corners[5], corners[4], corners[6]); // far
+
+    RenderList result;
+    if(m_Nodes.empty()) {
+        return result;
+    }
+
+    uint32_t stack[STACK_SIZE];
+    int32_t top = 0;
+    stack[top++] = 0;
+    while(top > 0) {
+        uint32_t index = stack[--top];
+        const Node &node = m_Nodes[index];
+        if(!frustumTest(node.min, node.max, planes)) {
+            continue;
+        }
+
+        if(node.count > 0) {
+            for(uint32_t i = node.offset; i < node.offset + node.count; i++) {
+                const Item &item = m_Items[i];
+                if(frustumTest(item.min, item.max, planes)) {
+                    result.push_back(item.renderable);
+                }
+            }
+        } else if(top + 2 <= STACK_SIZE) {
+            stack[top++] = node.offset;
+            stack[top++] = index + 1;
+        }
+    }
+
+    return result;
+}
+
+uint32_t ScenePicker::buildNode(uint32_t begin, uint32_t end) {
+    uint32_t index = m_Nodes.size();
+    m_Nodes.push_back(Node());
+
+    Vector3 min( FLT_MAX);
+    Vector3 max(-FLT_MAX);
+    Vector3 cmin( FLT_MAX);
+    Vector3 cmax(-FLT_MAX);
+    for(uint32_t i = begin; i < end; i++) {
+        const Item &item = m_Items[i];
+        for(int32_t axis = 0; axis < 3; axis++) {
+            min[axis] = MIN(min[axis], item.min[axis]);
+            max[axis] = MAX(max[axis], item.max[axis]);
+            cmin[axis] = MIN(cmin[axis], item.center[axis]);
+            cmax[axis] = MAX(cmax[axis], item.center[axis]);
+        }
+    }
+    m_Nodes[index].min = min;
+    m_Nodes[index].max = max;
+
+    Vector3 size = cmax - cmin;
+    int32_t axis = (size.x > size.y) ? ((size.x > size.z) ? 0 : 2) : ((size.y > size.z) ? 1 : 2);
+    if(end - begin <= LEAF_SIZE || size[axis] <= 0.0f) {
+        m_Nodes[index].offset = begin;
+        m_Nodes[index].count = end - begin;
+        return index;
+    }
+
+    uint32_t middle = (begin + end) / 2;
+    nth_element(m_Items.begin() + begin, m_Items.begin() + middle, m_Items.begin() + end,
+                [axis](const Item &a, const Item &b) { return a.center[axis] < b.center[axis]; });
+
+    buildNode(begin, middle);
+    uint32_t right = buildNode(middle, end);
+
+    m_Nodes[index].offset = right;
+    m_Nodes[index].count = 0;
+    return index;
+}
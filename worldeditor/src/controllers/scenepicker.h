@@ -0,0 +1,40 @@
+#ifndef SCENEPICKER_H
+#define SCENEPICKER_H
+
+#include <components/renderable.h>
+
+#include <array>
+
+class ScenePicker {
+public:
+    void build(const RenderList &list);
+
+    Renderable *raycast(const Ray &ray, Vector3 *pt) const;
+
+    RenderList frustum(const array<Vector3, 8> &corners) const;
+
+protected:
+    struct Node {
+        Vector3 min;
+        Vector3 max;
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    struct Item {
+        Renderable *renderable;
+        Vector3 min;
+        Vector3 max;
+        Vector3 center;
+    };
+
+    uint32_t buildNode(uint32_t begin, uint32_t end);
+
+    vector<Node> m_Nodes;
+
+    vector<Item> m_Items;
+
+    RenderList m_Unbounded;
+};
+
+#endif // SCENEPICKER_H
@@ -22,6 +22,7 @@ ImportQueue::ImportQueue(Engine *engine, QWidget *parent) :
 
     AssetManager *manager = AssetManager::instance();
     connect(manager, &AssetManager::importStarted, this, &ImportQueue::onStarted);
+    connect(manager, &AssetManager::importProgress, this, &ImportQueue::onProgress);
     connect(manager, &AssetManager::imported, this, &ImportQueue::onProcessed);
 
     connect(manager, &AssetManager::importFinished, this, &ImportQueue::onImportFinished);
@@ -39,12 +40,15 @@ ImportQueue::~ImportQueue() {
 }
 
 void ImportQueue::onProcessed(const QString &path, const QString &type) {
-    ui->progressBar->setValue(ui->progressBar->value() + 1);
-
     QString guid = QString::fromStdString(AssetManager::instance()->pathToGuid(path.toStdString()));
     m_UpdateQueue[guid] = type;
 }
 
+void ImportQueue::onProgress(int processed, int count) {
+    ui->progressBar->setMaximum(count);
+    ui->progressBar->setValue(processed);
+}
+
 void ImportQueue::onStarted(int count, const QString &action) {
     show();
     ui->progressBar->setValue(0);
@@ -31,6 +31,7 @@ signals:
 
 private slots:
     void onProcessed(const QString &path, const QString &type);
+    void onProgress(int processed, int count);
 
     void onStarted(int count, const QString &action);
     void onImportFinished();
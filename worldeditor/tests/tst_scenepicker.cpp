@@ -0,0 +1,131 @@
+#include "tst_common.h"
+
+#include "scenepicker.h"
+
+#include "components/actor.h"
+#include "components/transform.h"
+#include "components/meshrender.h"
+#include "components/camera.h"
+
+#include "resources/mesh.h"
+
+#include "systems/rendersystem.h"
+
+#include <cfloat>
+
+#define GRID 8
+
+class ScenePickerTest : public QObject {
+    Q_OBJECT
+
+    Mesh *createCube() {
+        Lod lod;
+        lod.setVertices({Vector3(-0.5f,-0.5f,-0.5f), Vector3( 0.5f,-0.5f,-0.5f), Vector3( 0.5f, 0.5f,-0.5f), Vector3(-0.5f, 0.5f,-0.5f),
+                         Vector3(-0.5f,-0.5f, 0.5f), Vector3( 0.5f,-0.5f, 0.5f), Vector3( 0.5f, 0.5f, 0.5f), Vector3(-0.5f, 0.5f, 0.5f)});
+        lod.setIndices({0, 2, 1, 0, 3, 2,  4, 5, 6, 4, 6, 7,  0, 1, 5, 0, 5, 4,
+                        3, 6, 2, 3, 7, 6,  0, 4, 7, 0, 7, 3,  1, 2, 6, 1, 6, 5});
+
+        Mesh *mesh = Engine::objectCreate<Mesh>("Cube");
+        mesh->addLod(&lod);
+        return mesh;
+    }
+
+    RenderList createScene(Mesh *mesh) {
+        Actor *root = Engine::objectCreate<Actor>("Root");
+        RenderList result;
+        for(int32_t z = 0; z < GRID; z++) {
+            for(int32_t y = 0; y < GRID; y++) {
+                for(int32_t x = 0; x < GRID; x++) {
+                    Actor *actor = Engine::objectCreate<Actor>("Actor", root);
+                    actor->addComponent("Transform");
+                    actor->transform()->setPosition(Vector3(x * 2.0f, y * 2.0f, z * 2.0f));
+
+                    MeshRender *render = static_cast<MeshRender *>(actor->addComponent("MeshRender"));
+                    render->setMesh(mesh);
+                    result.push_back(render);
+                }
+            }
+        }
+        return result;
+    }
+
+    Renderable *bruteForce(const RenderList &list, const Ray &ray, Vector3 *pt) {
+        Renderable *result = nullptr;
+        float distance = FLT_MAX;
+        for(auto it : list) {
+            Vector3 point;
+            if(it->raycast(ray, &point)) {
+                float d = (point - ray.pos).length();
+                if(d < distance) {
+                    distance = d;
+                    result = it;
+                    *pt = point;
+                }
+            }
+        }
+        return result;
+    }
+
+private slots:
+
+void Raycast_closest() {
+    Engine system(nullptr, "");
+    RenderSystem render;
+    render.registerClasses();
+
+    RenderList list = createScene(createCube());
+
+    ScenePicker picker;
+    picker.build(list);
+
+    // Rays along the axes, diagonal ones and the ones which start inside of the scene
+    Ray rays[] = {
+        Ray(Vector3(-10.0f, 4.2f, 6.1f), Vector3(1.0f, 0.0f, 0.0f)),
+        Ray(Vector3(2.1f, 30.0f, 4.3f), Vector3(0.0f,-1.0f, 0.0f)),
+        Ray(Vector3(-5.0f,-5.0f,-5.0f), Vector3(1.0f, 1.0f, 1.0f)),
+        Ray(Vector3(7.0f, 7.0f, 7.0f), Vector3(-0.3f, 1.0f, 0.2f)),
+        Ray(Vector3(4.1f, 4.2f,-3.0f), Vector3(0.1f, 0.05f, 2.0f)),
+        Ray(Vector3(0.2f, 0.1f, 1.0f), Vector3(0.0f, 0.0f, 1.0f))
+    };
+    for(auto &ray : rays) {
+        ray.dir.normalize();
+
+        Vector3 expectedPoint;
+        Renderable *expected = bruteForce(list, ray, &expectedPoint);
+        QVERIFY(expected != nullptr);
+
+        Vector3 point;
+        QCOMPARE(picker.raycast(ray, &point), expected);
+        QVERIFY((point - expectedPoint).length() < 0.001f);
+    }
+
+    // Rays which miss the whole scene
+    Vector3 point;
+    QVERIFY(picker.raycast(Ray(Vector3(-10.0f, 4.0f, 6.0f), Vector3(-1.0f, 0.0f, 0.0f)), &point) == nullptr);
+    QVERIFY(picker.raycast(Ray(Vector3(-10.0f, 1.0f, 6.0f), Vector3(0.0f, 1.0f, 0.0f)), &point) == nullptr);
+}
+
+void Frustum_selection() {
+    Engine system(nullptr, "");
+    RenderSystem render;
+    render.registerClasses();
+
+    RenderList list = createScene(createCube());
+
+    ScenePicker picker;
+    picker.build(list);
+
+    // Orthographic frustum around the 2x2x2 group of cubes in the corner of the grid
+    array<Vector3, 8> corners = Camera::frustumCorners(true, 2.4f, 1.0f, Vector3(1.0f, 1.0f, 5.0f), Quaternion(), 2.8f, 5.2f);
+
+    RenderList result = picker.frustum(corners);
+    QCOMPARE(result.size(), static_cast<size_t>(8));
+    for(auto it : result) {
+        Vector3 position = it->actor()->transform()->position();
+        QVERIFY(position.x < 3.0f && position.y < 3.0f && position.z < 3.0f);
+    }
+}
+
+} REGISTER(ScenePickerTest)
+
+#include "tst_scenepicker.moc"